@@ -0,0 +1,128 @@
+// Compares MQ partial tracking with linked lists (mq_track_peaks) and with
+// arrays (mq_track_peak_array) as the number of peaks per frame grows.
+//
+// Each frame has num_peaks random peaks between 20 Hz and 20 kHz, which
+// drift by up to 20 Hz from frame to frame. The times include building
+// and sorting the peaks for each frame, as done by MQPartialTracking.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <vector>
+
+#include "mq.h"
+
+using namespace simpl;
+
+static const int NUM_FRAMES = 64;
+
+static double now() {
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + (t.tv_usec * 1e-6);
+}
+
+static void make_peaks(int num_peaks, std::vector<sample>& amps,
+                       std::vector<sample>& freqs) {
+    amps.resize(NUM_FRAMES * num_peaks);
+    freqs.resize(NUM_FRAMES * num_peaks);
+
+    for(int i = 0; i < num_peaks; i++) {
+        freqs[i] = 20 + (19980.0 * rand() / RAND_MAX);
+    }
+    for(int frame = 1; frame < NUM_FRAMES; frame++) {
+        for(int i = 0; i < num_peaks; i++) {
+            freqs[(frame * num_peaks) + i] =
+                freqs[((frame - 1) * num_peaks) + i] +
+                (40.0 * rand() / RAND_MAX) - 20.0;
+        }
+    }
+    for(int i = 0; i < amps.size(); i++) {
+        amps[i] = (sample)rand() / RAND_MAX;
+    }
+}
+
+// Returns the mean time per frame in microseconds
+static double time_list(int num_peaks, std::vector<sample>& amps,
+                        std::vector<sample>& freqs) {
+    MQParameters params;
+    params.max_peaks = num_peaks;
+    params.matching_interval = 100.0;
+    init_mq(&params);
+
+    MQPeakList* prev_list = NULL;
+    double start = now();
+
+    for(int frame = 0; frame < NUM_FRAMES; frame++) {
+        MQPeakList* list = mq_new_peak_list(&params);
+        for(int i = 0; i < num_peaks; i++) {
+            MQPeak* p = mq_new_peak(&params);
+            p->amplitude = amps[(frame * num_peaks) + i];
+            p->frequency = freqs[(frame * num_peaks) + i];
+            p->bin = i;
+            mq_add_peak(p, list, &params);
+        }
+        mq_track_peaks(list, &params);
+        list = mq_sort_peaks_by_frequency(list, num_peaks);
+        params.prev_peaks = list;
+
+        if(prev_list) {
+            delete_peak_list(prev_list, &params);
+        }
+        prev_list = list;
+    }
+
+    double elapsed = now() - start;
+    delete_peak_list(prev_list, &params);
+    destroy_mq(&params);
+    return (elapsed * 1e6) / NUM_FRAMES;
+}
+
+static double time_array(int num_peaks, std::vector<sample>& amps,
+                         std::vector<sample>& freqs) {
+    MQParameters params;
+    params.max_peaks = num_peaks;
+    params.matching_interval = 100.0;
+
+    MQPeakArray peaks;
+    MQPeakArray prev_peaks;
+    mq_init_peak_array(&peaks, num_peaks);
+    mq_init_peak_array(&prev_peaks, num_peaks);
+
+    std::vector<sample> phases(num_peaks, 0.0);
+    double start = now();
+
+    for(int frame = 0; frame < NUM_FRAMES; frame++) {
+        mq_set_peaks(&peaks, num_peaks, &amps[frame * num_peaks],
+                     &freqs[frame * num_peaks], &phases[0]);
+        mq_track_peak_array(&prev_peaks, &peaks, &params);
+        std::swap(peaks, prev_peaks);
+    }
+
+    double elapsed = now() - start;
+    mq_destroy_peak_array(&peaks);
+    mq_destroy_peak_array(&prev_peaks);
+    return (elapsed * 1e6) / NUM_FRAMES;
+}
+
+int main() {
+    srand(1);
+
+    printf("%8s %14s %14s %10s\n", "peaks", "list (us)", "array (us)",
+           "speedup");
+
+    int sizes[] = {100, 250, 500, 1000, 2000, 4000};
+    for(int i = 0; i < 6; i++) {
+        std::vector<sample> amps;
+        std::vector<sample> freqs;
+        make_peaks(sizes[i], amps, freqs);
+
+        double list = time_list(sizes[i], amps, freqs);
+        double array = time_array(sizes[i], amps, freqs);
+        printf("%8d %14.2f %14.2f %9.2fx\n", sizes[i], list, array,
+               list / array);
+    }
+
+    return 0;
+}
@@ -0,0 +1,493 @@
+// Times the peak detection, partial tracking, synthesis and residual stages
+// of every backend, on a recording and on synthetic signals, over a grid of
+// frame sizes, hop sizes and max_peaks values.
+//
+// The results are written as JSON in the same layout as Google Benchmark
+// (a "context" object and a "benchmarks" array), so that runs of different
+// releases can be compared with the same tools. Times are per frame, in
+// microseconds.
+//
+// Options:
+//   --benchmark_filter=<regex>      only run benchmarks with matching names
+//   --benchmark_repetitions=<n>     run each benchmark n times (default 3)
+//   --benchmark_out=<file>          write the JSON to file, not stdout
+//   --benchmark_audio=<file>        the recording (default flute.wav)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <regex.h>
+#include <string>
+#include <vector>
+#include <sndfile.hh>
+
+#include "simpl.h"
+
+using namespace simpl;
+
+static const int SAMPLING_RATE = 44100;
+static const int DEFAULT_REPETITIONS = 3;
+static const char* DEFAULT_AUDIO_FILE = "../tests/audio/flute.wav";
+
+
+// ---------------------------------------------------------------------------
+// Backends and parameters
+// ---------------------------------------------------------------------------
+template<class T, class Base>
+static Base* make() {
+    return new T();
+}
+
+struct Backend {
+    const char* name;
+    PeakDetection* (*peak_detection)();
+    PartialTracking* (*partial_tracking)();
+    Synthesis* (*synthesis)();
+    Residual* (*residual)();
+};
+
+static const Backend BACKENDS[] = {
+    {"MQ",
+     &make<MQPeakDetection, PeakDetection>,
+     &make<MQPartialTracking, PartialTracking>,
+     &make<MQSynthesis, Synthesis>,
+     NULL},
+    {"SMS",
+     &make<SMSPeakDetection, PeakDetection>,
+     &make<SMSPartialTracking, PartialTracking>,
+     &make<SMSSynthesis, Synthesis>,
+     &make<SMSResidual, Residual>},
+    {"SndObj",
+     &make<SndObjPeakDetection, PeakDetection>,
+     &make<SndObjPartialTracking, PartialTracking>,
+     &make<SndObjSynthesis, Synthesis>,
+     NULL},
+    {"Loris",
+     &make<LorisPeakDetection, PeakDetection>,
+     &make<LorisPartialTracking, PartialTracking>,
+     &make<LorisSynthesis, Synthesis>,
+     NULL},
+    // inverse FFT synthesis of MQ partials
+    {"IFFT",
+     &make<MQPeakDetection, PeakDetection>,
+     &make<MQPartialTracking, PartialTracking>,
+     &make<IFFTSynthesis, Synthesis>,
+     NULL},
+    // linear prediction tracking of MQ peaks
+    {"LP",
+     &make<MQPeakDetection, PeakDetection>,
+     &make<LPPartialTracking, PartialTracking>,
+     &make<MQSynthesis, Synthesis>,
+     NULL}
+};
+static const int NUM_BACKENDS = sizeof(BACKENDS) / sizeof(Backend);
+
+struct Parameters {
+    int frame_size;
+    int hop_size;
+    int max_peaks;
+};
+
+static const Parameters PARAMETERS[] = {
+    {512, 128, 20}, {512, 128, 100},
+    {512, 256, 20}, {512, 256, 100},
+    {1024, 256, 20}, {1024, 256, 100},
+    {2048, 256, 20}, {2048, 256, 100},
+    {2048, 512, 20}, {2048, 512, 100}
+};
+static const int NUM_PARAMETERS = sizeof(PARAMETERS) / sizeof(Parameters);
+
+enum Stages {
+    PEAK_DETECTION = 0,
+    PARTIAL_TRACKING,
+    SYNTHESIS,
+    RESIDUAL,
+    NUM_STAGES
+};
+
+static const char* STAGE_NAMES[] = {
+    "PeakDetection", "PartialTracking", "Synthesis", "Residual"
+};
+
+
+// ---------------------------------------------------------------------------
+// Signals
+// ---------------------------------------------------------------------------
+struct Signal {
+    std::string name;
+    std::vector<sample> audio;
+};
+
+static bool read_audio(const char* path, Signal& signal) {
+    SndfileHandle file(path);
+    if(file.error() > 0 || file.frames() == 0) {
+        return false;
+    }
+
+    int channels = file.channels();
+    std::vector<sample> interleaved(file.frames() * channels);
+    file.read(&interleaved[0], interleaved.size());
+
+    // Report the recording by its file name without directory or extension
+    const char* base = strrchr(path, '/');
+    signal.name = base ? base + 1 : path;
+    size_t dot = signal.name.rfind('.');
+    if(dot != std::string::npos && dot > 0) {
+        signal.name.erase(dot);
+    }
+    signal.audio.resize(file.frames());
+    for(int i = 0; i < file.frames(); i++) {
+        signal.audio[i] = interleaved[i * channels];
+    }
+    return true;
+}
+
+// One second of num_partials sinusoids with 1/n amplitudes, either the
+// harmonics of 220 Hz with vibrato, or fixed inharmonic partials
+static void make_signal(const char* name, int num_partials, bool harmonic,
+                        Signal& signal) {
+    int size = SAMPLING_RATE;
+    signal.name = name;
+    signal.audio.assign(size, 0.0);
+
+    srand(1);
+    for(int n = 1; n <= num_partials; n++) {
+        sample freq = harmonic ? 220.0 * n : 100 + (15000.0 * rand() / RAND_MAX);
+        sample amp = 1.0 / n;
+        sample phase = 0.0;
+
+        for(int i = 0; i < size; i++) {
+            sample f = freq;
+            if(harmonic) {
+                f *= 1.0 + (0.01 * sin(2 * M_PI * 5.0 * i / SAMPLING_RATE));
+            }
+            phase += 2 * M_PI * f / SAMPLING_RATE;
+            signal.audio[i] += amp * sin(phase);
+        }
+    }
+
+    sample max_amp = 0.0;
+    for(int i = 0; i < size; i++) {
+        if(fabs(signal.audio[i]) > max_amp) {
+            max_amp = fabs(signal.audio[i]);
+        }
+    }
+    for(int i = 0; i < size; i++) {
+        signal.audio[i] *= 0.9 / max_amp;
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+// Timing
+// ---------------------------------------------------------------------------
+struct Result {
+    std::string name;
+    std::string backend;
+    std::string stage;
+    std::string signal;
+    Parameters parameters;
+    int num_frames;
+    int repetitions;
+    double real_time;
+    double min_real_time;
+    double cpu_time;
+    double peaks_per_frame;
+    double partials_per_frame;
+};
+
+struct Timer {
+    double real_start;
+    clock_t cpu_start;
+    double real_time;
+    double min_real_time;
+    double cpu_time;
+
+    Timer() {
+        real_time = 0.0;
+        min_real_time = -1.0;
+        cpu_time = 0.0;
+    }
+
+    void start() {
+        real_start = profile_clock();
+        cpu_start = clock();
+    }
+
+    void stop() {
+        double real = profile_clock() - real_start;
+        real_time += real;
+        if(min_real_time < 0 || real < min_real_time) {
+            min_real_time = real;
+        }
+        cpu_time += (double)(clock() - cpu_start) / CLOCKS_PER_SEC;
+    }
+};
+
+static std::string benchmark_name(const Backend& backend, int stage,
+                                  const Signal& signal,
+                                  const Parameters& parameters) {
+    char name[256];
+    snprintf(name, sizeof(name),
+             "%s%s/%s/frame_size:%d/hop_size:%d/max_peaks:%d",
+             backend.name, STAGE_NAMES[stage], signal.name.c_str(),
+             parameters.frame_size, parameters.hop_size,
+             parameters.max_peaks);
+    return name;
+}
+
+static void configure(PeakDetection* pd, PartialTracking* pt,
+                      Synthesis* synth, const Parameters& parameters) {
+    pd->sampling_rate(SAMPLING_RATE);
+    pd->frame_size(parameters.frame_size);
+    pd->hop_size(parameters.hop_size);
+    pd->max_peaks(parameters.max_peaks);
+
+    pt->sampling_rate(SAMPLING_RATE);
+    pt->max_partials(parameters.max_peaks);
+
+    synth->sampling_rate(SAMPLING_RATE);
+    synth->frame_size(parameters.frame_size);
+    synth->hop_size(parameters.hop_size);
+    synth->max_partials(parameters.max_peaks);
+}
+
+// Run every stage of the backend repetitions times on the signal, adding
+// a result for each stage whose name matches the filter
+static void run(const Backend& backend, Signal& signal,
+                const Parameters& parameters, int repetitions,
+                regex_t* filter, std::vector<Result>& results) {
+    std::string names[NUM_STAGES];
+    bool selected = false;
+
+    for(int stage = 0; stage < NUM_STAGES; stage++) {
+        names[stage] = benchmark_name(backend, stage, signal, parameters);
+        if(stage == RESIDUAL && !backend.residual) {
+            continue;
+        }
+        if(!filter || regexec(filter, names[stage].c_str(), 0, NULL, 0) == 0) {
+            selected = true;
+        }
+    }
+    if(!selected) {
+        return;
+    }
+
+    Timer timers[NUM_STAGES];
+    int num_frames = 0;
+    long num_peaks = 0;
+    long num_partials = 0;
+    int audio_size = signal.audio.size();
+    sample* audio = &signal.audio[0];
+
+    for(int i = 0; i < repetitions; i++) {
+        PeakDetection* pd = backend.peak_detection();
+        PartialTracking* pt = backend.partial_tracking();
+        Synthesis* synth = backend.synthesis();
+        configure(pd, pt, synth, parameters);
+
+        timers[PEAK_DETECTION].start();
+        Frames frames = pd->find_peaks(audio_size, audio);
+        timers[PEAK_DETECTION].stop();
+
+        timers[PARTIAL_TRACKING].start();
+        frames = pt->find_partials(frames);
+        timers[PARTIAL_TRACKING].stop();
+
+        timers[SYNTHESIS].start();
+        frames = synth->synth(frames);
+        timers[SYNTHESIS].stop();
+
+        num_frames = frames.size();
+        for(int j = 0; j < num_frames; j++) {
+            num_peaks += frames[j]->num_peaks();
+            num_partials += frames[j]->num_partials();
+        }
+
+        delete synth;
+        delete pt;
+        delete pd;
+
+        if(backend.residual) {
+            Residual* residual = backend.residual();
+            residual->sampling_rate(SAMPLING_RATE);
+            residual->frame_size(parameters.frame_size);
+            residual->hop_size(parameters.hop_size);
+
+            timers[RESIDUAL].start();
+            residual->synth(audio_size, audio);
+            timers[RESIDUAL].stop();
+
+            delete residual;
+        }
+    }
+
+    for(int stage = 0; stage < NUM_STAGES; stage++) {
+        if(stage == RESIDUAL && !backend.residual) {
+            continue;
+        }
+        if(filter && regexec(filter, names[stage].c_str(), 0, NULL, 0) != 0) {
+            continue;
+        }
+
+        double frames_run = (double)num_frames * repetitions;
+        Result r;
+        r.name = names[stage];
+        r.backend = backend.name;
+        r.stage = STAGE_NAMES[stage];
+        r.signal = signal.name;
+        r.parameters = parameters;
+        r.num_frames = num_frames;
+        r.repetitions = repetitions;
+        r.real_time = frames_run > 0 ?
+            (timers[stage].real_time * 1e6) / frames_run : 0.0;
+        r.min_real_time = num_frames > 0 ?
+            (timers[stage].min_real_time * 1e6) / num_frames : 0.0;
+        r.cpu_time = frames_run > 0 ?
+            (timers[stage].cpu_time * 1e6) / frames_run : 0.0;
+        r.peaks_per_frame = frames_run > 0 ? num_peaks / frames_run : 0.0;
+        r.partials_per_frame = frames_run > 0 ?
+            num_partials / frames_run : 0.0;
+        results.push_back(r);
+
+        fprintf(stderr, "%-64s %12.2f us\n", r.name.c_str(), r.real_time);
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+static void write_json(FILE* out, std::vector<Result>& results,
+                       int repetitions) {
+    char date[64];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"library\": \"simpl\",\n");
+#ifdef __VERSION__
+    fprintf(out, "    \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(out, "    \"sampling_rate\": %d,\n", SAMPLING_RATE);
+    fprintf(out, "    \"repetitions\": %d,\n", repetitions);
+    fprintf(out, "    \"simd_level\": %d,\n", mq_simd_level());
+    fprintf(out, "    \"profiling_enabled\": %s\n",
+            profiling_enabled() ? "true" : "false");
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"benchmarks\": [");
+
+    for(int i = 0; i < results.size(); i++) {
+        Result& r = results[i];
+        fprintf(out, "%s\n    {\n", i > 0 ? "," : "");
+        fprintf(out, "      \"name\": \"%s\",\n", r.name.c_str());
+        fprintf(out, "      \"backend\": \"%s\",\n", r.backend.c_str());
+        fprintf(out, "      \"stage\": \"%s\",\n", r.stage.c_str());
+        fprintf(out, "      \"signal\": \"%s\",\n", r.signal.c_str());
+        fprintf(out, "      \"frame_size\": %d,\n", r.parameters.frame_size);
+        fprintf(out, "      \"hop_size\": %d,\n", r.parameters.hop_size);
+        fprintf(out, "      \"max_peaks\": %d,\n", r.parameters.max_peaks);
+        fprintf(out, "      \"iterations\": %d,\n", r.num_frames * r.repetitions);
+        fprintf(out, "      \"frames\": %d,\n", r.num_frames);
+        fprintf(out, "      \"repetitions\": %d,\n", r.repetitions);
+        fprintf(out, "      \"real_time\": %.4f,\n", r.real_time);
+        fprintf(out, "      \"min_real_time\": %.4f,\n", r.min_real_time);
+        fprintf(out, "      \"cpu_time\": %.4f,\n", r.cpu_time);
+        fprintf(out, "      \"time_unit\": \"us\",\n");
+        fprintf(out, "      \"peaks_per_frame\": %.4f,\n", r.peaks_per_frame);
+        fprintf(out, "      \"partials_per_frame\": %.4f\n",
+                r.partials_per_frame);
+        fprintf(out, "    }");
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static const char* option(const char* arg, const char* name) {
+    int length = strlen(name);
+    if(strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        return arg + length + 1;
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    const char* filter_pattern = NULL;
+    const char* out_path = NULL;
+    const char* audio_path = DEFAULT_AUDIO_FILE;
+    int repetitions = DEFAULT_REPETITIONS;
+
+    for(int i = 1; i < argc; i++) {
+        const char* value = NULL;
+        if((value = option(argv[i], "--benchmark_filter"))) {
+            filter_pattern = value;
+        }
+        else if((value = option(argv[i], "--benchmark_repetitions"))) {
+            repetitions = atoi(value);
+        }
+        else if((value = option(argv[i], "--benchmark_out"))) {
+            out_path = value;
+        }
+        else if((value = option(argv[i], "--benchmark_audio"))) {
+            audio_path = value;
+        }
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if(repetitions < 1) {
+        fprintf(stderr, "Repetitions must be at least 1\n");
+        return 1;
+    }
+
+    regex_t filter;
+    if(filter_pattern &&
+       regcomp(&filter, filter_pattern, REG_EXTENDED | REG_NOSUB) != 0) {
+        fprintf(stderr, "Invalid filter: %s\n", filter_pattern);
+        return 1;
+    }
+
+    std::vector<Signal> signals(3);
+    if(!read_audio(audio_path, signals[0])) {
+        fprintf(stderr, "Could not open audio file: %s\n", audio_path);
+        return 1;
+    }
+    make_signal("harmonic_20", 20, true, signals[1]);
+    make_signal("inharmonic_60", 60, false, signals[2]);
+
+    std::vector<Result> results;
+    for(int s = 0; s < signals.size(); s++) {
+        for(int p = 0; p < NUM_PARAMETERS; p++) {
+            for(int b = 0; b < NUM_BACKENDS; b++) {
+                run(BACKENDS[b], signals[s], PARAMETERS[p], repetitions,
+                    filter_pattern ? &filter : NULL, results);
+            }
+        }
+    }
+
+    if(filter_pattern) {
+        regfree(&filter);
+    }
+
+    FILE* out = stdout;
+    if(out_path) {
+        out = fopen(out_path, "w");
+        if(!out) {
+            fprintf(stderr, "Could not open output file: %s\n", out_path);
+            return 1;
+        }
+    }
+
+    write_json(out, results, repetitions);
+
+    if(out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Compares the SMS FFT backends on the transform sizes used by SMS.
+//
+// SMS analysis uses FFTs of twice the magnitude spectrum size, which
+// depends on the analysis window size and is capped by SMS_MAX_SPEC.
+// Synthesis and the residual use FFTs of twice the hop size.
+
+#include <stdio.h>
+#include <sys/time.h>
+#include <vector>
+
+extern "C" {
+    #include "sms.h"
+}
+
+static double now() {
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + (t.tv_usec * 1e-6);
+}
+
+// Returns the mean time in microseconds for a forward and inverse
+// transform of the given size
+static double time_fft(int backend, int size) {
+    if(sms_setFFTBackend(backend) != SMS_OK) {
+        return -1;
+    }
+
+    std::vector<sfloat> signal(size);
+    for(int i = 0; i < size; i++) {
+        signal[i] = sin(0.1 * i);
+    }
+
+    // warm up and make any plans
+    sms_fft(size, &signal[0]);
+    sms_ifft(size, &signal[0]);
+
+    int num_iterations = (1 << 24) / size;
+    double start = now();
+    for(int i = 0; i < num_iterations; i++) {
+        sms_fft(size, &signal[0]);
+        sms_ifft(size, &signal[0]);
+        for(int j = 0; j < size; j++) {
+            signal[j] *= 2.0 / size;
+        }
+    }
+    return ((now() - start) * 1e6) / num_iterations;
+}
+
+int main() {
+    sms_init();
+
+    printf("%8s %14s %14s %10s\n", "size", "ooura (us)", "fftw (us)",
+           "speedup");
+
+    for(int size = 256; size <= SMS_MAX_SPEC * 2; size *= 2) {
+        // the bundled OOURA tables stop at 8192
+        double ooura = size <= 8192 ? time_fft(SMS_FFT_OOURA, size) : -1;
+        double fftw = time_fft(SMS_FFT_FFTW, size);
+
+        if(ooura > 0 && fftw > 0) {
+            printf("%8d %14.2f %14.2f %9.2fx\n", size, ooura, fftw,
+                   ooura / fftw);
+        }
+        else if(fftw > 0) {
+            printf("%8d %14s %14.2f %10s\n", size, "-", fftw, "-");
+        }
+        else {
+            printf("%8d %14.2f %14s %10s\n", size, ooura, "-", "-");
+        }
+    }
+
+    sms_free();
+    return 0;
+}
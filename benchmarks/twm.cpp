@@ -0,0 +1,117 @@
+// Compares TWM fundamental frequency estimation with twm(), with a TWM
+// object searching every candidate, and with a TWM object using the
+// default coarse to fine search, at each SIMD level.
+//
+// Each frame has the first 5 to 35 harmonics of a random fundamental
+// between 50 Hz and 1 kHz, with small frequency deviations and random
+// amplitudes, plus up to 10 weaker spurious peaks.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+#include "twm.h"
+
+using namespace simpl;
+
+static const int NUM_FRAMES = 2000;
+
+static double now() {
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + (t.tv_usec * 1e-6);
+}
+
+static sample random(sample max) {
+    return max * rand() / RAND_MAX;
+}
+
+static void make_peaks(std::vector<int>& num_peaks,
+                       std::vector<sample>& amps,
+                       std::vector<sample>& freqs) {
+    for(int frame = 0; frame < NUM_FRAMES; frame++) {
+        sample f0 = 50 + random(950);
+        int num_harmonics = 5 + (rand() % 31);
+        int num_spurious = rand() % 11;
+
+        for(int n = 1; n <= num_harmonics; n++) {
+            freqs.push_back(n * f0 * (1 + random(0.003) - 0.0015));
+            amps.push_back(0.05 + random(1.0));
+        }
+        for(int i = 0; i < num_spurious; i++) {
+            freqs.push_back(20 + random(5000));
+            amps.push_back(random(0.3));
+        }
+        num_peaks.push_back(num_harmonics + num_spurious);
+    }
+}
+
+// Returns the mean time per frame in microseconds
+static double time_function(std::vector<int>& num_peaks,
+                            std::vector<sample>& amps,
+                            std::vector<sample>& freqs) {
+    std::vector<Peak> peak_storage(amps.size());
+    Peaks peaks;
+    int first = 0;
+    double elapsed = 0.0;
+
+    for(int frame = 0; frame < NUM_FRAMES; frame++) {
+        peaks.clear();
+        for(int i = first; i < first + num_peaks[frame]; i++) {
+            peak_storage[i].amplitude = amps[i];
+            peak_storage[i].frequency = freqs[i];
+            peaks.push_back(&peak_storage[i]);
+        }
+
+        double start = now();
+        twm(peaks);
+        elapsed += now() - start;
+        first += num_peaks[frame];
+    }
+
+    return (elapsed * 1e6) / NUM_FRAMES;
+}
+
+static double time_object(TWM& estimator, std::vector<int>& num_peaks,
+                          std::vector<sample>& amps,
+                          std::vector<sample>& freqs) {
+    int first = 0;
+    double start = now();
+
+    for(int frame = 0; frame < NUM_FRAMES; frame++) {
+        estimator.find_f0(num_peaks[frame], &amps[first], &freqs[first]);
+        first += num_peaks[frame];
+    }
+
+    return ((now() - start) * 1e6) / NUM_FRAMES;
+}
+
+int main() {
+    srand(1);
+
+    std::vector<int> num_peaks;
+    std::vector<sample> amps;
+    std::vector<sample> freqs;
+    make_peaks(num_peaks, amps, freqs);
+
+    printf("%-24s %10s\n", "estimator", "time (us)");
+    printf("%-24s %10.2f\n", "twm()", time_function(num_peaks, amps, freqs));
+
+    const char* levels[] = {"scalar", "sse2", "avx2"};
+    for(int level = MQ_SIMD_NONE; level <= mq_simd_level(); level++) {
+        TWM exhaustive;
+        exhaustive.coarse_factor(1);
+        exhaustive.simd_level(level);
+
+        TWM coarse;
+        coarse.simd_level(level);
+
+        printf("exhaustive, %-12s %10.2f\n", levels[level],
+               time_object(exhaustive, num_peaks, amps, freqs));
+        printf("coarse, %-16s %10.2f\n", levels[level],
+               time_object(coarse, num_peaks, amps, freqs));
+    }
+
+    return 0;
+}
@@ -10,19 +10,15 @@ using namespace std;
 class AnalysisData {
 public:
     const int max_peaks;
-    std::vector<double> audio;
-    simpl::Frame frame;
+    std::vector<simpl::sample> audio;
     simpl::LorisPeakDetection pd;
     simpl::SMSPartialTracking pt;
     simpl::SMSSynthesis synth;
+    simpl::Stream* stream;
 
-    AnalysisData(int frame_size, int hop_size) : max_peaks(50),
-                                                 frame(frame_size, true) {
-        audio.resize(hop_size);
-
-        frame.synth_size(hop_size);
-        frame.max_peaks(max_peaks);
-        frame.max_partials(max_peaks);
+    AnalysisData(int frame_size, int hop_size, int buffer_size) :
+            max_peaks(50) {
+        audio.resize(buffer_size);
 
         pd.frame_size(frame_size);
         pd.hop_size(hop_size);
@@ -34,6 +30,12 @@ public:
         synth.det_synthesis_type(0);
         synth.hop_size(hop_size);
         synth.max_partials(frame_size);
+
+        stream = new simpl::Stream(&pd, &pt, &synth);
+    }
+
+    ~AnalysisData() {
+        delete stream;
     }
 };
 
@@ -48,20 +50,18 @@ static int patestCallback(const void *input,
     float *in = (float*)input;
     float *out = (float*)output;
 
-    std::copy(in, in + buffer_size, data->audio.begin());
-    data->frame.audio(&(data->audio[0]), buffer_size);
-
-    data->pd.find_peaks_in_frame(&(data->frame));
-    data->pt.update_partials(&(data->frame));
-    data->synth.synth_frame(&(data->frame));
-
-    for(unsigned int i = 0; i < buffer_size; i++) {
-        out[i] = data->frame.synth()[i];
+    if(buffer_size > data->audio.size()) {
+        return paAbort;
     }
 
-    data->frame.clear_peaks();
-    data->frame.clear_partials();
-    data->frame.clear_synth();
+#ifdef SIMPL_FLOAT
+    // samples are already floats, so PortAudio's buffers are used directly
+    data->stream->process(buffer_size, in, out);
+#else
+    std::copy(in, in + buffer_size, data->audio.begin());
+    data->stream->process(buffer_size, &(data->audio[0]), &(data->audio[0]));
+    std::copy(data->audio.begin(), data->audio.begin() + buffer_size, out);
+#endif
     return 0;
 }
 
@@ -73,7 +73,8 @@ int main() {
     int n_output_chans = 1;
     int buffer_size = 512;
     int frame_size = 2048;
-    static AnalysisData data(frame_size, buffer_size);
+    int hop_size = 256;
+    static AnalysisData data(frame_size, hop_size, buffer_size);
 
     err = Pa_Initialize();
     if(err != paNoError) {
@@ -103,6 +104,7 @@ int main() {
     cout << endl;
     cout << "Analysing audio from default input and "
          << "synthesising to default output." << endl;
+    cout << "Latency: " << data.stream->latency() << " samples" << endl;
     cout << "Press Enter to stop" << endl;
     cin.ignore();
     
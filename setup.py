@@ -36,10 +36,32 @@ macros = []
 link_args = []
 include_dirs = ['simpl', 'src/simpl', 'src/sms', 'src/sndobj',
                 'src/loris', 'src/mq', numpy_include, '/usr/local/include']
-libs = ['m', 'fftw3', 'gsl', 'gslcblas']
+libs = ['m', 'fftw3', 'gsl', 'gslcblas', 'pthread']
 compile_args = ['-DMERSENNE_TWISTER', '-DHAVE_FFTW3_H']
 sources = []
 
+# simpl is written in C++98. Later standards declare std::sample, which
+# clashes with simpl::sample in files using both namespaces. The flag is
+# also passed for the C sources, where GCC ignores it with a warning.
+compile_args.append('-std=gnu++98')
+
+# -----------------------------------------------------------------------------
+# FFT plan cache
+# -----------------------------------------------------------------------------
+sources.append('src/simpl/fft_plans.cpp')
+
+# -----------------------------------------------------------------------------
+# Profiling
+# -----------------------------------------------------------------------------
+# Set SIMPL_PROFILE in the environment to record per-frame statistics.
+# Every extension module links its own copy of profile.cpp, so the global
+# operator new and delete are not replaced and allocations are not counted.
+if os.environ.get('SIMPL_PROFILE'):
+    compile_args.append('-DSIMPL_PROFILE')
+    compile_args.append('-DSIMPL_PROFILE_NO_ALLOCATIONS')
+
+sources.append('src/simpl/profile.cpp')
+
 # -----------------------------------------------------------------------------
 # SndObj Library
 # -----------------------------------------------------------------------------
@@ -68,6 +90,7 @@ sources.extend(sms_sources)
 # -----------------------------------------------------------------------------
 loris_sources = glob.glob(os.path.join('src', 'loris', '*.C'))
 sources.extend(loris_sources)
+sources.append('src/simpl/loris_oscillator_bank.cpp')
 
 # -----------------------------------------------------------------------------
 # MQ
@@ -82,8 +105,10 @@ base = Extension(
     'simpl.base',
     sources=['simpl/base.pyx',
              'src/simpl/base.cpp',
-             'src/simpl/exceptions.cpp'],
+             'src/simpl/exceptions.cpp',
+             'src/simpl/profile.cpp'],
     include_dirs=include_dirs,
+    extra_compile_args=compile_args,
     language='c++'
 )
 
@@ -94,6 +119,7 @@ peak_detection = Extension(
     'simpl.peak_detection',
     sources=sources + ['simpl/peak_detection.pyx',
                        'src/simpl/peak_detection.cpp',
+                       'src/simpl/spectrum.cpp',
                        'src/simpl/base.cpp',
                        'src/simpl/exceptions.cpp'],
     include_dirs=include_dirs,
@@ -109,6 +135,7 @@ partial_tracking = Extension(
     'simpl.partial_tracking',
     sources=sources + ['simpl/partial_tracking.pyx',
                        'src/simpl/partial_tracking.cpp',
+                       'src/simpl/lp.cpp',
                        'src/simpl/base.cpp',
                        'src/simpl/exceptions.cpp'],
     libraries=libs,
@@ -139,7 +166,9 @@ residual = Extension(
     'simpl.residual',
     sources=sources + ['simpl/residual.pyx',
                        'src/simpl/peak_detection.cpp',
+                       'src/simpl/spectrum.cpp',
                        'src/simpl/partial_tracking.cpp',
+                       'src/simpl/lp.cpp',
                        'src/simpl/synthesis.cpp',
                        'src/simpl/residual.cpp',
                        'src/simpl/base.cpp',
@@ -150,6 +179,20 @@ residual = Extension(
     language='c++'
 )
 
+# -----------------------------------------------------------------------------
+# Archive
+# -----------------------------------------------------------------------------
+archive = Extension(
+    'simpl.archive',
+    sources=['simpl/archive.pyx',
+             'src/simpl/archive.cpp',
+             'src/simpl/base.cpp',
+             'src/simpl/exceptions.cpp'],
+    include_dirs=include_dirs,
+    extra_compile_args=compile_args,
+    language='c++'
+)
+
 # -----------------------------------------------------------------------------
 # Package
 # -----------------------------------------------------------------------------
@@ -166,7 +209,8 @@ setup(
     author_email='j@johnglover.net',
     platforms=['Linux', 'Mac OS-X', 'Unix'],
     version='0.3',
-    ext_modules=[base, peak_detection, partial_tracking, synthesis, residual],
+    ext_modules=[base, peak_detection, partial_tracking, synthesis, residual,
+                 archive],
     cmdclass={'build_ext': build_ext},
     packages=['simpl', 'simpl.plot']
 )
@@ -4,6 +4,7 @@ import peak_detection
 import partial_tracking
 import synthesis
 import residual
+import archive
 import plot
 import audio
 import pybase
@@ -14,13 +15,18 @@ Peak = base.Peak
 compare_peak_amps = pybase.compare_peak_amps
 compare_peak_freqs = pybase.compare_peak_freqs
 read_wav = audio.read_wav
+profiling_enabled = base.profiling_enabled
+peak_arrays = base.peak_arrays
+partial_arrays = base.partial_arrays
 
+Spectrum = peak_detection.Spectrum
 PeakDetection = peak_detection.PeakDetection
 SMSPeakDetection = peak_detection.SMSPeakDetection
 SndObjPeakDetection = peak_detection.SndObjPeakDetection
 LorisPeakDetection = peak_detection.LorisPeakDetection
 
 PartialTracking = partial_tracking.PartialTracking
+LPPartialTracking = partial_tracking.LPPartialTracking
 SMSPartialTracking = partial_tracking.SMSPartialTracking
 SndObjPartialTracking = partial_tracking.SndObjPartialTracking
 LorisPartialTracking = partial_tracking.LorisPartialTracking
@@ -29,10 +35,14 @@ Synthesis = synthesis.Synthesis
 SMSSynthesis = synthesis.SMSSynthesis
 SndObjSynthesis = synthesis.SndObjSynthesis
 LorisSynthesis = synthesis.LorisSynthesis
+IFFTSynthesis = synthesis.IFFTSynthesis
 
 Residual = residual.Residual
 SMSResidual = residual.SMSResidual
 
+Archive = archive.Archive
+write_archive = archive.write_archive
+
 plot_peaks = plot.plot_peaks
 plot_partials = plot.plot_partials
 
@@ -0,0 +1,75 @@
+import numpy as np
+cimport numpy as np
+np.import_array()
+from libcpp.vector cimport vector
+from libcpp cimport bool
+
+from base cimport c_Frame
+from base cimport string
+
+
+cdef extern from "<stdint.h>":
+    ctypedef unsigned long long uint64_t
+    ctypedef long long int64_t
+
+
+cdef extern from "../src/simpl/archive.h" namespace "simpl":
+    cdef int c_ARCHIVE_PEAKS "simpl::ARCHIVE_PEAKS"
+    cdef int c_ARCHIVE_PARTIALS "simpl::ARCHIVE_PARTIALS"
+    cdef int c_ARCHIVE_AUDIO "simpl::ARCHIVE_AUDIO"
+    cdef int c_ARCHIVE_SYNTH "simpl::ARCHIVE_SYNTH"
+    cdef int c_ARCHIVE_RESIDUAL "simpl::ARCHIVE_RESIDUAL"
+    cdef int c_ARCHIVE_SYNTH_RESIDUAL "simpl::ARCHIVE_SYNTH_RESIDUAL"
+
+    void c_write_archive "simpl::write_archive"(string filename,
+                                                vector[c_Frame*] frames,
+                                                int sampling_rate,
+                                                int hop_size,
+                                                int contents) except +
+
+    cdef cppclass c_Archive "simpl::Archive":
+        c_Archive()
+        void open(string filename) except +
+        void close()
+        bool is_open()
+
+        int version()
+        int contents()
+        int sampling_rate()
+        int hop_size()
+        int num_frames()
+        int64_t num_peaks()
+        int64_t num_partials()
+
+        double frame_time(int frame)
+        int frame_at(double time)
+        int num_peaks(int frame) except +
+        int num_partials(int frame) except +
+        int frame_size(int frame) except +
+        int synth_size(int frame) except +
+
+        uint64_t* peak_starts()
+        uint64_t* partial_starts()
+        uint64_t* audio_starts()
+        uint64_t* synth_starts()
+
+        double* peak_amplitudes()
+        double* peak_frequencies()
+        double* peak_phases()
+        double* peak_bandwidths()
+        double* partial_amplitudes()
+        double* partial_frequencies()
+        double* partial_phases()
+        double* partial_bandwidths()
+        double* audio()
+        double* synth()
+        double* residual()
+        double* synth_residual()
+
+        void read_frame(int frame_number, c_Frame* frame) except +
+
+
+cdef class Archive:
+    cdef c_Archive* thisptr
+    cdef np.ndarray _column(self, void* data, np.npy_intp size, int type)
+    cdef np.npy_intp _total(self, uint64_t* starts)
@@ -0,0 +1,174 @@
+import numpy as np
+cimport numpy as np
+np.import_array()
+from libcpp.vector cimport vector
+
+from base cimport c_Frame
+from base cimport string
+from base cimport Frame
+import base
+
+ARCHIVE_PEAKS = c_ARCHIVE_PEAKS
+ARCHIVE_PARTIALS = c_ARCHIVE_PARTIALS
+ARCHIVE_AUDIO = c_ARCHIVE_AUDIO
+ARCHIVE_SYNTH = c_ARCHIVE_SYNTH
+ARCHIVE_RESIDUAL = c_ARCHIVE_RESIDUAL
+ARCHIVE_SYNTH_RESIDUAL = c_ARCHIVE_SYNTH_RESIDUAL
+
+
+def write_archive(filename, frames, int sampling_rate, int hop_size,
+                  int contents=c_ARCHIVE_PEAKS | c_ARCHIVE_PARTIALS):
+    """Write a list of Frames to a simpl archive file."""
+    cdef vector[c_Frame*] c_frames
+    for f in frames:
+        c_frames.push_back((<Frame>f).thisptr)
+    c_write_archive(string(filename), c_frames, sampling_rate, hop_size,
+                    contents)
+
+
+cdef class Archive:
+    """A simpl archive file, opened through a memory map.
+
+    The columns are numpy arrays that share memory with the map, which is
+    released once the Archive and every array taken from it have been
+    garbage collected.
+    """
+    def __cinit__(self, filename):
+        self.thisptr = new c_Archive()
+        self.thisptr.open(string(filename))
+
+    def __dealloc__(self):
+        if self.thisptr:
+            del self.thisptr
+            self.thisptr = <c_Archive*>0
+
+    cdef np.ndarray _column(self, void* data, np.npy_intp size, int type):
+        if data == NULL:
+            return None
+        cdef np.ndarray a = np.PyArray_SimpleNewFromData(1, &size, type,
+                                                         data)
+        np.set_array_base(a, self)
+        return a
+
+    cdef np.npy_intp _total(self, uint64_t* starts):
+        if starts == NULL:
+            return 0
+        return starts[self.thisptr.num_frames()]
+
+    property version:
+        def __get__(self): return self.thisptr.version()
+
+    property contents:
+        def __get__(self): return self.thisptr.contents()
+
+    property sampling_rate:
+        def __get__(self): return self.thisptr.sampling_rate()
+
+    property hop_size:
+        def __get__(self): return self.thisptr.hop_size()
+
+    property num_frames:
+        def __get__(self): return self.thisptr.num_frames()
+
+    def __len__(self):
+        return self.thisptr.num_frames()
+
+    # frame index
+    def frame_time(self, int frame):
+        return self.thisptr.frame_time(frame)
+
+    def frame_at(self, double time):
+        return self.thisptr.frame_at(time)
+
+    def frame(self, int frame_number):
+        """Return a copy of the given frame."""
+        f = base.Frame(self.thisptr.frame_size(frame_number))
+        self.thisptr.read_frame(frame_number, (<Frame>f).thisptr)
+        return f
+
+    property peak_starts:
+        def __get__(self):
+            return self._column(self.thisptr.peak_starts(),
+                                self.thisptr.num_frames() + 1, np.NPY_UINT64)
+
+    property partial_starts:
+        def __get__(self):
+            return self._column(self.thisptr.partial_starts(),
+                                self.thisptr.num_frames() + 1, np.NPY_UINT64)
+
+    property audio_starts:
+        def __get__(self):
+            return self._column(self.thisptr.audio_starts(),
+                                self.thisptr.num_frames() + 1, np.NPY_UINT64)
+
+    property synth_starts:
+        def __get__(self):
+            return self._column(self.thisptr.synth_starts(),
+                                self.thisptr.num_frames() + 1, np.NPY_UINT64)
+
+    # peaks
+    property peak_amplitudes:
+        def __get__(self):
+            return self._column(self.thisptr.peak_amplitudes(),
+                                self.thisptr.num_peaks(), np.NPY_DOUBLE)
+
+    property peak_frequencies:
+        def __get__(self):
+            return self._column(self.thisptr.peak_frequencies(),
+                                self.thisptr.num_peaks(), np.NPY_DOUBLE)
+
+    property peak_phases:
+        def __get__(self):
+            return self._column(self.thisptr.peak_phases(),
+                                self.thisptr.num_peaks(), np.NPY_DOUBLE)
+
+    property peak_bandwidths:
+        def __get__(self):
+            return self._column(self.thisptr.peak_bandwidths(),
+                                self.thisptr.num_peaks(), np.NPY_DOUBLE)
+
+    # partials
+    property partial_amplitudes:
+        def __get__(self):
+            return self._column(self.thisptr.partial_amplitudes(),
+                                self.thisptr.num_partials(), np.NPY_DOUBLE)
+
+    property partial_frequencies:
+        def __get__(self):
+            return self._column(self.thisptr.partial_frequencies(),
+                                self.thisptr.num_partials(), np.NPY_DOUBLE)
+
+    property partial_phases:
+        def __get__(self):
+            return self._column(self.thisptr.partial_phases(),
+                                self.thisptr.num_partials(), np.NPY_DOUBLE)
+
+    property partial_bandwidths:
+        def __get__(self):
+            return self._column(self.thisptr.partial_bandwidths(),
+                                self.thisptr.num_partials(), np.NPY_DOUBLE)
+
+    # audio buffers
+    property audio:
+        def __get__(self):
+            return self._column(self.thisptr.audio(),
+                                self._total(self.thisptr.audio_starts()),
+                                np.NPY_DOUBLE)
+
+    property residual:
+        def __get__(self):
+            return self._column(self.thisptr.residual(),
+                                self._total(self.thisptr.audio_starts()),
+                                np.NPY_DOUBLE)
+
+    property synth:
+        def __get__(self):
+            return self._column(self.thisptr.synth(),
+                                self._total(self.thisptr.synth_starts()),
+                                np.NPY_DOUBLE)
+
+    property synth_residual:
+        def __get__(self):
+            return self._column(self.thisptr.synth_residual(),
+                                self._total(self.thisptr.synth_starts()),
+                                np.NPY_DOUBLE)
@@ -3,10 +3,23 @@ import scipy.io.wavfile as wav
 import simpl
 
 
-def read_wav(file):
-    'return floating point values between -1 and 1'
+def read_wav(file, all_channels=False):
+    '''return floating point values between -1 and 1
+
+    By default only the first channel of a multichannel file is returned.
+    If all_channels is True, a contiguous (channels x samples) array is
+    returned instead, with one row for each channel (even for mono files).
+    '''
     sampling_rate, audio = wav.read(file)
 
+    if all_channels:
+        if audio.ndim == 1:
+            audio = audio.reshape(1, -1)
+        else:
+            audio = audio.T
+        audio = np.ascontiguousarray(audio, dtype=simpl.dtype) / 32768.0
+        return audio, sampling_rate
+
     # if wav file has more than 1 channel, just take the first one
     if audio.ndim > 1:
         audio = audio.T[0]
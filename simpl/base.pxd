@@ -20,6 +20,7 @@ cdef class Frame:
     cdef c_Frame* thisptr
     cdef int created
     cdef set_frame(self, c_Frame* f)
+    cdef np.ndarray _view(self, double* data, int size)
     cdef list _peaks
     cdef list _partials
 
@@ -50,10 +51,14 @@ cdef extern from "../src/simpl/base.h" namespace "simpl":
         void num_peaks(int new_num_peaks)
         int max_peaks()
         void max_peaks(int new_max_peaks)
-        c_Peak* peak(int peak_number)
+        c_Peak peak(int peak_number)
         void add_peak(double amplitude, double frequency,
                       double phase, double bandwidth)
         void clear_peaks()
+        double* peak_amplitudes()
+        double* peak_frequencies()
+        double* peak_phases()
+        double* peak_bandwidths()
 
         # partials
         int num_partials()
@@ -62,10 +67,14 @@ cdef extern from "../src/simpl/base.h" namespace "simpl":
         void max_partials(int new_max_partials)
         void add_partial(double amplitude, double frequency,
                          double phase, double bandwidth)
-        c_Peak* partial(int partial_number)
+        c_Peak partial(int partial_number)
         void partial(int partial_number, double amplitude, double frequency,
                      double phase, double bandwidth)
         void clear_partials()
+        double* partial_amplitudes()
+        double* partial_frequencies()
+        double* partial_phases()
+        double* partial_bandwidths()
 
         # audio buffers
         int size()
@@ -80,3 +89,38 @@ cdef extern from "../src/simpl/base.h" namespace "simpl":
         double* residual()
         void synth_residual(double* new_synth_residual)
         double* synth_residual()
+
+    int c_max_peaks "simpl::max_peaks"(vector[c_Frame*]& frames)
+    int c_max_partials "simpl::max_partials"(vector[c_Frame*]& frames)
+    void c_copy_peaks "simpl::copy_peaks"(vector[c_Frame*]& frames, int width,
+                                          double* amplitudes,
+                                          double* frequencies,
+                                          double* phases,
+                                          double* bandwidths)
+    void c_copy_partials "simpl::copy_partials"(vector[c_Frame*]& frames,
+                                                int width,
+                                                double* amplitudes,
+                                                double* frequencies,
+                                                double* phases,
+                                                double* bandwidths)
+
+
+cdef extern from "../src/simpl/profile.h" namespace "simpl":
+    cdef cppclass c_Profile "simpl::Profile":
+        c_Profile()
+        void reset()
+        int num_frames()
+        double time()
+        double mean_time()
+        double max_time()
+        long num_peaks()
+        double mean_peaks()
+        long num_partials()
+        double mean_partials()
+        long num_allocations()
+        long num_deallocations()
+
+    bool c_profiling_enabled "simpl::profiling_enabled"()
+
+
+cdef dict profile_dict(c_Profile* profile)
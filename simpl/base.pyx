@@ -63,6 +63,14 @@ cdef class Frame:
     cdef set_frame(self, c_Frame* f):
         self.thisptr = f
 
+    cdef np.ndarray _view(self, double* data, int size):
+        cdef np.npy_intp shape[1]
+        shape[0] = <np.npy_intp> size
+        cdef np.ndarray a = np.PyArray_SimpleNewFromData(1, shape,
+                                                         np.NPY_DOUBLE, data)
+        np.set_array_base(a, self)
+        return a
+
     # peaks
     property max_peaks:
         def __get__(self): return self.thisptr.max_peaks()
@@ -77,7 +85,7 @@ cdef class Frame:
             self.add_peak(p)
 
     def peak(self, int i):
-        cdef c_Peak* c_p = self.thisptr.peak(i)
+        cdef c_Peak c_p = self.thisptr.peak(i)
         # return the same Python peak object if it exists so
         # memory is not deallocated
         if i < len(self._peaks) and self._peaks[i] and \
@@ -89,7 +97,7 @@ cdef class Frame:
         # if not, make a new Python peak and copy the values
         else:
             p = Peak()
-            p.copy(c_p)
+            p.copy(&c_p)
             return p
 
     property peaks:
@@ -105,6 +113,28 @@ cdef class Frame:
             self.add_peaks(peaks)
             self._peaks = peaks
 
+    # Arrays of the num_peaks values of each peak field, which share memory
+    # with the frame. They are only valid until max_peaks is changed.
+    property peak_amplitudes:
+        def __get__(self):
+            return self._view(self.thisptr.peak_amplitudes(),
+                              self.thisptr.num_peaks())
+
+    property peak_frequencies:
+        def __get__(self):
+            return self._view(self.thisptr.peak_frequencies(),
+                              self.thisptr.num_peaks())
+
+    property peak_phases:
+        def __get__(self):
+            return self._view(self.thisptr.peak_phases(),
+                              self.thisptr.num_peaks())
+
+    property peak_bandwidths:
+        def __get__(self):
+            return self._view(self.thisptr.peak_bandwidths(),
+                              self.thisptr.num_peaks())
+
     def clear(self):
         self.thisptr.clear()
         self._peaks = []
@@ -124,7 +154,7 @@ cdef class Frame:
             self.add_partial(p)
 
     def partial(self, int i, Peak p=None):
-        cdef c_Peak* c_p
+        cdef c_Peak c_p
         if not p:
             c_p = self.thisptr.partial(i)
             # return the same Python peak object if it exists so
@@ -138,7 +168,7 @@ cdef class Frame:
             # if not, make a new Python peak and copy the values
             else:
                 peak = Peak()
-                peak.copy(c_p)
+                peak.copy(&c_p)
                 return peak
         else:
             self.thisptr.partial(i, p.amplitude, p.frequency,
@@ -157,6 +187,28 @@ cdef class Frame:
             self.add_partials(peaks)
             self._partials = peaks
 
+    # Arrays of the num_partials values of each partial field, see
+    # peak_amplitudes
+    property partial_amplitudes:
+        def __get__(self):
+            return self._view(self.thisptr.partial_amplitudes(),
+                              self.thisptr.num_partials())
+
+    property partial_frequencies:
+        def __get__(self):
+            return self._view(self.thisptr.partial_frequencies(),
+                              self.thisptr.num_partials())
+
+    property partial_phases:
+        def __get__(self):
+            return self._view(self.thisptr.partial_phases(),
+                              self.thisptr.num_partials())
+
+    property partial_bandwidths:
+        def __get__(self):
+            return self._view(self.thisptr.partial_bandwidths(),
+                              self.thisptr.num_partials())
+
     # audio buffers
     property size:
         def __get__(self): return self.thisptr.size()
@@ -197,3 +249,64 @@ cdef class Frame:
             return np.PyArray_SimpleNewFromData(1, shape, np.NPY_DOUBLE, self.thisptr.synth_residual())
         def __set__(self, np.ndarray[dtype_t, ndim=1] a):
             self.thisptr.synth_residual(<double*> a.data)
+
+
+cdef vector[c_Frame*] _c_frames(frames):
+    cdef vector[c_Frame*] c_frames
+    for frame in frames:
+        c_frames.push_back((<Frame?>frame).thisptr)
+    return c_frames
+
+
+def peak_arrays(frames, width=None):
+    """Returns the amplitudes, frequencies, phases and bandwidths of the
+    peaks of each frame as 2D arrays of len(frames) rows of width values
+    (by default the largest max_peaks of the frames). Rows are zero padded
+    after the last peak of the frame."""
+    cdef vector[c_Frame*] c_frames = _c_frames(frames)
+    cdef int w = c_max_peaks(c_frames) if width is None else width
+    cdef np.ndarray[dtype_t, ndim=2] amplitudes = np.zeros((len(frames), w))
+    cdef np.ndarray[dtype_t, ndim=2] frequencies = np.zeros((len(frames), w))
+    cdef np.ndarray[dtype_t, ndim=2] phases = np.zeros((len(frames), w))
+    cdef np.ndarray[dtype_t, ndim=2] bandwidths = np.zeros((len(frames), w))
+    c_copy_peaks(c_frames, w,
+                 <double*> amplitudes.data, <double*> frequencies.data,
+                 <double*> phases.data, <double*> bandwidths.data)
+    return amplitudes, frequencies, phases, bandwidths
+
+
+def partial_arrays(frames, width=None):
+    """Returns the partials of each frame as 2D arrays, as peak_arrays.
+    Column n holds partial number n, so rows are padded with inactive (0
+    amplitude) partials. The default width is the largest max_partials of
+    the frames."""
+    cdef vector[c_Frame*] c_frames = _c_frames(frames)
+    cdef int w = c_max_partials(c_frames) if width is None else width
+    cdef np.ndarray[dtype_t, ndim=2] amplitudes = np.zeros((len(frames), w))
+    cdef np.ndarray[dtype_t, ndim=2] frequencies = np.zeros((len(frames), w))
+    cdef np.ndarray[dtype_t, ndim=2] phases = np.zeros((len(frames), w))
+    cdef np.ndarray[dtype_t, ndim=2] bandwidths = np.zeros((len(frames), w))
+    c_copy_partials(c_frames, w,
+                    <double*> amplitudes.data, <double*> frequencies.data,
+                    <double*> phases.data, <double*> bandwidths.data)
+    return amplitudes, frequencies, phases, bandwidths
+
+
+def profiling_enabled():
+    """True if the C++ library was built with SIMPL_PROFILE."""
+    return c_profiling_enabled()
+
+
+cdef dict profile_dict(c_Profile* profile):
+    return {
+        'num_frames': profile.num_frames(),
+        'time': profile.time(),
+        'mean_time': profile.mean_time(),
+        'max_time': profile.max_time(),
+        'num_peaks': profile.num_peaks(),
+        'mean_peaks': profile.mean_peaks(),
+        'num_partials': profile.num_partials(),
+        'mean_partials': profile.mean_partials(),
+        'num_allocations': profile.num_allocations(),
+        'num_deallocations': profile.num_deallocations()
+    }
@@ -53,18 +53,5 @@ def predict(signal, coefs, num_predictions):
     return predictions
 
 
-class LPPartialTracking(simpl.PartialTracking):
-    "Partial tracking, based on the McAulay and Quatieri (MQ) algorithm"
-    def __init__(self):
-        simpl.PartialTracking.__init__(self)
-        self._matching_interval = 100  # peak matching interval, in Hz
-
-    def update_partials(self, frame, frame_number):
-        """Streamable (real-time) LP peak-tracking.
-        """
-        frame_partials = []
-
-        for peak in frame:
-            pass
-
-        return frame_partials
+# LP partial tracking is implemented in C++ (see src/simpl/partial_tracking.h)
+LPPartialTracking = simpl.LPPartialTracking
@@ -6,6 +6,7 @@ from libcpp cimport bool
 
 from base cimport c_Peak
 from base cimport c_Frame
+from base cimport c_Profile
 from base cimport string
 from base cimport dtype_t
 from base import dtype
@@ -14,6 +15,7 @@ from base import dtype
 cdef extern from "../src/simpl/partial_tracking.h" namespace "simpl":
     cdef cppclass c_PartialTracking "simpl::PartialTracking":
         c_PartialTracking()
+        c_Profile* profile()
         void clear()
         int sampling_rate()
         void sampling_rate(int new_sampling_rate)
@@ -23,11 +25,22 @@ cdef extern from "../src/simpl/partial_tracking.h" namespace "simpl":
         void min_partial_length(int new_min_partial_length)
         int max_gap()
         void max_gap(int new_max_gap)
-        void update_partials(c_Frame* frame)
-        vector[c_Frame*] find_partials(vector[c_Frame*] frames)
+        void update_partials(c_Frame* frame) nogil
+        vector[c_Frame*] find_partials(vector[c_Frame*] frames) nogil
 
     cdef cppclass c_MQPartialTracking "simpl::MQPartialTracking"(c_PartialTracking):
         c_MQPartialTracking()
+        double matching_interval()
+        void matching_interval(double new_matching_interval)
+
+    cdef cppclass c_LPPartialTracking "simpl::LPPartialTracking"(c_PartialTracking):
+        c_LPPartialTracking()
+        double matching_interval()
+        void matching_interval(double new_matching_interval)
+        int order()
+        void order(int new_order) except +
+        int history_size()
+        void history_size(int new_history_size) except +
 
     cdef cppclass c_SMSPartialTracking "simpl::SMSPartialTracking"(c_PartialTracking):
         c_SMSPartialTracking()
@@ -8,6 +8,7 @@ from base cimport Peak
 from base cimport Frame
 from base cimport c_Peak
 from base cimport c_Frame
+from base cimport profile_dict
 
 
 cdef class PartialTracking:
@@ -39,17 +40,42 @@ cdef class PartialTracking:
         def __get__(self): return self.thisptr.max_gap()
         def __set__(self, int i): self.thisptr.max_gap(i)
 
+    property profile:
+        def __get__(self): return profile_dict(self.thisptr.profile())
+
+    def reset_profile(self):
+        self.thisptr.profile().reset()
+
     def update_partials(self, Frame frame not None):
-        self.thisptr.update_partials(frame.thisptr)
+        cdef c_PartialTracking* pt = self.thisptr
+        cdef c_Frame* c_frame = frame.thisptr
+        with nogil:
+            pt.update_partials(c_frame)
         return frame.partials
 
     def find_partials(self, frames):
+        # unless update_partials is overridden in Python, the frames are
+        # tracked together without the GIL
+        native = (type(self).update_partials is
+                  PartialTracking.update_partials)
+        cdef vector[c_Frame*] c_frames
+        cdef c_PartialTracking* pt = self.thisptr
+        cdef int i
+
         partial_frames = []
         for frame in frames:
             if frame.max_partials != self.thisptr.max_partials():
                 frame.max_partials = self.thisptr.max_partials()
-            self.update_partials(frame)
+            if native:
+                c_frames.push_back((<Frame>frame).thisptr)
+            else:
+                self.update_partials(frame)
             partial_frames.append(frame)
+
+        with nogil:
+            for i in range(c_frames.size()):
+                pt.update_partials(c_frames[i])
+
         return partial_frames
 
 
@@ -64,6 +90,34 @@ cdef class MQPartialTracking(PartialTracking):
             del self.thisptr
             self.thisptr = <c_PartialTracking*>0
 
+    property matching_interval:
+        def __get__(self): return (<c_MQPartialTracking*>self.thisptr).matching_interval()
+        def __set__(self, double x): (<c_MQPartialTracking*>self.thisptr).matching_interval(x)
+
+
+cdef class LPPartialTracking(PartialTracking):
+    def __cinit__(self):
+        if self.thisptr:
+            del self.thisptr
+        self.thisptr = new c_LPPartialTracking()
+
+    def __dealloc__(self):
+        if self.thisptr:
+            del self.thisptr
+            self.thisptr = <c_PartialTracking*>0
+
+    property matching_interval:
+        def __get__(self): return (<c_LPPartialTracking*>self.thisptr).matching_interval()
+        def __set__(self, double x): (<c_LPPartialTracking*>self.thisptr).matching_interval(x)
+
+    property order:
+        def __get__(self): return (<c_LPPartialTracking*>self.thisptr).order()
+        def __set__(self, int i): (<c_LPPartialTracking*>self.thisptr).order(i)
+
+    property history_size:
+        def __get__(self): return (<c_LPPartialTracking*>self.thisptr).history_size()
+        def __set__(self, int i): (<c_LPPartialTracking*>self.thisptr).history_size(i)
+
 
 cdef class SMSPartialTracking(PartialTracking):
     def __cinit__(self):
@@ -6,14 +6,35 @@ from libcpp cimport bool
 
 from base cimport c_Peak
 from base cimport c_Frame
+from base cimport c_Profile
 from base cimport string
 from base cimport dtype_t
 from base import dtype
 
 
+cdef extern from "../src/simpl/spectrum.h" namespace "simpl":
+    cdef cppclass c_Spectrum "simpl::Spectrum":
+        c_Spectrum(int size, string window_type, bool reassignment) except +
+        int size()
+        void size(int new_size) except +
+        int num_bins()
+        int sampling_rate()
+        void sampling_rate(int new_sampling_rate)
+        string window_type()
+        void window_type(string new_window_type) except +
+        bool reassignment()
+        void reassignment(bool new_reassignment)
+        void analyse(int audio_size, double* audio) nogil
+        double* magnitudes()
+        double* phases()
+        double* frequencies()
+        double* time_offsets()
+
+
 cdef extern from "../src/simpl/peak_detection.h" namespace "simpl":
     cdef cppclass c_PeakDetection "simpl::PeakDetection":
         c_PeakDetection()
+        c_Profile* profile()
         int sampling_rate()
         void sampling_rate(int new_sampling_rate)
         int frame_size()
@@ -31,33 +52,37 @@ cdef extern from "../src/simpl/peak_detection.h" namespace "simpl":
         void window_size(int new_window_size)
         double min_peak_separation()
         void min_peak_separation(double new_min_peak_separation)
+        int num_threads()
+        void num_threads(int new_num_threads) except +
         int num_frames()
         c_Frame* frame(int frame_number)
         void frames(vector[c_Frame*] new_frames)
-        void find_peaks_in_frame(c_Frame* frame)
-        vector[c_Frame*] find_peaks(int audio_size, double* audio)
+        void find_peaks_in_frame(c_Frame* frame) nogil
+        bool uses_spectrum(c_Spectrum* spectrum)
+        void find_peaks_in_spectrum(c_Frame* frame, c_Spectrum* spectrum) nogil
+        vector[c_Frame*] find_peaks(int audio_size, double* audio) nogil
 
     cdef cppclass c_MQPeakDetection "simpl::MQPeakDetection"(c_PeakDetection):
         c_MQPeakDetection()
         void hop_size(int new_hop_size)
         void max_peaks(int new_max_peaks)
-        void find_peaks_in_frame(c_Frame* frame)
+        void find_peaks_in_frame(c_Frame* frame) nogil
 
     cdef cppclass c_SMSPeakDetection "simpl::SMSPeakDetection"(c_PeakDetection):
         c_SMSPeakDetection()
         void hop_size(int new_hop_size)
         void max_peaks(int new_max_peaks)
-        void find_peaks_in_frame(c_Frame* frame)
-        vector[c_Frame*] find_peaks(int audio_size, double* audio)
+        void find_peaks_in_frame(c_Frame* frame) nogil
+        vector[c_Frame*] find_peaks(int audio_size, double* audio) nogil
 
     cdef cppclass c_SndObjPeakDetection "simpl::SndObjPeakDetection"(c_PeakDetection):
         c_SndObjPeakDetection()
         void hop_size(int new_hop_size)
         void max_peaks(int new_max_peaks)
-        void find_peaks_in_frame(c_Frame* frame)
+        void find_peaks_in_frame(c_Frame* frame) nogil
 
     cdef cppclass c_LorisPeakDetection "simpl::LorisPeakDetection"(c_PeakDetection):
         c_LorisPeakDetection()
         void hop_size(int new_hop_size)
         void max_peaks(int new_max_peaks)
-        void find_peaks_in_frame(c_Frame* frame)
+        void find_peaks_in_frame(c_Frame* frame) nogil
@@ -8,11 +8,68 @@ from base cimport Peak
 from base cimport Frame
 from base cimport c_Peak
 from base cimport c_Frame
+from base cimport profile_dict
+
+
+cdef class Spectrum:
+    cdef c_Spectrum* thisptr
+
+    def __cinit__(self, int size=2048, char* window_type="hamming",
+                  bool reassignment=False):
+        self.thisptr = new c_Spectrum(size, string(window_type), reassignment)
+
+    def __dealloc__(self):
+        if self.thisptr:
+            del self.thisptr
+
+    property size:
+        def __get__(self): return self.thisptr.size()
+        def __set__(self, int i): self.thisptr.size(i)
+
+    property num_bins:
+        def __get__(self): return self.thisptr.num_bins()
+
+    property sampling_rate:
+        def __get__(self): return self.thisptr.sampling_rate()
+        def __set__(self, int i): self.thisptr.sampling_rate(i)
+
+    property window_type:
+        def __get__(self): return self.thisptr.window_type().c_str()
+        def __set__(self, char* s): self.thisptr.window_type(string(s))
+
+    property reassignment:
+        def __get__(self): return self.thisptr.reassignment()
+        def __set__(self, bool b): self.thisptr.reassignment(b)
+
+    cdef _bins(self, double* values):
+        cdef np.npy_intp shape[1]
+        shape[0] = <np.npy_intp> self.thisptr.num_bins()
+        return np.PyArray_SimpleNewFromData(1, shape, np.NPY_DOUBLE, values)
+
+    property magnitudes:
+        def __get__(self): return self._bins(self.thisptr.magnitudes())
+
+    property phases:
+        def __get__(self): return self._bins(self.thisptr.phases())
+
+    property frequencies:
+        def __get__(self): return self._bins(self.thisptr.frequencies())
+
+    property time_offsets:
+        def __get__(self): return self._bins(self.thisptr.time_offsets())
+
+    def analyse(self, np.ndarray[dtype_t, ndim=1] audio):
+        cdef c_Spectrum* s = self.thisptr
+        cdef int audio_size = len(audio)
+        cdef double* audio_data = <double*> audio.data
+        with nogil:
+            s.analyse(audio_size, audio_data)
 
 
 cdef class PeakDetection:
     cdef c_PeakDetection* thisptr
     cdef public list frames
+    cdef object _audio
 
     def __cinit__(self):
         self.thisptr = new c_PeakDetection()
@@ -59,6 +116,16 @@ cdef class PeakDetection:
         def __get__(self): return self.thisptr.min_peak_separation()
         def __set__(self, double d): self.thisptr.min_peak_separation(d)
 
+    property num_threads:
+        def __get__(self): return self.thisptr.num_threads()
+        def __set__(self, int i): self.thisptr.num_threads(i)
+
+    property profile:
+        def __get__(self): return profile_dict(self.thisptr.profile())
+
+    def reset_profile(self):
+        self.thisptr.profile().reset()
+
     def frame(self, int i):
         cdef c_Frame* c_f = self.thisptr.frame(i)
         f = Frame(None, False)
@@ -66,12 +133,39 @@ cdef class PeakDetection:
         return f
 
     def find_peaks_in_frame(self, Frame frame not None):
-        self.thisptr.find_peaks_in_frame(frame.thisptr)
+        cdef c_PeakDetection* pd = self.thisptr
+        cdef c_Frame* c_frame = frame.thisptr
+        with nogil:
+            pd.find_peaks_in_frame(c_frame)
+        return frame.peaks
+
+    def uses_spectrum(self, Spectrum spectrum not None):
+        return self.thisptr.uses_spectrum(spectrum.thisptr)
+
+    def find_peaks_in_spectrum(self, Frame frame not None,
+                               Spectrum spectrum not None):
+        cdef c_PeakDetection* pd = self.thisptr
+        cdef c_Frame* c_frame = frame.thisptr
+        cdef c_Spectrum* c_spectrum = spectrum.thisptr
+        with nogil:
+            pd.find_peaks_in_spectrum(c_frame, c_spectrum)
         return frame.peaks
 
     def find_peaks(self, np.ndarray[dtype_t, ndim=1] audio):
+        if self.num_threads > 1:
+            return self._find_peaks_native(audio)
+
         self.frames = []
 
+        # frames are analysed together without the GIL once they have all
+        # been created, unless find_peaks_in_frame is overridden in Python
+        # or the size of each frame depends on the previous one
+        native = (type(self).find_peaks_in_frame is
+                  PeakDetection.find_peaks_in_frame)
+        cdef vector[c_Frame*] c_frames
+        cdef c_PeakDetection* pd = self.thisptr
+        cdef int i
+
         cdef int pos = 0
         while pos <= len(audio) - self.hop_size:
             if not self.static_frame_size:
@@ -88,10 +182,34 @@ cdef class PeakDetection:
                 ))
 
             frame.max_peaks = self.max_peaks
-            self.find_peaks_in_frame(frame)
+            if native and self.static_frame_size:
+                c_frames.push_back((<Frame>frame).thisptr)
+            else:
+                self.find_peaks_in_frame(frame)
             self.frames.append(frame)
             pos += self.hop_size
 
+        with nogil:
+            for i in range(c_frames.size()):
+                pd.find_peaks_in_frame(c_frames[i])
+
+        return self.frames
+
+    def _find_peaks_native(self, np.ndarray[dtype_t, ndim=1] audio):
+        # frame audio points into the input signal, so keep a reference
+        # to it while the frames are alive
+        self._audio = audio
+        self.frames = []
+        cdef c_PeakDetection* pd = self.thisptr
+        cdef int audio_size = len(audio)
+        cdef double* audio_data = <double*> audio.data
+        cdef vector[c_Frame*] output_frames
+        with nogil:
+            output_frames = pd.find_peaks(audio_size, audio_data)
+        for i in range(output_frames.size()):
+            f = Frame(output_frames[i].size(), False)
+            f.set_frame(output_frames[i])
+            self.frames.append(f)
         return self.frames
 
 
@@ -119,14 +237,7 @@ cdef class SMSPeakDetection(PeakDetection):
             self.thisptr = <c_PeakDetection*>0
 
     def find_peaks(self, np.ndarray[dtype_t, ndim=1] audio):
-        self.frames = []
-        cdef vector[c_Frame*] output_frames = \
-            self.thisptr.find_peaks(len(audio), <double*> audio.data)
-        for i in range(output_frames.size()):
-            f = Frame(output_frames[i].size(), False)
-            f.set_frame(output_frames[i])
-            self.frames.append(f)
-        return self.frames
+        return self._find_peaks_native(audio)
 
 
 cdef class SndObjPeakDetection(PeakDetection):
@@ -5,6 +5,7 @@ from libcpp.vector cimport vector
 
 from base cimport c_Peak
 from base cimport c_Frame
+from base cimport c_Profile
 from base cimport string
 from base cimport dtype_t
 from base import dtype
@@ -13,6 +14,7 @@ from base import dtype
 cdef extern from "../src/simpl/residual.h" namespace "simpl":
     cdef cppclass c_Residual "simpl::Residual":
         c_Residual()
+        c_Profile* profile()
         int frame_size()
         void frame_size(int new_frame_size)
         int next_frame_size()
@@ -20,12 +22,12 @@ cdef extern from "../src/simpl/residual.h" namespace "simpl":
         void hop_size(int new_hop_size)
         int sampling_rate()
         void sampling_rate(int new_sampling_rate)
-        void residual_frame(c_Frame* frame)
+        void residual_frame(c_Frame* frame) nogil
         void find_residual(int synth_size, double* synth,
                            int original_size, double* original,
-                           int residual_size, double* residual)
-        void synth_frame(c_Frame* frame)
-        vector[c_Frame*] synth(int original_size, double* original)
+                           int residual_size, double* residual) nogil
+        void synth_frame(c_Frame* frame) nogil
+        vector[c_Frame*] synth(int original_size, double* original) nogil
 
     cdef cppclass c_SMSResidual "simpl::SMSResidual"(c_Residual):
         c_SMSResidual()
@@ -7,6 +7,7 @@ from base cimport Peak
 from base cimport Frame
 from base cimport c_Peak
 from base cimport c_Frame
+from base cimport profile_dict
 
 
 cdef class Residual:
@@ -33,27 +34,49 @@ cdef class Residual:
             print('setting hop size...')
             self.thisptr.hop_size(i)
 
+    property profile:
+        def __get__(self): return profile_dict(self.thisptr.profile())
+
+    def reset_profile(self):
+        self.thisptr.profile().reset()
+
     def residual_frame(self, Frame frame not None):
-        self.thisptr.residual_frame(frame.thisptr)
+        cdef c_Residual* r = self.thisptr
+        cdef c_Frame* c_frame = frame.thisptr
+        with nogil:
+            r.residual_frame(c_frame)
         return frame.residual
 
     def find_residual(self, np.ndarray[dtype_t, ndim=1] synth,
                       np.ndarray[dtype_t, ndim=1] original):
         cdef np.ndarray[dtype_t, ndim=1] residual = np.zeros(len(synth))
-        self.thisptr.find_residual(len(synth), <double*> synth.data,
-                                   len(original), <double*> original.data,
-                                   len(residual), <double*> residual.data)
+        cdef c_Residual* r = self.thisptr
+        cdef int synth_size = len(synth)
+        cdef int original_size = len(original)
+        cdef double* synth_data = <double*> synth.data
+        cdef double* original_data = <double*> original.data
+        cdef double* residual_data = <double*> residual.data
+        with nogil:
+            r.find_residual(synth_size, synth_data,
+                            original_size, original_data,
+                            synth_size, residual_data)
         return residual
 
     def synth_frame(self, Frame frame not None):
-        self.thisptr.synth_frame(frame.thisptr)
+        cdef c_Residual* r = self.thisptr
+        cdef c_Frame* c_frame = frame.thisptr
+        with nogil:
+            r.synth_frame(c_frame)
         return frame.audio
 
     def synth(self, np.ndarray[dtype_t, ndim=1] original):
         cdef int hop = self.thisptr.hop_size()
-        cdef vector[c_Frame*] output_frames = self.thisptr.synth(
-            len(original), <double*> original.data
-        )
+        cdef c_Residual* r = self.thisptr
+        cdef int original_size = len(original)
+        cdef double* original_data = <double*> original.data
+        cdef vector[c_Frame*] output_frames
+        with nogil:
+            output_frames = r.synth(original_size, original_data)
 
         cdef np.ndarray[dtype_t, ndim=1] output = np.zeros(output_frames.size() * hop)
         cdef np.npy_intp shape[1]
@@ -5,6 +5,7 @@ from libcpp.vector cimport vector
 
 from base cimport c_Peak
 from base cimport c_Frame
+from base cimport c_Profile
 from base cimport string
 from base cimport dtype_t
 from base import dtype
@@ -13,6 +14,7 @@ from base import dtype
 cdef extern from "../src/simpl/synthesis.h" namespace "simpl":
     cdef cppclass c_Synthesis "simpl::Synthesis":
         c_Synthesis()
+        c_Profile* profile()
         int frame_size()
         void frame_size(int new_frame_size)
         int next_frame_size()
@@ -22,8 +24,8 @@ cdef extern from "../src/simpl/synthesis.h" namespace "simpl":
         void sampling_rate(int new_sampling_rate)
         int max_partials()
         void max_partials(int new_max_partials)
-        void synth_frame(c_Frame* frame)
-        vector[c_Frame*] synth(vector[c_Frame*] frames)
+        void synth_frame(c_Frame* frame) nogil
+        vector[c_Frame*] synth(vector[c_Frame*] frames) nogil
 
     cdef cppclass c_MQSynthesis "simpl::MQSynthesis"(c_Synthesis):
         c_MQSynthesis()
@@ -42,3 +44,6 @@ cdef extern from "../src/simpl/synthesis.h" namespace "simpl":
         c_LorisSynthesis()
         double bandwidth()
         void bandwidth(double new_bandwidth)
+
+    cdef cppclass c_IFFTSynthesis "simpl::IFFTSynthesis"(c_Synthesis):
+        c_IFFTSynthesis()
@@ -7,6 +7,7 @@ from base cimport Peak
 from base cimport Frame
 from base cimport c_Peak
 from base cimport c_Frame
+from base cimport profile_dict
 
 
 cdef class Synthesis:
@@ -35,17 +36,47 @@ cdef class Synthesis:
         def __get__(self): return self.thisptr.max_partials()
         def __set__(self, int i): self.thisptr.max_partials(i)
 
+    property profile:
+        def __get__(self): return profile_dict(self.thisptr.profile())
+
+    def reset_profile(self):
+        self.thisptr.profile().reset()
+
     def synth_frame(self, Frame frame not None):
-        self.thisptr.synth_frame(frame.thisptr)
+        cdef c_Synthesis* synth = self.thisptr
+        cdef c_Frame* c_frame = frame.thisptr
+        with nogil:
+            synth.synth_frame(c_frame)
         return frame.synth
 
     def synth(self, frames):
         cdef int hop = self.thisptr.hop_size()
         cdef np.ndarray[dtype_t, ndim=1] output = np.zeros(len(frames) * hop)
+
+        # unless synth_frame is overridden in Python, the frames are
+        # synthesised together without the GIL
+        native = type(self).synth_frame is Synthesis.synth_frame
+        cdef vector[c_Frame*] c_frames
+        cdef c_Synthesis* synth = self.thisptr
+        cdef int i
+
+        # frames that do not own their memory use these buffers
+        buffers = []
         for i in range(len(frames)):
-            frames[i].synth = np.zeros(hop)
+            buffer = np.zeros(hop)
+            buffers.append(buffer)
+            frames[i].synth = buffer
             frames[i].synth_size = hop
-            self.synth_frame(frames[i])
+            if native:
+                c_frames.push_back((<Frame>frames[i]).thisptr)
+            else:
+                self.synth_frame(frames[i])
+
+        with nogil:
+            for i in range(c_frames.size()):
+                synth.synth_frame(c_frames[i])
+
+        for i in range(len(frames)):
             output[i * hop:(i + 1) * hop] = frames[i].synth
         return output
 
@@ -115,3 +146,15 @@ cdef class LorisSynthesis(Synthesis):
     property bandwidth:
         def __get__(self): return (<c_LorisSynthesis*>self.thisptr).bandwidth()
         def __set__(self, double d): (<c_LorisSynthesis*>self.thisptr).bandwidth(d)
+
+
+cdef class IFFTSynthesis(Synthesis):
+    def __cinit__(self):
+        if self.thisptr:
+            del self.thisptr
+        self.thisptr = new c_IFFTSynthesis()
+
+    def __dealloc__(self):
+        if self.thisptr:
+            del self.thisptr
+            self.thisptr = <c_Synthesis*>0
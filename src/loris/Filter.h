@@ -39,7 +39,6 @@
 #include "Notifier.h"
 
 #include <algorithm>
-#include <deque>
 #include <vector>
 
 //  begin namespace
@@ -66,11 +65,8 @@ namespace Loris {
 //! G is the additional filter gain, and is unity if unspecified.
 //!
 //!
-//! Filter is implemented using a std::deque to store the filter state, 
-//! and relies on the efficiency of that class. If deque is not implemented
-//! using some sort of circular buffer (as it should be -- deque is guaranteed
-//! to be efficient for repeated insertion and removal at both ends), then
-//! this filter class will be slow.
+//! Filter stores its state in a fixed-size circular buffer, so filtering
+//! does not allocate memory.
 //
 class Filter
 {
@@ -165,6 +161,10 @@ public:
 	
 	const std::vector< double > denominator( void ) const;
 	
+	//!	Return the gain scale applied to the filtered signal.
+	
+	double gain( void ) const { return m_gain; }
+	
     
     //! Clear the filter state. 
     void clear( void );
@@ -174,8 +174,13 @@ private:
     
 //  --- implementation ---
 
-    //! single delay line for Direct-Form II implementation
-    std::deque< double > m_delayline;
+    //! single delay line for Direct-Form II implementation, stored
+    //! as a circular buffer so that filtering does not allocate. The
+    //! buffer holds one more sample than the order of the filter.
+    std::vector< double > m_delayline;
+    
+    //! index of the most recent sample in the delay line
+    unsigned int m_delayhead;
         
     //! feed-forward coefficients
     std::vector< double > m_ffwdcoefs;  
@@ -221,7 +226,8 @@ Filter::Filter( const double * ffwdbegin, const double * ffwdend, //    feed-for
 #endif
     m_ffwdcoefs( ffwdbegin, ffwdend ),
     m_fbackcoefs( fbackbegin, fbackend ),
-    m_delayline( std::max( ffwdend-ffwdbegin, fbackend-fbackbegin ) - 1, 0. ),
+    m_delayline( std::max( ffwdend-ffwdbegin, fbackend-fbackbegin ), 0. ),
+    m_delayhead( 0 ),
     m_gain( gain )
 {
     if ( *fbackbegin == 0. )
@@ -77,6 +77,16 @@ public:
 	//!	\sa sample
 	double operator() ( void ) 	{ return sample(); }
 	
+	//	fill
+	//
+	//!	Fill the half-open (STL-style) range of doubles starting at begin
+	//!	and ending before end with new samples, exactly as if sample()
+	//!	were called for each one.
+	//!
+	//!	\param begin is the beginning of the range to fill
+	//!	\param end is the end of the range to fill
+	void fill( double * begin, double * end );
+	
 
 //	--- implementation ---
 private:
@@ -64,6 +64,11 @@ public:
     //  separate class, but for now, they are just separate functions.
     Peaks selectPeaks( ReassignedSpectrum & spectrum, double minFrequency = 0 );
     
+	//	Same as above, but replace the contents of peaks with the selected
+	//	peaks, so that the storage in peaks can be reused from frame to frame.
+    void selectPeaks( ReassignedSpectrum & spectrum, double minFrequency, 
+                      Peaks & peaks );
+    
     	
 // --- implementation ---
 private:
@@ -73,8 +78,10 @@ private:
     //
     //  Currently, the reassignment minima are used.
     
-    Peaks selectReassignmentMinima( ReassignedSpectrum & spectrum, double minFrequency );
-    Peaks selectMagnitudePeaks( ReassignedSpectrum & spectrum, double minFrequency );
+    void selectReassignmentMinima( ReassignedSpectrum & spectrum, double minFrequency,
+                                   Peaks & peaks );
+    void selectMagnitudePeaks( ReassignedSpectrum & spectrum, double minFrequency,
+                               Peaks & peaks );
         
 
 // --- member data ---
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "mq.h"
 
 using namespace simpl;
@@ -27,12 +29,13 @@ int simpl::init_mq(MQParameters* params) {
     hamming_window(params->frame_size, params->window);
 
 	// allocate memory for FFT
-	params->fft_in = (sample*) fftw_malloc(sizeof(sample) *
+	params->fft_in = (double*) fftw_malloc(sizeof(double) *
                                            params->frame_size);
 	params->fft_out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) *
                                                   params->num_bins);
-	params->fft_plan = fftw_plan_dft_r2c_1d(params->frame_size, params->fft_in,
-                                            params->fft_out, FFTW_ESTIMATE);
+	params->fft_plan = simpl_fft_plan(params->frame_size, SIMPL_FFT_R2C);
+    mq_reserve_peaks(params);
+
     // set other variables to defaults
     reset_mq(params);
     return 0;
@@ -47,21 +50,82 @@ int simpl::destroy_mq(MQParameters* params) {
         if(params->window) delete [] params->window;
         if(params->fft_in) fftw_free(params->fft_in);
         if(params->fft_out) fftw_free(params->fft_out);
-        fftw_destroy_plan(params->fft_plan);
 
         params->window = NULL;
         params->fft_in = NULL;
         params->fft_out = NULL;
+
+        // peaks that are still in use must be returned with
+        // delete_peak_list before this is called
+        while(params->free_peaks) {
+            MQPeak* next = params->free_peaks->next;
+            delete params->free_peaks;
+            params->free_peaks = next;
+        }
+        while(params->free_peak_lists) {
+            MQPeakList* next = params->free_peak_lists->next;
+            delete params->free_peak_lists;
+            params->free_peak_lists = next;
+        }
+        params->pool_size = 0;
     }
     return 0;
 }
 
+void simpl::mq_reserve_peaks(MQParameters* params) {
+    // 1 extra peak is used while adding a peak to a full list
+    int max_peaks = params->max_peaks > 1 ? params->max_peaks : 1;
+    int num_peaks = 2 * (max_peaks + 1);
+
+    while(params->pool_size < num_peaks) {
+        MQPeak* peak = new MQPeak();
+        peak->next = params->free_peaks;
+        params->free_peaks = peak;
+
+        MQPeakList* node = new MQPeakList();
+        node->next = params->free_peak_lists;
+        params->free_peak_lists = node;
+
+        params->pool_size++;
+    }
+}
+
+// Peaks and nodes come from the pool, which is only extended if the
+// caller has used more than the reserved number of peaks
+MQPeak* simpl::mq_new_peak(MQParameters* params) {
+    MQPeak* peak = params->free_peaks;
+
+    if(peak) {
+        params->free_peaks = peak->next;
+        *peak = MQPeak();
+    }
+    else {
+        peak = new MQPeak();
+        params->pool_size++;
+    }
+    return peak;
+}
+
+MQPeakList* simpl::mq_new_peak_list(MQParameters* params) {
+    MQPeakList* node = params->free_peak_lists;
+
+    if(node) {
+        params->free_peak_lists = node->next;
+        *node = MQPeakList();
+    }
+    else {
+        node = new MQPeakList();
+    }
+    return node;
+}
+
 // ----------------------------------------------------------------------------
 // Peak Detection
 
 // Add new_peak to the doubly linked list of peaks, keeping peaks sorted
 // with the largest amplitude peaks at the start of the list
-void simpl::mq_add_peak(MQPeak* new_peak, MQPeakList* peak_list) {
+static void insert_peak(MQPeak* new_peak, MQPeakList* peak_list,
+                        MQParameters* params) {
     while(true) {
         if(peak_list->peak) {
             if(peak_list->peak->amplitude > new_peak->amplitude) {
@@ -69,7 +133,7 @@ void simpl::mq_add_peak(MQPeak* new_peak, MQPeakList* peak_list) {
                     peak_list = peak_list->next;
                 }
                 else {
-                    MQPeakList* new_node = new MQPeakList();
+                    MQPeakList* new_node = mq_new_peak_list(params);
                     new_node->peak = new_peak;
                     new_node->prev = peak_list;
                     new_node->next = NULL;
@@ -78,7 +142,7 @@ void simpl::mq_add_peak(MQPeak* new_peak, MQPeakList* peak_list) {
                 }
             }
             else {
-                MQPeakList* new_node = new MQPeakList();
+                MQPeakList* new_node = mq_new_peak_list(params);
                 new_node->peak = peak_list->peak;
                 new_node->prev = peak_list;
                 new_node->next = peak_list->next;
@@ -95,25 +159,39 @@ void simpl::mq_add_peak(MQPeak* new_peak, MQPeakList* peak_list) {
     }
 }
 
-void simpl::delete_peak_list(MQPeakList* peak_list) {
-    while(peak_list && peak_list->next) {
-        if(peak_list->peak) {
-            delete peak_list->peak;
-            peak_list->peak = NULL;
-        }
-        MQPeakList* temp = peak_list->next;
-        delete peak_list;
-        peak_list = temp;
+// Add new_peak to peak_list, and then return the smallest peak to the
+// pool if the list has more than params->max_peaks peaks
+void simpl::mq_add_peak(MQPeak* new_peak, MQPeakList* peak_list,
+                        MQParameters* params) {
+    insert_peak(new_peak, peak_list, params);
+
+    MQPeakList* last = peak_list;
+    for(int i = 1; i < params->max_peaks && last; i++) {
+        last = last->next;
+    }
+
+    if(last && last->next) {
+        delete_peak_list(last->next, params);
+        last->next = NULL;
     }
-    if(peak_list) {
+}
+
+void simpl::delete_peak_list(MQPeakList* peak_list, MQParameters* params) {
+    while(peak_list) {
+        MQPeakList* next = peak_list->next;
+
         if(peak_list->peak) {
-            delete peak_list->peak;
-            peak_list->peak = NULL;
+            peak_list->peak->next = params->free_peaks;
+            peak_list->peak->prev = NULL;
+            params->free_peaks = peak_list->peak;
         }
-        peak_list->next = NULL;
+
+        peak_list->peak = NULL;
         peak_list->prev = NULL;
-        delete peak_list;
-        peak_list = NULL;
+        peak_list->next = params->free_peak_lists;
+        params->free_peak_lists = peak_list;
+
+        peak_list = next;
     }
 }
 
@@ -129,14 +207,13 @@ MQPeakList* simpl::mq_find_peaks(int signal_size, sample* signal,
                                  MQParameters* params) {
     int num_peaks = 0;
     sample prev_amp, current_amp, next_amp;
-    MQPeakList* peak_list = new MQPeakList();
+    MQPeakList* peak_list = mq_new_peak_list(params);
 
     // take fft of the signal
-    memcpy(params->fft_in, signal, sizeof(sample)*params->frame_size);
     for(int i = 0; i < params->frame_size; i++) {
-        params->fft_in[i] *= params->window[i];
+        params->fft_in[i] = signal[i] * params->window[i];
     }
-    fftw_execute(params->fft_plan);
+    fftw_execute_dft_r2c(params->fft_plan, params->fft_in, params->fft_out);
 
     // get initial magnitudes
     prev_amp = get_magnitude(params->fft_out[0][0], params->fft_out[0][1]);
@@ -150,7 +227,7 @@ MQPeakList* simpl::mq_find_peaks(int signal_size, sample* signal,
         if((current_amp > prev_amp) &&
            (current_amp > next_amp) &&
            (current_amp > params->peak_threshold)) {
-            MQPeak* p = new MQPeak();
+            MQPeak* p = mq_new_peak(params);
             p->amplitude = current_amp;
             p->frequency = i * params->fundamental;
             p->phase = get_phase(params->fft_out[i][0], params->fft_out[i][1]);
@@ -158,23 +235,16 @@ MQPeakList* simpl::mq_find_peaks(int signal_size, sample* signal,
             p->next = NULL;
             p->prev = NULL;
 
-            // add it to the appropriate position in the list of Peaks
-            mq_add_peak(p, peak_list);
+            // add it to the appropriate position in the list of Peaks,
+            // which is limited to a maximum of max_peaks
+            mq_add_peak(p, peak_list, params);
             num_peaks++;
         }
         prev_amp = current_amp;
         current_amp = next_amp;
     }
 
-    // limit peaks to a maximum of max_peaks
     if(num_peaks > params->max_peaks) {
-        MQPeakList* current = peak_list;
-        for(int i = 0; i < params->max_peaks-1; i++) {
-            current = current->next;
-        }
-
-        delete_peak_list(current->next);
-        current->next = NULL;
         num_peaks = params->max_peaks;
     }
 
@@ -404,3 +474,340 @@ MQPeakList* simpl::mq_track_peaks(MQPeakList* peak_list,
     params->prev_peaks = peak_list;
     return peak_list;
 }
+
+// ----------------------------------------------------------------------------
+// Array-based Peak Detection and Partial Tracking
+
+void simpl::mq_init_peak_array(MQPeakArray* peaks, int capacity) {
+    mq_destroy_peak_array(peaks);
+
+    if(capacity < 1) {
+        capacity = 1;
+    }
+    peaks->capacity = capacity;
+    peaks->peaks = new MQArrayPeak[capacity];
+    peaks->order = new int[capacity];
+    peaks->left = new int[capacity + 1];
+    peaks->right = new int[capacity + 1];
+}
+
+void simpl::mq_destroy_peak_array(MQPeakArray* peaks) {
+    if(peaks->peaks) delete [] peaks->peaks;
+    if(peaks->order) delete [] peaks->order;
+    if(peaks->left) delete [] peaks->left;
+    if(peaks->right) delete [] peaks->right;
+
+    peaks->num_peaks = 0;
+    peaks->capacity = 0;
+    peaks->peaks = NULL;
+    peaks->order = NULL;
+    peaks->left = NULL;
+    peaks->right = NULL;
+}
+
+// Orders peak indices by decreasing amplitude. Peaks with the same
+// amplitude are ordered from last to first, as mq_add_peak inserts a new
+// peak before any peaks with the same amplitude.
+class AmplitudeOrder {
+    public:
+        MQArrayPeak* peaks;
+
+        AmplitudeOrder(MQArrayPeak* p) {
+            peaks = p;
+        }
+
+        bool operator()(int a, int b) const {
+            if(peaks[a].amplitude != peaks[b].amplitude) {
+                return peaks[a].amplitude > peaks[b].amplitude;
+            }
+            return a > b;
+        }
+};
+
+// The same order as AmplitudeOrder, for peaks that are found in bin order
+static bool largest_peak(const MQArrayPeak& a, const MQArrayPeak& b) {
+    if(a.amplitude != b.amplitude) {
+        return a.amplitude > b.amplitude;
+    }
+    return a.bin > b.bin;
+}
+
+static bool lowest_bin(const MQArrayPeak& a, const MQArrayPeak& b) {
+    return a.bin < b.bin;
+}
+
+// Merge sorting an MQPeakList by frequency keeps peaks with the same
+// frequency in amplitude order
+static bool lowest_frequency(const MQArrayPeak& a, const MQArrayPeak& b) {
+    if(a.frequency != b.frequency) {
+        return a.frequency < b.frequency;
+    }
+    return a.rank < b.rank;
+}
+
+// Rank the peaks by amplitude, then sort them by frequency
+static void rank_peaks(MQPeakArray* peaks) {
+    int n = peaks->num_peaks;
+
+    for(int i = 0; i < n; i++) {
+        peaks->order[i] = i;
+    }
+    std::sort(peaks->order, peaks->order + n, AmplitudeOrder(peaks->peaks));
+
+    for(int i = 0; i < n; i++) {
+        MQArrayPeak* p = &peaks->peaks[peaks->order[i]];
+        p->rank = i;
+        p->next = -1;
+        p->prev = -1;
+    }
+    std::sort(peaks->peaks, peaks->peaks + n, lowest_frequency);
+}
+
+void simpl::mq_set_peaks(MQPeakArray* peaks, int num_peaks,
+                         sample* amplitudes, sample* frequencies,
+                         sample* phases) {
+    int n = num_peaks < peaks->capacity ? num_peaks : peaks->capacity;
+
+    for(int i = 0; i < n; i++) {
+        MQArrayPeak* p = &peaks->peaks[i];
+        p->amplitude = amplitudes[i];
+        p->frequency = frequencies[i];
+        p->phase = phases[i];
+        p->bin = i;
+    }
+
+    // if there are more peaks than fit, keep the largest as mq_add_peak
+    // does, using a heap with the smallest kept peak at the front
+    if(num_peaks > n) {
+        std::make_heap(peaks->peaks, peaks->peaks + n, largest_peak);
+        for(int i = n; i < num_peaks; i++) {
+            MQArrayPeak p;
+            p.amplitude = amplitudes[i];
+            p.frequency = frequencies[i];
+            p.phase = phases[i];
+            p.bin = i;
+            if(largest_peak(p, peaks->peaks[0])) {
+                std::pop_heap(peaks->peaks, peaks->peaks + n, largest_peak);
+                peaks->peaks[n - 1] = p;
+                std::push_heap(peaks->peaks, peaks->peaks + n, largest_peak);
+            }
+        }
+        std::sort(peaks->peaks, peaks->peaks + n, lowest_bin);
+    }
+    peaks->num_peaks = n;
+
+    rank_peaks(peaks);
+}
+
+// Keep the largest params->max_peaks of the num_peaks peaks found in a
+// spectrum, in bin order, and rank them. Returns the number of peaks.
+static int keep_largest_peaks(int num_peaks, MQParameters* params,
+                              MQPeakArray* peaks) {
+    if(num_peaks > params->max_peaks) {
+        int max_peaks = params->max_peaks > 0 ? params->max_peaks : 0;
+        std::nth_element(peaks->peaks, peaks->peaks + max_peaks,
+                         peaks->peaks + num_peaks, largest_peak);
+        std::sort(peaks->peaks, peaks->peaks + max_peaks, lowest_bin);
+        num_peaks = max_peaks;
+    }
+
+    peaks->num_peaks = num_peaks;
+    rank_peaks(peaks);
+    return num_peaks;
+}
+
+int simpl::mq_find_peak_array(int signal_size, sample* signal,
+                              MQParameters* params, MQPeakArray* peaks) {
+    int num_peaks = 0;
+    sample prev_amp, current_amp, next_amp;
+
+    // take fft of the signal
+    for(int i = 0; i < params->frame_size; i++) {
+        params->fft_in[i] = signal[i] * params->window[i];
+    }
+    fftw_execute_dft_r2c(params->fft_plan, params->fft_in, params->fft_out);
+
+    // get initial magnitudes
+    prev_amp = get_magnitude(params->fft_out[0][0], params->fft_out[0][1]);
+    current_amp = get_magnitude(params->fft_out[1][0], params->fft_out[1][1]);
+
+    // find all peaks in the amplitude spectrum
+    for(int i = 1; i < params->num_bins - 1; i++) {
+        next_amp = get_magnitude(params->fft_out[i+1][0],
+                                 params->fft_out[i+1][1]);
+
+        if((current_amp > prev_amp) &&
+           (current_amp > next_amp) &&
+           (current_amp > params->peak_threshold) &&
+           (num_peaks < peaks->capacity)) {
+            MQArrayPeak* p = &peaks->peaks[num_peaks];
+            p->amplitude = current_amp;
+            p->frequency = i * params->fundamental;
+            p->phase = get_phase(params->fft_out[i][0], params->fft_out[i][1]);
+            p->bin = i;
+            num_peaks++;
+        }
+        prev_amp = current_amp;
+        current_amp = next_amp;
+    }
+
+    return keep_largest_peaks(num_peaks, params, peaks);
+}
+
+int simpl::mq_find_spectrum_peak_array(int num_bins, sample* magnitudes,
+                                       sample* phases, MQParameters* params,
+                                       MQPeakArray* peaks) {
+    int num_peaks = 0;
+
+    for(int i = 1; i < num_bins - 1; i++) {
+        if((magnitudes[i] > magnitudes[i - 1]) &&
+           (magnitudes[i] > magnitudes[i + 1]) &&
+           (magnitudes[i] > params->peak_threshold) &&
+           (num_peaks < peaks->capacity)) {
+            MQArrayPeak* p = &peaks->peaks[num_peaks];
+            p->amplitude = magnitudes[i];
+            p->frequency = i * params->fundamental;
+            p->phase = phases[i];
+            p->bin = i;
+            num_peaks++;
+        }
+    }
+
+    return keep_largest_peaks(num_peaks, params, peaks);
+}
+
+// The unmatched peaks are found with two disjoint-set forests:
+// right[i] leads to the first unmatched peak at or after peak i (or to
+// num_peaks) and left[i + 1] leads to the last unmatched peak at or before
+// peak i (or to 0, meaning no peak).
+static void reset_unmatched(MQPeakArray* peaks) {
+    for(int i = 0; i <= peaks->num_peaks; i++) {
+        peaks->right[i] = i;
+        peaks->left[i] = i;
+    }
+}
+
+static int find_root(int* parent, int i) {
+    while(parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static int unmatched_after(MQPeakArray* peaks, int i) {
+    return find_root(peaks->right, i);
+}
+
+static int unmatched_before(MQPeakArray* peaks, int i) {
+    return find_root(peaks->left, i + 1) - 1;
+}
+
+static void set_matched(MQPeakArray* peaks, int i) {
+    peaks->right[i] = i + 1;
+    peaks->left[i + 1] = i;
+}
+
+// Returns the unmatched peak that is closest in frequency to freq, if its
+// distance is less than max_distance, or -1. If below is set, only peaks
+// with lower frequencies are considered.
+//
+// Of the peaks at the closest distance, the first one in the order of
+// the equivalent MQPeakList is chosen: the peak with the lowest rank, or
+// if by_rank is not set, the peak with the lowest index.
+static int closest_unmatched(MQPeakArray* peaks, float freq,
+                             sample max_distance, bool by_rank, bool below) {
+    MQArrayPeak* p = peaks->peaks;
+    int n = peaks->num_peaks;
+    int best = -1;
+    sample best_distance = max_distance;
+
+    // index of the first peak with a frequency >= freq
+    int start = 0;
+    int end = n;
+    while(start < end) {
+        int middle = start + ((end - start) / 2);
+        if(p[middle].frequency < freq) {
+            start = middle + 1;
+        }
+        else {
+            end = middle;
+        }
+    }
+
+    // distances increase away from freq, so stop at the first unmatched
+    // peak on each side that is further away than the best match
+    if(!below) {
+        for(int i = unmatched_after(peaks, start); i < n;
+            i = unmatched_after(peaks, i + 1)) {
+            sample distance = fabs(p[i].frequency - freq);
+            if(distance > best_distance) {
+                break;
+            }
+            if(distance < best_distance ||
+               (best >= 0 &&
+                (by_rank ? p[i].rank < p[best].rank : i < best))) {
+                best = i;
+                best_distance = distance;
+            }
+        }
+    }
+
+    for(int i = unmatched_before(peaks, start - 1); i >= 0;
+        i = unmatched_before(peaks, i - 1)) {
+        sample distance = fabs(p[i].frequency - freq);
+        if(distance > best_distance) {
+            break;
+        }
+        if(distance < best_distance ||
+           (best >= 0 &&
+            (by_rank ? p[i].rank < p[best].rank : i < best))) {
+            best = i;
+            best_distance = distance;
+        }
+    }
+
+    return best;
+}
+
+// The same algorithm as mq_track_peaks, with the searches of
+// find_closest_match and free_peak_below done by closest_unmatched
+void simpl::mq_track_peak_array(MQPeakArray* prev_peaks, MQPeakArray* peaks,
+                                MQParameters* params) {
+    sample max_distance = params->matching_interval;
+    if(max_distance > 44100.0) {
+        max_distance = 44100.0;
+    }
+
+    reset_unmatched(prev_peaks);
+    reset_unmatched(peaks);
+
+    for(int i = 0; i < prev_peaks->num_peaks; i++) {
+        MQArrayPeak* p = &prev_peaks->peaks[i];
+
+        int match = closest_unmatched(peaks, p->frequency, max_distance,
+                                      true, false);
+        if(match < 0) {
+            continue;
+        }
+
+        float match_freq = peaks->peaks[match].frequency;
+        int closest_to_match = closest_unmatched(prev_peaks, match_freq,
+                                                 max_distance, false, false);
+        if(closest_to_match != i) {
+            // see if the closest peak with lower frequency to the
+            // candidate is within the matching interval
+            match = closest_unmatched(peaks, match_freq, 44100.0, true, true);
+            if(match < 0 ||
+               fabs(peaks->peaks[match].frequency - p->frequency) >=
+               params->matching_interval) {
+                continue;
+            }
+        }
+
+        p->next = match;
+        peaks->peaks[match].prev = i;
+        set_matched(prev_peaks, i);
+        set_matched(peaks, match);
+    }
+}
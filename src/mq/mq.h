@@ -4,6 +4,8 @@
 #include <cstdlib>
 
 #include <fftw3.h>
+
+#include "fft_plans.h"
 #include <math.h>
 #include <string.h>
 
@@ -53,8 +55,74 @@ class MQPeakList {
 };
 
 
+// ---------------------------------------------------------------------------
+// MQArrayPeak
+//
+// A peak in an MQPeakArray. next and prev are the indices of the peaks
+// that this peak is matched to in the next and previous frames, or -1.
+// ---------------------------------------------------------------------------
+class MQArrayPeak {
+    public:
+        float amplitude;
+        float frequency;
+        float phase;
+        int bin;
+        int rank;
+        int next;
+        int prev;
+
+        MQArrayPeak() {
+            amplitude = 0.f;
+            frequency = 0.f;
+            phase = 0.f;
+            bin = 0;
+            rank = 0;
+            next = -1;
+            prev = -1;
+        }
+};
+
+
+// ---------------------------------------------------------------------------
+// MQPeakArray
+//
+// The peaks in one frame, stored contiguously and sorted by increasing
+// frequency. Peaks with equal frequencies are sorted by rank, which is the
+// position of the peak in order of decreasing amplitude (the order of an
+// MQPeakList before it is sorted by frequency).
+//
+// This is an alternative to MQPeakList with the same results. Candidate
+// matches are found by binary search instead of a walk through the whole
+// list, so tracking takes O(n log n) time per frame instead of O(n^2).
+// ---------------------------------------------------------------------------
+class MQPeakArray {
+    public:
+        int num_peaks;
+        int capacity;
+        MQArrayPeak* peaks;
+
+        // workspace used to rank peaks and to skip over matched peaks
+        int* order;
+        int* left;
+        int* right;
+
+        MQPeakArray() {
+            num_peaks = 0;
+            capacity = 0;
+            peaks = NULL;
+            order = NULL;
+            left = NULL;
+            right = NULL;
+        }
+};
+
+
 // ---------------------------------------------------------------------------
 // MQParameters
+//
+// Peaks and peak list nodes are taken from free lists that are filled by
+// init_mq (see mq_reserve_peaks), so that finding and tracking peaks does
+// not allocate memory once the parameters have been set.
 // ---------------------------------------------------------------------------
 class MQParameters {
     public:
@@ -65,10 +133,13 @@ class MQParameters {
         sample fundamental;
         sample matching_interval;
         sample* window;
-        sample* fft_in;
+        double* fft_in;
         fftw_complex* fft_out;
         fftw_plan fft_plan;
         MQPeakList* prev_peaks;
+        MQPeak* free_peaks;
+        MQPeakList* free_peak_lists;
+        int pool_size;
 
         MQParameters() {
             frame_size = 0;
@@ -81,6 +152,9 @@ class MQParameters {
             fft_in = NULL;
             fft_out = NULL;
             prev_peaks = NULL;
+            free_peaks = NULL;
+            free_peak_lists = NULL;
+            pool_size = 0;
         }
 };
 
@@ -91,14 +165,51 @@ class MQParameters {
 int init_mq(MQParameters* params);
 void reset_mq(MQParameters* params);
 int destroy_mq(MQParameters* params);
-void mq_add_peak(MQPeak* new_peak, MQPeakList* peak_list);
-void delete_peak_list(MQPeakList* peak_list);
+
+// Fill the pool with enough peaks and list nodes for two lists of
+// params->max_peaks peaks (the peaks in the current and previous frames)
+void mq_reserve_peaks(MQParameters* params);
+MQPeak* mq_new_peak(MQParameters* params);
+MQPeakList* mq_new_peak_list(MQParameters* params);
+
+// Add new_peak to peak_list, keeping at most params->max_peaks peaks
+void mq_add_peak(MQPeak* new_peak, MQPeakList* peak_list,
+                 MQParameters* params);
+
+// Return all peaks and nodes in peak_list to the pool
+void delete_peak_list(MQPeakList* peak_list, MQParameters* params);
 
 MQPeakList* mq_sort_peaks_by_frequency(MQPeakList* peak_list, int num_peaks);
 MQPeakList* mq_find_peaks(int signal_size, sample* signal,
                           MQParameters* params);
 MQPeakList* mq_track_peaks(MQPeakList* peak_list, MQParameters* params);
 
+// Array-based versions of mq_find_peaks and mq_track_peaks
+void mq_init_peak_array(MQPeakArray* peaks, int capacity);
+void mq_destroy_peak_array(MQPeakArray* peaks);
+
+// Set the peaks in the array to the given peaks, ranking and sorting them.
+// If there are more than peaks->capacity, the largest are kept.
+void mq_set_peaks(MQPeakArray* peaks, int num_peaks, sample* amplitudes,
+                  sample* frequencies, sample* phases);
+
+// Find the params->max_peaks largest peaks in signal. peaks->capacity must
+// be at least params->num_bins / 2. Returns the number of peaks.
+int mq_find_peak_array(int signal_size, sample* signal,
+                       MQParameters* params, MQPeakArray* peaks);
+
+// As mq_find_peak_array, but with the num_bins magnitudes and phases of a
+// spectrum that has already been computed with the MQ window
+int mq_find_spectrum_peak_array(int num_bins, sample* magnitudes,
+                                sample* phases, MQParameters* params,
+                                MQPeakArray* peaks);
+
+// Match the peaks in prev_peaks to the peaks in peaks, setting their next
+// and prev indices. Gives the same matches as mq_track_peaks when the
+// previous peak list is sorted by frequency.
+void mq_track_peak_array(MQPeakArray* prev_peaks, MQPeakArray* peaks,
+                         MQParameters* params);
+
 } // end of namespace simpl
 
 
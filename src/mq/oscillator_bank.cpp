@@ -0,0 +1,490 @@
+#include "oscillator_bank.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MQ_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace simpl;
+
+// ----------------------------------------------------------------------------
+// Phase polynomial
+
+// Forward differences of p(n) = phase + freq * n + alpha * n^2 + beta * n^3,
+// p(n + 1) = p(n) + d1(n), d1(n + 1) = d1(n) + d2(n), d2(n + 1) = d2(n) + d3
+static inline void phase_differences(double freq, double alpha, double beta,
+                                     double* d1, double* d2, double* d3) {
+    *d1 = freq + alpha + beta;
+    *d2 = (2.0 * alpha) + (6.0 * beta);
+    *d3 = 6.0 * beta;
+}
+
+// Oscillators first to num_oscillators - 1, using cos from the C library.
+// The phase is always accumulated in double precision.
+static void oscillator_bank_scalar(int first, int num_oscillators,
+                                   int num_samples,
+                                   sample* amps, sample* amp_incs,
+                                   sample* phases, sample* freqs,
+                                   sample* alphas, sample* betas,
+                                   sample* out) {
+    for(int i = first; i < num_oscillators; i++) {
+        double amp = amps[i];
+        double amp_inc = amp_incs[i];
+        double phase = phases[i];
+        double d1, d2, d3;
+        phase_differences(freqs[i], alphas[i], betas[i], &d1, &d2, &d3);
+
+        for(int n = 0; n < num_samples; n++) {
+            amp += amp_inc;
+            out[n] += amp * cos(phase);
+            phase += d1;
+            d1 += d2;
+            d2 += d3;
+        }
+    }
+}
+
+#if defined(MQ_X86_SIMD) && !defined(SIMPL_FLOAT)
+
+// ----------------------------------------------------------------------------
+// Vector cos
+//
+// The argument is reduced to [-pi, pi] using a two part 2 * pi (the high
+// part has 30 significant bits so that k * TWO_PI_HI is exact), folded
+// into [0, pi / 2] and cos is evaluated with its Taylor series up to x^18.
+// The truncation error is below 4e-15 on [0, pi / 2].
+
+static const sample TWO_PI_HI = 6.283185310661793;
+static const sample TWO_PI_LO = -3.4822062782016664e-09;
+static const sample INV_TWO_PI = 0.15915494309189535;
+static const sample ROUND_MAGIC = 6755399441055744.0;  // 1.5 * 2^52
+
+static const sample COS_C0 = 1.0;
+static const sample COS_C1 = -0.5;
+static const sample COS_C2 = 0.041666666666666664;
+static const sample COS_C3 = -0.001388888888888889;
+static const sample COS_C4 = 2.48015873015873e-05;
+static const sample COS_C5 = -2.755731922398589e-07;
+static const sample COS_C6 = 2.08767569878681e-09;
+static const sample COS_C7 = -1.1470745597729725e-11;
+static const sample COS_C8 = 4.779477332387385e-14;
+static const sample COS_C9 = -1.5619206968586225e-16;
+
+__attribute__((target("sse2")))
+static inline __m128d cos_sse2(__m128d x) {
+    const __m128d magic = _mm_set1_pd(ROUND_MAGIC);
+    const __m128d sign = _mm_set1_pd(-0.0);
+
+    __m128d k = _mm_mul_pd(x, _mm_set1_pd(INV_TWO_PI));
+    k = _mm_sub_pd(_mm_add_pd(k, magic), magic);
+    x = _mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(TWO_PI_HI)));
+    x = _mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(TWO_PI_LO)));
+
+    // cos(x) = -cos(pi - |x|)
+    x = _mm_andnot_pd(sign, x);
+    __m128d flip = _mm_cmpgt_pd(x, _mm_set1_pd(M_PI / 2.0));
+    x = _mm_or_pd(_mm_and_pd(flip, _mm_sub_pd(_mm_set1_pd(M_PI), x)),
+                  _mm_andnot_pd(flip, x));
+
+    __m128d z = _mm_mul_pd(x, x);
+    __m128d y = _mm_set1_pd(COS_C9);
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C8));
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C7));
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C6));
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C5));
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C4));
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C3));
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C2));
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C1));
+    y = _mm_add_pd(_mm_mul_pd(y, z), _mm_set1_pd(COS_C0));
+
+    return _mm_xor_pd(y, _mm_and_pd(flip, sign));
+}
+
+__attribute__((target("avx2")))
+static inline __m256d cos_avx2(__m256d x) {
+    const __m256d magic = _mm256_set1_pd(ROUND_MAGIC);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+
+    __m256d k = _mm256_mul_pd(x, _mm256_set1_pd(INV_TWO_PI));
+    k = _mm256_sub_pd(_mm256_add_pd(k, magic), magic);
+    x = _mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(TWO_PI_HI)));
+    x = _mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(TWO_PI_LO)));
+
+    // cos(x) = -cos(pi - |x|)
+    x = _mm256_andnot_pd(sign, x);
+    __m256d flip = _mm256_cmp_pd(x, _mm256_set1_pd(M_PI / 2.0), _CMP_GT_OQ);
+    x = _mm256_blendv_pd(x, _mm256_sub_pd(_mm256_set1_pd(M_PI), x), flip);
+
+    __m256d z = _mm256_mul_pd(x, x);
+    __m256d y = _mm256_set1_pd(COS_C9);
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C8));
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C7));
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C6));
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C5));
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C4));
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C3));
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C2));
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C1));
+    y = _mm256_add_pd(_mm256_mul_pd(y, z), _mm256_set1_pd(COS_C0));
+
+    return _mm256_xor_pd(y, _mm256_and_pd(flip, sign));
+}
+
+// ----------------------------------------------------------------------------
+// Vector oscillator banks
+//
+// Each vector lane holds one oscillator. Returns the number of oscillators
+// processed, the rest are left for the scalar version.
+
+__attribute__((target("sse2")))
+static int oscillator_bank_sse2(int num_oscillators, int num_samples,
+                                sample* amps, sample* amp_incs,
+                                sample* phases, sample* freqs,
+                                sample* alphas, sample* betas,
+                                sample* out) {
+    int i = 0;
+
+    for(; i + 2 <= num_oscillators; i += 2) {
+        __m128d amp = _mm_loadu_pd(&amps[i]);
+        __m128d amp_inc = _mm_loadu_pd(&amp_incs[i]);
+        __m128d phase = _mm_loadu_pd(&phases[i]);
+        __m128d freq = _mm_loadu_pd(&freqs[i]);
+        __m128d alpha = _mm_loadu_pd(&alphas[i]);
+        __m128d beta = _mm_loadu_pd(&betas[i]);
+
+        __m128d d1 = _mm_add_pd(_mm_add_pd(freq, alpha), beta);
+        __m128d d2 = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(2.0), alpha),
+                                _mm_mul_pd(_mm_set1_pd(6.0), beta));
+        __m128d d3 = _mm_mul_pd(_mm_set1_pd(6.0), beta);
+
+        for(int n = 0; n < num_samples; n++) {
+            amp = _mm_add_pd(amp, amp_inc);
+            __m128d value = _mm_mul_pd(amp, cos_sse2(phase));
+            value = _mm_add_sd(value, _mm_unpackhi_pd(value, value));
+            out[n] += _mm_cvtsd_f64(value);
+
+            phase = _mm_add_pd(phase, d1);
+            d1 = _mm_add_pd(d1, d2);
+            d2 = _mm_add_pd(d2, d3);
+        }
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int oscillator_bank_avx2(int num_oscillators, int num_samples,
+                                sample* amps, sample* amp_incs,
+                                sample* phases, sample* freqs,
+                                sample* alphas, sample* betas,
+                                sample* out) {
+    int i = 0;
+
+    for(; i + 4 <= num_oscillators; i += 4) {
+        __m256d amp = _mm256_loadu_pd(&amps[i]);
+        __m256d amp_inc = _mm256_loadu_pd(&amp_incs[i]);
+        __m256d phase = _mm256_loadu_pd(&phases[i]);
+        __m256d freq = _mm256_loadu_pd(&freqs[i]);
+        __m256d alpha = _mm256_loadu_pd(&alphas[i]);
+        __m256d beta = _mm256_loadu_pd(&betas[i]);
+
+        __m256d d1 = _mm256_add_pd(_mm256_add_pd(freq, alpha), beta);
+        __m256d d2 = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(2.0), alpha),
+                                   _mm256_mul_pd(_mm256_set1_pd(6.0), beta));
+        __m256d d3 = _mm256_mul_pd(_mm256_set1_pd(6.0), beta);
+
+        for(int n = 0; n < num_samples; n++) {
+            amp = _mm256_add_pd(amp, amp_inc);
+            __m256d value = _mm256_mul_pd(amp, cos_avx2(phase));
+            __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(value),
+                                     _mm256_extractf128_pd(value, 1));
+            sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+            out[n] += _mm_cvtsd_f64(sum);
+
+            phase = _mm256_add_pd(phase, d1);
+            d1 = _mm256_add_pd(d1, d2);
+            d2 = _mm256_add_pd(d2, d3);
+        }
+    }
+
+    // avoid AVX to SSE transition stalls in the SSE2 and scalar code
+    _mm256_zeroupper();
+
+    // pick up a remaining pair with SSE2
+    return i + oscillator_bank_sse2(num_oscillators - i, num_samples,
+                                    &amps[i], &amp_incs[i],
+                                    &phases[i], &freqs[i],
+                                    &alphas[i], &betas[i], out);
+}
+
+#endif
+
+#if defined(MQ_X86_SIMD) && defined(SIMPL_FLOAT)
+
+// ----------------------------------------------------------------------------
+// Single precision vector cos
+//
+// With float samples there are 4 oscillators in each SSE2 vector and 8 in
+// each AVX2 vector. Single precision forward differences drift by several
+// 1e-4 radians over a hop, so the phase polynomial is evaluated directly at
+// each sample instead. The frequency is split into a high part with 13
+// significant bits, so that freq_hi * n is exact for n < 2048, and a small
+// low part. The whole turns are removed from freq_hi * n using a two part
+// 2 * pi (the high part having 8 significant bits, so that subtraction is
+// exact too), leaving only rounding errors that do not grow with n.
+//
+// cos is evaluated with its Taylor series up to x^12, which has a
+// truncation error below 5e-9 on [0, pi / 2].
+
+static const float TWO_PI_HI = 6.28125f;
+static const float TWO_PI_LO = 1.9353071795864769e-3f;
+static const float INV_TWO_PI = 0.15915494309189535f;
+static const float ROUND_MAGIC = 12582912.0f;  // 1.5 * 2^23
+static const float HALF_PI = 1.5707963267948966f;
+static const float PI = 3.141592653589793f;
+static const int FREQ_HI_MASK = 0xfffff800;  // clears 11 mantissa bits
+
+static const float COS_C0 = 1.0f;
+static const float COS_C1 = -0.5f;
+static const float COS_C2 = 0.041666666666666664f;
+static const float COS_C3 = -0.001388888888888889f;
+static const float COS_C4 = 2.48015873015873e-05f;
+static const float COS_C5 = -2.755731922398589e-07f;
+static const float COS_C6 = 2.08767569878681e-09f;
+
+// The nearest whole number of turns to x
+__attribute__((target("sse2")))
+static inline __m128 turns_sse2(__m128 x) {
+    const __m128 magic = _mm_set1_ps(ROUND_MAGIC);
+    __m128 k = _mm_mul_ps(x, _mm_set1_ps(INV_TWO_PI));
+    return _mm_sub_ps(_mm_add_ps(k, magic), magic);
+}
+
+// phase + freq * n + alpha * n^2 + beta * n^3, reduced to [-pi, pi]
+__attribute__((target("sse2")))
+static inline __m128 phase_sse2(__m128 n, __m128 phase,
+                                __m128 freq_hi, __m128 freq_lo,
+                                __m128 alpha, __m128 beta) {
+    __m128 x = _mm_mul_ps(freq_hi, n);
+    __m128 k = turns_sse2(x);
+    x = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_HI)));
+    x = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_LO)));
+
+    __m128 rest = _mm_add_ps(alpha, _mm_mul_ps(n, beta));
+    rest = _mm_add_ps(freq_lo, _mm_mul_ps(n, rest));
+    x = _mm_add_ps(x, _mm_add_ps(phase, _mm_mul_ps(n, rest)));
+
+    k = turns_sse2(x);
+    x = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_HI)));
+    return _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_LO)));
+}
+
+// x must be in [-pi, pi]
+__attribute__((target("sse2")))
+static inline __m128 cos_sse2(__m128 x) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    // cos(x) = -cos(pi - |x|)
+    x = _mm_andnot_ps(sign, x);
+    __m128 flip = _mm_cmpgt_ps(x, _mm_set1_ps(HALF_PI));
+    x = _mm_or_ps(_mm_and_ps(flip, _mm_sub_ps(_mm_set1_ps(PI), x)),
+                  _mm_andnot_ps(flip, x));
+
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(COS_C6);
+    y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(COS_C5));
+    y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(COS_C4));
+    y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(COS_C3));
+    y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(COS_C2));
+    y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(COS_C1));
+    y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(COS_C0));
+
+    return _mm_xor_ps(y, _mm_and_ps(flip, sign));
+}
+
+__attribute__((target("avx2")))
+static inline __m256 turns_avx2(__m256 x) {
+    const __m256 magic = _mm256_set1_ps(ROUND_MAGIC);
+    __m256 k = _mm256_mul_ps(x, _mm256_set1_ps(INV_TWO_PI));
+    return _mm256_sub_ps(_mm256_add_ps(k, magic), magic);
+}
+
+__attribute__((target("avx2")))
+static inline __m256 phase_avx2(__m256 n, __m256 phase,
+                                __m256 freq_hi, __m256 freq_lo,
+                                __m256 alpha, __m256 beta) {
+    __m256 x = _mm256_mul_ps(freq_hi, n);
+    __m256 k = turns_avx2(x);
+    x = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(TWO_PI_HI)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(TWO_PI_LO)));
+
+    __m256 rest = _mm256_add_ps(alpha, _mm256_mul_ps(n, beta));
+    rest = _mm256_add_ps(freq_lo, _mm256_mul_ps(n, rest));
+    x = _mm256_add_ps(x, _mm256_add_ps(phase, _mm256_mul_ps(n, rest)));
+
+    k = turns_avx2(x);
+    x = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(TWO_PI_HI)));
+    return _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(TWO_PI_LO)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256 cos_avx2(__m256 x) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+
+    x = _mm256_andnot_ps(sign, x);
+    __m256 flip = _mm256_cmp_ps(x, _mm256_set1_ps(HALF_PI), _CMP_GT_OQ);
+    x = _mm256_blendv_ps(x, _mm256_sub_ps(_mm256_set1_ps(PI), x), flip);
+
+    __m256 z = _mm256_mul_ps(x, x);
+    __m256 y = _mm256_set1_ps(COS_C6);
+    y = _mm256_add_ps(_mm256_mul_ps(y, z), _mm256_set1_ps(COS_C5));
+    y = _mm256_add_ps(_mm256_mul_ps(y, z), _mm256_set1_ps(COS_C4));
+    y = _mm256_add_ps(_mm256_mul_ps(y, z), _mm256_set1_ps(COS_C3));
+    y = _mm256_add_ps(_mm256_mul_ps(y, z), _mm256_set1_ps(COS_C2));
+    y = _mm256_add_ps(_mm256_mul_ps(y, z), _mm256_set1_ps(COS_C1));
+    y = _mm256_add_ps(_mm256_mul_ps(y, z), _mm256_set1_ps(COS_C0));
+
+    return _mm256_xor_ps(y, _mm256_and_ps(flip, sign));
+}
+
+// ----------------------------------------------------------------------------
+// Single precision vector oscillator banks
+
+__attribute__((target("sse2")))
+static int oscillator_bank_sse2(int num_oscillators, int num_samples,
+                                sample* amps, sample* amp_incs,
+                                sample* phases, sample* freqs,
+                                sample* alphas, sample* betas,
+                                sample* out) {
+    const __m128 hi_mask = _mm_castsi128_ps(_mm_set1_epi32(FREQ_HI_MASK));
+    int i = 0;
+
+    for(; i + 4 <= num_oscillators; i += 4) {
+        __m128 amp = _mm_loadu_ps(&amps[i]);
+        __m128 amp_inc = _mm_loadu_ps(&amp_incs[i]);
+        __m128 phase = _mm_loadu_ps(&phases[i]);
+        __m128 freq = _mm_loadu_ps(&freqs[i]);
+        __m128 alpha = _mm_loadu_ps(&alphas[i]);
+        __m128 beta = _mm_loadu_ps(&betas[i]);
+
+        __m128 freq_hi = _mm_and_ps(freq, hi_mask);
+        __m128 freq_lo = _mm_sub_ps(freq, freq_hi);
+        __m128 n = _mm_setzero_ps();
+
+        for(int j = 0; j < num_samples; j++) {
+            // the amplitude is also evaluated directly, as summing amp_inc
+            // in single precision drifts
+            __m128 next = _mm_add_ps(n, _mm_set1_ps(1.0f));
+            __m128 value = _mm_add_ps(amp, _mm_mul_ps(next, amp_inc));
+            value = _mm_mul_ps(value, cos_sse2(
+                phase_sse2(n, phase, freq_hi, freq_lo, alpha, beta)
+            ));
+            value = _mm_add_ps(value, _mm_movehl_ps(value, value));
+            value = _mm_add_ss(value, _mm_shuffle_ps(value, value, 1));
+            out[j] += _mm_cvtss_f32(value);
+            n = next;
+        }
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int oscillator_bank_avx2(int num_oscillators, int num_samples,
+                                sample* amps, sample* amp_incs,
+                                sample* phases, sample* freqs,
+                                sample* alphas, sample* betas,
+                                sample* out) {
+    const __m256 hi_mask =
+        _mm256_castsi256_ps(_mm256_set1_epi32(FREQ_HI_MASK));
+    int i = 0;
+
+    for(; i + 8 <= num_oscillators; i += 8) {
+        __m256 amp = _mm256_loadu_ps(&amps[i]);
+        __m256 amp_inc = _mm256_loadu_ps(&amp_incs[i]);
+        __m256 phase = _mm256_loadu_ps(&phases[i]);
+        __m256 freq = _mm256_loadu_ps(&freqs[i]);
+        __m256 alpha = _mm256_loadu_ps(&alphas[i]);
+        __m256 beta = _mm256_loadu_ps(&betas[i]);
+
+        __m256 freq_hi = _mm256_and_ps(freq, hi_mask);
+        __m256 freq_lo = _mm256_sub_ps(freq, freq_hi);
+        __m256 n = _mm256_setzero_ps();
+
+        for(int j = 0; j < num_samples; j++) {
+            __m256 next = _mm256_add_ps(n, _mm256_set1_ps(1.0f));
+            __m256 value = _mm256_add_ps(amp, _mm256_mul_ps(next, amp_inc));
+            value = _mm256_mul_ps(value, cos_avx2(
+                phase_avx2(n, phase, freq_hi, freq_lo, alpha, beta)
+            ));
+            __m128 sum = _mm_add_ps(_mm256_castps256_ps128(value),
+                                    _mm256_extractf128_ps(value, 1));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+            out[j] += _mm_cvtss_f32(sum);
+            n = next;
+        }
+    }
+
+    // avoid AVX to SSE transition stalls in the SSE2 and scalar code
+    _mm256_zeroupper();
+
+    // pick up a remaining group of 4 with SSE2
+    return i + oscillator_bank_sse2(num_oscillators - i, num_samples,
+                                    &amps[i], &amp_incs[i],
+                                    &phases[i], &freqs[i],
+                                    &alphas[i], &betas[i], out);
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Dispatch
+
+static int detect_simd_level() {
+#ifdef MQ_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        return MQ_SIMD_AVX2;
+    }
+    if(__builtin_cpu_supports("sse2")) {
+        return MQ_SIMD_SSE2;
+    }
+#endif
+    return MQ_SIMD_NONE;
+}
+
+int simpl::mq_simd_level() {
+    static int level = detect_simd_level();
+    return level;
+}
+
+void simpl::mq_oscillator_bank(int num_oscillators, int num_samples,
+                               sample* amps, sample* amp_incs,
+                               sample* phases, sample* freqs,
+                               sample* alphas, sample* betas,
+                               sample* out, int simd_level) {
+    if(simd_level > mq_simd_level()) {
+        simd_level = mq_simd_level();
+    }
+
+    int first = 0;
+
+#ifdef MQ_X86_SIMD
+    if(simd_level == MQ_SIMD_AVX2) {
+        first = oscillator_bank_avx2(num_oscillators, num_samples,
+                                     amps, amp_incs, phases, freqs,
+                                     alphas, betas, out);
+    }
+    else if(simd_level == MQ_SIMD_SSE2) {
+        first = oscillator_bank_sse2(num_oscillators, num_samples,
+                                     amps, amp_incs, phases, freqs,
+                                     alphas, betas, out);
+    }
+#endif
+
+    oscillator_bank_scalar(first, num_oscillators, num_samples,
+                           amps, amp_incs, phases, freqs,
+                           alphas, betas, out);
+}
@@ -0,0 +1,57 @@
+#ifndef _SIMPL_MQ_OSCILLATOR_BANK_H
+#define _SIMPL_MQ_OSCILLATOR_BANK_H
+
+#include <math.h>
+
+#include "base.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// MQ oscillator bank
+//
+// Adds the output of a bank of oscillators with linearly interpolated
+// amplitudes and cubic phase polynomials (McAulay and Quatieri) to out.
+// At sample n (0 <= n < num_samples), oscillator i contributes
+//
+//     (amps[i] + (n + 1) * amp_incs[i]) *
+//     cos(phases[i] + freqs[i] * n + alphas[i] * n^2 + betas[i] * n^3)
+//
+// The phase polynomial is evaluated incrementally using forward
+// differences. Blocks of oscillators are processed with SSE2 or AVX2 when
+// the CPU supports them, using a polynomial approximation of cos.
+//
+// Tolerance: for phases up to about 1e4 radians (a hop size of 1024
+// samples at the Nyquist frequency) the output of every oscillator is
+// within 1e-9 * its amplitude of the direct evaluation of the formula
+// above with cos from the C library, for every SIMD level.
+//
+// In a SIMPL_FLOAT build the vectors hold 4 (SSE2) or 8 (AVX2) oscillators
+// and the phase polynomial is evaluated directly at each sample, as single
+// precision forward differences drift. The error is then limited by the
+// precision of a float phase, about 6e-8 * |phase| radians, so below
+// 2e-4 * amplitude for hops of up to 1024 samples. The scalar version
+// always works in double precision.
+// ---------------------------------------------------------------------------
+enum MQSimdLevel {
+    MQ_SIMD_NONE = 0,
+    MQ_SIMD_SSE2 = 1,
+    MQ_SIMD_AVX2 = 2,
+    MQ_SIMD_AUTO = 3
+};
+
+// The highest SIMD level supported by this CPU
+int mq_simd_level();
+
+// Levels above the one supported by the CPU are clamped to mq_simd_level()
+void mq_oscillator_bank(int num_oscillators, int num_samples,
+                        sample* amps, sample* amp_incs,
+                        sample* phases, sample* freqs,
+                        sample* alphas, sample* betas,
+                        sample* out, int simd_level=MQ_SIMD_AUTO);
+
+} // end of namespace simpl
+
+#endif
@@ -1,10 +1,25 @@
+#include <algorithm>
 #include "math.h"
 #include "twm.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TWM_X86_SIMD
+#include <immintrin.h>
+#endif
+
 using namespace simpl;
 
+// TWM error parameters, from Maher and Beauchamp
+static const sample TWM_P = 0.5;
+static const sample TWM_Q = 1.4;
+static const sample TWM_R = 0.5;
+static const sample TWM_RHO = 0.33;
+
+// peaks below this fraction of the largest amplitude are ignored
+static const sample TWM_MIN_AMP = 0.1;
+
 
-int simpl::best_match(sample freq, std::vector<sample> candidates) {
+int simpl::best_match(sample freq, const std::vector<sample>& candidates) {
     sample best_diff = 22050.0;
     sample diff = 0.0;
     int best = 0;
@@ -20,100 +35,539 @@ int simpl::best_match(sample freq, std::vector<sample> candidates) {
     return best;
 }
 
-sample simpl::twm(Peaks peaks, sample f_min, sample f_max, sample f_step) {
-    sample p = 0.5;
-    sample q = 1.4;
-    sample r = 0.5;
-    sample rho = 0.33;
-    int N = 30;
-    std::map<sample, sample> err;
-
+sample simpl::twm(const Peaks& peaks, sample f_min, sample f_max,
+                  sample f_step) {
     if(peaks.size() == 0) {
         return 0.0;
     }
 
-    sample max_amp = 0.0;
+    std::vector<sample> amps(peaks.size());
+    std::vector<sample> freqs(peaks.size());
+
     for(int i = 0; i < peaks.size(); i++) {
-        if(peaks[i]->amplitude > max_amp) {
-            max_amp = peaks[i]->amplitude;
+        amps[i] = peaks[i]->amplitude;
+        freqs[i] = peaks[i]->frequency;
+    }
+
+    TWM estimator(f_min, f_max, f_step);
+    estimator.coarse_factor(1);
+    return estimator.find_f0(peaks.size(), &amps[0], &freqs[0]);
+}
+
+
+// ----------------------------------------------------------------------------
+// Peak to harmonic mismatch
+//
+// Sum of weights[i] * |freqs[i] - h| for the closest harmonic h = k * f0 to
+// each peak, 1 <= k <= num_harmonics. Returns the number of peaks processed
+// by the SIMD versions, the rest are left for the scalar version.
+
+static sample mismatch_scalar(int first, int num_peaks, sample* freqs,
+                              sample* weights, sample f0,
+                              sample num_harmonics) {
+    sample err = 0.0;
+
+    for(int i = first; i < num_peaks; i++) {
+        sample k = floor(freqs[i] / f0);
+        k = k < 1 ? 1 : (k > num_harmonics ? num_harmonics : k);
+        sample k_next = k + 1 > num_harmonics ? num_harmonics : k + 1;
+
+        sample diff = fabs(freqs[i] - (k * f0));
+        sample diff_next = fabs(freqs[i] - (k_next * f0));
+        err += weights[i] * (diff_next < diff ? diff_next : diff);
+    }
+
+    return err;
+}
+
+#if defined(TWM_X86_SIMD) && !defined(SIMPL_FLOAT)
+
+__attribute__((target("sse2")))
+static int mismatch_sse2(int num_peaks, sample* freqs, sample* weights,
+                         sample f0, sample num_harmonics, sample* err) {
+    __m128d f = _mm_set1_pd(f0);
+    __m128d one = _mm_set1_pd(1.0);
+    __m128d max_k = _mm_set1_pd(num_harmonics);
+    __m128d sign = _mm_set1_pd(-0.0);
+    __m128d sum = _mm_setzero_pd();
+    int i = 0;
+
+    for(; i + 2 <= num_peaks; i += 2) {
+        __m128d freq = _mm_loadu_pd(&freqs[i]);
+
+        // peak frequencies are positive, so truncation is floor
+        __m128d k = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_div_pd(freq, f)));
+        k = _mm_min_pd(_mm_max_pd(k, one), max_k);
+        __m128d k_next = _mm_min_pd(_mm_add_pd(k, one), max_k);
+
+        __m128d diff = _mm_andnot_pd(sign,
+                                     _mm_sub_pd(freq, _mm_mul_pd(k, f)));
+        __m128d diff_next = _mm_andnot_pd(sign,
+            _mm_sub_pd(freq, _mm_mul_pd(k_next, f)));
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(&weights[i]),
+                                         _mm_min_pd(diff, diff_next)));
+    }
+
+    sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+    *err = _mm_cvtsd_f64(sum);
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int mismatch_avx2(int num_peaks, sample* freqs, sample* weights,
+                         sample f0, sample num_harmonics, sample* err) {
+    __m256d f = _mm256_set1_pd(f0);
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d max_k = _mm256_set1_pd(num_harmonics);
+    __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d sum = _mm256_setzero_pd();
+    int i = 0;
+
+    for(; i + 4 <= num_peaks; i += 4) {
+        __m256d freq = _mm256_loadu_pd(&freqs[i]);
+
+        __m256d k = _mm256_floor_pd(_mm256_div_pd(freq, f));
+        k = _mm256_min_pd(_mm256_max_pd(k, one), max_k);
+        __m256d k_next = _mm256_min_pd(_mm256_add_pd(k, one), max_k);
+
+        __m256d diff = _mm256_andnot_pd(sign,
+            _mm256_sub_pd(freq, _mm256_mul_pd(k, f)));
+        __m256d diff_next = _mm256_andnot_pd(sign,
+            _mm256_sub_pd(freq, _mm256_mul_pd(k_next, f)));
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(&weights[i]),
+                                               _mm256_min_pd(diff, diff_next)));
+    }
+
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum),
+                              _mm256_extractf128_pd(sum, 1));
+    half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+    *err = _mm_cvtsd_f64(half);
+    return i;
+}
+
+#endif
+
+#if defined(TWM_X86_SIMD) && defined(SIMPL_FLOAT)
+
+// Single precision versions, 4 peaks per SSE2 vector and 8 per AVX2 vector
+
+__attribute__((target("sse2")))
+static int mismatch_sse2(int num_peaks, sample* freqs, sample* weights,
+                         sample f0, sample num_harmonics, sample* err) {
+    __m128 f = _mm_set1_ps(f0);
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 max_k = _mm_set1_ps(num_harmonics);
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 sum = _mm_setzero_ps();
+    int i = 0;
+
+    for(; i + 4 <= num_peaks; i += 4) {
+        __m128 freq = _mm_loadu_ps(&freqs[i]);
+
+        // peak frequencies are positive, so truncation is floor
+        __m128 k = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(freq, f)));
+        k = _mm_min_ps(_mm_max_ps(k, one), max_k);
+        __m128 k_next = _mm_min_ps(_mm_add_ps(k, one), max_k);
+
+        __m128 diff = _mm_andnot_ps(sign, _mm_sub_ps(freq, _mm_mul_ps(k, f)));
+        __m128 diff_next = _mm_andnot_ps(sign,
+            _mm_sub_ps(freq, _mm_mul_ps(k_next, f)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&weights[i]),
+                                         _mm_min_ps(diff, diff_next)));
+    }
+
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    *err = _mm_cvtss_f32(sum);
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int mismatch_avx2(int num_peaks, sample* freqs, sample* weights,
+                         sample f0, sample num_harmonics, sample* err) {
+    __m256 f = _mm256_set1_ps(f0);
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 max_k = _mm256_set1_ps(num_harmonics);
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 sum = _mm256_setzero_ps();
+    int i = 0;
+
+    for(; i + 8 <= num_peaks; i += 8) {
+        __m256 freq = _mm256_loadu_ps(&freqs[i]);
+
+        __m256 k = _mm256_floor_ps(_mm256_div_ps(freq, f));
+        k = _mm256_min_ps(_mm256_max_ps(k, one), max_k);
+        __m256 k_next = _mm256_min_ps(_mm256_add_ps(k, one), max_k);
+
+        __m256 diff = _mm256_andnot_ps(sign,
+            _mm256_sub_ps(freq, _mm256_mul_ps(k, f)));
+        __m256 diff_next = _mm256_andnot_ps(sign,
+            _mm256_sub_ps(freq, _mm256_mul_ps(k_next, f)));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(&weights[i]),
+                                               _mm256_min_ps(diff, diff_next)));
+    }
+
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum),
+                             _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    *err = _mm_cvtss_f32(half);
+    return i;
+}
+
+#endif
+
+static sample mismatch(int num_peaks, sample* freqs, sample* weights,
+                       sample f0, int num_harmonics, int simd_level) {
+    sample err = 0.0;
+    int first = 0;
+
+#ifdef TWM_X86_SIMD
+    if(simd_level == MQ_SIMD_AVX2) {
+        first = mismatch_avx2(num_peaks, freqs, weights, f0,
+                              num_harmonics, &err);
+    }
+    else if(simd_level == MQ_SIMD_SSE2) {
+        first = mismatch_sse2(num_peaks, freqs, weights, f0,
+                              num_harmonics, &err);
+    }
+#endif
+
+    return err + mismatch_scalar(first, num_peaks, freqs, weights, f0,
+                                 num_harmonics);
+}
+
+
+// ---------------------------------------------------------------------------
+// TWM
+// ---------------------------------------------------------------------------
+TWM::TWM(sample f_min, sample f_max, sample f_step) {
+    _f_min = f_min;
+    _f_max = f_max;
+    _f_step = f_step;
+    _num_harmonics = 0;
+    _coarse_factor = 4;
+    _num_refinements = 4;
+    _simd_level = mq_simd_level();
+    _max_peaks = 0;
+    _f0 = 0.0;
+    _num_peaks = 0;
+    _loudest = -1;
+    _num_candidates = 0;
+
+    num_harmonics(30);
+    max_peaks(100);
+    resize_candidates();
+}
+
+void TWM::resize_peaks(int new_max_peaks) {
+    _max_peaks = new_max_peaks;
+    _freqs.resize(_max_peaks);
+    _amps.resize(_max_peaks);
+    _indices.resize(_max_peaks);
+    _run_starts.resize(_max_peaks);
+    _mp_weights.resize(_max_peaks);
+    _order.resize(_max_peaks);
+}
+
+void TWM::resize_candidates() {
+    _num_candidates = 0;
+    if(_f_step > 0) {
+        while(_f_min + (_num_candidates * _f_step) < _f_max) {
+            _num_candidates++;
+        }
+    }
+
+    _errors.resize(_num_candidates);
+    _searched.resize(_num_candidates);
+    _best.resize(_num_refinements);
+}
+
+sample TWM::f_min() {
+    return _f_min;
+}
+
+void TWM::f_min(sample new_f_min) {
+    _f_min = new_f_min;
+    resize_candidates();
+}
+
+sample TWM::f_max() {
+    return _f_max;
+}
+
+void TWM::f_max(sample new_f_max) {
+    _f_max = new_f_max;
+    resize_candidates();
+}
+
+sample TWM::f_step() {
+    return _f_step;
+}
+
+void TWM::f_step(sample new_f_step) {
+    _f_step = new_f_step;
+    resize_candidates();
+}
+
+int TWM::num_harmonics() {
+    return _num_harmonics;
+}
+
+void TWM::num_harmonics(int new_num_harmonics) {
+    _num_harmonics = new_num_harmonics;
+    _harmonic_weights.resize(_num_harmonics + 1);
+    for(int n = 1; n <= _num_harmonics; n++) {
+        _harmonic_weights[n] = pow((sample)n, -TWM_P);
+    }
+}
+
+int TWM::coarse_factor() {
+    return _coarse_factor;
+}
+
+void TWM::coarse_factor(int new_coarse_factor) {
+    _coarse_factor = new_coarse_factor < 1 ? 1 : new_coarse_factor;
+}
+
+int TWM::num_refinements() {
+    return _num_refinements;
+}
+
+void TWM::num_refinements(int new_num_refinements) {
+    _num_refinements = new_num_refinements < 1 ? 1 : new_num_refinements;
+    _best.resize(_num_refinements);
+}
+
+int TWM::max_peaks() {
+    return _max_peaks;
+}
+
+void TWM::max_peaks(int new_max_peaks) {
+    resize_peaks(new_max_peaks);
+}
+
+int TWM::simd_level() {
+    return _simd_level;
+}
+
+void TWM::simd_level(int new_simd_level) {
+    _simd_level = new_simd_level;
+    if(_simd_level > mq_simd_level()) {
+        _simd_level = mq_simd_level();
+    }
+}
+
+sample TWM::f0() {
+    return _f0;
+}
+
+void TWM::reset() {
+    _f0 = 0.0;
+}
+
+// Orders peak indices by frequency, and then by index
+class FrequencyOrder {
+    public:
+        sample* freqs;
+
+        FrequencyOrder(sample* f) {
+            freqs = f;
+        }
+
+        bool operator()(int a, int b) const {
+            if(freqs[a] != freqs[b]) {
+                return freqs[a] < freqs[b];
+            }
+            return a < b;
+        }
+};
+
+void TWM::set_peaks(int num_peaks, sample* amplitudes, sample* frequencies) {
+    if(num_peaks > _max_peaks) {
+        resize_peaks(num_peaks);
+    }
+
+    sample max_amp = 0.0;
+    for(int i = 0; i < num_peaks; i++) {
+        if(amplitudes[i] > max_amp) {
+            max_amp = amplitudes[i];
         }
     }
 
+    _num_peaks = 0;
+    _loudest = -1;
     if(max_amp == 0) {
-        return 0.0;
+        return;
     }
 
-    // remove all peaks with amplitude of less than 10% of max
-    // note: this is not in the TWM paper, found that it improved
-    // accuracy however
-    for(int i = 0; i < peaks.size(); i++) {
-        if(peaks[i]->amplitude < (max_amp * 0.1)) {
-            peaks.erase(peaks.begin() + i);
+    for(int i = 0; i < num_peaks; i++) {
+        if(amplitudes[i] >= max_amp * TWM_MIN_AMP) {
+            _order[_num_peaks++] = i;
         }
     }
+    std::sort(_order.begin(), _order.begin() + _num_peaks,
+              FrequencyOrder(frequencies));
 
-    // get the max frequency of the remaining peaks
-    sample max_freq = 0.0;
-    for(int i = 0; i < peaks.size(); i++) {
-        if(peaks[i]->frequency > max_freq) {
-            max_freq = peaks[i]->frequency;
+    for(int i = 0; i < _num_peaks; i++) {
+        int peak = _order[i];
+        sample f = frequencies[peak];
+        sample a = amplitudes[peak] / max_amp;
+        sample w = pow(f, -TWM_P);
+
+        _freqs[i] = f;
+        _amps[i] = a;
+        _indices[i] = peak;
+        _mp_weights[i] = w + (a * TWM_Q * (w - TWM_R));
+        _run_starts[i] = (i > 0 && _freqs[i - 1] == f) ? _run_starts[i - 1] : i;
+
+        if(a == 1.0 && _loudest < 0) {
+            _loudest = i;
         }
     }
+}
 
-    std::vector<sample> peak_freqs;
-    for(int i = 0; i < peaks.size(); i++) {
-        peak_freqs.push_back(peaks[i]->frequency);
+// Returns the position of the peak closest to freq. Of peaks at the same
+// distance, the one that was given first to find_f0 is chosen.
+int TWM::closest_peak(sample freq) {
+    int start = std::lower_bound(_freqs.begin(), _freqs.begin() + _num_peaks,
+                                 freq) - _freqs.begin();
+
+    if(start == 0) {
+        return 0;
+    }
+    else if(start == _num_peaks) {
+        return _run_starts[_num_peaks - 1];
+    }
+
+    int below = _run_starts[start - 1];
+    sample diff_below = freq - _freqs[below];
+    sample diff_above = _freqs[start] - freq;
+
+    if(diff_below < diff_above ||
+       (diff_below == diff_above && _indices[below] < _indices[start])) {
+        return below;
+    }
+    return start;
+}
+
+sample TWM::error(sample f0) {
+    if(_num_peaks == 0 || f0 <= 0) {
+        return 0.0;
+    }
+
+    int num_harmonics = (int)(_f_max / f0);
+    if(num_harmonics > _num_harmonics) {
+        num_harmonics = _num_harmonics;
+    }
+    if(num_harmonics < 1) {
+        num_harmonics = 1;
+    }
+
+    // mismatch between predicted and actual peaks
+    sample err_pm = 0.0;
+    sample f0_weight = pow(f0, -TWM_P);
+    for(int n = 1; n <= num_harmonics; n++) {
+        sample h = n * f0;
+        sample w = _harmonic_weights[n] * f0_weight;
+        int k = closest_peak(h);
+        err_pm += fabs(h - _freqs[k]) * (w + (_amps[k] * TWM_Q * (w - TWM_R)));
+    }
+
+    // mismatch between actual and predicted peaks
+    sample err_mp = mismatch(_num_peaks, &_freqs[0], &_mp_weights[0], f0,
+                             num_harmonics, _simd_level);
+
+    return (err_pm / num_harmonics) + (TWM_RHO * err_mp / _num_peaks);
+}
+
+sample TWM::candidate_error(int candidate) {
+    if(!_searched[candidate]) {
+        _errors[candidate] = fabs(error(_f_min + (candidate * _f_step)));
+        _searched[candidate] = 1;
+    }
+    return _errors[candidate];
+}
+
+void TWM::search(int first, int last, int step) {
+    if(first < 0) {
+        first = 0;
+    }
+    if(last >= _num_candidates) {
+        last = _num_candidates - 1;
+    }
+
+    for(int i = first; i <= last; i += step) {
+        candidate_error(i);
+    }
+}
+
+void TWM::search_near(sample freq, int radius) {
+    int candidate = (int)floor(((freq - _f_min) / _f_step) + 0.5);
+    search(candidate - radius, candidate + radius, 1);
+}
+
+sample TWM::find_f0(int num_peaks, sample* amplitudes, sample* frequencies) {
+    set_peaks(num_peaks, amplitudes, frequencies);
+
+    if(_num_peaks == 0 || _num_candidates == 0) {
+        _f0 = 0.0;
+        return _f0;
     }
 
-    sample f_current = f_min;
-    while(f_current < f_max) {
-        sample err_pm = 0.0;
-        sample err_mp = 0.0;
-        std::vector<sample> harmonics;
+    std::fill(_searched.begin(), _searched.end(), 0);
+    search(0, _num_candidates - 1, _coarse_factor);
 
-        for(sample f = f_current; f <= f_max; f += f_current) {
-            harmonics.push_back(f);
-            if(harmonics.size() >= N) {
-                break;
+    int radius = _coarse_factor - 1;
+    if(radius > 0) {
+        // find the best coarse candidates, lowest error first
+        int num_best = 0;
+        for(int i = 0; i < _num_candidates; i += _coarse_factor) {
+            int pos = num_best;
+            while(pos > 0 && _errors[i] < _errors[_best[pos - 1]]) {
+                pos--;
             }
-        }
 
-        // calculate mismatch between predicted and actual peaks
-        for(int i = 0; i < harmonics.size(); i++) {
-            sample h = harmonics[i];
-            int k = best_match(h, peak_freqs);
-            sample f = peaks[k]->frequency;
-            sample a = peaks[k]->amplitude;
-            err_pm += (fabs(h - f) * pow(h, -p)) +
-                      (((a / max_amp) * (q * fabs(h - f)) * (pow(h, -p) - r)));
+            if(pos < _num_refinements) {
+                if(num_best < _num_refinements) {
+                    num_best++;
+                }
+                for(int j = num_best - 1; j > pos; j--) {
+                    _best[j] = _best[j - 1];
+                }
+                _best[pos] = i;
+            }
         }
 
-        // calculate the mismatch between actual and predicted peaks
-        for(int i = 0; i < peaks.size(); i++) {
-            sample f = peaks[i]->frequency;
-            sample a = peaks[i]->amplitude;
-            int k = best_match(f, harmonics);
-            sample h = harmonics[k];
-            err_mp += (fabs(f - h) * pow(f, -p)) +
-                      ((a / max_amp) * (q * fabs(f - h)) * (pow(f, -p) - r));
+        // refine around them and the previous estimate
+        for(int i = 0; i < num_best; i++) {
+            search(_best[i] - radius, _best[i] + radius, 1);
         }
 
-        // calculate the total error for f_current as a fundamental frequency
-        err[f_current] = (err_pm / harmonics.size()) +
-                         (rho * err_mp / peaks.size());
+        if(_f0 > 0) {
+            search_near(_f0, radius);
+        }
 
-        f_current += f_step;
+        // and around the subharmonics of the loudest peak
+        sample f = _freqs[_loudest];
+        for(int n = 1; n <= _num_harmonics && f / n >= _f_min - _f_step; n++) {
+            search_near(f / n, 1);
+        }
     }
 
-    // return the value with the minimum total error
-    sample best_freq = 0;
-    sample min_error = 22050;
-    for(std::map<sample, sample>::iterator i = err.begin(); i != err.end(); i++) {
-        if(fabs((*i).second) < min_error) {
-            min_error = fabs((*i).second);
-            best_freq = (*i).first;
+    // the candidate with the minimum error, lowest first
+    int best = -1;
+    for(int i = 0; i < _num_candidates; i++) {
+        if(_searched[i] && (best < 0 || _errors[i] < _errors[best])) {
+            best = i;
         }
     }
 
-    return best_freq;
+    _f0 = _f_min + (best * _f_step);
+    return _f0;
+}
+
+sample TWM::find_f0(Frame* frame) {
+    return find_f0(frame->num_peaks(), frame->peak_amplitudes(),
+                   frame->peak_frequencies());
 }
@@ -5,15 +5,117 @@
 #include <vector>
 
 #include "base.h"
+#include "oscillator_bank.h"
 
 namespace simpl
 {
 
-int best_match(sample freq, std::vector<sample> candidates);
+int best_match(sample freq, const std::vector<sample>& candidates);
 
-sample twm(Peaks peaks, sample f_min=20.0,
+sample twm(const Peaks& peaks, sample f_min=20.0,
            sample f_max=3000.0, sample f_step=10.0);
 
+
+// ---------------------------------------------------------------------------
+// TWM
+//
+// Two-way mismatch fundamental frequency estimation (Maher and Beauchamp),
+// for estimating the fundamental of every frame of a signal. Each channel
+// of a multichannel signal should use its own TWM object.
+//
+// Candidate fundamentals are f_min + i * f_step for each i with a
+// candidate below f_max, and the one with the smallest absolute error is
+// returned, as in twm(). Peaks with less than 10% of the largest amplitude
+// are ignored.
+//
+// The peaks are sorted by frequency so that the closest peak to each
+// harmonic is found by binary search, and the closest harmonic to each
+// peak is found directly. The peak to harmonic errors are accumulated
+// with SSE2 or AVX2 when the CPU supports them.
+//
+// With a coarse factor c > 1, the error is first found for every c-th
+// candidate. The fine candidates within c - 1 steps of the best
+// num_refinements coarse candidates and of the previous estimate, and
+// those next to each subharmonic of the loudest peak, are then searched.
+// This usually finds the same minimum as searching every candidate (a
+// coarse factor of 1), but is not guaranteed to.
+//
+// No memory is allocated by find_f0 unless the number of peaks is larger
+// than max_peaks.
+// ---------------------------------------------------------------------------
+class TWM {
+    private:
+        sample _f_min;
+        sample _f_max;
+        sample _f_step;
+        int _num_harmonics;
+        int _coarse_factor;
+        int _num_refinements;
+        int _simd_level;
+        int _max_peaks;
+        sample _f0;
+
+        // peaks above the amplitude threshold, sorted by frequency
+        int _num_peaks;
+        std::vector<sample> _freqs;
+        std::vector<sample> _amps;
+        std::vector<int> _indices;
+        std::vector<int> _run_starts;
+        std::vector<sample> _mp_weights;
+        std::vector<int> _order;
+        int _loudest;
+
+        // harmonic number ^ -p, for each harmonic number
+        std::vector<sample> _harmonic_weights;
+
+        // error for each candidate, and whether it has been calculated
+        int _num_candidates;
+        std::vector<sample> _errors;
+        std::vector<char> _searched;
+        std::vector<int> _best;
+
+        void resize_peaks(int max_peaks);
+        void resize_candidates();
+        void set_peaks(int num_peaks, sample* amplitudes, sample* frequencies);
+        int closest_peak(sample freq);
+        sample candidate_error(int candidate);
+        void search(int first, int last, int step);
+        void search_near(sample freq, int radius);
+
+    public:
+        TWM(sample f_min=20.0, sample f_max=3000.0, sample f_step=10.0);
+
+        sample f_min();
+        void f_min(sample new_f_min);
+        sample f_max();
+        void f_max(sample new_f_max);
+        sample f_step();
+        void f_step(sample new_f_step);
+        int num_harmonics();
+        void num_harmonics(int new_num_harmonics);
+        int coarse_factor();
+        void coarse_factor(int new_coarse_factor);
+        int num_refinements();
+        void num_refinements(int new_num_refinements);
+        int max_peaks();
+        void max_peaks(int new_max_peaks);
+        int simd_level();
+        void simd_level(int new_simd_level);
+
+        // The most recent estimate, or 0 if there is none
+        sample f0();
+        void reset();
+
+        // Estimate the fundamental frequency of the given peaks, returning
+        // 0 if there are no peaks
+        sample find_f0(int num_peaks, sample* amplitudes, sample* frequencies);
+        sample find_f0(Frame* frame);
+
+        // The TWM error of candidate fundamental f0 for the peaks of the
+        // last call to find_f0
+        sample error(sample f0);
+};
+
 }
 
 #endif
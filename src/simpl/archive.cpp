@@ -0,0 +1,585 @@
+#include <algorithm>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "archive.h"
+
+using namespace std;
+using namespace simpl;
+
+
+// ---------------------------------------------------------------------------
+// Writing
+// ---------------------------------------------------------------------------
+struct ArchiveFile {
+    FILE* file;
+    std::string filename;
+    uint64_t offset;
+};
+
+typedef int (Frame::*FrameCount)();
+typedef sample* (Frame::*FrameValues)();
+
+static void write_bytes(ArchiveFile& archive, const void* data, size_t size) {
+    if(size > 0 && fwrite(data, 1, size, archive.file) != size) {
+        throw Exception(std::string("Could not write to archive ") +
+                        archive.filename);
+    }
+    archive.offset += size;
+}
+
+// Pads the file to the start of the next column and returns its offset
+static uint64_t begin_column(ArchiveFile& archive) {
+    static const char padding[ARCHIVE_ALIGNMENT] = {0};
+    write_bytes(archive, padding,
+                (ARCHIVE_ALIGNMENT - (archive.offset % ARCHIVE_ALIGNMENT)) %
+                ARCHIVE_ALIGNMENT);
+    return archive.offset;
+}
+
+static uint64_t write_starts(ArchiveFile& archive, Frames& frames,
+                             FrameCount count) {
+    uint64_t offset = begin_column(archive);
+    uint64_t start = 0;
+    write_bytes(archive, &start, sizeof(start));
+
+    for(int i = 0; i < frames.size(); i++) {
+        start += (frames[i]->*count)();
+        write_bytes(archive, &start, sizeof(start));
+    }
+    return offset;
+}
+
+static uint64_t write_values(ArchiveFile& archive, Frames& frames,
+                             FrameCount count, FrameValues values) {
+    uint64_t offset = begin_column(archive);
+
+    for(int i = 0; i < frames.size(); i++) {
+        int num_values = (frames[i]->*count)();
+        if(num_values <= 0) {
+            continue;
+        }
+
+        sample* data = (frames[i]->*values)();
+        if(!data) {
+            throw Exception(std::string("Frame has no data to archive."));
+        }
+        write_bytes(archive, data, sizeof(sample) * num_values);
+    }
+    return offset;
+}
+
+static uint64_t total(Frames& frames, FrameCount count) {
+    uint64_t n = 0;
+    for(int i = 0; i < frames.size(); i++) {
+        n += (frames[i]->*count)();
+    }
+    return n;
+}
+
+static void write_columns(ArchiveFile& archive, ArchiveHeader& header,
+                          Frames& frames) {
+    uint64_t* offsets = header.offsets;
+    int contents = header.contents;
+
+    write_bytes(archive, &header, sizeof(header));
+
+    if(contents & ARCHIVE_PEAKS) {
+        FrameCount n = &Frame::num_peaks;
+        offsets[ARCHIVE_PEAK_STARTS] = write_starts(archive, frames, n);
+        offsets[ARCHIVE_PEAK_AMPLITUDES] =
+            write_values(archive, frames, n, &Frame::peak_amplitudes);
+        offsets[ARCHIVE_PEAK_FREQUENCIES] =
+            write_values(archive, frames, n, &Frame::peak_frequencies);
+        offsets[ARCHIVE_PEAK_PHASES] =
+            write_values(archive, frames, n, &Frame::peak_phases);
+        offsets[ARCHIVE_PEAK_BANDWIDTHS] =
+            write_values(archive, frames, n, &Frame::peak_bandwidths);
+    }
+
+    if(contents & ARCHIVE_PARTIALS) {
+        FrameCount n = &Frame::num_partials;
+        offsets[ARCHIVE_PARTIAL_STARTS] = write_starts(archive, frames, n);
+        offsets[ARCHIVE_PARTIAL_AMPLITUDES] =
+            write_values(archive, frames, n, &Frame::partial_amplitudes);
+        offsets[ARCHIVE_PARTIAL_FREQUENCIES] =
+            write_values(archive, frames, n, &Frame::partial_frequencies);
+        offsets[ARCHIVE_PARTIAL_PHASES] =
+            write_values(archive, frames, n, &Frame::partial_phases);
+        offsets[ARCHIVE_PARTIAL_BANDWIDTHS] =
+            write_values(archive, frames, n, &Frame::partial_bandwidths);
+    }
+
+    if(contents & (ARCHIVE_AUDIO | ARCHIVE_RESIDUAL)) {
+        FrameCount n = &Frame::size;
+        offsets[ARCHIVE_AUDIO_STARTS] = write_starts(archive, frames, n);
+        if(contents & ARCHIVE_AUDIO) {
+            offsets[ARCHIVE_AUDIO_SAMPLES] =
+                write_values(archive, frames, n, &Frame::audio);
+        }
+        if(contents & ARCHIVE_RESIDUAL) {
+            offsets[ARCHIVE_RESIDUAL_SAMPLES] =
+                write_values(archive, frames, n, &Frame::residual);
+        }
+    }
+
+    if(contents & (ARCHIVE_SYNTH | ARCHIVE_SYNTH_RESIDUAL)) {
+        FrameCount n = &Frame::synth_size;
+        offsets[ARCHIVE_SYNTH_STARTS] = write_starts(archive, frames, n);
+        if(contents & ARCHIVE_SYNTH) {
+            offsets[ARCHIVE_SYNTH_SAMPLES] =
+                write_values(archive, frames, n, &Frame::synth);
+        }
+        if(contents & ARCHIVE_SYNTH_RESIDUAL) {
+            offsets[ARCHIVE_SYNTH_RESIDUAL_SAMPLES] =
+                write_values(archive, frames, n, &Frame::synth_residual);
+        }
+    }
+
+    // the header is written again now that the offsets are known
+    if(fseek(archive.file, 0, SEEK_SET) != 0) {
+        throw Exception(std::string("Could not write to archive ") +
+                        archive.filename);
+    }
+    write_bytes(archive, &header, sizeof(header));
+}
+
+void simpl::write_archive(const std::string& filename, Frames& frames,
+                          int sampling_rate, int hop_size, int contents) {
+    ArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.byte_order = ARCHIVE_BYTE_ORDER;
+    header.version = ARCHIVE_VERSION;
+    header.header_size = sizeof(header);
+    header.sample_size = sizeof(sample);
+    header.contents = contents;
+    header.sampling_rate = sampling_rate;
+    header.hop_size = hop_size;
+    header.num_frames = frames.size();
+    header.num_peaks = total(frames, &Frame::num_peaks);
+    header.num_partials = total(frames, &Frame::num_partials);
+    header.audio_size = total(frames, &Frame::size);
+    header.synth_size = total(frames, &Frame::synth_size);
+
+    ArchiveFile archive;
+    archive.filename = filename;
+    archive.offset = 0;
+    archive.file = fopen(filename.c_str(), "wb");
+    if(!archive.file) {
+        throw Exception(std::string("Could not create archive ") + filename);
+    }
+
+    try {
+        write_columns(archive, header, frames);
+    }
+    catch(Exception& e) {
+        fclose(archive.file);
+        remove(filename.c_str());
+        throw;
+    }
+
+    if(fclose(archive.file) != 0) {
+        remove(filename.c_str());
+        throw Exception(std::string("Could not write to archive ") +
+                        filename);
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+// Archive
+// ---------------------------------------------------------------------------
+Archive::Archive() {
+    _data = NULL;
+    _size = 0;
+    memset(&_header, 0, sizeof(_header));
+}
+
+Archive::Archive(const std::string& filename) {
+    _data = NULL;
+    _size = 0;
+    memset(&_header, 0, sizeof(_header));
+    open(filename);
+}
+
+Archive::~Archive() {
+    close();
+}
+
+void Archive::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw Exception(std::string("Could not open archive ") + filename);
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size < sizeof(ArchiveHeader)) {
+        ::close(fd);
+        throw Exception(filename + std::string(" is not a simpl archive."));
+    }
+
+    void* data = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(data == MAP_FAILED) {
+        throw Exception(std::string("Could not map archive ") + filename);
+    }
+
+    _data = (char*)data;
+    _size = info.st_size;
+    memcpy(&_header, _data, sizeof(_header));
+
+    try {
+        if(memcmp(_header.magic, ARCHIVE_MAGIC, sizeof(_header.magic)) != 0) {
+            throw Exception(filename +
+                            std::string(" is not a simpl archive."));
+        }
+        if(_header.byte_order != ARCHIVE_BYTE_ORDER) {
+            throw Exception(std::string("Archive was written with a "
+                                        "different byte order."));
+        }
+        if(_header.version > ARCHIVE_VERSION) {
+            throw Exception(std::string("Archive was written by a newer "
+                                        "version of simpl."));
+        }
+        if(_header.sample_size != sizeof(sample)) {
+            throw Exception(std::string("Archive was written with a "
+                                        "different sample type."));
+        }
+        if(_header.header_size < sizeof(_header) ||
+           _header.num_frames > INT_MAX - 1) {
+            throw Exception(std::string("Archive is corrupt."));
+        }
+
+        uint64_t num_starts = _header.num_frames + 1;
+        int contents = _header.contents;
+
+        if(contents & ARCHIVE_PEAKS) {
+            check_column(ARCHIVE_PEAK_STARTS, num_starts, sizeof(uint64_t));
+            for(int i = ARCHIVE_PEAK_AMPLITUDES;
+                i <= ARCHIVE_PEAK_BANDWIDTHS; i++) {
+                check_column(i, _header.num_peaks, sizeof(sample));
+            }
+            if(peak_starts()[_header.num_frames] != _header.num_peaks) {
+                throw Exception(std::string("Archive is corrupt."));
+            }
+        }
+
+        if(contents & ARCHIVE_PARTIALS) {
+            check_column(ARCHIVE_PARTIAL_STARTS, num_starts,
+                         sizeof(uint64_t));
+            for(int i = ARCHIVE_PARTIAL_AMPLITUDES;
+                i <= ARCHIVE_PARTIAL_BANDWIDTHS; i++) {
+                check_column(i, _header.num_partials, sizeof(sample));
+            }
+            if(partial_starts()[_header.num_frames] != _header.num_partials) {
+                throw Exception(std::string("Archive is corrupt."));
+            }
+        }
+
+        if(contents & (ARCHIVE_AUDIO | ARCHIVE_RESIDUAL)) {
+            check_column(ARCHIVE_AUDIO_STARTS, num_starts, sizeof(uint64_t));
+            if(contents & ARCHIVE_AUDIO) {
+                check_column(ARCHIVE_AUDIO_SAMPLES, _header.audio_size,
+                             sizeof(sample));
+            }
+            if(contents & ARCHIVE_RESIDUAL) {
+                check_column(ARCHIVE_RESIDUAL_SAMPLES, _header.audio_size,
+                             sizeof(sample));
+            }
+            if(audio_starts()[_header.num_frames] != _header.audio_size) {
+                throw Exception(std::string("Archive is corrupt."));
+            }
+        }
+
+        if(contents & (ARCHIVE_SYNTH | ARCHIVE_SYNTH_RESIDUAL)) {
+            check_column(ARCHIVE_SYNTH_STARTS, num_starts, sizeof(uint64_t));
+            if(contents & ARCHIVE_SYNTH) {
+                check_column(ARCHIVE_SYNTH_SAMPLES, _header.synth_size,
+                             sizeof(sample));
+            }
+            if(contents & ARCHIVE_SYNTH_RESIDUAL) {
+                check_column(ARCHIVE_SYNTH_RESIDUAL_SAMPLES,
+                             _header.synth_size, sizeof(sample));
+            }
+            if(synth_starts()[_header.num_frames] != _header.synth_size) {
+                throw Exception(std::string("Archive is corrupt."));
+            }
+        }
+    }
+    catch(Exception& e) {
+        close();
+        throw;
+    }
+}
+
+void Archive::close() {
+    if(_data) {
+        munmap(_data, _size);
+    }
+    _data = NULL;
+    _size = 0;
+    memset(&_header, 0, sizeof(_header));
+}
+
+bool Archive::is_open() {
+    return _data != NULL;
+}
+
+// Checks that a column is aligned and lies within the file
+void Archive::check_column(int column, uint64_t num_values,
+                           size_t value_size) {
+    uint64_t offset = _header.offsets[column];
+
+    if(offset < sizeof(_header) || offset > _size ||
+       offset % ARCHIVE_ALIGNMENT != 0 ||
+       num_values > (_size - offset) / value_size) {
+        throw Exception(std::string("Archive is corrupt."));
+    }
+}
+
+void Archive::check_frame(int frame) {
+    if(frame < 0 || frame >= num_frames()) {
+        throw Exception(std::string("Invalid archive frame number."));
+    }
+}
+
+uint64_t* Archive::starts(int column) {
+    if(!_data || !_header.offsets[column]) {
+        return NULL;
+    }
+    return (uint64_t*)(_data + _header.offsets[column]);
+}
+
+sample* Archive::column(int column) {
+    if(!_data || !_header.offsets[column]) {
+        return NULL;
+    }
+    return (sample*)(_data + _header.offsets[column]);
+}
+
+int Archive::version() {
+    return _header.version;
+}
+
+int Archive::contents() {
+    return _header.contents;
+}
+
+int Archive::sampling_rate() {
+    return _header.sampling_rate;
+}
+
+int Archive::hop_size() {
+    return _header.hop_size;
+}
+
+int Archive::num_frames() {
+    return (int)_header.num_frames;
+}
+
+int64_t Archive::num_peaks() {
+    return _header.num_peaks;
+}
+
+int64_t Archive::num_partials() {
+    return _header.num_partials;
+}
+
+double Archive::frame_time(int frame) {
+    if(_header.sampling_rate <= 0) {
+        return 0.0;
+    }
+    return ((double)frame * _header.hop_size) / _header.sampling_rate;
+}
+
+int Archive::frame_at(double time) {
+    if(_header.hop_size <= 0 || num_frames() == 0) {
+        return 0;
+    }
+
+    double frame = floor((time * _header.sampling_rate) / _header.hop_size);
+    if(frame < 0) {
+        return 0;
+    }
+    if(frame >= num_frames()) {
+        return num_frames() - 1;
+    }
+    return (int)frame;
+}
+
+// The number of rows of frame in a starts column, which is checked here
+// rather than when the archive is opened so that opening does not read
+// the whole index
+static int num_rows(uint64_t* starts, int frame, uint64_t total) {
+    if(!starts) {
+        return 0;
+    }
+
+    uint64_t start = starts[frame];
+    uint64_t end = starts[frame + 1];
+    if(start > end || end > total || end - start > INT_MAX) {
+        throw Exception(std::string("Archive is corrupt."));
+    }
+    return (int)(end - start);
+}
+
+int Archive::num_peaks(int frame) {
+    check_frame(frame);
+    return num_rows(peak_starts(), frame, _header.num_peaks);
+}
+
+int Archive::num_partials(int frame) {
+    check_frame(frame);
+    return num_rows(partial_starts(), frame, _header.num_partials);
+}
+
+int Archive::frame_size(int frame) {
+    check_frame(frame);
+    return num_rows(audio_starts(), frame, _header.audio_size);
+}
+
+int Archive::synth_size(int frame) {
+    check_frame(frame);
+    return num_rows(synth_starts(), frame, _header.synth_size);
+}
+
+uint64_t* Archive::peak_starts() {
+    return starts(ARCHIVE_PEAK_STARTS);
+}
+
+uint64_t* Archive::partial_starts() {
+    return starts(ARCHIVE_PARTIAL_STARTS);
+}
+
+uint64_t* Archive::audio_starts() {
+    return starts(ARCHIVE_AUDIO_STARTS);
+}
+
+uint64_t* Archive::synth_starts() {
+    return starts(ARCHIVE_SYNTH_STARTS);
+}
+
+sample* Archive::peak_amplitudes() {
+    return column(ARCHIVE_PEAK_AMPLITUDES);
+}
+
+sample* Archive::peak_frequencies() {
+    return column(ARCHIVE_PEAK_FREQUENCIES);
+}
+
+sample* Archive::peak_phases() {
+    return column(ARCHIVE_PEAK_PHASES);
+}
+
+sample* Archive::peak_bandwidths() {
+    return column(ARCHIVE_PEAK_BANDWIDTHS);
+}
+
+sample* Archive::partial_amplitudes() {
+    return column(ARCHIVE_PARTIAL_AMPLITUDES);
+}
+
+sample* Archive::partial_frequencies() {
+    return column(ARCHIVE_PARTIAL_FREQUENCIES);
+}
+
+sample* Archive::partial_phases() {
+    return column(ARCHIVE_PARTIAL_PHASES);
+}
+
+sample* Archive::partial_bandwidths() {
+    return column(ARCHIVE_PARTIAL_BANDWIDTHS);
+}
+
+sample* Archive::audio() {
+    return column(ARCHIVE_AUDIO_SAMPLES);
+}
+
+sample* Archive::synth() {
+    return column(ARCHIVE_SYNTH_SAMPLES);
+}
+
+sample* Archive::residual() {
+    return column(ARCHIVE_RESIDUAL_SAMPLES);
+}
+
+sample* Archive::synth_residual() {
+    return column(ARCHIVE_SYNTH_RESIDUAL_SAMPLES);
+}
+
+void Archive::read_frame(int frame_number, Frame* frame) {
+    check_frame(frame_number);
+
+    if(peak_starts()) {
+        int n = num_peaks(frame_number);
+        uint64_t start = peak_starts()[frame_number];
+        if(n > frame->max_peaks()) {
+            frame->max_peaks(n);
+        }
+        std::copy(peak_amplitudes() + start, peak_amplitudes() + start + n,
+                  frame->peak_amplitudes());
+        std::copy(peak_frequencies() + start, peak_frequencies() + start + n,
+                  frame->peak_frequencies());
+        std::copy(peak_phases() + start, peak_phases() + start + n,
+                  frame->peak_phases());
+        std::copy(peak_bandwidths() + start, peak_bandwidths() + start + n,
+                  frame->peak_bandwidths());
+        frame->num_peaks(n);
+    }
+
+    if(partial_starts()) {
+        int n = num_partials(frame_number);
+        uint64_t start = partial_starts()[frame_number];
+        if(n > frame->max_partials()) {
+            frame->max_partials(n);
+        }
+        std::copy(partial_amplitudes() + start,
+                  partial_amplitudes() + start + n,
+                  frame->partial_amplitudes());
+        std::copy(partial_frequencies() + start,
+                  partial_frequencies() + start + n,
+                  frame->partial_frequencies());
+        std::copy(partial_phases() + start, partial_phases() + start + n,
+                  frame->partial_phases());
+        std::copy(partial_bandwidths() + start,
+                  partial_bandwidths() + start + n,
+                  frame->partial_bandwidths());
+        frame->num_partials(n);
+    }
+
+    if(audio_starts()) {
+        int n = frame_size(frame_number);
+        uint64_t start = audio_starts()[frame_number];
+        if(frame->size() != n) {
+            frame->size(n);
+        }
+        if(audio()) {
+            frame->audio(audio() + start);
+        }
+        if(residual()) {
+            frame->residual(residual() + start);
+        }
+    }
+
+    if(synth_starts()) {
+        int n = synth_size(frame_number);
+        uint64_t start = synth_starts()[frame_number];
+        if(frame->synth_size() != n) {
+            frame->synth_size(n);
+        }
+        if(synth()) {
+            frame->synth(synth() + start);
+        }
+        if(synth_residual()) {
+            frame->synth_residual(synth_residual() + start);
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdint.h>
+#include <string>
+
+#include "base.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// Archive file format
+//
+// A simpl archive stores the peaks, partials and (optionally) the audio
+// buffers of a sequence of Frames. All values of a field are stored
+// together in one column, so the peak frequencies of every frame are one
+// contiguous array, followed by the peak amplitudes, and so on. Each
+// column starts on a 64 byte boundary.
+//
+// The frames are indexed by "starts" columns of num_frames + 1 offsets:
+// the peaks of frame n are rows peak_starts[n] to peak_starts[n + 1] of
+// the peak columns, and likewise for partials and audio.
+//
+// The header records the byte order, the format version and the size of
+// a sample. Values are stored in the byte order and precision of the
+// machine and build that wrote them, so that they can be used directly
+// from a memory map.
+// ---------------------------------------------------------------------------
+static const char ARCHIVE_MAGIC[8] = {'S', 'I', 'M', 'P', 'L', 'A', 'R', 'C'};
+static const uint32_t ARCHIVE_VERSION = 1;
+static const uint32_t ARCHIVE_BYTE_ORDER = 0x01020304;
+static const int ARCHIVE_ALIGNMENT = 64;
+
+// What an archive contains, a combination of these flags
+enum ArchiveContents {
+    ARCHIVE_PEAKS = 1,
+    ARCHIVE_PARTIALS = 2,
+    ARCHIVE_AUDIO = 4,
+    ARCHIVE_SYNTH = 8,
+    ARCHIVE_RESIDUAL = 16,
+    ARCHIVE_SYNTH_RESIDUAL = 32
+};
+
+enum ArchiveColumn {
+    ARCHIVE_PEAK_STARTS,
+    ARCHIVE_PARTIAL_STARTS,
+    ARCHIVE_AUDIO_STARTS,
+    ARCHIVE_SYNTH_STARTS,
+    ARCHIVE_PEAK_AMPLITUDES,
+    ARCHIVE_PEAK_FREQUENCIES,
+    ARCHIVE_PEAK_PHASES,
+    ARCHIVE_PEAK_BANDWIDTHS,
+    ARCHIVE_PARTIAL_AMPLITUDES,
+    ARCHIVE_PARTIAL_FREQUENCIES,
+    ARCHIVE_PARTIAL_PHASES,
+    ARCHIVE_PARTIAL_BANDWIDTHS,
+    ARCHIVE_AUDIO_SAMPLES,
+    ARCHIVE_SYNTH_SAMPLES,
+    ARCHIVE_RESIDUAL_SAMPLES,
+    ARCHIVE_SYNTH_RESIDUAL_SAMPLES,
+    ARCHIVE_NUM_COLUMNS
+};
+
+// The first bytes of an archive. Absent columns have an offset of 0.
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t sample_size;
+    uint32_t contents;
+    int32_t sampling_rate;
+    int32_t hop_size;
+    uint32_t reserved;
+    uint64_t num_frames;
+    uint64_t num_peaks;
+    uint64_t num_partials;
+    uint64_t audio_size;
+    uint64_t synth_size;
+    uint64_t offsets[ARCHIVE_NUM_COLUMNS];
+};
+
+// Writes frames to a new archive file, replacing any existing file.
+// contents selects the fields that are stored.
+void write_archive(const std::string& filename, Frames& frames,
+                   int sampling_rate, int hop_size,
+                   int contents=ARCHIVE_PEAKS | ARCHIVE_PARTIALS);
+
+
+// ---------------------------------------------------------------------------
+// Archive
+//
+// Read access to an archive file through a memory map. Opening an archive
+// only reads and checks its header, so it takes the same time whatever the
+// size of the file: the columns are paged in by the operating system as
+// they are used.
+//
+// The column accessors return pointers into the map, which are valid
+// until the archive is closed. The map is private, so values written
+// through them are not saved to the file. Archives written by a build
+// with a different sample type (see SIMPL_FLOAT) or byte order can not be
+// opened.
+// ---------------------------------------------------------------------------
+class Archive {
+    private:
+        char* _data;
+        size_t _size;
+        ArchiveHeader _header;
+
+        void check_column(int column, uint64_t num_values,
+                          size_t value_size);
+        void check_frame(int frame);
+        uint64_t* starts(int column);
+        sample* column(int column);
+
+    public:
+        Archive();
+        Archive(const std::string& filename);
+        ~Archive();
+        void open(const std::string& filename);
+        void close();
+        bool is_open();
+
+        int version();
+        int contents();
+        int sampling_rate();
+        int hop_size();
+        int num_frames();
+        int64_t num_peaks();
+        int64_t num_partials();
+
+        // frame index
+        double frame_time(int frame);
+
+        // Returns the frame that starts at or most recently before time
+        // seconds (0 before the first frame, the last frame after the end)
+        int frame_at(double time);
+        int num_peaks(int frame);
+        int num_partials(int frame);
+        int frame_size(int frame);
+        int synth_size(int frame);
+
+        // num_frames + 1 row offsets of each frame in the columns below,
+        // or NULL if the archive does not contain them
+        uint64_t* peak_starts();
+        uint64_t* partial_starts();
+        uint64_t* audio_starts();
+        uint64_t* synth_starts();
+
+        // Columns of all the frames, or NULL if the archive does not
+        // contain them
+        sample* peak_amplitudes();
+        sample* peak_frequencies();
+        sample* peak_phases();
+        sample* peak_bandwidths();
+        sample* partial_amplitudes();
+        sample* partial_frequencies();
+        sample* partial_phases();
+        sample* partial_bandwidths();
+        sample* audio();
+        sample* synth();
+        sample* residual();
+        sample* synth_residual();
+
+        // Copies the given frame into frame. Frames that do not manage
+        // their own memory are given audio buffers that point into the map.
+        void read_frame(int frame_number, Frame* frame);
+};
+
+} // end of namespace simpl
+
+#endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "base.h"
 
 using namespace std;
@@ -51,23 +53,6 @@ Frame::Frame(int frame_size, bool alloc_memory) {
 }
 
 Frame::~Frame() {
-    clear_peaks();
-    clear_partials();
-
-    for(int i = 0; i < _peaks.size(); i++) {
-        if(_peaks[i]) {
-            delete _peaks[i];
-            _peaks[i] = NULL;
-        }
-    }
-
-    for(int i = 0; i < _partials.size(); i++) {
-        if(_partials[i]) {
-            delete _partials[i];
-            _partials[i] = NULL;
-        }
-    }
-
     if(_alloc_memory) {
         destroy_arrays();
     }
@@ -78,7 +63,11 @@ void Frame::init() {
     _max_peaks = 100;
     _num_partials = 0;
     _max_partials = 100;
+    _capacity = 0;
+    _synth_capacity = 0;
     _audio = NULL;
+    _audio_view = NULL;
+    _audio_view_size = 0;
     _synth = NULL;
     _residual = NULL;
     _synth_residual = NULL;
@@ -87,6 +76,7 @@ void Frame::init() {
 }
 
 void Frame::create_arrays() {
+    _capacity = _size;
     _audio = new sample[_size];
     _residual = new sample[_size];
     memset(_audio, 0.0, sizeof(sample) * _size);
@@ -95,6 +85,7 @@ void Frame::create_arrays() {
 }
 
 void Frame::destroy_arrays() {
+    _capacity = 0;
     if(_audio) {
         delete [] _audio;
         _audio = NULL;
@@ -108,6 +99,7 @@ void Frame::destroy_arrays() {
 }
 
 void Frame::create_synth_arrays() {
+    _synth_capacity = _synth_size;
     _synth = new sample[_synth_size];
     _synth_residual = new sample[_synth_size];
     memset(_synth, 0.0, sizeof(sample) * _synth_size);
@@ -115,6 +107,7 @@ void Frame::create_synth_arrays() {
 }
 
 void Frame::destroy_synth_arrays() {
+    _synth_capacity = 0;
     if(_synth) {
         delete [] _synth;
         _synth = NULL;
@@ -125,43 +118,43 @@ void Frame::destroy_synth_arrays() {
     }
 }
 
+// The first element of values, or NULL if there are none
+static sample* array_data(std::vector<sample>& values) {
+    return values.empty() ? NULL : &values[0];
+}
+
 void Frame::resize_peaks(int new_num_peaks) {
+    _peak_amplitudes.resize(new_num_peaks);
+    _peak_frequencies.resize(new_num_peaks);
+    _peak_phases.resize(new_num_peaks);
+    _peak_bandwidths.resize(new_num_peaks);
     clear_peaks();
-
-    for(int i = 0; i < _peaks.size(); i++) {
-        if(_peaks[i]) {
-            delete _peaks[i];
-            _peaks[i] = NULL;
-        }
-    }
-
-    _peaks.resize(new_num_peaks);
-
-    for(int i = 0; i < _peaks.size(); i++) {
-        _peaks[i] = new Peak();
-    }
 }
 
 void Frame::resize_partials(int new_num_partials) {
+    _partial_amplitudes.resize(new_num_partials);
+    _partial_frequencies.resize(new_num_partials);
+    _partial_phases.resize(new_num_partials);
+    _partial_bandwidths.resize(new_num_partials);
     clear_partials();
+}
 
-    for(int i = 0; i < _partials.size(); i++) {
-        if(_partials[i]) {
-            delete _partials[i];
-            _partials[i] = NULL;
-        }
-    }
-
-    _partials.resize(new_num_partials);
-
-    for(int i = 0; i < _partials.size(); i++) {
-        _partials[i] = new Peak();
-    }
+// Return the frame to the state of a newly constructed Frame of the
+// given size. Memory managed by the frame is only reallocated if it is
+// too small.
+void Frame::reset(int frame_size) {
+    _max_peaks = 100;
+    _max_partials = 100;
+    resize_peaks(_max_peaks);
+    resize_partials(_max_partials);
+    synth_size(512);
+    size(frame_size);
 }
 
 void Frame::clear() {
     clear_peaks();
     clear_partials();
+    _audio_view = NULL;
 
     if(_alloc_memory) {
         memset(_audio, 0.0, sizeof(sample) * _size);
@@ -171,20 +164,18 @@ void Frame::clear() {
 
 void Frame::clear_peaks() {
     _num_peaks = 0;
-    for(int i = 0; i < _peaks.size(); i++) {
-        if(_peaks[i]) {
-            _peaks[i]->reset();
-        }
-    }
+    std::fill(_peak_amplitudes.begin(), _peak_amplitudes.end(), 0.0);
+    std::fill(_peak_frequencies.begin(), _peak_frequencies.end(), 0.0);
+    std::fill(_peak_phases.begin(), _peak_phases.end(), 0.0);
+    std::fill(_peak_bandwidths.begin(), _peak_bandwidths.end(), 0.0);
 }
 
 void Frame::clear_partials() {
     _num_partials = 0;
-    for(int i = 0; i < _partials.size(); i++) {
-        if(_partials[i]) {
-            _partials[i]->reset();
-        }
-    }
+    std::fill(_partial_amplitudes.begin(), _partial_amplitudes.end(), 0.0);
+    std::fill(_partial_frequencies.begin(), _partial_frequencies.end(), 0.0);
+    std::fill(_partial_phases.begin(), _partial_phases.end(), 0.0);
+    std::fill(_partial_bandwidths.begin(), _partial_bandwidths.end(), 0.0);
 }
 
 void Frame::clear_synth() {
@@ -232,23 +223,42 @@ void Frame::add_peak(sample amplitude, sample frequency,
         return;
     }
 
-    _peaks[_num_peaks]->amplitude = amplitude;
-    _peaks[_num_peaks]->frequency = frequency;
-    _peaks[_num_peaks]->phase = phase;
-    _peaks[_num_peaks]->bandwidth = bandwidth;
+    _peak_amplitudes[_num_peaks] = amplitude;
+    _peak_frequencies[_num_peaks] = frequency;
+    _peak_phases[_num_peaks] = phase;
+    _peak_bandwidths[_num_peaks] = bandwidth;
     _num_peaks++;
 }
 
-Peak* Frame::peak(int peak_number) {
-    return _peaks[peak_number];
+Peak Frame::peak(int peak_number) {
+    return Peak(_peak_amplitudes[peak_number],
+                _peak_frequencies[peak_number],
+                _peak_phases[peak_number],
+                _peak_bandwidths[peak_number]);
 }
 
 void Frame::peak(int peak_number, sample amplitude, sample frequency,
                     sample phase, sample bandwidth) {
-    _peaks[peak_number]->amplitude = amplitude;
-    _peaks[peak_number]->frequency = frequency;
-    _peaks[peak_number]->phase = phase;
-    _peaks[peak_number]->bandwidth = bandwidth;
+    _peak_amplitudes[peak_number] = amplitude;
+    _peak_frequencies[peak_number] = frequency;
+    _peak_phases[peak_number] = phase;
+    _peak_bandwidths[peak_number] = bandwidth;
+}
+
+sample* Frame::peak_amplitudes() {
+    return array_data(_peak_amplitudes);
+}
+
+sample* Frame::peak_frequencies() {
+    return array_data(_peak_frequencies);
+}
+
+sample* Frame::peak_phases() {
+    return array_data(_peak_phases);
+}
+
+sample* Frame::peak_bandwidths() {
+    return array_data(_peak_bandwidths);
 }
 
 // Frame - partials
@@ -287,23 +297,42 @@ void Frame::add_partial(sample amplitude, sample frequency,
         return;
     }
 
-    _partials[_num_partials]->amplitude = amplitude;
-    _partials[_num_partials]->frequency = frequency;
-    _partials[_num_partials]->phase = phase;
-    _partials[_num_partials]->bandwidth = bandwidth;
+    _partial_amplitudes[_num_partials] = amplitude;
+    _partial_frequencies[_num_partials] = frequency;
+    _partial_phases[_num_partials] = phase;
+    _partial_bandwidths[_num_partials] = bandwidth;
     _num_partials++;
 }
 
-Peak* Frame::partial(int partial_number) {
-    return _partials[partial_number];
+Peak Frame::partial(int partial_number) {
+    return Peak(_partial_amplitudes[partial_number],
+                _partial_frequencies[partial_number],
+                _partial_phases[partial_number],
+                _partial_bandwidths[partial_number]);
 }
 
 void Frame::partial(int partial_number, sample amplitude, sample frequency,
                     sample phase, sample bandwidth) {
-    _partials[partial_number]->amplitude = amplitude;
-    _partials[partial_number]->frequency = frequency;
-    _partials[partial_number]->phase = phase;
-    _partials[partial_number]->bandwidth = bandwidth;
+    _partial_amplitudes[partial_number] = amplitude;
+    _partial_frequencies[partial_number] = frequency;
+    _partial_phases[partial_number] = phase;
+    _partial_bandwidths[partial_number] = bandwidth;
+}
+
+sample* Frame::partial_amplitudes() {
+    return array_data(_partial_amplitudes);
+}
+
+sample* Frame::partial_frequencies() {
+    return array_data(_partial_frequencies);
+}
+
+sample* Frame::partial_phases() {
+    return array_data(_partial_phases);
+}
+
+sample* Frame::partial_bandwidths() {
+    return array_data(_partial_bandwidths);
 }
 
 
@@ -316,10 +345,19 @@ int Frame::size() {
 
 void Frame::size(int new_size) {
     _size = new_size;
+    _audio_view = NULL;
 
     if(_alloc_memory) {
-        destroy_arrays();
-        create_arrays();
+        if(_size > _capacity) {
+            destroy_arrays();
+            create_arrays();
+        }
+        else {
+            memset(_audio, 0.0, sizeof(sample) * _size);
+            memset(_residual, 0.0, sizeof(sample) * _size);
+            memset(_synth, 0.0, sizeof(sample) * _synth_size);
+            memset(_synth_residual, 0.0, sizeof(sample) * _synth_size);
+        }
     }
 }
 
@@ -331,12 +369,20 @@ void Frame::synth_size(int new_size) {
     _synth_size = new_size;
 
     if(_alloc_memory) {
-        destroy_synth_arrays();
-        create_synth_arrays();
+        if(_synth_size > _synth_capacity) {
+            destroy_synth_arrays();
+            create_synth_arrays();
+        }
+        else {
+            memset(_synth, 0.0, sizeof(sample) * _synth_size);
+            memset(_synth_residual, 0.0, sizeof(sample) * _synth_size);
+        }
     }
 }
 
 void Frame::audio(sample* new_audio) {
+    _audio_view = NULL;
+
     if(_alloc_memory) {
         std::copy(new_audio, new_audio + _size, _audio);
     }
@@ -352,6 +398,11 @@ void Frame::audio(sample* new_audio, int size) {
         throw Exception(std::string("Memory not managed by Frame."));
     }
 
+    if(_audio_view) {
+        // the view contents are needed if the existing audio is rotated
+        copy_audio_view();
+    }
+
     if((size < _size) && (_size % size == 0)) {
         std::rotate(_audio, _audio + size, _audio + _size);
         std::copy(new_audio, new_audio + size, _audio + (_size - size));
@@ -371,7 +422,39 @@ void Frame::audio(sample* new_audio, int size) {
     }
 }
 
+void Frame::audio_view(sample* new_audio, int size) {
+    if(size > _size) {
+        throw Exception(std::string("Specified view size is too large, "
+                                    "it must be less than the Frame size."));
+    }
+
+    // a partial view is zero padded into the frame audio buffer
+    if(size < _size && !_alloc_memory) {
+        throw Exception(std::string("Memory not managed by Frame."));
+    }
+
+    // an earlier view is part of the history a partial view is added to
+    if(_audio_view && size < _size) {
+        copy_audio_view();
+    }
+
+    _audio_view = new_audio;
+    _audio_view_size = size;
+}
+
+void Frame::copy_audio_view() {
+    sample* view = _audio_view;
+    _audio_view = NULL;
+    audio(view, _audio_view_size);
+}
+
 sample* Frame::audio() {
+    if(_audio_view) {
+        if(_audio_view_size == _size) {
+            return _audio_view;
+        }
+        copy_audio_view();
+    }
     return _audio;
 }
 
@@ -461,3 +544,113 @@ void Frame::synth_residual(sample* new_synth_residual, int size) {
 sample* Frame::synth_residual() {
     return _synth_residual;
 }
+
+
+// ---------------------------------------------------------------------------
+// FramePool
+// ---------------------------------------------------------------------------
+FramePool::FramePool() {
+}
+
+FramePool::~FramePool() {
+    clear();
+}
+
+void FramePool::clear() {
+    for(int i = 0; i < _free_frames.size(); i++) {
+        delete _free_frames[i];
+    }
+    _free_frames.clear();
+}
+
+int FramePool::num_free_frames() {
+    return _free_frames.size();
+}
+
+void FramePool::reserve(int num_frames, int frame_size) {
+    while(_free_frames.size() < num_frames) {
+        _free_frames.push_back(new Frame(frame_size, true));
+    }
+}
+
+Frame* FramePool::acquire(int frame_size) {
+    if(_free_frames.empty()) {
+        return new Frame(frame_size, true);
+    }
+
+    Frame* f = _free_frames.back();
+    _free_frames.pop_back();
+    f->reset(frame_size);
+    return f;
+}
+
+void FramePool::release(Frame* frame) {
+    if(frame) {
+        _free_frames.push_back(frame);
+    }
+}
+
+void FramePool::release(Frames& frames) {
+    for(int i = 0; i < frames.size(); i++) {
+        release(frames[i]);
+        frames[i] = NULL;
+    }
+    frames.clear();
+}
+
+
+// ---------------------------------------------------------------------------
+// Peak and partial arrays
+// ---------------------------------------------------------------------------
+static void copy_rows(int num_rows, int width, sample* values, int size,
+                      sample* rows) {
+    if(!rows) {
+        return;
+    }
+
+    int n = std::min(size, width);
+    std::copy(values, values + n, rows + num_rows * width);
+    std::fill(rows + num_rows * width + n, rows + (num_rows + 1) * width, 0.0);
+}
+
+int simpl::max_peaks(Frames& frames) {
+    int width = 0;
+    for(int i = 0; i < frames.size(); i++) {
+        width = std::max(width, frames[i]->max_peaks());
+    }
+    return width;
+}
+
+int simpl::max_partials(Frames& frames) {
+    int width = 0;
+    for(int i = 0; i < frames.size(); i++) {
+        width = std::max(width, frames[i]->max_partials());
+    }
+    return width;
+}
+
+void simpl::copy_peaks(Frames& frames, int width,
+                       sample* amplitudes, sample* frequencies,
+                       sample* phases, sample* bandwidths) {
+    for(int i = 0; i < frames.size(); i++) {
+        Frame* f = frames[i];
+        int n = f->num_peaks();
+        copy_rows(i, width, f->peak_amplitudes(), n, amplitudes);
+        copy_rows(i, width, f->peak_frequencies(), n, frequencies);
+        copy_rows(i, width, f->peak_phases(), n, phases);
+        copy_rows(i, width, f->peak_bandwidths(), n, bandwidths);
+    }
+}
+
+void simpl::copy_partials(Frames& frames, int width,
+                          sample* amplitudes, sample* frequencies,
+                          sample* phases, sample* bandwidths) {
+    for(int i = 0; i < frames.size(); i++) {
+        Frame* f = frames[i];
+        int n = f->num_partials();
+        copy_rows(i, width, f->partial_amplitudes(), n, amplitudes);
+        copy_rows(i, width, f->partial_frequencies(), n, frequencies);
+        copy_rows(i, width, f->partial_phases(), n, phases);
+        copy_rows(i, width, f->partial_bandwidths(), n, bandwidths);
+    }
+}
@@ -12,7 +12,58 @@
 namespace simpl
 {
 
+// Samples are double precision unless simpl is built with SIMPL_FLOAT
+// defined (cmake -D SIMPL_FLOAT=yes), which halves the size of frame audio,
+// peak, partial and synthesis buffers and doubles the number of values in
+// each SIMD vector. Programs using a float build must also define it.
+#ifdef SIMPL_FLOAT
+typedef float sample;
+#else
 typedef double sample;
+#endif
+
+
+// ---------------------------------------------------------------------------
+// Double precision buffers
+//
+// FFTW, libsms, SndObj and Loris work with double precision arrays. These
+// convert samples at the boundaries with them when sample is float, using
+// a buffer owned by the caller (which only allocates when it grows). When
+// sample is double they return the samples themselves without copying.
+// ---------------------------------------------------------------------------
+
+// Samples to be read by a double precision function
+inline double* double_input(int size, double* input,
+                            std::vector<double>& buffer) {
+    return input;
+}
+
+inline double* double_input(int size, float* input,
+                            std::vector<double>& buffer) {
+    buffer.assign(input, input + size);
+    return size > 0 ? &buffer[0] : NULL;
+}
+
+// Samples to be written or added to by a double precision function.
+// Call copy_double_output afterwards to write the results back.
+inline double* double_output(int size, double* output,
+                             std::vector<double>& buffer) {
+    return output;
+}
+
+inline double* double_output(int size, float* output,
+                             std::vector<double>& buffer) {
+    return double_input(size, output, buffer);
+}
+
+inline void copy_double_output(int size, double* buffer, double* output) {
+}
+
+inline void copy_double_output(int size, double* buffer, float* output) {
+    for(int i = 0; i < size; i++) {
+        output[i] = buffer[i];
+    }
+}
 
 
 // ---------------------------------------------------------------------------
@@ -47,18 +98,31 @@ typedef std::vector<Peak*> Peaks;
 //              - synthesised audio samples
 //              - residual samples
 //              - synthesised residual samples
+//
+// Peaks and partials are stored as a structure of arrays: one contiguous
+// array of max_peaks (or max_partials) values per field.
 // ---------------------------------------------------------------------------
 class Frame {
     private:
         int _size;
         int _synth_size;
+        int _capacity;
+        int _synth_capacity;
         int _max_peaks;
         int _num_peaks;
         int _max_partials;
         int _num_partials;
-        Peaks _peaks;
-        Peaks _partials;
+        std::vector<sample> _peak_amplitudes;
+        std::vector<sample> _peak_frequencies;
+        std::vector<sample> _peak_phases;
+        std::vector<sample> _peak_bandwidths;
+        std::vector<sample> _partial_amplitudes;
+        std::vector<sample> _partial_frequencies;
+        std::vector<sample> _partial_phases;
+        std::vector<sample> _partial_bandwidths;
         sample* _audio;
+        sample* _audio_view;
+        int _audio_view_size;
         sample* _synth;
         sample* _residual;
         sample* _synth_residual;
@@ -68,6 +132,7 @@ class Frame {
         void destroy_arrays();
         void create_synth_arrays();
         void destroy_synth_arrays();
+        void copy_audio_view();
         void resize_peaks(int new_num_peaks);
         void resize_partials(int new_num_partials);
 
@@ -75,6 +140,7 @@ class Frame {
         Frame();
         Frame(int frame_size, bool alloc_memory=false);
         ~Frame();
+        void reset(int frame_size);
         void clear();
         void clear_peaks();
         void clear_partials();
@@ -87,10 +153,20 @@ class Frame {
         void max_peaks(int new_max_peaks);
         void add_peak(sample amplitude, sample frequency,
                       sample phase, sample bandwidth);
-        Peak* peak(int peak_number);
+
+        // Returns a copy of the given peak. Use peak(peak_number, ...) to
+        // change it.
+        Peak peak(int peak_number);
         void peak(int peak_number, sample amplitude, sample frequency,
                   sample phase, sample bandwidth);
 
+        // Contiguous arrays of max_peaks values, the first num_peaks of
+        // which hold the peaks in this frame. NULL if max_peaks is 0.
+        sample* peak_amplitudes();
+        sample* peak_frequencies();
+        sample* peak_phases();
+        sample* peak_bandwidths();
+
         // partials
         int num_partials();
         void num_partials(int new_num_partials);
@@ -98,10 +174,20 @@ class Frame {
         void max_partials(int new_max_partials);
         void add_partial(sample amplitude, sample frequency,
                          sample phase, sample bandwidth);
-        Peak* partial(int partial_number);
+
+        // Returns a copy of the given partial, see peak()
+        Peak partial(int partial_number);
         void partial(int partial_number, sample amplitude, sample frequency,
                      sample phase, sample bandwidth);
 
+        // Contiguous arrays of max_partials values, the first num_partials
+        // of which hold the partials in this frame. NULL if max_partials
+        // is 0.
+        sample* partial_amplitudes();
+        sample* partial_frequencies();
+        sample* partial_phases();
+        sample* partial_bandwidths();
+
         // audio buffers
         int size();
         void size(int new_size);
@@ -109,6 +195,13 @@ class Frame {
         void synth_size(int new_size);
         void audio(sample* new_audio);
         void audio(sample* new_audio, int size);
+
+        // Use size samples of new_audio as the frame audio without copying
+        // them. new_audio must stay valid while the frame is used. If size
+        // is less than the frame size, the samples are only added to the
+        // existing audio (as by audio(new_audio, size)) when audio() is
+        // called.
+        void audio_view(sample* new_audio, int size);
         sample* audio();
         void synth(sample* new_synth);
         void synth(sample* new_synth, int size);
@@ -123,6 +216,57 @@ class Frame {
 
 typedef std::vector<Frame*> Frames;
 
+
+// ---------------------------------------------------------------------------
+// FramePool
+//
+// Recycles Frames that manage their own memory, so that analysing a
+// signal does not allocate a new Frame and audio buffers for every hop.
+// Acquired Frames belong to the caller until they are released back to
+// the pool. Free Frames are deleted when the pool is cleared or destroyed.
+// A FramePool is not thread safe.
+// ---------------------------------------------------------------------------
+class FramePool {
+    private:
+        Frames _free_frames;
+
+    public:
+        FramePool();
+        ~FramePool();
+        void clear();
+        int num_free_frames();
+
+        // Make sure that at least num_frames are free
+        void reserve(int num_frames, int frame_size);
+
+        // Return a cleared Frame of the given size, the same as
+        // new Frame(frame_size, true)
+        Frame* acquire(int frame_size);
+        void release(Frame* frame);
+        void release(Frames& frames);
+};
+
+
+// ---------------------------------------------------------------------------
+// Peak and partial arrays
+//
+// Copy the peaks (or partials) of a sequence of frames into one array per
+// field of frames.size() rows of width values, row n holding the values of
+// frames[n]. Rows are zero padded after the last peak, and peaks after the
+// first width are not copied. Arrays that are NULL are skipped.
+// ---------------------------------------------------------------------------
+
+// The largest max_peaks (or max_partials) of the frames
+int max_peaks(Frames& frames);
+int max_partials(Frames& frames);
+
+void copy_peaks(Frames& frames, int width,
+                sample* amplitudes, sample* frequencies,
+                sample* phases, sample* bandwidths);
+void copy_partials(Frames& frames, int width,
+                   sample* amplitudes, sample* frequencies,
+                   sample* phases, sample* bandwidths);
+
 } // end of namespace simpl
 
 #endif
@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <deque>
+#include <pthread.h>
+
+#include "batch.h"
+
+using namespace std;
+using namespace simpl;
+
+
+// ---------------------------------------------------------------------------
+// Scheduling
+// ---------------------------------------------------------------------------
+
+// The signals still to be processed. Each worker has its own queue, taking
+// signals from the front of it and stealing from the back of the others.
+// No signals are added once the workers have started, so a worker can stop
+// as soon as it finds every queue empty.
+struct BatchSchedule {
+    std::vector<std::deque<int> > queues;
+    std::vector<pthread_mutex_t> locks;
+    pthread_mutex_t clone_lock;
+    int* sizes;
+    sample** signals;
+    std::vector<Frames>* frames;
+};
+
+struct BatchWorker {
+    BatchSchedule* schedule;
+    int id;
+
+    PeakDetection* peak_detection_prototype;
+    PartialTracking* partial_tracking_prototype;
+    PeakDetection* peak_detection;
+    PartialTracking* partial_tracking;
+    Synthesis* synthesis;
+    bool started;
+
+    // statistics of the objects that have been replaced
+    Profile peak_detection_profile;
+    Profile partial_tracking_profile;
+    std::string error;
+};
+
+static bool next_signal(BatchSchedule* schedule, int worker, int* signal) {
+    int num_queues = schedule->queues.size();
+
+    for(int i = 0; i < num_queues; i++) {
+        int queue = (worker + i) % num_queues;
+        bool found = false;
+
+        pthread_mutex_lock(&schedule->locks[queue]);
+        if(!schedule->queues[queue].empty()) {
+            if(i == 0) {
+                *signal = schedule->queues[queue].front();
+                schedule->queues[queue].pop_front();
+            }
+            else {
+                *signal = schedule->queues[queue].back();
+                schedule->queues[queue].pop_back();
+            }
+            found = true;
+        }
+        pthread_mutex_unlock(&schedule->locks[queue]);
+
+        if(found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Detectors that keep state from previous frames are replaced by a new
+// clone for every signal after the first. Partial trackers are always
+// replaced, as reset() does not clear the tracks of every backend.
+static void prepare_worker(BatchWorker* worker) {
+    BatchSchedule* schedule = worker->schedule;
+    bool replace_peak_detection = worker->started &&
+                                  !worker->peak_detection->independent_frames();
+    bool replace_partial_tracking = worker->started &&
+                                    worker->partial_tracking;
+    worker->started = true;
+
+    if(replace_peak_detection) {
+        worker->peak_detection_profile.add(worker->peak_detection->profile());
+        delete worker->peak_detection;
+        worker->peak_detection = NULL;
+    }
+    if(replace_partial_tracking) {
+        worker->partial_tracking_profile.add(
+            worker->partial_tracking->profile()
+        );
+        delete worker->partial_tracking;
+        worker->partial_tracking = NULL;
+    }
+    if(!replace_peak_detection && !replace_partial_tracking) {
+        return;
+    }
+
+    pthread_mutex_lock(&schedule->clone_lock);
+    if(replace_peak_detection) {
+        worker->peak_detection = worker->peak_detection_prototype->clone();
+    }
+    if(replace_partial_tracking) {
+        worker->partial_tracking = worker->partial_tracking_prototype->clone();
+    }
+    pthread_mutex_unlock(&schedule->clone_lock);
+}
+
+static void process_signal(BatchWorker* worker, int signal) {
+    BatchSchedule* schedule = worker->schedule;
+
+    prepare_worker(worker);
+
+    Frames frames = worker->peak_detection->find_peaks(
+        schedule->sizes[signal], schedule->signals[signal]
+    );
+
+    // the batch takes ownership of the frames from the detector
+    worker->peak_detection->frames(Frames());
+    (*schedule->frames)[signal] = frames;
+
+    if(worker->partial_tracking) {
+        worker->partial_tracking->find_partials(frames);
+        worker->partial_tracking->clear();
+    }
+
+    if(worker->synthesis) {
+        worker->synthesis->reset();
+        worker->synthesis->synth(frames);
+    }
+}
+
+static void* batch_worker(void* arg) {
+    BatchWorker* worker = (BatchWorker*)arg;
+    int signal = 0;
+
+    try {
+        while(next_signal(worker->schedule, worker->id, &signal)) {
+            process_signal(worker, signal);
+        }
+    }
+    catch(std::exception& e) {
+        worker->error = e.what();
+    }
+
+    return NULL;
+}
+
+// Sorts signal numbers by decreasing size
+struct LargerSignal {
+    int* sizes;
+
+    bool operator()(int a, int b) const {
+        return sizes[a] > sizes[b];
+    }
+};
+
+
+// ---------------------------------------------------------------------------
+// Batch
+// ---------------------------------------------------------------------------
+Batch::Batch(PeakDetection* peak_detection,
+             PartialTracking* partial_tracking,
+             Synthesis* synthesis) {
+    if(!peak_detection) {
+        throw Exception(std::string("Batch requires peak detection."));
+    }
+    if(synthesis && !partial_tracking) {
+        throw Exception(std::string("Batch synthesis requires partial "
+                                    "tracking."));
+    }
+
+    _peak_detection = peak_detection;
+    _partial_tracking = partial_tracking;
+    _synthesis = synthesis;
+    _num_threads = 1;
+}
+
+Batch::~Batch() {
+    clear();
+}
+
+void Batch::clear() {
+    for(int i = 0; i < _frames.size(); i++) {
+        for(int j = 0; j < _frames[i].size(); j++) {
+            delete _frames[i][j];
+        }
+    }
+    _frames.clear();
+}
+
+int Batch::num_threads() {
+    return _num_threads;
+}
+
+void Batch::num_threads(int new_num_threads) {
+    if(new_num_threads < 1) {
+        throw Exception(std::string("Batch needs at least 1 thread."));
+    }
+    _num_threads = new_num_threads;
+}
+
+int Batch::num_signals() {
+    return _frames.size();
+}
+
+Frames Batch::frames(int signal) {
+    return _frames[signal];
+}
+
+std::vector<Frames> Batch::process(int num_signals, int* sizes,
+                                   sample** signals) {
+    clear();
+    _frames.resize(num_signals);
+
+    int num_workers = std::min(_num_threads, num_signals);
+    if(num_workers < 1) {
+        return _frames;
+    }
+
+    BatchSchedule schedule;
+    schedule.sizes = sizes;
+    schedule.signals = signals;
+    schedule.frames = &_frames;
+    schedule.queues.resize(num_workers);
+    schedule.locks.resize(num_workers);
+    for(int i = 0; i < num_workers; i++) {
+        pthread_mutex_init(&schedule.locks[i], NULL);
+    }
+    pthread_mutex_init(&schedule.clone_lock, NULL);
+
+    // deal the signals out largest first, so that the smallest ones are
+    // at the back of each queue where they are stolen from
+    std::vector<int> order(num_signals);
+    for(int i = 0; i < num_signals; i++) {
+        order[i] = i;
+    }
+    LargerSignal larger;
+    larger.sizes = sizes;
+    std::stable_sort(order.begin(), order.end(), larger);
+    for(int i = 0; i < num_signals; i++) {
+        schedule.queues[i % num_workers].push_back(order[i]);
+    }
+
+    std::vector<BatchWorker> workers(num_workers);
+    for(int i = 0; i < num_workers; i++) {
+        workers[i].schedule = &schedule;
+        workers[i].id = i;
+        workers[i].peak_detection_prototype = _peak_detection;
+        workers[i].partial_tracking_prototype = _partial_tracking;
+        workers[i].peak_detection = _peak_detection->clone();
+        workers[i].started = false;
+        workers[i].partial_tracking = NULL;
+        workers[i].synthesis = NULL;
+        if(_partial_tracking) {
+            workers[i].partial_tracking = _partial_tracking->clone();
+        }
+        if(_synthesis) {
+            workers[i].synthesis = _synthesis->clone();
+        }
+    }
+
+    // the calling thread is the first worker. If a thread cannot be
+    // created, its queue is left to be stolen by the other workers.
+    std::vector<pthread_t> threads(num_workers);
+    std::vector<bool> running(num_workers, false);
+    for(int i = 1; i < num_workers; i++) {
+        running[i] = pthread_create(&threads[i], NULL, batch_worker,
+                                    &workers[i]) == 0;
+    }
+    batch_worker(&workers[0]);
+
+    std::string error;
+    for(int i = 0; i < num_workers; i++) {
+        if(running[i]) {
+            pthread_join(threads[i], NULL);
+        }
+
+        _peak_detection->profile()->add(&workers[i].peak_detection_profile);
+        _peak_detection->profile()->add(workers[i].peak_detection->profile());
+        delete workers[i].peak_detection;
+
+        if(workers[i].partial_tracking) {
+            _partial_tracking->profile()->add(
+                &workers[i].partial_tracking_profile
+            );
+            _partial_tracking->profile()->add(
+                workers[i].partial_tracking->profile()
+            );
+            delete workers[i].partial_tracking;
+        }
+
+        if(workers[i].synthesis) {
+            _synthesis->profile()->add(workers[i].synthesis->profile());
+            delete workers[i].synthesis;
+        }
+
+        if(error.empty()) {
+            error = workers[i].error;
+        }
+    }
+
+    for(int i = 0; i < num_workers; i++) {
+        pthread_mutex_destroy(&schedule.locks[i]);
+    }
+    pthread_mutex_destroy(&schedule.clone_lock);
+
+    if(!error.empty()) {
+        clear();
+        throw Exception(error);
+    }
+
+    return _frames;
+}
+
+std::vector<Frames> Batch::process_interleaved(int num_channels,
+                                               int num_samples,
+                                               sample* audio) {
+    clear();
+
+    _channels.resize(num_channels);
+    std::vector<int> sizes(num_channels, num_samples);
+    std::vector<sample*> signals(num_channels);
+
+    for(int channel = 0; channel < num_channels; channel++) {
+        _channels[channel].resize(num_samples);
+        for(int i = 0; i < num_samples; i++) {
+            _channels[channel][i] = audio[(i * num_channels) + channel];
+        }
+        signals[channel] = num_samples > 0 ? &_channels[channel][0] : NULL;
+    }
+
+    return process(num_channels,
+                   num_channels > 0 ? &sizes[0] : NULL,
+                   num_channels > 0 ? &signals[0] : NULL);
+}
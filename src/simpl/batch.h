@@ -0,0 +1,80 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <vector>
+
+#include "base.h"
+#include "peak_detection.h"
+#include "partial_tracking.h"
+#include "synthesis.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// Batch
+//
+// Analysis (and optionally synthesis) of many independent signals, such as
+// the channels of a multichannel file or the files of a corpus, spread over
+// a pool of worker threads.
+//
+// The peak detection, partial tracking and synthesis objects given to the
+// batch (which are not owned by it) are only used as prototypes: each
+// worker makes its own clones of them. Peak detection and synthesis clones
+// are reused for every signal that the worker processes (synthesis is
+// reset between signals), except for detectors that do not have
+// independent frames. Those, and the partial trackers, are cloned again
+// for each signal. The statistics of the clones are added to the prototype
+// profiles afterwards.
+//
+// Each worker starts with a share of the signals, largest first. When it
+// runs out it takes the smallest remaining signal from the end of another
+// worker's share, so that a few long signals do not leave the other
+// workers idle.
+//
+// The result for each signal is the same as calling find_peaks,
+// find_partials and synth on it with freshly constructed objects. The
+// returned frames are owned by the batch and are valid until the next call
+// to process or until the batch is destroyed. As with find_peaks, the frame
+// audio is a view into the input signals.
+// ---------------------------------------------------------------------------
+class Batch {
+    protected:
+        PeakDetection* _peak_detection;
+        PartialTracking* _partial_tracking;
+        Synthesis* _synthesis;
+        int _num_threads;
+
+        std::vector<Frames> _frames;
+
+        // deinterleaved channels for process_interleaved
+        std::vector<std::vector<sample> > _channels;
+
+    public:
+        Batch(PeakDetection* peak_detection,
+              PartialTracking* partial_tracking=NULL,
+              Synthesis* synthesis=NULL);
+        ~Batch();
+        void clear();
+
+        int num_threads();
+        void num_threads(int new_num_threads);
+
+        int num_signals();
+        Frames frames(int signal);
+
+        // Analyse num_signals signals, signals[i] containing sizes[i]
+        // samples. Returns the frames of each signal, in the same order.
+        std::vector<Frames> process(int num_signals, int* sizes,
+                                    sample** signals);
+
+        // Analyse each channel of num_samples frames of interleaved audio
+        std::vector<Frames> process_interleaved(int num_channels,
+                                                int num_samples,
+                                                sample* audio);
+};
+
+} // end of namespace simpl
+
+#endif
@@ -0,0 +1,147 @@
+#include <map>
+#include <utility>
+#include <pthread.h>
+
+#include "fft_plans.h"
+
+typedef std::map<std::pair<int, int>, fftw_plan> FFTPlanMap;
+
+// plan_lock guards the cache and is only held to look up or insert plans.
+// planner_lock serialises the FFTW planner, which can take a long time with
+// the measuring planner flags, so that lookups do not wait for it. When
+// both are needed, planner_lock is taken first.
+static pthread_mutex_t plan_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t planner_lock = PTHREAD_MUTEX_INITIALIZER;
+static FFTPlanMap* plans = NULL;
+static unsigned planner_flags = FFTW_ESTIMATE;
+static unsigned plan_generation = 0;
+
+
+// Plans are made on temporary buffers, as measuring overwrites them. The
+// buffers come from fftw_malloc so that the plans can be executed on any
+// other buffers allocated in the same way.
+static fftw_plan make_plan(int size, int type, unsigned flags) {
+    fftw_plan plan = NULL;
+    double* real = (double*) fftw_malloc(sizeof(double) * size);
+    fftw_complex* in = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * size);
+    fftw_complex* out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * size);
+
+    if(real && in && out) {
+        switch(type) {
+            case SIMPL_FFT_R2C:
+                plan = fftw_plan_dft_r2c_1d(size, real, out, flags);
+                break;
+            case SIMPL_FFT_C2R:
+                plan = fftw_plan_dft_c2r_1d(size, in, real, flags);
+                break;
+            case SIMPL_FFT_FORWARD:
+                plan = fftw_plan_dft_1d(size, in, out, FFTW_FORWARD, flags);
+                break;
+            case SIMPL_FFT_BACKWARD:
+                plan = fftw_plan_dft_1d(size, in, out, FFTW_BACKWARD, flags);
+                break;
+        }
+    }
+
+    fftw_free(real);
+    fftw_free(in);
+    fftw_free(out);
+    return plan;
+}
+
+fftw_plan simpl_fft_plan(int size, int type) {
+    if(size <= 0 || type < SIMPL_FFT_R2C || type > SIMPL_FFT_BACKWARD) {
+        return NULL;
+    }
+
+    fftw_plan plan = NULL;
+    std::pair<int, int> key(size, type);
+
+    pthread_mutex_lock(&plan_lock);
+    if(!plans) {
+        plans = new FFTPlanMap();
+    }
+    FFTPlanMap::iterator i = plans->find(key);
+    if(i != plans->end()) {
+        plan = i->second;
+    }
+    unsigned flags = planner_flags;
+    pthread_mutex_unlock(&plan_lock);
+
+    if(plan) {
+        return plan;
+    }
+
+    pthread_mutex_lock(&planner_lock);
+    fftw_plan new_plan = make_plan(size, type, flags);
+
+    // another thread may have made the same plan in the meantime
+    pthread_mutex_lock(&plan_lock);
+    i = plans->find(key);
+    if(i != plans->end()) {
+        plan = i->second;
+    }
+    else if(new_plan) {
+        plan = new_plan;
+        (*plans)[key] = plan;
+    }
+    pthread_mutex_unlock(&plan_lock);
+
+    if(new_plan && new_plan != plan) {
+        fftw_destroy_plan(new_plan);
+    }
+    pthread_mutex_unlock(&planner_lock);
+    return plan;
+}
+
+unsigned simpl_fft_plan_generation(void) {
+    return __sync_fetch_and_add(&plan_generation, 0);
+}
+
+void simpl_set_fft_planner_flags(unsigned flags) {
+    pthread_mutex_lock(&plan_lock);
+    planner_flags = flags;
+    pthread_mutex_unlock(&plan_lock);
+}
+
+unsigned simpl_get_fft_planner_flags(void) {
+    pthread_mutex_lock(&plan_lock);
+    unsigned flags = planner_flags;
+    pthread_mutex_unlock(&plan_lock);
+    return flags;
+}
+
+int simpl_load_fft_wisdom(const char* filename) {
+    pthread_mutex_lock(&planner_lock);
+    int result = fftw_import_wisdom_from_filename(filename);
+    pthread_mutex_unlock(&planner_lock);
+    return result ? 1 : 0;
+}
+
+int simpl_save_fft_wisdom(const char* filename) {
+    pthread_mutex_lock(&planner_lock);
+    int result = fftw_export_wisdom_to_filename(filename);
+    pthread_mutex_unlock(&planner_lock);
+    return result ? 1 : 0;
+}
+
+int simpl_num_fft_plans(void) {
+    pthread_mutex_lock(&plan_lock);
+    int num_plans = plans ? (int)plans->size() : 0;
+    pthread_mutex_unlock(&plan_lock);
+    return num_plans;
+}
+
+void simpl_clear_fft_plans(void) {
+    pthread_mutex_lock(&planner_lock);
+    pthread_mutex_lock(&plan_lock);
+    if(plans) {
+        for(FFTPlanMap::iterator i = plans->begin(); i != plans->end(); i++) {
+            fftw_destroy_plan(i->second);
+        }
+        plans->clear();
+    }
+    __sync_fetch_and_add(&plan_generation, 1);
+    pthread_mutex_unlock(&plan_lock);
+    pthread_mutex_unlock(&planner_lock);
+}
@@ -0,0 +1,68 @@
+#ifndef FFT_PLANS_H
+#define FFT_PLANS_H
+
+#include <fftw3.h>
+
+// ---------------------------------------------------------------------------
+// FFT plan cache
+//
+// A process-wide cache of FFTW plans, shared by the MQ, SMS, SndObj and
+// Loris backends. A plan is made once for each size and type and is then
+// reused by every object that needs it, so changing the frame size or hop
+// size of an analysis object only looks up another plan.
+//
+// Making plans and reading or writing wisdom are serialised by a mutex, as
+// the FFTW planner is not thread safe. Looking up a cached plan takes a
+// separate lock, so it does not wait for plans of other sizes to be made
+// by other threads. Cached plans can be used from any
+// number of threads at the same time with the new-array execute functions
+// (fftw_execute_dft_r2c, fftw_execute_dft_c2r and fftw_execute_dft), on
+// separate input and output buffers allocated with fftw_malloc.
+//
+// The functions have C linkage so that they can also be used by libsms.
+// ---------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum SIMPL_FFT_PLAN_TYPES {
+    SIMPL_FFT_R2C = 0,      // size real -> size / 2 + 1 complex
+    SIMPL_FFT_C2R = 1,      // size / 2 + 1 complex -> size real
+    SIMPL_FFT_FORWARD = 2,  // size complex -> size complex
+    SIMPL_FFT_BACKWARD = 3  // size complex -> size complex
+};
+
+// Returns the cached plan for a transform of the given size and type,
+// making it with the current planner flags if it does not exist yet.
+// Returns NULL if the plan cannot be made. Plans are owned by the cache
+// and must not be destroyed by the caller.
+fftw_plan simpl_fft_plan(int size, int type);
+
+// Planner flags used for new plans: FFTW_ESTIMATE (the default),
+// FFTW_MEASURE, FFTW_PATIENT or FFTW_EXHAUSTIVE. Plans that are already
+// cached are not replanned.
+void simpl_set_fft_planner_flags(unsigned flags);
+unsigned simpl_get_fft_planner_flags(void);
+
+// Import or export FFTW wisdom, so that tuned plans can be made quickly in
+// later processes. Return 1 on success and 0 on failure.
+int simpl_load_fft_wisdom(const char* filename);
+int simpl_save_fft_wisdom(const char* filename);
+
+// The number of plans in the cache
+int simpl_num_fft_plans(void);
+
+// Destroys all cached plans. Must not be called while any object that
+// uses a cached plan is still alive.
+void simpl_clear_fft_plans(void);
+
+// A number that changes whenever the cached plans are destroyed, so that
+// callers that keep their own copies of plans know when to look them up
+// again. Can be called without taking any lock.
+unsigned simpl_fft_plan_generation(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
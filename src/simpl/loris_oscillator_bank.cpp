@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <math.h>
+
+#include "loris_oscillator_bank.h"
+#include "exceptions.h"
+
+#include "Filter.h"
+#include "Oscillator.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LORIS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace std;
+using namespace simpl;
+
+// Oscillators processed together
+static const int LANES = 4;
+
+
+// ----------------------------------------------------------------------------
+// Phase rotation
+//
+// Each lane starts at cos(phase) + i sin(phase) and is multiplied every
+// sample by a rotation whose angle is the phase increment of that sample.
+// The increment grows linearly, so the rotation is itself multiplied by a
+// fixed step each sample. gains holds the modulated amplitude of each lane
+// for each sample, interleaved.
+
+struct Rotation {
+    double re[LANES];
+    double im[LANES];
+    double inc_re[LANES];
+    double inc_im[LANES];
+    double step_re[LANES];
+    double step_im[LANES];
+};
+
+static void rotate_scalar(int num_samples, double* gains, Rotation* r,
+                          sample* out) {
+    for(int n = 0; n < num_samples; n++) {
+        double value = 0.0;
+
+        for(int lane = 0; lane < LANES; lane++) {
+            value += gains[(n * LANES) + lane] * r->re[lane];
+
+            double re = (r->re[lane] * r->inc_re[lane]) -
+                        (r->im[lane] * r->inc_im[lane]);
+            double im = (r->re[lane] * r->inc_im[lane]) +
+                        (r->im[lane] * r->inc_re[lane]);
+            r->re[lane] = re;
+            r->im[lane] = im;
+
+            re = (r->inc_re[lane] * r->step_re[lane]) -
+                 (r->inc_im[lane] * r->step_im[lane]);
+            im = (r->inc_re[lane] * r->step_im[lane]) +
+                 (r->inc_im[lane] * r->step_re[lane]);
+            r->inc_re[lane] = re;
+            r->inc_im[lane] = im;
+        }
+
+        out[n] += value;
+    }
+}
+
+#ifdef LORIS_X86_SIMD
+
+// (a + ib) * (c + id) for two lanes
+__attribute__((target("sse2")))
+static inline void complex_mul_sse2(__m128d* re, __m128d* im,
+                                    __m128d c, __m128d d) {
+    __m128d a = *re;
+    *re = _mm_sub_pd(_mm_mul_pd(a, c), _mm_mul_pd(*im, d));
+    *im = _mm_add_pd(_mm_mul_pd(a, d), _mm_mul_pd(*im, c));
+}
+
+__attribute__((target("sse2")))
+static void rotate_sse2(int num_samples, double* gains, Rotation* r,
+                        sample* out) {
+    __m128d re[2], im[2], inc_re[2], inc_im[2], step_re[2], step_im[2];
+    for(int j = 0; j < 2; j++) {
+        re[j] = _mm_loadu_pd(&r->re[2 * j]);
+        im[j] = _mm_loadu_pd(&r->im[2 * j]);
+        inc_re[j] = _mm_loadu_pd(&r->inc_re[2 * j]);
+        inc_im[j] = _mm_loadu_pd(&r->inc_im[2 * j]);
+        step_re[j] = _mm_loadu_pd(&r->step_re[2 * j]);
+        step_im[j] = _mm_loadu_pd(&r->step_im[2 * j]);
+    }
+
+    for(int n = 0; n < num_samples; n++) {
+        __m128d value = _mm_add_pd(
+            _mm_mul_pd(_mm_loadu_pd(&gains[n * LANES]), re[0]),
+            _mm_mul_pd(_mm_loadu_pd(&gains[(n * LANES) + 2]), re[1])
+        );
+        value = _mm_add_sd(value, _mm_unpackhi_pd(value, value));
+        out[n] += _mm_cvtsd_f64(value);
+
+        for(int j = 0; j < 2; j++) {
+            complex_mul_sse2(&re[j], &im[j], inc_re[j], inc_im[j]);
+            complex_mul_sse2(&inc_re[j], &inc_im[j], step_re[j], step_im[j]);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static inline void complex_mul_avx2(__m256d* re, __m256d* im,
+                                    __m256d c, __m256d d) {
+    __m256d a = *re;
+    *re = _mm256_sub_pd(_mm256_mul_pd(a, c), _mm256_mul_pd(*im, d));
+    *im = _mm256_add_pd(_mm256_mul_pd(a, d), _mm256_mul_pd(*im, c));
+}
+
+__attribute__((target("avx2")))
+static void rotate_avx2(int num_samples, double* gains, Rotation* r,
+                        sample* out) {
+    __m256d re = _mm256_loadu_pd(r->re);
+    __m256d im = _mm256_loadu_pd(r->im);
+    __m256d inc_re = _mm256_loadu_pd(r->inc_re);
+    __m256d inc_im = _mm256_loadu_pd(r->inc_im);
+    __m256d step_re = _mm256_loadu_pd(r->step_re);
+    __m256d step_im = _mm256_loadu_pd(r->step_im);
+
+    for(int n = 0; n < num_samples; n++) {
+        __m256d value = _mm256_mul_pd(_mm256_loadu_pd(&gains[n * LANES]), re);
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(value),
+                                  _mm256_extractf128_pd(value, 1));
+        half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+        out[n] += _mm_cvtsd_f64(half);
+
+        complex_mul_avx2(&re, &im, inc_re, inc_im);
+        complex_mul_avx2(&inc_re, &inc_im, step_re, step_im);
+    }
+
+    // avoid AVX to SSE transition stalls in the scalar code that follows
+    _mm256_zeroupper();
+}
+
+#endif
+
+// Wraps a phase to [-pi, pi], as Loris does
+static inline double m2pi(double x) {
+    return x + (2 * M_PI * floor(0.5 - (x / (2 * M_PI))));
+}
+
+
+// ---------------------------------------------------------------------------
+// LorisOscillatorBank
+// ---------------------------------------------------------------------------
+LorisOscillatorBank::LorisOscillatorBank(int num_oscillators) {
+    const Loris::Filter& filter = Loris::Oscillator::prototype_filter();
+    std::vector<double> ffwd = filter.numerator();
+    std::vector<double> fback = filter.denominator();
+    if(ffwd.size() != 4 || fback.size() != 4) {
+        throw Exception(std::string("LorisOscillatorBank requires a third "
+                                    "order noise filter."));
+    }
+    for(int i = 0; i < 4; i++) {
+        _ffwd[i] = ffwd[i];
+        _fback[i] = fback[i];
+    }
+    _filter_gain = filter.gain();
+
+    this->num_oscillators(num_oscillators);
+}
+
+int LorisOscillatorBank::num_oscillators() {
+    return _freqs.size();
+}
+
+void LorisOscillatorBank::num_oscillators(int new_num_oscillators) {
+    _freqs.resize(new_num_oscillators);
+    _amps.resize(new_num_oscillators);
+    _bandwidths.resize(new_num_oscillators);
+    _phases.resize(new_num_oscillators);
+    _modulators.resize(new_num_oscillators);
+    _filter_state.resize(new_num_oscillators * 3);
+    reset();
+}
+
+void LorisOscillatorBank::reset() {
+    std::fill(_freqs.begin(), _freqs.end(), 0.0);
+    std::fill(_amps.begin(), _amps.end(), 0.0);
+    std::fill(_bandwidths.begin(), _bandwidths.end(), 0.0);
+    std::fill(_phases.begin(), _phases.end(), 0.0);
+    std::fill(_filter_state.begin(), _filter_state.end(), 0.0);
+    std::fill(_modulators.begin(), _modulators.end(),
+              Loris::NoiseGenerator(1.0));
+}
+
+// Writes the amplitude of an oscillator for each sample to its lane of
+// _gains, including the noise modulation when it has bandwidth, and moves
+// the amplitude and bandwidth to their targets. The filter is the same
+// recurrence as Loris::Filter::apply, in the same order.
+void LorisOscillatorBank::modulate(int oscillator, int num_samples, int lane,
+                                   double target_amp,
+                                   double target_bandwidth) {
+    double d_time = 1.0 / num_samples;
+    double amp = _amps[oscillator];
+    double bw = _bandwidths[oscillator];
+    double d_amp = (target_amp - amp) * d_time;
+    double d_bw = (target_bandwidth - bw) * d_time;
+    double* gains = &_gains[lane];
+
+    if(0 < bw || 0 < d_bw) {
+        _modulators[oscillator].fill(&_noise[0], &_noise[0] + num_samples);
+
+        double* state = &_filter_state[oscillator * 3];
+        double s1 = state[0];
+        double s2 = state[1];
+        double s3 = state[2];
+
+        // the modulation depths are constant unless the bandwidth changes
+        double carrier = sqrt(1.0 - bw);
+        double depth = sqrt(2.0 * bw);
+
+        for(int n = 0; n < num_samples; n++) {
+            double w = -_noise[n];
+            w += _fback[1] * s1;
+            w += _fback[2] * s2;
+            w += _fback[3] * s3;
+            w = -w;
+
+            double nz = 0.0;
+            nz += _ffwd[0] * w;
+            nz += _ffwd[1] * s1;
+            nz += _ffwd[2] * s2;
+            nz += _ffwd[3] * s3;
+            nz *= _filter_gain;
+
+            s3 = s2;
+            s2 = s1;
+            s1 = w;
+
+            if(d_bw != 0.0) {
+                carrier = sqrt(1.0 - bw);
+                depth = sqrt(2.0 * bw);
+            }
+            gains[n * LANES] = (carrier + (nz * depth)) * amp;
+
+            amp += d_amp;
+            bw += d_bw;
+            if(bw < 0.0) {
+                bw = 0.0;
+            }
+        }
+
+        state[0] = s1;
+        state[1] = s2;
+        state[2] = s3;
+    }
+    else {
+        for(int n = 0; n < num_samples; n++) {
+            gains[n * LANES] = amp;
+            amp += d_amp;
+        }
+    }
+
+    _amps[oscillator] = target_amp;
+    _bandwidths[oscillator] = target_bandwidth;
+}
+
+void LorisOscillatorBank::oscillate(int num_oscillators, int num_samples,
+                                    sample* amps, sample* freqs,
+                                    sample* bandwidths, int sampling_rate,
+                                    sample* out, int simd_level) {
+    if(num_oscillators > (int)_freqs.size()) {
+        throw Exception(std::string("LorisOscillatorBank has too few "
+                                    "oscillators."));
+    }
+    if(num_samples <= 0) {
+        return;
+    }
+    if(simd_level > mq_simd_level()) {
+        simd_level = mq_simd_level();
+    }
+
+    if((int)_noise.size() < num_samples) {
+        _noise.resize(num_samples);
+        _gains.resize(num_samples * LANES);
+    }
+
+    double d_time = 1.0 / num_samples;
+    Rotation r;
+
+    for(int first = 0; first < num_oscillators; first += LANES) {
+        for(int lane = 0; lane < LANES; lane++) {
+            int i = first + lane;
+
+            if(i >= num_oscillators) {
+                for(int n = 0; n < num_samples; n++) {
+                    _gains[(n * LANES) + lane] = 0.0;
+                }
+                r.re[lane] = 1.0;
+                r.im[lane] = 0.0;
+                r.inc_re[lane] = 1.0;
+                r.inc_im[lane] = 0.0;
+                r.step_re[lane] = 1.0;
+                r.step_im[lane] = 0.0;
+                continue;
+            }
+
+            double target_freq = (freqs[i] * 2 * M_PI) / sampling_rate;
+            double target_amp = amps[i];
+            double target_bw = bandwidths[i];
+
+            if(target_bw > 1.0) {
+                target_bw = 1.0;
+            }
+            else if(target_bw < 0.0) {
+                target_bw = 0.0;
+            }
+            if(target_freq > M_PI) {
+                target_amp = 0.0;
+            }
+
+            modulate(i, num_samples, lane, target_amp, target_bw);
+
+            // Loris adds half of the frequency change before and half after
+            // updating the phase, so the increment at sample n is
+            // freq + (n + 1/2) * d_freq
+            double freq = _freqs[i];
+            double phase = _phases[i];
+            double d_freq = (target_freq - freq) * d_time;
+            double inc = freq + (0.5 * d_freq);
+
+            r.re[lane] = cos(phase);
+            r.im[lane] = sin(phase);
+            r.inc_re[lane] = cos(inc);
+            r.inc_im[lane] = sin(inc);
+            r.step_re[lane] = cos(d_freq);
+            r.step_im[lane] = sin(d_freq);
+
+            _phases[i] = m2pi(phase +
+                              (0.5 * num_samples * (freq + target_freq)));
+            _freqs[i] = target_freq;
+        }
+
+#ifdef LORIS_X86_SIMD
+        if(simd_level == MQ_SIMD_AVX2) {
+            rotate_avx2(num_samples, &_gains[0], &r, out);
+            continue;
+        }
+        if(simd_level == MQ_SIMD_SSE2) {
+            rotate_sse2(num_samples, &_gains[0], &r, out);
+            continue;
+        }
+#endif
+        rotate_scalar(num_samples, &_gains[0], &r, out);
+    }
+}
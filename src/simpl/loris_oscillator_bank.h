@@ -0,0 +1,87 @@
+#ifndef LORIS_OSCILLATOR_BANK_H
+#define LORIS_OSCILLATOR_BANK_H
+
+#include <vector>
+
+#include "base.h"
+#include "oscillator_bank.h"
+
+#include "NoiseGenerator.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// LorisOscillatorBank
+//
+// A bank of Loris bandwidth-enhanced oscillators that synthesises a block
+// of samples for all of them at once. Calling oscillate() moves each
+// oscillator from its current frequency, amplitude and bandwidth to the
+// given targets over the block, exactly as Loris::Oscillator::oscillate
+// does for one breakpoint, and adds the result to out.
+//
+// Each oscillator has its own Loris noise generator, seeded as in Loris,
+// so the output is the same as that of a Loris::Oscillator per partial to
+// within rounding (about 1e-9 of the amplitude for blocks of up to 2048
+// samples). The differences are in how a block is computed:
+//
+//  - the noise of an oscillator is generated for the whole block at once
+//    and filtered with a fixed third order filter state, rather than one
+//    sample at a time through Loris::Filter
+//  - the phase ramp is computed by complex rotation (two complex
+//    multiplications per sample instead of a cos)
+//  - groups of 4 oscillators are processed together, with SSE2 or AVX2
+//    when the CPU supports them (see MQSimdLevel)
+//
+// Oscillators past num_oscillators keep their state. No memory is
+// allocated once the bank has processed a block of the largest size used.
+// ---------------------------------------------------------------------------
+class LorisOscillatorBank {
+    private:
+        // instantaneous state, frequencies in radians per sample
+        std::vector<double> _freqs;
+        std::vector<double> _amps;
+        std::vector<double> _bandwidths;
+        std::vector<double> _phases;
+
+        std::vector<Loris::NoiseGenerator> _modulators;
+
+        // last 3 filter values of each oscillator, most recent first
+        std::vector<double> _filter_state;
+        double _ffwd[4];
+        double _fback[4];
+        double _filter_gain;
+
+        // noise for one oscillator, and the modulated amplitudes of
+        // a group of oscillators (interleaved)
+        std::vector<double> _noise;
+        std::vector<double> _gains;
+
+        void modulate(int oscillator, int num_samples, int lane,
+                      double target_amp, double target_bandwidth);
+
+    public:
+        LorisOscillatorBank(int num_oscillators=0);
+
+        int num_oscillators();
+
+        // Changes the number of oscillators and resets them
+        void num_oscillators(int new_num_oscillators);
+
+        // Sets every oscillator to 0 frequency, amplitude, bandwidth and
+        // phase and reseeds the noise generators
+        void reset();
+
+        // Adds num_samples samples of the first num_oscillators oscillators
+        // to out. Frequencies are in Hz. Bandwidths are clamped to [0, 1]
+        // and oscillators above the Nyquist frequency fade out.
+        void oscillate(int num_oscillators, int num_samples,
+                       sample* amps, sample* freqs, sample* bandwidths,
+                       int sampling_rate, sample* out,
+                       int simd_level=MQ_SIMD_AUTO);
+};
+
+} // end of namespace simpl
+
+#endif
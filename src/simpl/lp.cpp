@@ -0,0 +1,86 @@
+#include <algorithm>
+
+#include "lp.h"
+
+using namespace std;
+using namespace simpl;
+
+
+void simpl::burg(int size, int num_signals, sample* signals, int order,
+                 sample* coefs, std::vector<sample>& buffer) {
+    int n = num_signals;
+    if(buffer.size() < (2 * size + order + 3) * n) {
+        buffer.resize((2 * size + order + 3) * n);
+    }
+
+    // forward and backward prediction errors, the sums used for the
+    // reflection coefficient of each signal, and the previous coefficients
+    sample* f = &buffer[0];
+    sample* b = f + size * n;
+    sample* num = b + size * n;
+    sample* den = num + n;
+    sample* mu = den + n;
+    sample* prev = mu + n;
+
+    std::copy(signals, signals + size * n, f);
+    std::copy(signals, signals + size * n, b);
+    std::fill(coefs, coefs + order * n, 0.0);
+
+    for(int k = 0, len = size; k < order && len > 1; k++, len--) {
+        std::fill(num, num + 2 * n, 0.0);
+        for(int t = 1; t < len; t++) {
+            sample* ft = f + t * n;
+            sample* bt = b + (t - 1) * n;
+            for(int j = 0; j < n; j++) {
+                num[j] += ft[j] * bt[j];
+                den[j] += (ft[j] * ft[j]) + (bt[j] * bt[j]);
+            }
+        }
+
+        for(int j = 0; j < n; j++) {
+            mu[j] = den[j] != 0 ? -2.0 * num[j] / den[j] : 0.0;
+        }
+
+        // Levinson update: a[i] += mu * a[k + 1 - i], with a[0] = 1
+        std::copy(coefs, coefs + k * n, prev);
+        for(int i = 1; i <= k; i++) {
+            sample* a = coefs + (i - 1) * n;
+            sample* r = prev + (k - i) * n;
+            for(int j = 0; j < n; j++) {
+                a[j] += mu[j] * r[j];
+            }
+        }
+        std::copy(mu, mu + n, coefs + k * n);
+
+        for(int t = 0; t < len - 1; t++) {
+            sample* ft = f + t * n;
+            sample* fnext = f + (t + 1) * n;
+            sample* bt = b + t * n;
+            for(int j = 0; j < n; j++) {
+                sample fj = fnext[j];
+                sample bj = bt[j];
+                ft[j] = fj + (mu[j] * bj);
+                bt[j] = bj + (mu[j] * fj);
+            }
+        }
+    }
+}
+
+void simpl::predict(int size, int num_signals, sample* signals, int order,
+                    sample* coefs, int num_predictions, sample* predictions) {
+    int n = num_signals;
+    std::fill(predictions, predictions + num_predictions * n, 0.0);
+
+    for(int i = 0; i < num_predictions; i++) {
+        sample* p = predictions + i * n;
+        for(int c = 0; c < order; c++) {
+            int lag = i - c - 1;
+            sample* x = lag >= 0 ? predictions + lag * n :
+                                   signals + (size + lag) * n;
+            sample* a = coefs + c * n;
+            for(int j = 0; j < n; j++) {
+                p[j] -= a[j] * x[j];
+            }
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef LP_H
+#define LP_H
+
+#include <vector>
+
+#include "base.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// Linear prediction
+//
+// Burg's method and linear prediction for a batch of signals of the same
+// size. The signals are interleaved: value t of signal j is
+// signals[t * num_signals + j], so that each step of the recursions is
+// one loop over all of the signals.
+//
+// Coefficients are stored the same way (coefficient i of signal j is
+// coefs[i * num_signals + j]) and follow the convention of simpl.lp.burg:
+// the coefficient of x[n] is an implicit 1, so that the prediction of
+// x[n] is -(coefs[0] * x[n - 1] + ... + coefs[order - 1] * x[n - order]).
+// ---------------------------------------------------------------------------
+
+// Calculates order coefficients for each signal from its size values.
+// buffer is used for the forward and backward prediction errors, and only
+// allocates when it grows.
+void burg(int size, int num_signals, sample* signals, int order,
+          sample* coefs, std::vector<sample>& buffer);
+
+// Predicts the next num_predictions values of each signal (interleaved in
+// predictions as in signals). size must be at least order.
+void predict(int size, int num_signals, sample* signals, int order,
+             sample* coefs, int num_predictions, sample* predictions);
+
+} // end of namespace simpl
+
+#endif
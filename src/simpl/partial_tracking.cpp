@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <sstream>
+
 #include "partial_tracking.h"
 
 using namespace std;
@@ -18,10 +21,33 @@ PartialTracking::~PartialTracking() {
     clear();
 }
 
+PartialTracking* PartialTracking::clone() {
+    PartialTracking* pt = new PartialTracking();
+    copy_parameters(pt);
+    return pt;
+}
+
+void PartialTracking::copy_parameters(PartialTracking* pt) {
+    pt->sampling_rate(_sampling_rate);
+    pt->max_partials(_max_partials);
+    pt->min_partial_length(_min_partial_length);
+    pt->max_gap(_max_gap);
+}
+
 void PartialTracking::clear() {
     _frames.clear();
 }
 
+std::string PartialTracking::parameters() {
+    std::ostringstream s;
+    s.precision(17);
+    s << "sampling_rate=" << _sampling_rate << ";"
+      << "max_partials=" << _max_partials << ";"
+      << "min_partial_length=" << _min_partial_length << ";"
+      << "max_gap=" << _max_gap << ";";
+    return s.str();
+}
+
 int PartialTracking::sampling_rate() {
     return _sampling_rate;
 }
@@ -54,6 +80,10 @@ void PartialTracking::max_gap(int new_max_gap) {
     _max_gap = new_max_gap;
 }
 
+Profile* PartialTracking::profile() {
+    return &_profile;
+}
+
 // Streamable (real-time) partial-tracking.
 void PartialTracking::update_partials(Frame* frame) {
 }
@@ -83,69 +113,312 @@ MQPartialTracking::MQPartialTracking() {
     _mq_params.matching_interval = 100.0;
     _mq_params.fundamental = 0;
     init_mq(&_mq_params);
-    _peak_list = NULL;
-    _prev_peak_list = NULL;
+    mq_init_peak_array(&_peaks, _max_partials);
+    mq_init_peak_array(&_prev_peaks, _max_partials);
 }
 
 MQPartialTracking::~MQPartialTracking() {
     destroy_mq(&_mq_params);
-    delete_peak_list(_prev_peak_list);
-    _peak_list = NULL;
-    _prev_peak_list = NULL;
+    mq_destroy_peak_array(&_peaks);
+    mq_destroy_peak_array(&_prev_peaks);
+}
+
+PartialTracking* MQPartialTracking::clone() {
+    MQPartialTracking* pt = new MQPartialTracking();
+    copy_parameters(pt);
+    pt->matching_interval(matching_interval());
+    return pt;
 }
 
 void MQPartialTracking::reset() {
     reset_mq(&_mq_params);
-    delete_peak_list(_prev_peak_list);
-    _peak_list = NULL;
-    _prev_peak_list = NULL;
+    _peaks.num_peaks = 0;
+    _prev_peaks.num_peaks = 0;
+}
+
+std::string MQPartialTracking::parameters() {
+    std::ostringstream s;
+    s.precision(17);
+    s << PartialTracking::parameters()
+      << "matching_interval=" << _mq_params.matching_interval << ";";
+    return s.str();
+}
+
+sample MQPartialTracking::matching_interval() {
+    return _mq_params.matching_interval;
+}
+
+void MQPartialTracking::matching_interval(sample new_matching_interval) {
+    _mq_params.matching_interval = new_matching_interval;
 }
 
 void MQPartialTracking::max_partials(int new_max_partials) {
     _max_partials = new_max_partials;
     _mq_params.max_peaks = _max_partials;
+    mq_init_peak_array(&_peaks, _max_partials);
+    mq_init_peak_array(&_prev_peaks, _max_partials);
 }
 
 void MQPartialTracking::update_partials(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     int num_peaks = _max_partials;
     if(num_peaks > frame->num_peaks()) {
         num_peaks = frame->num_peaks();
     }
     frame->clear_partials();
 
-    _peak_list = new MQPeakList();
-    for(int i = 0; i < num_peaks; i++) {
-        MQPeak* p = new MQPeak();
-        p->amplitude = frame->peak(i)->amplitude;
-        p->frequency = frame->peak(i)->frequency;
-        p->phase = frame->peak(i)->phase;
-        p->bin = i;
-        p->next = NULL;
-        p->prev = NULL;
-        mq_add_peak(p, _peak_list);
-    }
-
-    MQPeakList* partials = mq_track_peaks(_peak_list, &_mq_params);
-    partials = mq_sort_peaks_by_frequency(partials, num_peaks);
-
-    _peak_list = partials;
-    int num_partials = 0;
-    while(partials && partials->peak && (num_partials < _max_partials)) {
-        frame->add_partial(partials->peak->amplitude,
-                           partials->peak->frequency,
-                           partials->peak->phase,
-                           0.0);
+    mq_set_peaks(&_peaks, num_peaks, frame->peak_amplitudes(),
+                 frame->peak_frequencies(), frame->peak_phases());
+    mq_track_peak_array(&_prev_peaks, &_peaks, &_mq_params);
 
-        partials = partials->next;
-        num_partials++;
+    // partials are returned in order of frequency
+    int num_partials = _peaks.num_peaks;
+    for(int i = 0; i < num_partials; i++) {
+        frame->add_partial(_peaks.peaks[i].amplitude,
+                           _peaks.peaks[i].frequency,
+                           _peaks.peaks[i].phase,
+                           0.0);
     }
 
     for(int i = num_partials; i < _max_partials; i++) {
         frame->add_partial(0.0, 0.0, 0.0, 0.0);
     }
 
-    delete_peak_list(_prev_peak_list);
-    _prev_peak_list = _peak_list;
+    std::swap(_peaks, _prev_peaks);
+}
+
+
+// ---------------------------------------------------------------------------
+// LPPartialTracking
+// ---------------------------------------------------------------------------
+
+// Orders peak numbers by decreasing amplitude
+struct LPCompareAmplitudes {
+    sample* amplitudes;
+
+    LPCompareAmplitudes(sample* new_amplitudes) {
+        amplitudes = new_amplitudes;
+    }
+
+    bool operator()(int a, int b) const {
+        if(amplitudes[a] != amplitudes[b]) {
+            return amplitudes[a] > amplitudes[b];
+        }
+        return a < b;
+    }
+};
+
+LPPartialTracking::LPPartialTracking() {
+    _matching_interval = 100.0;
+    _order = 6;
+    _history_size = 16;
+    init();
+}
+
+PartialTracking* LPPartialTracking::clone() {
+    LPPartialTracking* pt = new LPPartialTracking();
+    copy_parameters(pt);
+    pt->_matching_interval = _matching_interval;
+
+    // set together, as the setters check each against the other
+    pt->_order = _order;
+    pt->_history_size = _history_size;
+    pt->init();
+    return pt;
+}
+
+void LPPartialTracking::init() {
+    _history.resize(_history_size * _max_partials);
+    _gaps.resize(_max_partials);
+    _active.reserve(_max_partials);
+    _signals.resize(_history_size * _max_partials);
+    _coefs.resize(_order * _max_partials);
+    _predictions.resize(_max_partials);
+    _matches.resize(_max_partials);
+    reset();
+}
+
+void LPPartialTracking::reset() {
+    std::fill(_history.begin(), _history.end(), 0.0);
+    std::fill(_gaps.begin(), _gaps.end(), -1);
+    _history_pos = 0;
+}
+
+std::string LPPartialTracking::parameters() {
+    std::ostringstream s;
+    s.precision(17);
+    s << PartialTracking::parameters()
+      << "matching_interval=" << _matching_interval << ";"
+      << "order=" << _order << ";"
+      << "history_size=" << _history_size << ";";
+    return s.str();
+}
+
+void LPPartialTracking::max_partials(int new_max_partials) {
+    _max_partials = new_max_partials;
+    init();
+}
+
+sample LPPartialTracking::matching_interval() {
+    return _matching_interval;
+}
+
+void LPPartialTracking::matching_interval(sample new_matching_interval) {
+    _matching_interval = new_matching_interval;
+}
+
+int LPPartialTracking::order() {
+    return _order;
+}
+
+void LPPartialTracking::order(int new_order) {
+    if(new_order < 1 || new_order >= _history_size) {
+        throw Exception(std::string("LP order must be at least 1 and "
+                                    "less than the history size."));
+    }
+    _order = new_order;
+    init();
+}
+
+int LPPartialTracking::history_size() {
+    return _history_size;
+}
+
+void LPPartialTracking::history_size(int new_history_size) {
+    if(new_history_size <= _order) {
+        throw Exception(std::string("LP history size must be greater "
+                                    "than the order."));
+    }
+    _history_size = new_history_size;
+    init();
+}
+
+void LPPartialTracking::update_partials(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
+    int num_peaks = frame->num_peaks();
+    sample* amps = frame->peak_amplitudes();
+    sample* freqs = frame->peak_frequencies();
+    sample* phases = frame->peak_phases();
+    sample* bandwidths = frame->peak_bandwidths();
+    frame->clear_partials();
+
+    // predict the next frequency of all active partials together
+    _active.clear();
+    for(int i = 0; i < _max_partials; i++) {
+        if(_gaps[i] >= 0) {
+            _active.push_back(i);
+        }
+    }
+
+    int n = _active.size();
+    if(n > 0) {
+        for(int t = 0; t < _history_size; t++) {
+            int row = (_history_pos + t) % _history_size;
+            sample* history = &_history[row * _max_partials];
+            sample* signal = &_signals[t * n];
+            for(int j = 0; j < n; j++) {
+                signal[j] = history[_active[j]];
+            }
+        }
+        burg(_history_size, n, &_signals[0], _order, &_coefs[0], _lp_buffer);
+        predict(_history_size, n, &_signals[0], _order, &_coefs[0], 1,
+                &_predictions[0]);
+    }
+
+    // match the closest pairs of predictions and peaks first. Buffers
+    // are sized for max_peaks so that they do not grow between frames.
+    _candidates.reserve(_max_partials * frame->max_peaks());
+    _peak_partials.reserve(frame->max_peaks());
+    _peak_order.reserve(frame->max_peaks());
+    _candidates.clear();
+    for(int j = 0; j < n; j++) {
+        for(int k = 0; k < num_peaks; k++) {
+            sample distance = fabs(freqs[k] - _predictions[j]);
+            if(amps[k] > 0 && distance < _matching_interval) {
+                _candidates.push_back(
+                    std::make_pair(distance, (j * num_peaks) + k)
+                );
+            }
+        }
+    }
+    std::sort(_candidates.begin(), _candidates.end());
+
+    _matches.assign(_max_partials, -1);
+    _peak_partials.assign(num_peaks, -1);
+    for(int c = 0; c < _candidates.size(); c++) {
+        int partial = _active[_candidates[c].second / num_peaks];
+        int peak = _candidates[c].second % num_peaks;
+        if(_matches[partial] < 0 && _peak_partials[peak] < 0) {
+            _matches[partial] = peak;
+            _peak_partials[peak] = partial;
+        }
+    }
+
+    // the newest history values replace the oldest. Unmatched partials
+    // continue with their predictions, and die (-2 until the end of this
+    // frame) after max_gap frames.
+    sample* history = &_history[_history_pos * _max_partials];
+    for(int j = 0; j < n; j++) {
+        int partial = _active[j];
+        if(_matches[partial] >= 0) {
+            _gaps[partial] = 0;
+            history[partial] = freqs[_matches[partial]];
+        }
+        else {
+            _gaps[partial] = _gaps[partial] < _max_gap ? _gaps[partial] + 1 : -2;
+            history[partial] = _predictions[j];
+        }
+    }
+
+    // unmatched peaks start new partials, largest first
+    _peak_order.clear();
+    for(int k = 0; k < num_peaks; k++) {
+        if(_peak_partials[k] < 0 && amps[k] > 0) {
+            _peak_order.push_back(k);
+        }
+    }
+    std::sort(_peak_order.begin(), _peak_order.end(),
+              LPCompareAmplitudes(amps));
+
+    for(int i = 0, partial = 0; i < _peak_order.size(); i++) {
+        while(partial < _max_partials && _gaps[partial] != -1) {
+            partial++;
+        }
+        if(partial == _max_partials) {
+            break;
+        }
+
+        int peak = _peak_order[i];
+        _gaps[partial] = 0;
+        _matches[partial] = peak;
+        for(int t = 0; t < _history_size; t++) {
+            _history[(t * _max_partials) + partial] = freqs[peak];
+        }
+    }
+
+    int num_partials = std::min(_max_partials, frame->max_partials());
+    for(int i = 0; i < num_partials; i++) {
+        int peak = _matches[i];
+        if(peak >= 0) {
+            frame->add_partial(amps[peak], freqs[peak],
+                               phases[peak], bandwidths[peak]);
+        }
+        else if(_gaps[i] != -1) {
+            frame->add_partial(0.0, history[i], 0.0, 0.0);
+        }
+        else {
+            frame->add_partial(0.0, 0.0, 0.0, 0.0);
+        }
+    }
+
+    for(int i = 0; i < _max_partials; i++) {
+        if(_gaps[i] == -2) {
+            _gaps[i] = -1;
+        }
+    }
+    _history_pos = (_history_pos + 1) % _history_size;
 }
 
 
@@ -194,6 +467,19 @@ SMSPartialTracking::~SMSPartialTracking() {
     _peak_phase = NULL;
 }
 
+PartialTracking* SMSPartialTracking::clone() {
+    SMSPartialTracking* pt = new SMSPartialTracking();
+    copy_parameters(pt);
+    pt->realtime(realtime());
+    pt->harmonic(harmonic());
+    pt->default_fundamental(default_fundamental());
+    pt->max_frame_delay(max_frame_delay());
+    pt->analysis_delay(analysis_delay());
+    pt->min_good_frames(min_good_frames());
+    pt->clean_tracks(clean_tracks());
+    return pt;
+}
+
 void SMSPartialTracking::init_peaks() {
     if(_peak_amplitude) {
         delete [] _peak_amplitude;
@@ -205,18 +491,32 @@ void SMSPartialTracking::init_peaks() {
         delete [] _peak_phase;
     }
 
-    _peak_amplitude = new sample[_max_partials];
-    _peak_frequency = new sample[_max_partials];
-    _peak_phase = new sample[_max_partials];
+    _peak_amplitude = new sfloat[_max_partials];
+    _peak_frequency = new sfloat[_max_partials];
+    _peak_phase = new sfloat[_max_partials];
 
-    memset(_peak_amplitude, 0.0, sizeof(sample) * _max_partials);
-    memset(_peak_frequency, 0.0, sizeof(sample) * _max_partials);
-    memset(_peak_phase, 0.0, sizeof(sample) * _max_partials);
+    memset(_peak_amplitude, 0.0, sizeof(sfloat) * _max_partials);
+    memset(_peak_frequency, 0.0, sizeof(sfloat) * _max_partials);
+    memset(_peak_phase, 0.0, sizeof(sfloat) * _max_partials);
 }
 
 void SMSPartialTracking::reset() {
 }
 
+std::string SMSPartialTracking::parameters() {
+    std::ostringstream s;
+    s.precision(17);
+    s << PartialTracking::parameters()
+      << "realtime=" << realtime() << ";"
+      << "harmonic=" << harmonic() << ";"
+      << "default_fundamental=" << default_fundamental() << ";"
+      << "max_frame_delay=" << max_frame_delay() << ";"
+      << "analysis_delay=" << analysis_delay() << ";"
+      << "min_good_frames=" << min_good_frames() << ";"
+      << "clean_tracks=" << clean_tracks() << ";";
+    return s.str();
+}
+
 void SMSPartialTracking::max_partials(int new_max_partials) {
     _max_partials = new_max_partials;
 
@@ -341,6 +641,8 @@ void SMSPartialTracking::clean_tracks(bool new_clean_tracks) {
 }
 
 void SMSPartialTracking::update_partials(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     int num_peaks = _max_partials;
     if(num_peaks > frame->num_peaks()) {
         num_peaks = frame->num_peaks();
@@ -348,11 +650,12 @@ void SMSPartialTracking::update_partials(Frame* frame) {
     frame->clear_partials();
 
     // set peaks in SMSAnalysisParams object
-    for(int i = 0; i < num_peaks; i++) {
-        _peak_amplitude[i] = frame->peak(i)->amplitude;
-        _peak_frequency[i] = frame->peak(i)->frequency;
-        _peak_phase[i] = frame->peak(i)->phase;
-    }
+    std::copy(frame->peak_amplitudes(), frame->peak_amplitudes() + num_peaks,
+              _peak_amplitude);
+    std::copy(frame->peak_frequencies(), frame->peak_frequencies() + num_peaks,
+              _peak_frequency);
+    std::copy(frame->peak_phases(), frame->peak_phases() + num_peaks,
+              _peak_phase);
 
     sms_setPeaks(&_analysis_params,
                  _max_partials, _peak_amplitude,
@@ -410,6 +713,13 @@ SndObjPartialTracking::~SndObjPartialTracking() {
     _peak_phase = NULL;
 }
 
+PartialTracking* SndObjPartialTracking::clone() {
+    SndObjPartialTracking* pt = new SndObjPartialTracking();
+    pt->_threshold = _threshold;
+    copy_parameters(pt);
+    return pt;
+}
+
 void SndObjPartialTracking::reset() {
     if(_input) {
         delete _input;
@@ -429,13 +739,13 @@ void SndObjPartialTracking::reset() {
 
     _input = new SndObj();
     _analysis = new SinAnal(_input, _num_bins, _threshold, _max_partials);
-    _peak_amplitude = new sample[_max_partials];
-    _peak_frequency = new sample[_max_partials];
-    _peak_phase = new sample[_max_partials];
+    _peak_amplitude = new double[_max_partials];
+    _peak_frequency = new double[_max_partials];
+    _peak_phase = new double[_max_partials];
 
-    memset(_peak_amplitude, 0.0, sizeof(sample) * _max_partials);
-    memset(_peak_frequency, 0.0, sizeof(sample) * _max_partials);
-    memset(_peak_phase, 0.0, sizeof(sample) * _max_partials);
+    memset(_peak_amplitude, 0.0, sizeof(double) * _max_partials);
+    memset(_peak_frequency, 0.0, sizeof(double) * _max_partials);
+    memset(_peak_phase, 0.0, sizeof(double) * _max_partials);
 }
 
 void SndObjPartialTracking::max_partials(int new_max_partials) {
@@ -444,17 +754,20 @@ void SndObjPartialTracking::max_partials(int new_max_partials) {
 }
 
 void SndObjPartialTracking::update_partials(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     int num_peaks = _max_partials;
     if(num_peaks > frame->num_peaks()) {
         num_peaks = frame->num_peaks();
     }
     frame->clear_partials();
 
-    for(int i = 0; i < num_peaks; i++) {
-        _peak_amplitude[i] = frame->peak(i)->amplitude;
-        _peak_frequency[i] = frame->peak(i)->frequency;
-        _peak_phase[i] = frame->peak(i)->phase;
-    }
+    std::copy(frame->peak_amplitudes(), frame->peak_amplitudes() + num_peaks,
+              _peak_amplitude);
+    std::copy(frame->peak_frequencies(), frame->peak_frequencies() + num_peaks,
+              _peak_frequency);
+    std::copy(frame->peak_phases(), frame->peak_phases() + num_peaks,
+              _peak_phase);
     for(int i = num_peaks; i < _max_partials; i++) {
         _peak_amplitude[i] = _peak_frequency[i] = _peak_phase[i] = 0.0;
     }
@@ -487,22 +800,18 @@ SimplLorisPTAnalyzer::SimplLorisPTAnalyzer(int max_partials) :
     buildFundamentalEnv(false);
     _partial_builder = new Loris::PartialBuilder(m_freqDrift);
     _partial_builder->maxPartials(max_partials);
+
+    peaks.reserve(max_partials);
+    partials.reserve(max_partials);
 }
 
 SimplLorisPTAnalyzer::~SimplLorisPTAnalyzer() {
     delete _partial_builder;
 }
 
+// The amplitude and fundamental envelopes of Loris::Analyzer are not used,
+// so they are not built here: building them allocates on every frame.
 void SimplLorisPTAnalyzer::analyze() {
-    m_ampEnvBuilder->reset();
-    m_f0Builder->reset();
-
-    // estimate the amplitude in this frame
-    m_ampEnvBuilder->build(peaks, 0);
-
-    // estimate the fundamental frequency
-    m_f0Builder->build(peaks, 0);
-
     // form partials
     _partial_builder->buildPartials(peaks);
     partials = _partial_builder->getPartials();
@@ -521,6 +830,12 @@ LorisPartialTracking::~LorisPartialTracking() {
     }
 }
 
+PartialTracking* LorisPartialTracking::clone() {
+    LorisPartialTracking* pt = new LorisPartialTracking();
+    copy_parameters(pt);
+    return pt;
+}
+
 void LorisPartialTracking::reset() {
     if(_analyzer) {
         delete _analyzer;
@@ -534,17 +849,22 @@ void LorisPartialTracking::max_partials(int new_max_partials) {
 }
 
 void LorisPartialTracking::update_partials(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     int num_peaks = frame->num_peaks();
     if(num_peaks > _max_partials) {
         num_peaks = _max_partials;
     }
 
+    sample* amps = frame->peak_amplitudes();
+    sample* freqs = frame->peak_frequencies();
+    sample* phases = frame->peak_phases();
+    sample* bandwidths = frame->peak_bandwidths();
+
     _analyzer->peaks.clear();
     for(int i = 0; i < num_peaks; i++) {
-        Loris::Breakpoint bp = Loris::Breakpoint(frame->peak(i)->frequency,
-                                                 frame->peak(i)->amplitude,
-                                                 frame->peak(i)->bandwidth,
-                                                 frame->peak(i)->phase);
+        Loris::Breakpoint bp = Loris::Breakpoint(freqs[i], amps[i],
+                                                 bandwidths[i], phases[i]);
         _analyzer->peaks.push_back(Loris::SpectralPeak(0, bp));
     }
 
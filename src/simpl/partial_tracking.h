@@ -2,6 +2,8 @@
 #define PARTIAL_TRACKING_H
 
 #include "base.h"
+#include "profile.h"
+#include "lp.h"
 
 #include "mq.h"
 
@@ -42,14 +44,26 @@ class PartialTracking {
         int _min_partial_length;
         int _max_gap;
         Frames _frames;
+        Profile _profile;
+
+        void copy_parameters(PartialTracking* pt);
 
     public:
         PartialTracking();
-        ~PartialTracking();
+        virtual ~PartialTracking();
+
+        // Return a new tracker with the same parameters as this one but
+        // with its own tracking state. The caller owns the returned object.
+        virtual PartialTracking* clone();
 
         virtual void reset() {};
         virtual void clear();
 
+        // The parameters that affect the partials found by this tracker,
+        // as "name=value;" pairs. Trackers with the same parameters find
+        // the same partials in the same peaks.
+        virtual std::string parameters();
+
         int sampling_rate();
         virtual void sampling_rate(int new_sampling_rate);
         int max_partials();
@@ -59,6 +73,9 @@ class PartialTracking {
         int max_gap();
         virtual void max_gap(int new_max_gap);
 
+        // Statistics for the frames processed by this object, see Profile
+        Profile* profile();
+
         virtual void update_partials(Frame* frame);
         virtual Frames find_partials(Frames frames);
 };
@@ -69,15 +86,77 @@ class PartialTracking {
 class MQPartialTracking : public PartialTracking {
     private:
         MQParameters _mq_params;
-        MQPeakList* _peak_list;
-        MQPeakList* _prev_peak_list;
+        MQPeakArray _peaks;
+        MQPeakArray _prev_peaks;
 
     public:
         MQPartialTracking();
         ~MQPartialTracking();
+        PartialTracking* clone();
+        void reset();
+        std::string parameters();
+        using PartialTracking::max_partials;
+        void max_partials(int new_max_partials);
+        sample matching_interval();
+        void matching_interval(sample new_matching_interval);
+        void update_partials(Frame* frame);
+};
+
+// ---------------------------------------------------------------------------
+// LPPartialTracking
+//
+// Streamable partial tracking using linear prediction. The next frequency
+// of every partial is predicted from its last history_size frequencies
+// with Burg's method (order coefficients), and peaks are matched to the
+// partials with the closest predictions, closest pairs first, if they are
+// within matching_interval Hz. Unmatched peaks start new partials in free
+// partial numbers, largest amplitude first.
+//
+// A partial with no matching peak has 0 amplitude but keeps its partial
+// number and continues with its predicted frequencies for up to max_gap
+// frames, so that it can be matched again. It dies after that.
+// A new partial's history starts as its first frequency repeated.
+// ---------------------------------------------------------------------------
+class LPPartialTracking : public PartialTracking {
+    private:
+        sample _matching_interval;
+        int _order;
+        int _history_size;
+
+        // frequency history of each partial number, interleaved (see
+        // burg), with _history_pos the row of the oldest values
+        std::vector<sample> _history;
+        int _history_pos;
+
+        // frames since each partial was last matched, -1 if it is free
+        std::vector<int> _gaps;
+
+        // working buffers for one frame
+        std::vector<int> _active;
+        std::vector<sample> _signals;
+        std::vector<sample> _coefs;
+        std::vector<sample> _predictions;
+        std::vector<sample> _lp_buffer;
+        std::vector<int> _matches;
+        std::vector<int> _peak_partials;
+        std::vector<int> _peak_order;
+        std::vector<std::pair<sample, int> > _candidates;
+
+        void init();
+
+    public:
+        LPPartialTracking();
+        PartialTracking* clone();
         void reset();
+        std::string parameters();
         using PartialTracking::max_partials;
         void max_partials(int new_max_partials);
+        sample matching_interval();
+        void matching_interval(sample new_matching_interval);
+        int order();
+        void order(int new_order);
+        int history_size();
+        void history_size(int new_history_size);
         void update_partials(Frame* frame);
 };
 
@@ -89,15 +168,17 @@ class SMSPartialTracking : public PartialTracking {
         SMSAnalysisParams _analysis_params;
         SMSHeader _header;
         SMSData _data;
-        sample* _peak_amplitude;
-        sample* _peak_frequency;
-        sample* _peak_phase;
+        sfloat* _peak_amplitude;
+        sfloat* _peak_frequency;
+        sfloat* _peak_phase;
         void init_peaks();
 
     public:
         SMSPartialTracking();
         ~SMSPartialTracking();
+        PartialTracking* clone();
         void reset();
+        std::string parameters();
         using PartialTracking::max_partials;
         void max_partials(int new_max_partials);
         bool realtime();
@@ -127,13 +208,14 @@ class SndObjPartialTracking : public PartialTracking {
         int _num_bins;
         SndObj* _input;
         SinAnal* _analysis;
-        sample* _peak_amplitude;
-        sample* _peak_frequency;
-        sample* _peak_phase;
+        double* _peak_amplitude;
+        double* _peak_frequency;
+        double* _peak_phase;
 
     public:
         SndObjPartialTracking();
         ~SndObjPartialTracking();
+        PartialTracking* clone();
         void reset();
         using PartialTracking::max_partials;
         void max_partials(int new_max_partials);
@@ -164,6 +246,7 @@ class LorisPartialTracking : public PartialTracking {
     public:
         LorisPartialTracking();
         ~LorisPartialTracking();
+        PartialTracking* clone();
         void reset();
         using PartialTracking::max_partials;
         void max_partials(int new_max_partials);
@@ -1,3 +1,5 @@
+#include <sstream>
+
 #include "peak_detection.h"
 
 using namespace std;
@@ -17,21 +19,57 @@ PeakDetection::PeakDetection() {
     _window_type = "hamming";
     _window_size = 2048;
     _min_peak_separation = 1.0; // in Hz
+    _num_threads = 1;
 }
 
 PeakDetection::~PeakDetection() {
     clear();
 }
 
+PeakDetection* PeakDetection::clone() {
+    PeakDetection* pd = new PeakDetection();
+    copy_parameters(pd);
+    return pd;
+}
+
+bool PeakDetection::independent_frames() {
+    return true;
+}
+
+void PeakDetection::copy_parameters(PeakDetection* pd) {
+    pd->sampling_rate(_sampling_rate);
+    pd->static_frame_size(_static_frame_size);
+    pd->frame_size(_frame_size);
+    pd->hop_size(_hop_size);
+    pd->max_peaks(_max_peaks);
+    pd->window_type(_window_type);
+    pd->window_size(_window_size);
+    pd->min_peak_separation(_min_peak_separation);
+}
+
+// Frames from the previous call to find_peaks are kept by the frame pool
+// and reused by the next call
 void PeakDetection::clear() {
-    for(int i = 0; i < _frames.size(); i++) {
-        if(_frames[i]) {
-            delete _frames[i];
-            _frames[i] = NULL;
-        }
+    _frame_pool.release(_frames);
+}
+
+std::string PeakDetection::parameters() {
+    std::ostringstream s;
+    s.precision(17);
+    s << "sampling_rate=" << _sampling_rate << ";"
+      << "static_frame_size=" << _static_frame_size << ";";
+
+    // without a static frame size, the frame size is set by find_peaks
+    if(_static_frame_size) {
+        s << "frame_size=" << _frame_size << ";";
     }
 
-    _frames.clear();
+    s << "hop_size=" << _hop_size << ";"
+      << "max_peaks=" << _max_peaks << ";"
+      << "window_type=" << _window_type << ";"
+      << "window_size=" << _window_size << ";"
+      << "min_peak_separation=" << _min_peak_separation << ";";
+    return s.str();
 }
 
 int PeakDetection::sampling_rate() {
@@ -102,6 +140,21 @@ void PeakDetection::min_peak_separation(sample new_min_peak_separation) {
     _min_peak_separation = new_min_peak_separation;
 }
 
+int PeakDetection::num_threads() {
+    return _num_threads;
+}
+
+void PeakDetection::num_threads(int new_num_threads) {
+    if(new_num_threads < 1) {
+        throw Exception(std::string("Number of threads must be at least 1."));
+    }
+    _num_threads = new_num_threads;
+}
+
+Profile* PeakDetection::profile() {
+    return &_profile;
+}
+
 int PeakDetection::num_frames() {
     return _frames.size();
 }
@@ -118,32 +171,48 @@ void PeakDetection::frames(Frames new_frames) {
     _frames = new_frames;
 }
 
+void PeakDetection::start_signal(int audio_size) {
+}
+
 // Find and return all spectral peaks in a given frame of audio
 void PeakDetection::find_peaks_in_frame(Frame* frame) {
 }
 
+bool PeakDetection::uses_spectrum(Spectrum* spectrum) {
+    return false;
+}
+
+void PeakDetection::find_peaks_in_spectrum(Frame* frame, Spectrum* spectrum) {
+    find_peaks_in_frame(frame);
+}
+
 // Find and return all spectral peaks in a given audio signal.
 // If the signal contains more than 1 frame worth of audio, it will be broken
 // up into separate frames, each containing a std::vector of peaks.
 // Frames* PeakDetection::find_peaks(const samples& audio)
 Frames PeakDetection::find_peaks(int audio_size, sample* audio) {
     clear();
+    start_signal(audio_size);
+
+    if(_num_threads > 1 && _static_frame_size && independent_frames()) {
+        return find_peaks_parallel(audio_size, audio);
+    }
+
     unsigned int pos = 0;
-    bool alloc_memory_in_frame = true;
 
     while(pos <= audio_size - _hop_size) {
         if(!_static_frame_size) {
             _frame_size = next_frame_size();
         }
 
-        Frame* f = new Frame(_frame_size, alloc_memory_in_frame);
+        Frame* f = _frame_pool.acquire(_frame_size);
         f->max_peaks(_max_peaks);
 
         if((int)pos <= (audio_size - _frame_size)) {
-            f->audio(&(audio[pos]), _frame_size);
+            f->audio_view(&(audio[pos]), _frame_size);
         }
         else {
-            f->audio(&(audio[pos]), audio_size - pos);
+            f->audio_view(&(audio[pos]), audio_size - pos);
         }
 
         find_peaks_in_frame(f);
@@ -154,6 +223,119 @@ Frames PeakDetection::find_peaks(int audio_size, sample* audio) {
     return _frames;
 }
 
+// A contiguous range of frames to be analysed by one worker thread
+struct PeakDetectionTask {
+    PeakDetection* pd;
+    Frames* frames;
+    int first_frame;
+    int last_frame;
+    int frame_size;
+    int hop_size;
+    int audio_size;
+    sample* audio;
+    std::string error;
+};
+
+static void* find_peaks_task(void* arg) {
+    PeakDetectionTask* task = (PeakDetectionTask*)arg;
+
+    try {
+        for(int i = task->first_frame; i < task->last_frame; i++) {
+            int pos = i * task->hop_size;
+            Frame* f = (*task->frames)[i];
+
+            if(pos <= (task->audio_size - task->frame_size)) {
+                f->audio_view(&(task->audio[pos]), task->frame_size);
+            }
+            else {
+                f->audio_view(&(task->audio[pos]), task->audio_size - pos);
+            }
+
+            task->pd->find_peaks_in_frame(f);
+        }
+    }
+    catch(std::exception& e) {
+        task->error = e.what();
+    }
+
+    return NULL;
+}
+
+// Multi-threaded version of find_peaks for detectors with a static frame
+// size whose frames can be analysed independently. The frame positions
+// are the same as those visited by the serial loop in find_peaks.
+Frames PeakDetection::find_peaks_parallel(int audio_size, sample* audio) {
+    int num_frames = 0;
+    if(audio_size >= _hop_size) {
+        num_frames = ((audio_size - _hop_size) / _hop_size) + 1;
+    }
+
+    int num_tasks = _num_threads;
+    if(num_tasks > num_frames) {
+        num_tasks = num_frames;
+    }
+
+    // frames are taken from the pool here as it is not thread safe
+    _frames.resize(num_frames);
+    for(int i = 0; i < num_frames; i++) {
+        _frames[i] = _frame_pool.acquire(_frame_size);
+        _frames[i]->max_peaks(_max_peaks);
+    }
+
+    std::vector<PeakDetectionTask> tasks(num_tasks);
+    std::vector<pthread_t> threads(num_tasks);
+
+    int first_frame = 0;
+    for(int i = 0; i < num_tasks; i++) {
+        int frames_in_task = num_frames / num_tasks;
+        if(i < num_frames % num_tasks) {
+            frames_in_task++;
+        }
+
+        tasks[i].pd = clone();
+        tasks[i].pd->start_signal(audio_size);
+        tasks[i].frames = &_frames;
+        tasks[i].first_frame = first_frame;
+        tasks[i].last_frame = first_frame + frames_in_task;
+        tasks[i].frame_size = _frame_size;
+        tasks[i].hop_size = _hop_size;
+        tasks[i].audio_size = audio_size;
+        tasks[i].audio = audio;
+        first_frame += frames_in_task;
+    }
+
+    // tasks whose thread cannot be created are run on the calling thread
+    std::vector<bool> running(num_tasks, false);
+    for(int i = 0; i < num_tasks; i++) {
+        running[i] = pthread_create(&threads[i], NULL, find_peaks_task,
+                                    &tasks[i]) == 0;
+    }
+    for(int i = 0; i < num_tasks; i++) {
+        if(!running[i]) {
+            find_peaks_task(&tasks[i]);
+        }
+    }
+
+    std::string error;
+    for(int i = 0; i < num_tasks; i++) {
+        if(running[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        _profile.add(tasks[i].pd->profile());
+        delete tasks[i].pd;
+        if(error.empty()) {
+            error = tasks[i].error;
+        }
+    }
+
+    if(!error.empty()) {
+        clear();
+        throw Exception(error);
+    }
+
+    return _frames;
+}
+
 
 // ---------------------------------------------------------------------------
 // MQPeakDetection
@@ -166,10 +348,22 @@ MQPeakDetection::MQPeakDetection() {
     _mq_params.matching_interval = 100.0;
     _mq_params.fundamental = 44100.0 / _frame_size;
     init_mq(&_mq_params);
+    mq_init_peak_array(&_peaks, _mq_params.num_bins);
 }
 
 MQPeakDetection::~MQPeakDetection() {
     destroy_mq(&_mq_params);
+    mq_destroy_peak_array(&_peaks);
+}
+
+PeakDetection* MQPeakDetection::clone() {
+    MQPeakDetection* pd = new MQPeakDetection();
+    copy_parameters(pd);
+    return pd;
+}
+
+bool MQPeakDetection::independent_frames() {
+    return true;
 }
 
 void MQPeakDetection::reset() {
@@ -180,6 +374,7 @@ void MQPeakDetection::reset() {
     _mq_params.num_bins = (_frame_size / 2) + 1;
     _mq_params.fundamental = 44100.0 / _frame_size;
     init_mq(&_mq_params);
+    mq_init_peak_array(&_peaks, _mq_params.num_bins);
 }
 
 void MQPeakDetection::frame_size(int new_frame_size) {
@@ -197,20 +392,46 @@ void MQPeakDetection::max_peaks(int new_max_peaks) {
 }
 
 void MQPeakDetection::find_peaks_in_frame(Frame* frame) {
-    MQPeakList* pl = mq_find_peaks(_frame_size, frame->audio(), &_mq_params);
-    MQPeakList* pl_start = pl;
-
-    int num_peaks = 0;
-    while(pl && pl->peak && num_peaks < _max_peaks) {
-        frame->add_peak(pl->peak->amplitude,
-                        pl->peak->frequency,
-                        pl->peak->phase,
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
+    int num_peaks = mq_find_peak_array(_frame_size, frame->audio(),
+                                       &_mq_params, &_peaks);
+
+    for(int i = 0; i < num_peaks && i < _max_peaks; i++) {
+        frame->add_peak(_peaks.peaks[i].amplitude,
+                        _peaks.peaks[i].frequency,
+                        _peaks.peaks[i].phase,
                         0.0);
-        pl = pl->next;
-        num_peaks++;
     }
+}
 
-    delete_peak_list(pl_start);
+// The MQ spectrum is a Hamming window of the frame size normalised by its
+// sum, which is the same as a Spectrum of that size and window type
+bool MQPeakDetection::uses_spectrum(Spectrum* spectrum) {
+    return spectrum->size() == _frame_size &&
+           spectrum->window_type() == "hamming";
+}
+
+void MQPeakDetection::find_peaks_in_spectrum(Frame* frame,
+                                             Spectrum* spectrum) {
+    if(!uses_spectrum(spectrum)) {
+        find_peaks_in_frame(frame);
+        return;
+    }
+
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
+    int num_peaks = mq_find_spectrum_peak_array(spectrum->num_bins(),
+                                                spectrum->magnitudes(),
+                                                spectrum->phases(),
+                                                &_mq_params, &_peaks);
+
+    for(int i = 0; i < num_peaks && i < _max_peaks; i++) {
+        frame->add_peak(_peaks.peaks[i].amplitude,
+                        _peaks.peaks[i].frequency,
+                        _peaks.peaks[i].phase,
+                        0.0);
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -253,6 +474,19 @@ SMSPeakDetection::~SMSPeakDetection() {
     sms_free();
 }
 
+PeakDetection* SMSPeakDetection::clone() {
+    SMSPeakDetection* pd = new SMSPeakDetection();
+    copy_parameters(pd);
+    pd->realtime(realtime());
+    return pd;
+}
+
+// SMS keeps a buffer of previous audio and uses the fundamental frequency
+// of previous frames when analysing the current one.
+bool SMSPeakDetection::independent_frames() {
+    return false;
+}
+
 int SMSPeakDetection::next_frame_size() {
     return _analysis_params.sizeNextRead;
 }
@@ -286,6 +520,13 @@ void SMSPeakDetection::max_peaks(int new_max_peaks) {
     sms_initSpectralPeaks(&_peaks, _max_peaks);
 }
 
+std::string SMSPeakDetection::parameters() {
+    std::ostringstream s;
+    s << PeakDetection::parameters()
+      << "realtime=" << realtime() << ";";
+    return s.str();
+}
+
 int SMSPeakDetection::realtime() {
     return _analysis_params.realtime;
 }
@@ -294,9 +535,18 @@ void SMSPeakDetection::realtime(int new_realtime) {
     _analysis_params.realtime = new_realtime;
 }
 
+// SMS stops finding peaks once a frame reaches the end of the sound
+void SMSPeakDetection::start_signal(int audio_size) {
+    _analysis_params.iSizeSound = audio_size;
+}
+
 // Find and return all spectral peaks in a given frame of audio
 void SMSPeakDetection::find_peaks_in_frame(Frame* frame) {
-    int num_peaks = sms_findPeaks(frame->size(), frame->audio(),
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
+    int num_peaks = sms_findPeaks(frame->size(),
+                                  double_input(frame->size(), frame->audio(),
+                                               _double_audio),
                                   &_analysis_params, &_peaks);
 
     for(int i = 0; i < num_peaks; i++) {
@@ -313,24 +563,22 @@ void SMSPeakDetection::find_peaks_in_frame(Frame* frame) {
 // peaks returned for each frame.
 Frames SMSPeakDetection::find_peaks(int audio_size, sample* audio) {
     clear();
+    start_signal(audio_size);
     unsigned int pos = 0;
-    bool alloc_memory_in_frame = true;
-
-    _analysis_params.iSizeSound = audio_size;
 
     while(pos <= audio_size - _hop_size) {
         if(!_static_frame_size) {
             _frame_size = next_frame_size();
         }
 
-        Frame* f = new Frame(_frame_size, alloc_memory_in_frame);
+        Frame* f = _frame_pool.acquire(_frame_size);
         f->max_peaks(_max_peaks);
 
         if((int)pos <= (audio_size - _frame_size)) {
-            f->audio(&(audio[pos]), _frame_size);
+            f->audio_view(&(audio[pos]), _frame_size);
         }
         else {
-            f->audio(&(audio[pos]), audio_size - pos);
+            f->audio_view(&(audio[pos]), audio_size - pos);
         }
 
         find_peaks_in_frame(f);
@@ -379,6 +627,19 @@ SndObjPeakDetection::~SndObjPeakDetection() {
     }
 }
 
+PeakDetection* SndObjPeakDetection::clone() {
+    SndObjPeakDetection* pd = new SndObjPeakDetection();
+    pd->_threshold = _threshold;
+    copy_parameters(pd);
+    return pd;
+}
+
+// IFGram analyses overlapping frames built from previous hops of audio,
+// and unwraps the phase of each bin from one frame to the next.
+bool SndObjPeakDetection::independent_frames() {
+    return false;
+}
+
 void SndObjPeakDetection::reset() {
     if(_input) {
         delete _input;
@@ -416,7 +677,11 @@ void SndObjPeakDetection::max_peaks(int new_max_peaks) {
 }
 
 void SndObjPeakDetection::find_peaks_in_frame(Frame* frame) {
-    _input->PushIn(frame->audio(), frame->size());
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
+    _input->PushIn(double_input(frame->size(), frame->audio(),
+                                _double_audio),
+                   frame->size());
     _ifgram->DoProcess();
     int num_peaks = _analysis->FindPeaks();
 
@@ -449,6 +714,9 @@ SimplLorisAnalyzer::SimplLorisAnalyzer(int window_size, sample resolution,
     m_cropTime = 2 * hop_size;
     _peak_selector = new Loris::SpectralPeakSelector(sampling_rate, m_cropTime);
 
+    // at most one peak per bin in the lower half of the spectrum
+    peaks.reserve(_spectrum->size() / 2);
+
     if(m_bwAssocParam > 0) {
         _bw_associator.reset(new Loris::AssociateBandwidth(bwRegionWidth(), sampling_rate));
     }
@@ -459,14 +727,13 @@ SimplLorisAnalyzer::~SimplLorisAnalyzer() {
     delete _peak_selector;
 }
 
-void SimplLorisAnalyzer::analyze(int audio_size, sample* audio) {
+void SimplLorisAnalyzer::analyze(int audio_size, double* audio) {
     m_ampEnvBuilder->reset();
     m_f0Builder->reset();
     m_partials.clear();
-    peaks.clear();
 
     _spectrum->transform(audio, audio + (audio_size / 2), audio + audio_size);
-    peaks = _peak_selector->selectPeaks(*_spectrum, m_freqFloor);
+    _peak_selector->selectPeaks(*_spectrum, m_freqFloor, peaks);
 
     fixBandwidth(peaks);
     if(m_bwAssocParam > 0) {
@@ -488,6 +755,18 @@ LorisPeakDetection::~LorisPeakDetection() {
     }
 }
 
+PeakDetection* LorisPeakDetection::clone() {
+    LorisPeakDetection* pd = new LorisPeakDetection();
+    copy_parameters(pd);
+    pd->_resolution = _resolution;
+    pd->reset();
+    return pd;
+}
+
+bool LorisPeakDetection::independent_frames() {
+    return true;
+}
+
 void LorisPeakDetection::reset() {
     if(_analyzer) {
         delete _analyzer;
@@ -513,7 +792,11 @@ void LorisPeakDetection::max_peaks(int new_max_peaks) {
 }
 
 void LorisPeakDetection::find_peaks_in_frame(Frame* frame) {
-    _analyzer->analyze(frame->size(), frame->audio());
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
+    _analyzer->analyze(frame->size(),
+                       double_input(frame->size(), frame->audio(),
+                                    _double_audio));
 
     int num_peaks = _analyzer->peaks.size();
     if(num_peaks > _max_peaks) {
@@ -527,3 +810,116 @@ void LorisPeakDetection::find_peaks_in_frame(Frame* frame) {
                         _analyzer->peaks[i].bandwidth());
     }
 }
+
+
+// ---------------------------------------------------------------------------
+// MultiPeakDetection
+// ---------------------------------------------------------------------------
+MultiPeakDetection::MultiPeakDetection() {
+}
+
+MultiPeakDetection::~MultiPeakDetection() {
+    clear();
+}
+
+void MultiPeakDetection::clear() {
+    for(int i = 0; i < _frames.size(); i++) {
+        _frame_pool.release(_frames[i]);
+    }
+    _frames.clear();
+}
+
+void MultiPeakDetection::add(PeakDetection* peak_detection) {
+    _peak_detection.push_back(peak_detection);
+}
+
+int MultiPeakDetection::num_detectors() {
+    return _peak_detection.size();
+}
+
+PeakDetection* MultiPeakDetection::detector(int n) {
+    return _peak_detection[n];
+}
+
+Spectrum* MultiPeakDetection::spectrum() {
+    return &_spectrum;
+}
+
+Frames MultiPeakDetection::frames(int n) {
+    return _frames[n];
+}
+
+std::vector<Frames> MultiPeakDetection::find_peaks(int audio_size,
+                                                   sample* audio) {
+    clear();
+
+    int num_detectors = _peak_detection.size();
+    if(num_detectors == 0) {
+        return _frames;
+    }
+
+    PeakDetection* first = _peak_detection[0];
+    int frame_size = first->frame_size();
+    int hop_size = first->hop_size();
+
+    for(int i = 0; i < num_detectors; i++) {
+        if(!_peak_detection[i]->static_frame_size()) {
+            throw Exception(std::string("Peak detectors must have a static "
+                                        "frame size."));
+        }
+        if(_peak_detection[i]->frame_size() != frame_size ||
+           _peak_detection[i]->hop_size() != hop_size) {
+            throw Exception(std::string("Peak detectors must have the same "
+                                        "frame size and hop size."));
+        }
+    }
+
+    if(_spectrum.size() != frame_size) {
+        _spectrum.size(frame_size);
+    }
+    if(_spectrum.sampling_rate() != first->sampling_rate()) {
+        _spectrum.sampling_rate(first->sampling_rate());
+    }
+    if(_spectrum.window_type() != first->window_type()) {
+        _spectrum.window_type(first->window_type());
+    }
+
+    // only compute the spectrum if a detector uses it
+    bool use_spectrum = false;
+    for(int i = 0; i < num_detectors; i++) {
+        if(_peak_detection[i]->uses_spectrum(&_spectrum)) {
+            use_spectrum = true;
+        }
+    }
+
+    for(int i = 0; i < num_detectors; i++) {
+        _peak_detection[i]->start_signal(audio_size);
+    }
+
+    _frames.resize(num_detectors);
+    unsigned int pos = 0;
+
+    while(pos <= audio_size - hop_size) {
+        int view_size = frame_size;
+        if((int)pos > (audio_size - frame_size)) {
+            view_size = audio_size - pos;
+        }
+
+        for(int i = 0; i < num_detectors; i++) {
+            Frame* f = _frame_pool.acquire(frame_size);
+            f->max_peaks(_peak_detection[i]->max_peaks());
+            f->audio_view(&(audio[pos]), view_size);
+
+            if(i == 0 && use_spectrum) {
+                _spectrum.analyse(f);
+            }
+
+            _peak_detection[i]->find_peaks_in_spectrum(f, &_spectrum);
+            _frames[i].push_back(f);
+        }
+
+        pos += hop_size;
+    }
+
+    return _frames;
+}
@@ -1,7 +1,11 @@
 #ifndef PEAK_DETECTION_H
 #define PEAK_DETECTION_H
 
+#include <pthread.h>
+
 #include "base.h"
+#include "profile.h"
+#include "spectrum.h"
 
 #include "mq.h"
 #include "twm.h"
@@ -46,13 +50,35 @@ class PeakDetection {
         std::string _window_type;
         int _window_size;
         sample _min_peak_separation;
+        int _num_threads;
         Frames _frames;
+        FramePool _frame_pool;
+        Profile _profile;
+
+        // frame audio for double precision libraries, see double_input
+        std::vector<double> _double_audio;
+
+        void copy_parameters(PeakDetection* pd);
+        Frames find_peaks_parallel(int audio_size, sample* audio);
 
     public:
         PeakDetection();
         virtual ~PeakDetection();
         void clear();
 
+        // The parameters that affect the peaks found by this detector, as
+        // "name=value;" pairs. Detectors with the same parameters find the
+        // same peaks in the same audio.
+        virtual std::string parameters();
+
+        // Return a new detector with the same parameters as this one but
+        // with its own analysis state. The caller owns the returned object.
+        virtual PeakDetection* clone();
+
+        // True if the peaks found in a frame depend only on the audio in
+        // that frame, so that frames can be analysed in any order.
+        virtual bool independent_frames();
+
         virtual int sampling_rate();
         virtual void sampling_rate(int new_sampling_rate);
         virtual int frame_size();
@@ -70,18 +96,45 @@ class PeakDetection {
         virtual void window_size(int new_window_size);
         virtual sample min_peak_separation();
         virtual void min_peak_separation(sample new_min_peak_separation);
+        int num_threads();
+        void num_threads(int new_num_threads);
+
+        // Statistics for the frames processed by this object, see Profile
+        Profile* profile();
+
         int num_frames();
         Frame* frame(int frame_number);
         Frames frames();
         void frames(Frames new_frames);
 
+        // Prepare to find the peaks in the frames of a signal of
+        // audio_size samples. Called by find_peaks (and by
+        // MultiPeakDetection) before the first frame of each signal.
+        virtual void start_signal(int audio_size);
+
         // Find and return all spectral peaks in a given frame of audio
         virtual void find_peaks_in_frame(Frame* frame);
 
+        // True if find_peaks_in_spectrum can find the peaks of a frame from
+        // spectrum (which must have the frame size and window type of this
+        // detector) without computing its own spectrum.
+        virtual bool uses_spectrum(Spectrum* spectrum);
+
+        // Find the spectral peaks in frame, given the spectrum of its audio.
+        // Detectors that do not use the spectrum call find_peaks_in_frame.
+        virtual void find_peaks_in_spectrum(Frame* frame, Spectrum* spectrum);
+
         // Find and return all spectral peaks in a given audio signal.
         // If the signal contains more than 1 frame worth of audio, it will be
         // broken up into separate frames, with an array of peaks returned for
-        // each frame
+        // each frame.
+        // If num_threads is greater than 1, the frame size is static and
+        // the detector has independent frames, the frames are split into
+        // contiguous ranges and analysed by that many threads, each with its
+        // own clone of this detector. The result is the same as a serial run.
+        // The frame audio is a view into the given signal (see
+        // Frame::audio_view), so it must not be freed while the returned
+        // frames are in use, and find_peaks_in_frame must not modify it.
         virtual Frames find_peaks(int audio_size, sample* audio);
 };
 
@@ -92,11 +145,14 @@ class PeakDetection {
 class MQPeakDetection : public PeakDetection {
     private:
         MQParameters _mq_params;
+        MQPeakArray _peaks;
         void reset();
 
     public:
         MQPeakDetection();
         ~MQPeakDetection();
+        PeakDetection* clone();
+        bool independent_frames();
         using PeakDetection::frame_size;
         void frame_size(int new_frame_size);
         using PeakDetection::hop_size;
@@ -104,6 +160,8 @@ class MQPeakDetection : public PeakDetection {
         using PeakDetection::max_peaks;
         void max_peaks(int new_max_peaks);
         void find_peaks_in_frame(Frame* frame);
+        bool uses_spectrum(Spectrum* spectrum);
+        void find_peaks_in_spectrum(Frame* frame, Spectrum* spectrum);
 };
 
 
@@ -118,6 +176,8 @@ class SMSPeakDetection : public PeakDetection {
     public:
         SMSPeakDetection();
         ~SMSPeakDetection();
+        PeakDetection* clone();
+        bool independent_frames();
         int next_frame_size();
         using PeakDetection::frame_size;
         void frame_size(int new_frame_size);
@@ -125,8 +185,10 @@ class SMSPeakDetection : public PeakDetection {
         void hop_size(int new_hop_size);
         using PeakDetection::max_peaks;
         void max_peaks(int new_max_peaks);
+        std::string parameters();
         int realtime();
         void realtime(int new_realtime);
+        void start_signal(int audio_size);
         void find_peaks_in_frame(Frame* frame);
         Frames find_peaks(int audio_size, sample* audio);
 };
@@ -147,6 +209,8 @@ class SndObjPeakDetection : public PeakDetection {
     public:
         SndObjPeakDetection();
         ~SndObjPeakDetection();
+        PeakDetection* clone();
+        bool independent_frames();
         using PeakDetection::frame_size;
         void frame_size(int new_frame_size);
         using PeakDetection::hop_size;
@@ -162,9 +226,9 @@ class SndObjPeakDetection : public PeakDetection {
 // ---------------------------------------------------------------------------
 class SimplLorisAnalyzer : public Loris::Analyzer {
     protected:
-        sample _window_shape;
-        std::vector<sample> _window;
-        std::vector<sample> _window_deriv;
+        double _window_shape;
+        std::vector<double> _window;
+        std::vector<double> _window_deriv;
         Loris::ReassignedSpectrum* _spectrum;
         Loris::SpectralPeakSelector* _peak_selector;
         std::auto_ptr<Loris::AssociateBandwidth> _bw_associator;
@@ -174,7 +238,7 @@ class SimplLorisAnalyzer : public Loris::Analyzer {
                            int hop_size, sample sampling_rate);
         ~SimplLorisAnalyzer();
         Loris::Peaks peaks;
-        void analyze(int audio_size, sample* audio);
+        void analyze(int audio_size, double* audio);
 };
 
 
@@ -187,6 +251,8 @@ class LorisPeakDetection : public PeakDetection {
     public:
         LorisPeakDetection();
         ~LorisPeakDetection();
+        PeakDetection* clone();
+        bool independent_frames();
         using PeakDetection::frame_size;
         void frame_size(int new_frame_size);
         using PeakDetection::hop_size;
@@ -197,6 +263,45 @@ class LorisPeakDetection : public PeakDetection {
 };
 
 
+// ---------------------------------------------------------------------------
+// MultiPeakDetection
+//
+// Runs several peak detectors over the same audio, computing the spectrum
+// of each frame once and passing it to every detector (see
+// PeakDetection::find_peaks_in_spectrum). Detectors that cannot use the
+// shared spectrum analyse the frame themselves, so the peaks found by each
+// detector are the same as those found by its own find_peaks.
+//
+// The detectors (which are not owned by this object) must have the same
+// static frame size and hop size. The spectrum has the frame size,
+// sampling rate and window type of the first detector.
+// ---------------------------------------------------------------------------
+class MultiPeakDetection {
+    protected:
+        std::vector<PeakDetection*> _peak_detection;
+        Spectrum _spectrum;
+        FramePool _frame_pool;
+        std::vector<Frames> _frames;
+
+    public:
+        MultiPeakDetection();
+        ~MultiPeakDetection();
+        void clear();
+
+        void add(PeakDetection* peak_detection);
+        int num_detectors();
+        PeakDetection* detector(int n);
+        Spectrum* spectrum();
+        Frames frames(int n);
+
+        // Find the peaks in audio with every detector. Returns the frames of
+        // each detector, in the order that they were added. The frames are
+        // owned by this object and are valid until the next call to
+        // find_peaks, and their audio is a view into the given signal.
+        std::vector<Frames> find_peaks(int audio_size, sample* audio);
+};
+
+
 } // end of namespace simpl
 
 #endif
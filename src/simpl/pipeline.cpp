@@ -0,0 +1,115 @@
+#include <sstream>
+#include <stdint.h>
+
+#include "pipeline.h"
+
+using namespace std;
+using namespace simpl;
+
+
+// ---------------------------------------------------------------------------
+// Pipeline
+// ---------------------------------------------------------------------------
+Pipeline::Pipeline(PeakDetection* peak_detection,
+                   PartialTracking* partial_tracking,
+                   Synthesis* synthesis) {
+    _peak_detection = peak_detection;
+    _partial_tracking = partial_tracking;
+    _synthesis = synthesis;
+    _peak_detection_runs = 0;
+    _partial_tracking_runs = 0;
+    _synthesis_runs = 0;
+}
+
+Pipeline::~Pipeline() {
+}
+
+void Pipeline::invalidate() {
+    _frames.clear();
+    _peaks_key.clear();
+    _partials_key.clear();
+    _synth_key.clear();
+}
+
+Frames Pipeline::frames() {
+    return _frames;
+}
+
+int Pipeline::peak_detection_runs() {
+    return _peak_detection_runs;
+}
+
+int Pipeline::partial_tracking_runs() {
+    return _partial_tracking_runs;
+}
+
+int Pipeline::synthesis_runs() {
+    return _synthesis_runs;
+}
+
+// FNV-1a hash of the bytes of the audio
+static uint64_t audio_hash(int audio_size, sample* audio) {
+    uint64_t hash = 14695981039346656037ULL;
+    unsigned char* bytes = (unsigned char*)audio;
+    size_t num_bytes = sizeof(sample) * audio_size;
+
+    for(size_t i = 0; i < num_bytes; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+Frames Pipeline::process(int audio_size, sample* audio) {
+    std::ostringstream audio_key;
+    audio_key << "audio=" << (void*)audio << ","
+              << audio_size << ","
+              << audio_hash(audio_size, audio) << ";";
+
+    std::string peaks_key = audio_key.str() + _peak_detection->parameters();
+    if(peaks_key != _peaks_key) {
+        invalidate();
+        _frames = _peak_detection->find_peaks(audio_size, audio);
+        _peak_detection_runs++;
+        _peaks_key = peaks_key;
+    }
+
+    std::string partials_key = _peaks_key + "|" +
+                               _partial_tracking->parameters();
+    if(partials_key != _partials_key) {
+        _synth_key.clear();
+
+        for(int i = 0; i < _frames.size(); i++) {
+            _frames[i]->clear_partials();
+        }
+
+        PartialTracking* pt = _partial_tracking->clone();
+        try {
+            pt->find_partials(_frames);
+        }
+        catch(...) {
+            delete pt;
+            _partials_key.clear();
+            throw;
+        }
+        _partial_tracking->profile()->add(pt->profile());
+        delete pt;
+
+        _partial_tracking_runs++;
+        _partials_key = partials_key;
+    }
+
+    if(_synthesis) {
+        std::string synth_key = _partials_key + "|" +
+                                _synthesis->parameters();
+        if(synth_key != _synth_key) {
+            _synth_key.clear();
+            _synthesis->reset();
+            _synthesis->synth(_frames);
+            _synthesis_runs++;
+            _synth_key = synth_key;
+        }
+    }
+
+    return _frames;
+}
@@ -0,0 +1,75 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <string>
+
+#include "base.h"
+#include "peak_detection.h"
+#include "partial_tracking.h"
+#include "synthesis.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// Pipeline
+//
+// Offline analysis (and optionally synthesis) of a signal that keeps the
+// output of each stage, so that calling process() again only runs the
+// stages whose input or parameters have changed. After changing a partial
+// tracking parameter such as max_gap, only partial tracking and synthesis
+// are run again, with the peaks found by the previous call.
+//
+// The output of each stage is keyed by the parameters of its object (see
+// PeakDetection::parameters) and by the key of the stage before it. The
+// peaks are also keyed by the address, size and contents of the audio.
+//
+// The objects given to the pipeline are not owned by it. The frames are
+// owned by the peak detection object, as with find_peaks, so invalidate()
+// must be called if find_peaks or clear is called on it directly. Each
+// partial tracking run uses a new clone of the tracker, as reset() does not
+// clear the tracks of every backend, and its statistics are added to the
+// tracker's profile. Synthesis is reset before each run.
+// ---------------------------------------------------------------------------
+class Pipeline {
+    protected:
+        PeakDetection* _peak_detection;
+        PartialTracking* _partial_tracking;
+        Synthesis* _synthesis;
+        Frames _frames;
+
+        // keys of the cached output of each stage, empty if not cached
+        std::string _peaks_key;
+        std::string _partials_key;
+        std::string _synth_key;
+
+        int _peak_detection_runs;
+        int _partial_tracking_runs;
+        int _synthesis_runs;
+
+    public:
+        Pipeline(PeakDetection* peak_detection,
+                 PartialTracking* partial_tracking,
+                 Synthesis* synthesis=NULL);
+        ~Pipeline();
+
+        // Discard the cached output of every stage
+        void invalidate();
+
+        Frames frames();
+
+        // The number of times that each stage has been run
+        int peak_detection_runs();
+        int partial_tracking_runs();
+        int synthesis_runs();
+
+        // Find the peaks and partials in audio (and synthesise them), only
+        // running the stages whose output is not already cached. Returns
+        // the same frames as find_peaks, find_partials and synth would.
+        Frames process(int audio_size, sample* audio);
+};
+
+} // end of namespace simpl
+
+#endif
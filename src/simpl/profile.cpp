@@ -0,0 +1,193 @@
+#include <cstdlib>
+#include <new>
+#include <time.h>
+
+#include "profile.h"
+
+using namespace simpl;
+
+
+// ---------------------------------------------------------------------------
+// Allocation counting
+// ---------------------------------------------------------------------------
+#if defined(SIMPL_PROFILE) && !defined(SIMPL_PROFILE_NO_ALLOCATIONS)
+
+#if __cplusplus >= 201103L
+    #define PROFILE_THROW noexcept(false)
+    #define PROFILE_NOTHROW noexcept
+#else
+    #define PROFILE_THROW throw(std::bad_alloc)
+    #define PROFILE_NOTHROW throw()
+#endif
+
+static __thread long num_thread_allocations = 0;
+static __thread long num_thread_deallocations = 0;
+
+static void* counted_alloc(std::size_t size) {
+    num_thread_allocations++;
+
+    void* p = malloc(size ? size : 1);
+    if(!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+static void counted_free(void* p) {
+    if(p) {
+        num_thread_deallocations++;
+    }
+    free(p);
+}
+
+void* operator new(std::size_t size) PROFILE_THROW {
+    return counted_alloc(size);
+}
+
+void* operator new[](std::size_t size) PROFILE_THROW {
+    return counted_alloc(size);
+}
+
+void operator delete(void* p) PROFILE_NOTHROW {
+    counted_free(p);
+}
+
+void operator delete[](void* p) PROFILE_NOTHROW {
+    counted_free(p);
+}
+
+long simpl::thread_allocations() {
+    return num_thread_allocations;
+}
+
+long simpl::thread_deallocations() {
+    return num_thread_deallocations;
+}
+
+#else
+
+long simpl::thread_allocations() {
+    return 0;
+}
+
+long simpl::thread_deallocations() {
+    return 0;
+}
+
+#endif
+
+bool simpl::profiling_enabled() {
+#ifdef SIMPL_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+double simpl::profile_clock() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + (t.tv_nsec * 1e-9);
+}
+
+
+// ---------------------------------------------------------------------------
+// Profile
+// ---------------------------------------------------------------------------
+Profile::Profile() {
+    reset();
+}
+
+void Profile::reset() {
+    _num_frames = 0;
+    _time = 0.0;
+    _max_time = 0.0;
+    _num_peaks = 0;
+    _num_partials = 0;
+    _num_allocations = 0;
+    _num_deallocations = 0;
+}
+
+void Profile::add_frame(double time, int num_peaks, int num_partials,
+                        long num_allocations, long num_deallocations) {
+    _num_frames++;
+    _time += time;
+    if(time > _max_time) {
+        _max_time = time;
+    }
+    _num_peaks += num_peaks;
+    _num_partials += num_partials;
+    _num_allocations += num_allocations;
+    _num_deallocations += num_deallocations;
+}
+
+void Profile::add(Profile* profile) {
+    _num_frames += profile->_num_frames;
+    _time += profile->_time;
+    if(profile->_max_time > _max_time) {
+        _max_time = profile->_max_time;
+    }
+    _num_peaks += profile->_num_peaks;
+    _num_partials += profile->_num_partials;
+    _num_allocations += profile->_num_allocations;
+    _num_deallocations += profile->_num_deallocations;
+}
+
+int Profile::num_frames() {
+    return _num_frames;
+}
+
+double Profile::time() {
+    return _time;
+}
+
+double Profile::mean_time() {
+    return _num_frames > 0 ? _time / _num_frames : 0.0;
+}
+
+double Profile::max_time() {
+    return _max_time;
+}
+
+long Profile::num_peaks() {
+    return _num_peaks;
+}
+
+double Profile::mean_peaks() {
+    return _num_frames > 0 ? (double)_num_peaks / _num_frames : 0.0;
+}
+
+long Profile::num_partials() {
+    return _num_partials;
+}
+
+double Profile::mean_partials() {
+    return _num_frames > 0 ? (double)_num_partials / _num_frames : 0.0;
+}
+
+long Profile::num_allocations() {
+    return _num_allocations;
+}
+
+long Profile::num_deallocations() {
+    return _num_deallocations;
+}
+
+
+// ---------------------------------------------------------------------------
+// ProfileScope
+// ---------------------------------------------------------------------------
+ProfileScope::ProfileScope(Profile* profile, Frame* frame) {
+    _profile = profile;
+    _frame = frame;
+    _allocations = thread_allocations();
+    _deallocations = thread_deallocations();
+    _start = profile_clock();
+}
+
+ProfileScope::~ProfileScope() {
+    double time = profile_clock() - _start;
+    _profile->add_frame(time, _frame->num_peaks(), _frame->num_partials(),
+                        thread_allocations() - _allocations,
+                        thread_deallocations() - _deallocations);
+}
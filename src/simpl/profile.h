@@ -0,0 +1,111 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "base.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// Profile
+//
+// Per-frame statistics for one peak detection, partial tracking, synthesis
+// or residual object: the number of frames processed, the wall clock time
+// spent on them, the number of peaks and partials in each frame afterwards
+// and the number of memory allocations made while processing them.
+//
+// Frames are only recorded when the library is built with SIMPL_PROFILE
+// defined (cmake -D SIMPL_PROFILE=yes). Otherwise the instrumentation is
+// compiled out, every statistic stays at 0 and profiling_enabled() returns
+// false. The layout of the class is the same in both builds.
+//
+// Allocations are counted by replacing the global operator new and delete
+// in profiling builds. Memory allocated directly with malloc (as by libsms)
+// is not counted. Builds that also define SIMPL_PROFILE_NO_ALLOCATIONS keep
+// the global operators and always count 0 allocations. The Python modules
+// are built this way, as each module links its own copy of this file.
+//
+// A Profile is not thread safe. Analysis objects used from several threads
+// at once (see PeakDetection::find_peaks) record into their own clones, and
+// the clone profiles are added together when the threads have finished.
+// ---------------------------------------------------------------------------
+class Profile {
+    private:
+        int _num_frames;
+        double _time;
+        double _max_time;
+        long _num_peaks;
+        long _num_partials;
+        long _num_allocations;
+        long _num_deallocations;
+
+    public:
+        Profile();
+        void reset();
+
+        // Record one frame, taking time seconds
+        void add_frame(double time, int num_peaks, int num_partials,
+                       long num_allocations, long num_deallocations);
+
+        // Add the statistics of another profile to this one
+        void add(Profile* profile);
+
+        int num_frames();
+
+        // Times are in seconds
+        double time();
+        double mean_time();
+        double max_time();
+
+        long num_peaks();
+        double mean_peaks();
+        long num_partials();
+        double mean_partials();
+        long num_allocations();
+        long num_deallocations();
+};
+
+// True if the library was built with SIMPL_PROFILE
+bool profiling_enabled();
+
+// Seconds from an arbitrary fixed point, from a monotonic clock
+double profile_clock();
+
+// The number of allocations and deallocations made by the calling thread
+// since it started. Always 0 unless profiling is enabled.
+long thread_allocations();
+long thread_deallocations();
+
+
+// ---------------------------------------------------------------------------
+// ProfileScope
+//
+// Records the frame into profile when the scope ends, with the time and the
+// allocations made since the scope started. Use SIMPL_PROFILE_FRAME at the
+// start of a per-frame method, so that it is removed from builds without
+// SIMPL_PROFILE.
+// ---------------------------------------------------------------------------
+class ProfileScope {
+    private:
+        Profile* _profile;
+        Frame* _frame;
+        double _start;
+        long _allocations;
+        long _deallocations;
+
+    public:
+        ProfileScope(Profile* profile, Frame* frame);
+        ~ProfileScope();
+};
+
+#ifdef SIMPL_PROFILE
+#define SIMPL_PROFILE_FRAME(profile, frame) \
+    simpl::ProfileScope _profile_scope(profile, frame)
+#else
+#define SIMPL_PROFILE_FRAME(profile, frame)
+#endif
+
+} // end of namespace simpl
+
+#endif
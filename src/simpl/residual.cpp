@@ -18,14 +18,7 @@ Residual::~Residual() {
 }
 
 void Residual::clear() {
-    for(int i = 0; i < _frames.size(); i++) {
-        if(_frames[i]) {
-            delete _frames[i];
-            _frames[i] = NULL;
-        }
-    }
-
-    _frames.clear();
+    _frame_pool.release(_frames);
 }
 
 void Residual::reset() {
@@ -55,6 +48,10 @@ void Residual::sampling_rate(int new_sampling_rate) {
     _sampling_rate = new_sampling_rate;
 }
 
+Profile* Residual::profile() {
+    return &_profile;
+}
+
 void Residual::residual_frame(Frame* frame) {
 }
 
@@ -77,16 +74,15 @@ Frames Residual::synth(Frames& frames) {
 Frames Residual::synth(int original_size, sample* original) {
     clear();
     unsigned int pos = 0;
-    bool alloc_memory_in_frame = true;
 
     while(pos <= original_size - _hop_size) {
-        Frame* f = new Frame(_frame_size, alloc_memory_in_frame);
+        Frame* f = _frame_pool.acquire(_frame_size);
 
         if((int)pos <= (original_size - _frame_size)) {
-            f->audio(&(original[pos]), _frame_size);
+            f->audio_view(&(original[pos]), _frame_size);
         }
         else {
-            f->audio(&(original[pos]), original_size - pos);
+            f->audio_view(&(original[pos]), original_size - pos);
         }
 
         synth_frame(f);
@@ -151,6 +147,8 @@ void SMSResidual::num_stochastic_coeffs(int new_num_stochastic_coeffs) {
 }
 
 void SMSResidual::residual_frame(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     frame->clear_peaks();
     frame->clear_partials();
     frame->clear_synth();
@@ -159,8 +157,12 @@ void SMSResidual::residual_frame(Frame* frame) {
     _pt.update_partials(frame);
     _synth.synth_frame(frame);
 
-    sms_findResidual(_hop_size, frame->synth(),
-                     _hop_size, &(frame->audio()[frame->size() - _hop_size]),
+    sms_findResidual(_hop_size,
+                     double_input(_hop_size, frame->synth(), _double_synth),
+                     _hop_size,
+                     double_input(_hop_size,
+                                  &(frame->audio()[frame->size() - _hop_size]),
+                                  _double_audio),
                      &_residual_params);
 
     for(int i = 0; i < frame->synth_size(); i++) {
@@ -171,9 +173,15 @@ void SMSResidual::residual_frame(Frame* frame) {
 // Calculate and return one frame of the synthesised residual signal
 void SMSResidual::synth_frame(Frame* frame) {
     residual_frame(frame);
-    sms_approxResidual(_hop_size, frame->residual(),
-                       _hop_size, frame->synth_residual(),
+    double* synth_residual = double_output(_hop_size,
+                                           frame->synth_residual(),
+                                           _double_synth);
+    sms_approxResidual(_hop_size,
+                       double_input(_hop_size, frame->residual(),
+                                    _double_audio),
+                       _hop_size, synth_residual,
                        &_residual_params);
+    copy_double_output(_hop_size, synth_residual, frame->synth_residual());
 
     // SMS stochastic component is currently a bit loud so scaled here
     for(int i = 0; i < frame->synth_size(); i++) {
@@ -2,6 +2,7 @@
 #define RESIDUAL_H
 
 #include "base.h"
+#include "profile.h"
 #include "peak_detection.h"
 #include "partial_tracking.h"
 #include "synthesis.h"
@@ -28,12 +29,14 @@ class Residual {
         int _hop_size;
         int _sampling_rate;
         Frames _frames;
+        FramePool _frame_pool;
+        Profile _profile;
 
         void clear();
 
     public:
         Residual();
-        ~Residual();
+        virtual ~Residual();
         virtual void reset();
         int frame_size();
         virtual void frame_size(int new_frame_size);
@@ -42,6 +45,9 @@ class Residual {
         int sampling_rate();
         void sampling_rate(int new_sampling_rate);
 
+        // Statistics for the frames processed by this object, see Profile
+        Profile* profile();
+
         virtual void residual_frame(Frame* frame);
         virtual void find_residual(int synth_size, sample* synth,
                                    int original_size, sample* original,
@@ -49,6 +55,8 @@ class Residual {
 
         virtual void synth_frame(Frame* frame);
         virtual Frames synth(Frames& frames);
+
+        // The frame audio is a view into original, see Frame::audio_view
         virtual Frames synth(int original_size, sample* original);
 };
 
@@ -64,6 +72,10 @@ class SMSResidual : public Residual {
         SMSPartialTracking _pt;
         SMSSynthesis _synth;
 
+        // libsms buffers, see double_input
+        std::vector<double> _double_synth;
+        std::vector<double> _double_audio;
+
     public:
         SMSResidual();
         ~SMSResidual();
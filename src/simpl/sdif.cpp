@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <stdint.h>
+
+#include "sdif.h"
+
+using namespace std;
+using namespace simpl;
+
+
+// ---------------------------------------------------------------------------
+// SDIF encoding
+//
+// SDIF files are big endian. Frames start with a 4 character type, the
+// size of the rest of the frame, the time, a stream ID and the number of
+// matrices. Matrices start with a 4 character type, a data type (the size
+// of a value in the low byte), a row count and a column count, and are
+// padded to a multiple of 8 bytes.
+// ---------------------------------------------------------------------------
+static const int SDIF_FRAME_HEADER_SIZE = 24;
+static const int SDIF_MATRIX_HEADER_SIZE = 16;
+static const int SDIF_FLOAT32 = 0x0004;
+static const int SDIF_FLOAT64 = 0x0008;
+static const int SDIF_STREAM_ID = 1;
+
+// matrices larger than this are assumed to be corrupt
+static const int64_t SDIF_MAX_MATRIX_SIZE = 1 << 30;
+
+static void put_uint32(char* p, uint32_t value) {
+    for(int i = 0; i < 4; i++) {
+        p[i] = (char)(value >> (24 - (8 * i)));
+    }
+}
+
+static void put_float64(char* p, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for(int i = 0; i < 8; i++) {
+        p[i] = (char)(bits >> (56 - (8 * i)));
+    }
+}
+
+static uint32_t get_uint32(const char* p) {
+    uint32_t value = 0;
+    for(int i = 0; i < 4; i++) {
+        value = (value << 8) | (unsigned char)p[i];
+    }
+    return value;
+}
+
+static float get_float32(const char* p) {
+    uint32_t bits = get_uint32(p);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static double get_float64(const char* p) {
+    uint64_t bits = ((uint64_t)get_uint32(p) << 32) | get_uint32(p + 4);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool is_partial_type(const char* type) {
+    return memcmp(type, "1TRC", 4) == 0 || memcmp(type, "RBEP", 4) == 0;
+}
+
+
+// ---------------------------------------------------------------------------
+// SDIFWriter
+// ---------------------------------------------------------------------------
+SDIFWriter::SDIFWriter() {
+    _file = NULL;
+    _bandwidth_enhanced = false;
+    _num_frames = 0;
+    _time = 0.0;
+    _next_index = 1;
+}
+
+SDIFWriter::~SDIFWriter() {
+    if(_file) {
+        fclose(_file);
+    }
+}
+
+void SDIFWriter::write(const std::vector<char>& buffer) {
+    if(fwrite(&buffer[0], 1, buffer.size(), _file) != buffer.size()) {
+        throw Exception(std::string("Could not write to SDIF file ") +
+                        _filename);
+    }
+}
+
+void SDIFWriter::open(const std::string& filename, bool bandwidth_enhanced) {
+    close();
+
+    _file = fopen(filename.c_str(), "wb");
+    if(!_file) {
+        throw Exception(std::string("Could not create SDIF file ") +
+                        filename);
+    }
+
+    _filename = filename;
+    _bandwidth_enhanced = bandwidth_enhanced;
+    _num_frames = 0;
+    _time = 0.0;
+    _indices.clear();
+    _next_index = 1;
+
+    // header frame: size 8, SDIF version 3, standard types version 1
+    std::vector<char> header(16);
+    memcpy(&header[0], "SDIF", 4);
+    put_uint32(&header[4], 8);
+    put_uint32(&header[8], 3);
+    put_uint32(&header[12], 1);
+    write(header);
+}
+
+void SDIFWriter::close() {
+    if(!_file) {
+        return;
+    }
+
+    int error = fclose(_file);
+    _file = NULL;
+    if(error != 0) {
+        throw Exception(std::string("Could not write to SDIF file ") +
+                        _filename);
+    }
+}
+
+bool SDIFWriter::is_open() {
+    return _file != NULL;
+}
+
+bool SDIFWriter::bandwidth_enhanced() {
+    return _bandwidth_enhanced;
+}
+
+int SDIFWriter::num_frames() {
+    return _num_frames;
+}
+
+void SDIFWriter::write_frame(Frame* frame, double time) {
+    if(!_file) {
+        throw Exception(std::string("SDIF file is not open."));
+    }
+    if(_num_frames > 0 && time < _time) {
+        throw Exception(std::string("SDIF frame times must not decrease."));
+    }
+
+    int num_partials = frame->num_partials();
+    sample* amps = frame->partial_amplitudes();
+    sample* freqs = frame->partial_frequencies();
+    sample* phases = frame->partial_phases();
+    sample* bandwidths = frame->partial_bandwidths();
+
+    // a partial gets a new index each time it becomes active
+    if(_indices.size() < num_partials) {
+        _indices.resize(num_partials, 0);
+    }
+    int num_rows = 0;
+    for(int i = 0; i < _indices.size(); i++) {
+        if(i < num_partials && amps[i] > 0) {
+            if(!_indices[i]) {
+                _indices[i] = _next_index++;
+            }
+            num_rows++;
+        }
+        else {
+            _indices[i] = 0;
+        }
+    }
+
+    int num_columns = _bandwidth_enhanced ? 6 : 4;
+    const char* type = _bandwidth_enhanced ? "RBEP" : "1TRC";
+    int data_size = num_rows * num_columns * 8;
+    _buffer.resize(SDIF_FRAME_HEADER_SIZE + SDIF_MATRIX_HEADER_SIZE +
+                   data_size);
+    char* p = &_buffer[0];
+
+    memcpy(p, type, 4);
+    put_uint32(p + 4, 16 + SDIF_MATRIX_HEADER_SIZE + data_size);
+    put_float64(p + 8, time);
+    put_uint32(p + 16, SDIF_STREAM_ID);
+    put_uint32(p + 20, 1);
+    p += SDIF_FRAME_HEADER_SIZE;
+
+    memcpy(p, type, 4);
+    put_uint32(p + 4, SDIF_FLOAT64);
+    put_uint32(p + 8, num_rows);
+    put_uint32(p + 12, num_columns);
+    p += SDIF_MATRIX_HEADER_SIZE;
+
+    for(int i = 0; i < num_partials; i++) {
+        if(!(amps[i] > 0)) {
+            continue;
+        }
+
+        put_float64(p, _indices[i]);
+        put_float64(p + 8, freqs[i]);
+        put_float64(p + 16, amps[i]);
+        put_float64(p + 24, phases[i]);
+        if(_bandwidth_enhanced) {
+            put_float64(p + 32, bandwidths[i]);
+            put_float64(p + 40, 0.0);
+        }
+        p += num_columns * 8;
+    }
+
+    write(_buffer);
+    _time = time;
+    _num_frames++;
+}
+
+
+// ---------------------------------------------------------------------------
+// SDIFReader
+// ---------------------------------------------------------------------------
+SDIFReader::SDIFReader() {
+    _file = NULL;
+    _time = 0.0;
+}
+
+SDIFReader::SDIFReader(const std::string& filename) {
+    _file = NULL;
+    _time = 0.0;
+    open(filename);
+}
+
+SDIFReader::~SDIFReader() {
+    close();
+}
+
+// Reads size bytes into the buffer, returning false if the file ends first
+bool SDIFReader::read(int size) {
+    if(_buffer.size() < size) {
+        _buffer.resize(size);
+    }
+    return size == 0 || fread(&_buffer[0], 1, size, _file) == size;
+}
+
+void SDIFReader::open(const std::string& filename) {
+    close();
+
+    _file = fopen(filename.c_str(), "rb");
+    if(!_file) {
+        throw Exception(std::string("Could not open SDIF file ") + filename);
+    }
+    _filename = filename;
+    _time = 0.0;
+    _partials.clear();
+    _indices.clear();
+    _active.clear();
+    _amplitudes.clear();
+    _frequencies.clear();
+    _phases.clear();
+    _bandwidths.clear();
+
+    // skip any extra header data after the version numbers
+    if(!read(8) || memcmp(&_buffer[0], "SDIF", 4) != 0) {
+        close();
+        throw Exception(filename + std::string(" is not an SDIF file."));
+    }
+    uint32_t header_size = get_uint32(&_buffer[4]);
+    if(header_size < 8 || header_size > SDIF_MAX_MATRIX_SIZE ||
+       !read(header_size)) {
+        close();
+        throw Exception(filename + std::string(" is not an SDIF file."));
+    }
+}
+
+void SDIFReader::close() {
+    if(_file) {
+        fclose(_file);
+    }
+    _file = NULL;
+}
+
+bool SDIFReader::is_open() {
+    return _file != NULL;
+}
+
+double SDIFReader::time() {
+    return _time;
+}
+
+bool SDIFReader::read_frame(Frame* frame) {
+    if(!_file) {
+        throw Exception(std::string("SDIF file is not open."));
+    }
+
+    char header[SDIF_FRAME_HEADER_SIZE];
+
+    while(true) {
+        size_t header_read = fread(header, 1, SDIF_FRAME_HEADER_SIZE, _file);
+        if(header_read == 0 && feof(_file)) {
+            return false;
+        }
+        if(header_read != SDIF_FRAME_HEADER_SIZE) {
+            throw Exception(_filename + std::string(" is corrupt."));
+        }
+
+        bool partials = is_partial_type(header);
+        double time = get_float64(header + 8);
+        int num_matrices = get_uint32(header + 20);
+
+        // rows are read into the partial number that their index has
+        std::fill(_active.begin(), _active.end(), false);
+
+        // matrices are read one at a time rather than skipping whole
+        // frames by their size, as older versions of Loris wrote frame
+        // sizes that are too small
+        for(int m = 0; m < num_matrices; m++) {
+            char matrix[SDIF_MATRIX_HEADER_SIZE];
+            if(fread(matrix, 1, SDIF_MATRIX_HEADER_SIZE, _file) !=
+               SDIF_MATRIX_HEADER_SIZE) {
+                throw Exception(_filename + std::string(" is corrupt."));
+            }
+
+            int data_type = get_uint32(matrix + 4);
+            int64_t num_rows = (int32_t)get_uint32(matrix + 8);
+            int64_t num_columns = (int32_t)get_uint32(matrix + 12);
+            int64_t data_size = (data_type & 0xff) * num_rows * num_columns;
+            if(num_rows < 0 || num_columns < 0 ||
+               data_size > SDIF_MAX_MATRIX_SIZE) {
+                throw Exception(_filename + std::string(" is corrupt."));
+            }
+            if(!read((data_size + 7) & ~(int64_t)7)) {
+                throw Exception(_filename + std::string(" is corrupt."));
+            }
+
+            if(!partials || !is_partial_type(matrix) || num_columns < 4 ||
+               (data_type != SDIF_FLOAT32 && data_type != SDIF_FLOAT64)) {
+                continue;
+            }
+
+            int value_size = data_type & 0xff;
+            for(int row = 0; row < num_rows; row++) {
+                double values[7] = {0};
+                const char* p = &_buffer[row * num_columns * value_size];
+                for(int i = 0; i < num_columns && i < 7; i++) {
+                    if(value_size == 8) {
+                        values[i] = get_float64(p + (i * 8));
+                    }
+                    else {
+                        values[i] = get_float32(p + (i * 4));
+                    }
+                }
+
+                // 7 column 1TRC rows that were resampled by Loris
+                if(values[6] != 0) {
+                    continue;
+                }
+
+                int index = (int)values[0];
+                int partial;
+                std::map<int, int>::iterator found = _partials.find(index);
+                if(found != _partials.end()) {
+                    partial = found->second;
+                }
+                else {
+                    partial = std::find(_indices.begin(), _indices.end(), -1) -
+                              _indices.begin();
+                    if(partial == _indices.size()) {
+                        _indices.push_back(-1);
+                        _active.push_back(false);
+                        _amplitudes.push_back(0);
+                        _frequencies.push_back(0);
+                        _phases.push_back(0);
+                        _bandwidths.push_back(0);
+                    }
+                    _indices[partial] = index;
+                    _partials[index] = partial;
+                }
+
+                _active[partial] = true;
+                _frequencies[partial] = values[1];
+                _amplitudes[partial] = values[2];
+                _phases[partial] = values[3];
+                _bandwidths[partial] = values[4];
+            }
+        }
+
+        if(!partials) {
+            continue;
+        }
+
+        // indices that were not in this frame have ended, and their
+        // partial numbers can be reused
+        for(int i = 0; i < _indices.size(); i++) {
+            if(_indices[i] >= 0 && !_active[i]) {
+                _partials.erase(_indices[i]);
+                _indices[i] = -1;
+            }
+        }
+
+        int num_partials = _indices.size();
+        while(num_partials > 0 && _indices[num_partials - 1] < 0) {
+            num_partials--;
+        }
+        if(frame->max_partials() < num_partials) {
+            frame->max_partials(num_partials);
+        }
+
+        for(int i = 0; i < num_partials; i++) {
+            if(_active[i]) {
+                frame->partial(i, _amplitudes[i], _frequencies[i],
+                               _phases[i], _bandwidths[i]);
+            }
+            else {
+                frame->partial(i, 0.0, 0.0, 0.0, 0.0);
+            }
+        }
+        frame->num_partials(num_partials);
+
+        _time = time;
+        return true;
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef SDIF_H
+#define SDIF_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// SDIFWriter
+//
+// Writes partials to an SDIF file one frame at a time, so that the
+// partials of a long analysis can be saved as they are tracked (for
+// example after each call to update_partials) without keeping every frame
+// in memory.
+//
+// Each frame is written as an SDIF frame with one matrix of float64 rows:
+// index, frequency (Hz), amplitude and phase (the standard 1TRC type), or
+// with bandwidth and a (zero) time offset added in the 6 column RBEP type
+// that Loris uses for bandwidth-enhanced partials. Partials with 0
+// amplitude are inactive and are not written. A partial number that
+// becomes active again is given a new index, so that each index is one
+// continuous partial, as expected by Loris::SdifFile and other readers.
+// ---------------------------------------------------------------------------
+class SDIFWriter {
+    private:
+        FILE* _file;
+        std::string _filename;
+        bool _bandwidth_enhanced;
+        int _num_frames;
+        double _time;
+
+        // SDIF index of each active partial number, 0 if inactive
+        std::vector<int> _indices;
+        int _next_index;
+
+        std::vector<char> _buffer;
+
+        void write(const std::vector<char>& buffer);
+
+    public:
+        SDIFWriter();
+        ~SDIFWriter();
+
+        // Creates filename (replacing an existing file) and writes the SDIF
+        // header. Bandwidth-enhanced files use RBEP frames, others 1TRC.
+        void open(const std::string& filename, bool bandwidth_enhanced=false);
+        void close();
+        bool is_open();
+        bool bandwidth_enhanced();
+        int num_frames();
+
+        // Appends the partials of frame, starting at time seconds. Frame
+        // times must not decrease.
+        void write_frame(Frame* frame, double time);
+};
+
+
+// ---------------------------------------------------------------------------
+// SDIFReader
+//
+// Reads the 1TRC or RBEP frames of an SDIF file one at a time. Frames of
+// other types are skipped, as are the RBEP time offsets of each row.
+//
+// Rows are given partial numbers in the order in which their indices
+// first appear: an index keeps its partial number while it is active,
+// and the number is reused once it has been absent from a frame. Inactive
+// partial numbers below the highest active one have 0 amplitude.
+// ---------------------------------------------------------------------------
+class SDIFReader {
+    private:
+        FILE* _file;
+        std::string _filename;
+        double _time;
+
+        // partial number of each active index, and the index of each
+        // partial number (-1 if it is free)
+        std::map<int, int> _partials;
+        std::vector<int> _indices;
+        std::vector<bool> _active;
+
+        // values of each partial number in the frame being read
+        std::vector<sample> _amplitudes;
+        std::vector<sample> _frequencies;
+        std::vector<sample> _phases;
+        std::vector<sample> _bandwidths;
+
+        std::vector<char> _buffer;
+
+        bool read(int size);
+
+    public:
+        SDIFReader();
+        SDIFReader(const std::string& filename);
+        ~SDIFReader();
+        void open(const std::string& filename);
+        void close();
+        bool is_open();
+
+        // Time in seconds of the last frame read
+        double time();
+
+        // Reads the next frame's partials into frame. Returns false (and
+        // leaves frame unchanged) at the end of the file.
+        bool read_frame(Frame* frame);
+};
+
+} // end of namespace simpl
+
+#endif
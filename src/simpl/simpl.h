@@ -2,9 +2,16 @@
 #define SIMPL_H
 
 #include "base.h"
+#include "spectrum.h"
 #include "peak_detection.h"
 #include "partial_tracking.h"
 #include "synthesis.h"
 #include "residual.h"
+#include "stream.h"
+#include "batch.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "archive.h"
+#include "sdif.h"
 
 #endif
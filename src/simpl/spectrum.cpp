@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <math.h>
+
+#include "fft_plans.h"
+#include "spectrum.h"
+
+using namespace std;
+using namespace simpl;
+
+
+// ---------------------------------------------------------------------------
+// Spectrum
+// ---------------------------------------------------------------------------
+Spectrum::Spectrum(int size, std::string window_type, bool reassignment) {
+    _size = size;
+    _num_bins = 0;
+    _sampling_rate = 44100;
+    _window_type = window_type;
+    _reassignment = reassignment;
+    _plan = NULL;
+    _fft_in = NULL;
+    _fft_out = NULL;
+    _derivative_fft_out = NULL;
+    _time_fft_out = NULL;
+    init();
+}
+
+Spectrum::~Spectrum() {
+    destroy();
+}
+
+void Spectrum::destroy() {
+    if(_fft_in) fftw_free(_fft_in);
+    if(_fft_out) fftw_free(_fft_out);
+    if(_derivative_fft_out) fftw_free(_derivative_fft_out);
+    if(_time_fft_out) fftw_free(_time_fft_out);
+
+    _fft_in = NULL;
+    _fft_out = NULL;
+    _derivative_fft_out = NULL;
+    _time_fft_out = NULL;
+}
+
+// Coefficients c of the cosine window c[0] - c[1] cos(a) + c[2] cos(2a).
+// Returns false if window_type is not known.
+static bool cosine_window(const std::string& window_type, double* c) {
+    if(window_type == "hamming") {
+        c[0] = 0.54;
+        c[1] = 0.46;
+        c[2] = 0.0;
+    }
+    else if(window_type == "hann") {
+        c[0] = 0.5;
+        c[1] = 0.5;
+        c[2] = 0.0;
+    }
+    else if(window_type == "blackman") {
+        c[0] = 0.42;
+        c[1] = 0.5;
+        c[2] = 0.08;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void Spectrum::init() {
+    double c[3];
+    if(!cosine_window(_window_type, c)) {
+        throw Exception(std::string("Invalid spectrum window type: ") +
+                        _window_type);
+    }
+
+    if(_size < 2) {
+        throw Exception(std::string("Spectrum size must be at least 2."));
+    }
+
+    destroy();
+    _num_bins = (_size / 2) + 1;
+
+    // windows are normalised by the sum of the window, computed in the
+    // same way as the MQ window so that MQ peaks are unchanged
+    _window.resize(_size);
+    _derivative_window.resize(_size);
+    _time_window.resize(_size);
+
+    sample sum = 0;
+    for(int i = 0; i < _size; i++) {
+        double a = 2.0 * M_PI * i / (_size - 1);
+        _window[i] = c[0] - (c[1] * cos(a));
+        if(c[2] != 0) {
+            _window[i] += c[2] * cos(2 * a);
+        }
+        _derivative_window[i] = (2.0 * M_PI / (_size - 1)) *
+                                ((c[1] * sin(a)) - (2 * c[2] * sin(2 * a)));
+        sum += _window[i];
+    }
+
+    sample centre = (_size - 1) / 2.0;
+    for(int i = 0; i < _size; i++) {
+        _window[i] /= sum;
+        _derivative_window[i] /= sum;
+        _time_window[i] = (i - centre) * _window[i];
+    }
+
+    _plan = simpl_fft_plan(_size, SIMPL_FFT_R2C);
+    if(!_plan) {
+        throw Exception(std::string("Could not create Spectrum FFT plan."));
+    }
+
+    _fft_in = (double*) fftw_malloc(sizeof(double) * _size);
+    _fft_out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * _num_bins);
+    if(_reassignment) {
+        _derivative_fft_out = (fftw_complex*) fftw_malloc(
+            sizeof(fftw_complex) * _num_bins
+        );
+        _time_fft_out = (fftw_complex*) fftw_malloc(
+            sizeof(fftw_complex) * _num_bins
+        );
+    }
+
+    _magnitudes.assign(_num_bins, 0.0);
+    _phases.assign(_num_bins, 0.0);
+    _frequencies.resize(_num_bins);
+    _time_offsets.assign(_num_bins, 0.0);
+    for(int i = 0; i < _num_bins; i++) {
+        _frequencies[i] = (sample)i * _sampling_rate / _size;
+    }
+}
+
+int Spectrum::size() {
+    return _size;
+}
+
+void Spectrum::size(int new_size) {
+    if(new_size < 2) {
+        throw Exception(std::string("Spectrum size must be at least 2."));
+    }
+    _size = new_size;
+    init();
+}
+
+int Spectrum::num_bins() {
+    return _num_bins;
+}
+
+int Spectrum::sampling_rate() {
+    return _sampling_rate;
+}
+
+void Spectrum::sampling_rate(int new_sampling_rate) {
+    _sampling_rate = new_sampling_rate;
+    init();
+}
+
+std::string Spectrum::window_type() {
+    return _window_type;
+}
+
+void Spectrum::window_type(std::string new_window_type) {
+    double c[3];
+    if(!cosine_window(new_window_type, c)) {
+        throw Exception(std::string("Invalid spectrum window type: ") +
+                        new_window_type);
+    }
+    _window_type = new_window_type;
+    init();
+}
+
+bool Spectrum::reassignment() {
+    return _reassignment;
+}
+
+void Spectrum::reassignment(bool new_reassignment) {
+    _reassignment = new_reassignment;
+    init();
+}
+
+sample* Spectrum::window() {
+    return &_window[0];
+}
+
+// Copies the windowed audio to the FFT input and transforms it into out
+static void transform(int size, int audio_size, sample* audio,
+                      sample* window, fftw_plan plan, double* in,
+                      fftw_complex* out) {
+    int n = std::min(audio_size, size);
+    for(int i = 0; i < n; i++) {
+        in[i] = audio[i] * window[i];
+    }
+    for(int i = n; i < size; i++) {
+        in[i] = 0.0;
+    }
+    fftw_execute_dft_r2c(plan, in, out);
+}
+
+void Spectrum::analyse(int audio_size, sample* audio) {
+    transform(_size, audio_size, audio, &_window[0], _plan, _fft_in,
+              _fft_out);
+
+    for(int i = 0; i < _num_bins; i++) {
+        sample re = _fft_out[i][0];
+        sample im = _fft_out[i][1];
+        _magnitudes[i] = sqrt((re * re) + (im * im));
+        _phases[i] = atan2(im, re);
+    }
+
+    if(!_reassignment) {
+        return;
+    }
+
+    transform(_size, audio_size, audio, &_derivative_window[0], _plan,
+              _fft_in, _derivative_fft_out);
+    transform(_size, audio_size, audio, &_time_window[0], _plan,
+              _fft_in, _time_fft_out);
+
+    // with X the spectrum and Xd and Xt the spectra with the derivative
+    // and time-ramped windows, the reassigned frequency (in radians per
+    // sample) is w - Im(Xd / X) and the time offset (in samples) is
+    // Re(Xt / X)
+    double bin_width = (double)_sampling_rate / _size;
+    double hz_per_radian = _sampling_rate / (2.0 * M_PI);
+    for(int i = 0; i < _num_bins; i++) {
+        double re = _fft_out[i][0];
+        double im = _fft_out[i][1];
+        double power = (re * re) + (im * im);
+
+        if(power > 0) {
+            double d_re = _derivative_fft_out[i][0];
+            double d_im = _derivative_fft_out[i][1];
+            double t_re = _time_fft_out[i][0];
+            double t_im = _time_fft_out[i][1];
+            _frequencies[i] = (i * bin_width) -
+                (((d_im * re) - (d_re * im)) / power) * hz_per_radian;
+            _time_offsets[i] = (((t_re * re) + (t_im * im)) / power) /
+                               _sampling_rate;
+        }
+        else {
+            _frequencies[i] = i * bin_width;
+            _time_offsets[i] = 0.0;
+        }
+    }
+}
+
+void Spectrum::analyse(Frame* frame) {
+    analyse(frame->size(), frame->audio());
+}
+
+sample* Spectrum::magnitudes() {
+    return &_magnitudes[0];
+}
+
+sample* Spectrum::phases() {
+    return &_phases[0];
+}
+
+sample* Spectrum::frequencies() {
+    return &_frequencies[0];
+}
+
+sample* Spectrum::time_offsets() {
+    return &_time_offsets[0];
+}
@@ -0,0 +1,97 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <string>
+#include <vector>
+
+#include <fftw3.h>
+
+#include "base.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// Spectrum
+//
+// The windowed FFT of one frame of audio, computed once so that it can be
+// used by several peak detectors (see PeakDetection::find_peaks_in_spectrum
+// and MultiPeakDetection).
+//
+// The window is a "hamming" (the default), "hann" or "blackman" window of
+// size samples, normalised to a sum of 1 (as in the MQ analysis) so that a
+// sinusoid at a bin frequency has a magnitude of half its amplitude.
+// Phases are relative to the first sample of the frame.
+//
+// With reassignment, the transforms of the frame with the time derivative
+// of the window and with the time-ramped window are also computed, giving
+// the reassigned (instantaneous) frequency of each bin and the time of its
+// energy relative to the centre of the frame. Without reassignment these
+// are the bin frequencies and 0.
+// ---------------------------------------------------------------------------
+class Spectrum {
+    private:
+        int _size;
+        int _num_bins;
+        int _sampling_rate;
+        std::string _window_type;
+        bool _reassignment;
+
+        std::vector<sample> _window;
+        std::vector<sample> _derivative_window;
+        std::vector<sample> _time_window;
+
+        fftw_plan _plan;
+        double* _fft_in;
+        fftw_complex* _fft_out;
+        fftw_complex* _derivative_fft_out;
+        fftw_complex* _time_fft_out;
+
+        std::vector<sample> _magnitudes;
+        std::vector<sample> _phases;
+        std::vector<sample> _frequencies;
+        std::vector<sample> _time_offsets;
+
+        void init();
+        void destroy();
+
+        // not copyable
+        Spectrum(const Spectrum&);
+        Spectrum& operator=(const Spectrum&);
+
+    public:
+        Spectrum(int size=2048, std::string window_type="hamming",
+                 bool reassignment=false);
+        ~Spectrum();
+
+        int size();
+        void size(int new_size);
+        int num_bins();
+        int sampling_rate();
+        void sampling_rate(int new_sampling_rate);
+        std::string window_type();
+        void window_type(std::string new_window_type);
+        bool reassignment();
+        void reassignment(bool new_reassignment);
+
+        // size window values
+        sample* window();
+
+        // Computes the spectrum of audio_size samples of audio (zero padded
+        // to size samples), or of the audio of frame
+        void analyse(int audio_size, sample* audio);
+        void analyse(Frame* frame);
+
+        // num_bins values from 0 Hz to the Nyquist frequency
+        sample* magnitudes();
+        sample* phases();
+
+        // Frequencies in Hz and time offsets in seconds
+        sample* frequencies();
+        sample* time_offsets();
+};
+
+} // end of namespace simpl
+
+#endif
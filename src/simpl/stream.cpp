@@ -0,0 +1,160 @@
+#include <algorithm>
+
+#include "stream.h"
+
+using namespace std;
+using namespace simpl;
+
+
+// ---------------------------------------------------------------------------
+// Stream
+// ---------------------------------------------------------------------------
+Stream::Stream(PeakDetection* peak_detection,
+               PartialTracking* partial_tracking,
+               Synthesis* synthesis) {
+    if(!peak_detection || !partial_tracking || !synthesis) {
+        throw Exception(std::string("Stream requires peak detection, "
+                                    "partial tracking and synthesis."));
+    }
+
+    _peak_detection = peak_detection;
+    _partial_tracking = partial_tracking;
+    _synthesis = synthesis;
+    _frame_size = 0;
+    _hop_size = 0;
+    _frame = NULL;
+    _input_pos = 0;
+    _input_count = 0;
+    _output_read = 0;
+    _output_available = 0;
+
+    prepare();
+}
+
+Stream::~Stream() {
+    if(_frame) {
+        delete _frame;
+        _frame = NULL;
+    }
+}
+
+void Stream::prepare() {
+    int frame_size = _peak_detection->frame_size();
+    int hop_size = _peak_detection->hop_size();
+
+    if(hop_size <= 0 || hop_size > frame_size) {
+        throw Exception(std::string("Stream hop size must be between 1 and "
+                                    "the frame size."));
+    }
+
+    _frame_size = frame_size;
+    _hop_size = hop_size;
+
+    if(_synthesis->hop_size() != _hop_size) {
+        _synthesis->hop_size(_hop_size);
+    }
+
+    if(_frame) {
+        delete _frame;
+    }
+    _frame = new Frame(_frame_size, true);
+    _frame->max_peaks(_peak_detection->max_peaks());
+    _frame->max_partials(_partial_tracking->max_partials());
+    _frame->synth_size(_hop_size);
+
+    // the output queue holds at most 2 * hop_size - 1 samples, see reset
+    _input.resize(_frame_size);
+    _output.resize(2 * _hop_size);
+
+    reset();
+}
+
+// Start again from silence. The output queue starts with hop_size - 1
+// samples of silence, which is the smallest delay that always leaves
+// enough synthesised samples to fill an output block: at most
+// hop_size - 1 samples can be read before the next hop is synthesised.
+void Stream::reset() {
+    std::fill(_input.begin(), _input.end(), 0.0);
+    std::fill(_output.begin(), _output.end(), 0.0);
+    _input_pos = 0;
+    _input_count = 0;
+    _output_read = 0;
+    _output_available = _hop_size - 1;
+
+    _frame->clear();
+    _partial_tracking->reset();
+    _synthesis->reset();
+}
+
+int Stream::frame_size() {
+    return _frame_size;
+}
+
+int Stream::hop_size() {
+    return _hop_size;
+}
+
+// The synthesised hop of a frame is output hop_size - 1 samples after the
+// last sample of the frame is input, while offline synthesis places it at
+// the first sample of the frame.
+int Stream::latency() {
+    return (_frame_size - _hop_size) + (_hop_size - 1);
+}
+
+void Stream::process_frame() {
+    sample* audio = _frame->audio();
+    std::copy(_input.begin() + _input_pos, _input.end(), audio);
+    std::copy(_input.begin(), _input.begin() + _input_pos,
+              audio + (_frame_size - _input_pos));
+
+    _frame->clear_peaks();
+    _frame->clear_partials();
+    _frame->clear_synth();
+
+    _peak_detection->find_peaks_in_frame(_frame);
+    _partial_tracking->update_partials(_frame);
+    _synthesis->synth_frame(_frame);
+
+    int output_size = _output.size();
+    int write_pos = (_output_read + _output_available) % output_size;
+    int first = std::min(_hop_size, output_size - write_pos);
+    sample* synth = _frame->synth();
+
+    std::copy(synth, synth + first, _output.begin() + write_pos);
+    std::copy(synth + first, synth + _hop_size, _output.begin());
+    _output_available += _hop_size;
+}
+
+void Stream::process(int block_size, sample* input, sample* output) {
+    int output_size = _output.size();
+    int pos = 0;
+
+    // work in chunks that end at the next hop boundary, so the chunk
+    // never wraps around either ring buffer more than once
+    while(pos < block_size) {
+        int n = std::min(block_size - pos, _hop_size - _input_count);
+
+        int first = std::min(n, _frame_size - _input_pos);
+        std::copy(input + pos, input + pos + first,
+                  _input.begin() + _input_pos);
+        std::copy(input + pos + first, input + pos + n, _input.begin());
+        _input_pos = (_input_pos + n) % _frame_size;
+        _input_count += n;
+
+        if(_input_count == _hop_size) {
+            process_frame();
+            _input_count = 0;
+        }
+
+        first = std::min(n, output_size - _output_read);
+        std::copy(_output.begin() + _output_read,
+                  _output.begin() + _output_read + first,
+                  output + pos);
+        std::copy(_output.begin(), _output.begin() + (n - first),
+                  output + pos + first);
+        _output_read = (_output_read + n) % output_size;
+        _output_available -= n;
+
+        pos += n;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <vector>
+
+#include "base.h"
+#include "peak_detection.h"
+#include "partial_tracking.h"
+#include "synthesis.h"
+
+namespace simpl
+{
+
+
+// ---------------------------------------------------------------------------
+// Stream
+//
+// Block-based analysis and synthesis of a continuous signal, for use in
+// realtime audio callbacks.
+//
+// Input is accepted in blocks of any size. The most recent frame_size input
+// samples are kept in a ring buffer, and every hop_size samples they are
+// analysed by the peak detection, partial tracking and synthesis objects
+// (which are not owned by the stream). The synthesised hops are queued and
+// returned in blocks of the same size as the input.
+//
+// The hop synthesised from the frame that starts at input sample n is
+// output starting at sample n + latency(), where offline synthesis of the
+// same signal (find_peaks, find_partials and synth) would place it at n.
+//
+// prepare() and reset() must be called from outside of the audio thread.
+// prepare() allocates all of the memory used by the stream, and must be
+// called again after changing the frame size or hop size of the peak
+// detection. process() does not allocate any memory itself, so it is
+// allocation free when the analysis and synthesis objects are.
+// ---------------------------------------------------------------------------
+class Stream {
+    protected:
+        PeakDetection* _peak_detection;
+        PartialTracking* _partial_tracking;
+        Synthesis* _synthesis;
+
+        int _frame_size;
+        int _hop_size;
+        Frame* _frame;
+
+        // the last _frame_size input samples, oldest at _input_pos
+        std::vector<sample> _input;
+        int _input_pos;
+        int _input_count;
+
+        // synthesised samples waiting to be output
+        std::vector<sample> _output;
+        int _output_read;
+        int _output_available;
+
+        void process_frame();
+
+    public:
+        Stream(PeakDetection* peak_detection,
+               PartialTracking* partial_tracking,
+               Synthesis* synthesis);
+        ~Stream();
+
+        void prepare();
+        void reset();
+
+        int frame_size();
+        int hop_size();
+
+        // The delay in samples between the input and output signals
+        int latency();
+
+        // Analyse block_size samples of input, and write block_size samples
+        // of synthesised audio to output. input and output may be the same.
+        void process(int block_size, sample* input, sample* output);
+};
+
+} // end of namespace simpl
+
+#endif
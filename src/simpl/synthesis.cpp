@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <sstream>
+
 #include "synthesis.h"
 
 using namespace std;
@@ -14,9 +17,34 @@ Synthesis::Synthesis() {
     _sampling_rate = 44100;
 }
 
+Synthesis::~Synthesis() {
+}
+
+Synthesis* Synthesis::clone() {
+    Synthesis* synth = new Synthesis();
+    copy_parameters(synth);
+    return synth;
+}
+
+void Synthesis::copy_parameters(Synthesis* synth) {
+    synth->sampling_rate(_sampling_rate);
+    synth->frame_size(_frame_size);
+    synth->hop_size(_hop_size);
+    synth->max_partials(_max_partials);
+}
+
 void Synthesis::reset() {
 }
 
+std::string Synthesis::parameters() {
+    std::ostringstream s;
+    s << "frame_size=" << _frame_size << ";"
+      << "hop_size=" << _hop_size << ";"
+      << "max_partials=" << _max_partials << ";"
+      << "sampling_rate=" << _sampling_rate << ";";
+    return s.str();
+}
+
 int Synthesis::frame_size() {
     return _frame_size;
 }
@@ -49,6 +77,10 @@ void Synthesis::sampling_rate(int new_sampling_rate) {
     _sampling_rate = new_sampling_rate;
 }
 
+Profile* Synthesis::profile() {
+    return &_profile;
+}
+
 void Synthesis::synth_frame(Frame* frame) {
 }
 
@@ -68,27 +100,59 @@ MQSynthesis::MQSynthesis() {
     _prev_amps = NULL;
     _prev_freqs = NULL;
     _prev_phases = NULL;
+    _amps = NULL;
+    _amp_incs = NULL;
+    _phases = NULL;
+    _freqs = NULL;
+    _alphas = NULL;
+    _betas = NULL;
     reset();
 }
 
 MQSynthesis::~MQSynthesis() {
+    destroy_arrays();
+}
+
+void MQSynthesis::destroy_arrays() {
     if(_prev_amps) delete [] _prev_amps;
     if(_prev_freqs) delete [] _prev_freqs;
     if(_prev_phases) delete [] _prev_phases;
+    if(_amps) delete [] _amps;
+    if(_amp_incs) delete [] _amp_incs;
+    if(_phases) delete [] _phases;
+    if(_freqs) delete [] _freqs;
+    if(_alphas) delete [] _alphas;
+    if(_betas) delete [] _betas;
 
     _prev_amps = NULL;
     _prev_freqs = NULL;
     _prev_phases = NULL;
+    _amps = NULL;
+    _amp_incs = NULL;
+    _phases = NULL;
+    _freqs = NULL;
+    _alphas = NULL;
+    _betas = NULL;
+}
+
+Synthesis* MQSynthesis::clone() {
+    MQSynthesis* synth = new MQSynthesis();
+    copy_parameters(synth);
+    return synth;
 }
 
 void MQSynthesis::reset() {
-    if(_prev_amps) delete [] _prev_amps;
-    if(_prev_freqs) delete [] _prev_freqs;
-    if(_prev_phases) delete [] _prev_phases;
+    destroy_arrays();
 
     _prev_amps = new sample[_max_partials];
     _prev_freqs = new sample[_max_partials];
     _prev_phases = new sample[_max_partials];
+    _amps = new sample[_max_partials];
+    _amp_incs = new sample[_max_partials];
+    _phases = new sample[_max_partials];
+    _freqs = new sample[_max_partials];
+    _alphas = new sample[_max_partials];
+    _betas = new sample[_max_partials];
 
     memset(_prev_amps, 0.0, sizeof(sample) * _max_partials);
     memset(_prev_freqs, 0.0, sizeof(sample) * _max_partials);
@@ -105,6 +169,8 @@ void MQSynthesis::max_partials(int new_max_partials) {
 }
 
 void MQSynthesis::synth_frame(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     int num_partials = frame->num_partials();
     if(num_partials > _max_partials) {
         num_partials = _max_partials;
@@ -114,10 +180,18 @@ void MQSynthesis::synth_frame(Frame* frame) {
         frame->synth()[n] = 0.f;
     }
 
+    sample* amps = frame->partial_amplitudes();
+    sample* freqs = frame->partial_frequencies();
+    sample* phases = frame->partial_phases();
+
+    sample hop = _hop_size;
+    sample hop_2 = hop * hop;
+    sample hop_3 = hop_2 * hop;
+
     for(int i = 0; i < num_partials; i++) {
-        sample amp = frame->partial(i)->amplitude;
-        sample freq = hz_to_radians(frame->partial(i)->frequency);
-        sample phase = frame->partial(i)->phase;
+        sample amp = amps[i];
+        sample freq = hz_to_radians(freqs[i]);
+        sample phase = phases[i];
 
         // get values for last amplitude, frequency and phase
         // these are the initial values of the instantaneous
@@ -128,7 +202,7 @@ void MQSynthesis::synth_frame(Frame* frame) {
 
         if(prev_amp == 0) {
             prev_freq = freq;
-            prev_phase = frame->partial(i)->phase - (freq * _hop_size);
+            prev_phase = phase - (freq * _hop_size);
             while(prev_phase >= M_PI) {
                 prev_phase -= (2.0 * M_PI);
             }
@@ -138,8 +212,9 @@ void MQSynthesis::synth_frame(Frame* frame) {
         }
 
         // amplitudes are linearly interpolated between frames
-        sample inst_amp = prev_amp;
-        sample amp_inc = (frame->partial(i)->amplitude - prev_amp) / _hop_size;
+        // (doubled as the output is 2 * amp * cos(phase))
+        _amps[i] = 2.0 * prev_amp;
+        _amp_incs[i] = 2.0 * ((amp - prev_amp) / _hop_size);
 
         // freqs/phases are calculated by cubic interpolation
         sample freq_diff = freq - prev_freq;
@@ -149,25 +224,19 @@ void MQSynthesis::synth_frame(Frame* frame) {
         int m = floor(x + 0.5);
         sample phase_diff = phase - prev_phase - (prev_freq * _hop_size) +
                             (2.0 * M_PI * m);
-        sample alpha = ((3.0 / pow(_hop_size, 2.0)) * phase_diff) -
-                       (freq_diff / _hop_size);
-        sample beta = ((-2.0 / pow(_hop_size, 3.0)) * phase_diff) +
-                      (freq_diff / pow(_hop_size, 2.0));
-
-        // calculate output samples
-        sample inst_phase = 0.f;
-        for(int n = 0; n < _hop_size; n++) {
-            inst_amp += amp_inc;
-            inst_phase = prev_phase + (prev_freq * n) +
-                         (alpha * pow((sample)n, 2.0)) +
-                         (beta * pow((sample)n, 3.0));
-            frame->synth()[n] += (2.f * inst_amp) * cos(inst_phase);
-        }
+        _alphas[i] = ((3.0 / hop_2) * phase_diff) - (freq_diff / hop);
+        _betas[i] = ((-2.0 / hop_3) * phase_diff) + (freq_diff / hop_2);
+        _phases[i] = prev_phase;
+        _freqs[i] = prev_freq;
 
         _prev_amps[i] = amp;
         _prev_freqs[i] = freq;
         _prev_phases[i] = phase;
     }
+
+    // calculate output samples
+    mq_oscillator_bank(num_partials, _hop_size, _amps, _amp_incs,
+                       _phases, _freqs, _alphas, _betas, frame->synth());
 }
 
 // ---------------------------------------------------------------------------
@@ -218,6 +287,13 @@ void SMSSynthesis::max_partials(int new_max_partials) {
                    stochastic_type(), 0);
 }
 
+std::string SMSSynthesis::parameters() {
+    std::ostringstream s;
+    s << Synthesis::parameters()
+      << "det_synthesis_type=" << det_synthesis_type() << ";";
+    return s.str();
+}
+
 int SMSSynthesis::num_stochastic_coeffs() {
     return _synth_params.nStochasticCoeff;
 }
@@ -226,6 +302,19 @@ int SMSSynthesis::stochastic_type() {
     return _synth_params.iStochasticType;
 }
 
+Synthesis* SMSSynthesis::clone() {
+    SMSSynthesis* synth = new SMSSynthesis();
+    copy_parameters(synth);
+    synth->det_synthesis_type(det_synthesis_type());
+    return synth;
+}
+
+// Clears the previous frame and overlap-add buffers
+void SMSSynthesis::reset() {
+    sms_freeSynth(&_synth_params);
+    sms_initSynth(&_synth_params);
+}
+
 int SMSSynthesis::det_synthesis_type() {
     return _synth_params.iDetSynthType;
 }
@@ -235,18 +324,23 @@ void SMSSynthesis::det_synthesis_type(int new_det_synthesis_type) {
 }
 
 void SMSSynthesis::synth_frame(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     int num_partials = _data.nTracks;
     if(num_partials > frame->num_partials()) {
         num_partials = frame->num_partials();
     }
 
-    for(int i = 0; i < num_partials; i++) {
-        _data.pFSinAmp[i] = frame->partial(i)->amplitude;
-        _data.pFSinFreq[i] = frame->partial(i)->frequency;
-        _data.pFSinPha[i] = frame->partial(i)->phase;
-    }
+    std::copy(frame->partial_amplitudes(),
+              frame->partial_amplitudes() + num_partials, _data.pFSinAmp);
+    std::copy(frame->partial_frequencies(),
+              frame->partial_frequencies() + num_partials, _data.pFSinFreq);
+    std::copy(frame->partial_phases(),
+              frame->partial_phases() + num_partials, _data.pFSinPha);
 
-    sms_synthesize(&_data, frame->synth(), &_synth_params);
+    double* synth = double_output(_hop_size, frame->synth(), _double_synth);
+    sms_synthesize(&_data, synth, &_synth_params);
+    copy_double_output(_hop_size, synth, frame->synth());
 }
 
 
@@ -254,44 +348,43 @@ void SMSSynthesis::synth_frame(Frame* frame) {
 // SndObjSynthesis
 // ---------------------------------------------------------------------------
 SimplSndObjAnalysisWrapper::SimplSndObjAnalysisWrapper(int max_partials) {
-    partials.resize(max_partials);
+    _max_partials = max_partials;
+    num_partials = 0;
+    amplitudes = NULL;
+    frequencies = NULL;
+    phases = NULL;
 }
 
 SimplSndObjAnalysisWrapper::~SimplSndObjAnalysisWrapper() {
-    partials.clear();
 }
 
 int SimplSndObjAnalysisWrapper::GetTrackID(int track) {
-    if(track < partials.size()) {
+    if(track < _max_partials) {
         return track;
     }
     return 0;
 }
 
 int SimplSndObjAnalysisWrapper::GetTracks() {
-    return partials.size();
+    return _max_partials;
 }
 
 double SimplSndObjAnalysisWrapper::Output(int pos) {
     int peak = pos / 3;
 
-    if(peak > partials.size()) {
+    if(peak >= num_partials) {
         return 0.0;
     }
 
     int data_field = pos % 3;
 
-    if(partials[peak]) {
-        if(data_field == 0) {
-            return partials[peak]->amplitude;
-        }
-        else if(data_field == 1) {
-            return partials[peak]->frequency;
-        }
-        return partials[peak]->phase;
+    if(data_field == 0) {
+        return amplitudes[peak];
     }
-
-    return 0.0;
+    else if(data_field == 1) {
+        return frequencies[peak];
+    }
+    return phases[peak];
 }
 
 SndObjSynthesis::SndObjSynthesis() {
@@ -317,6 +410,12 @@ SndObjSynthesis::~SndObjSynthesis() {
     _synth = NULL;
 }
 
+Synthesis* SndObjSynthesis::clone() {
+    SndObjSynthesis* synth = new SndObjSynthesis();
+    copy_parameters(synth);
+    return synth;
+}
+
 void SndObjSynthesis::reset() {
     if(_analysis) {
         delete _analysis;
@@ -349,17 +448,17 @@ void SndObjSynthesis::max_partials(int new_max_partials) {
 }
 
 void SndObjSynthesis::synth_frame(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     int num_partials = _max_partials;
     if(frame->num_partials() < _max_partials) {
         num_partials = frame->num_partials();
     }
 
-    for(int i = 0; i < num_partials; i++) {
-        _analysis->partials[i] = frame->partial(i);
-    }
-    for(int i = num_partials; i < _max_partials; i++) {
-        _analysis->partials[i] = NULL;
-    }
+    _analysis->num_partials = num_partials;
+    _analysis->amplitudes = frame->partial_amplitudes();
+    _analysis->frequencies = frame->partial_frequencies();
+    _analysis->phases = frame->partial_phases();
 
     _synth->DoProcess();
 
@@ -380,12 +479,16 @@ LorisSynthesis::LorisSynthesis() {
 LorisSynthesis::~LorisSynthesis() {
 }
 
+Synthesis* LorisSynthesis::clone() {
+    LorisSynthesis* synth = new LorisSynthesis();
+    copy_parameters(synth);
+    synth->bandwidth(_bandwidth);
+    return synth;
+}
+
 void LorisSynthesis::reset() {
-    _oscs.clear();
-    _oscs.resize(_max_partials);
-    for(int i = 0; i < _max_partials; i++) {
-        _oscs.push_back(Loris::Oscillator());
-    }
+    _oscs.num_oscillators(_max_partials);
+    _bandwidths.resize(_max_partials);
 }
 
 void LorisSynthesis::max_partials(int new_max_partials) {
@@ -393,6 +496,14 @@ void LorisSynthesis::max_partials(int new_max_partials) {
     reset();
 }
 
+std::string LorisSynthesis::parameters() {
+    std::ostringstream s;
+    s.precision(17);
+    s << Synthesis::parameters()
+      << "bandwidth=" << _bandwidth << ";";
+    return s.str();
+}
+
 sample LorisSynthesis::bandwidth() {
     return _bandwidth;
 }
@@ -402,19 +513,251 @@ void LorisSynthesis::bandwidth(sample new_bandwidth) {
 }
 
 void LorisSynthesis::synth_frame(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
     int num_partials = frame->num_partials();
     if(num_partials > _max_partials) {
         num_partials = _max_partials;
     }
 
+    sample* bandwidths = frame->partial_bandwidths();
     for(int i = 0; i < num_partials; i++) {
-        Loris::Breakpoint bp = Loris::Breakpoint(
-            frame->partial(i)->frequency,
-            frame->partial(i)->amplitude,
-            frame->partial(i)->bandwidth * _bandwidth,
-            frame->partial(i)->phase
-        );
-        _oscs[i].oscillate(frame->synth(), frame->synth() + _hop_size,
-                           bp, _sampling_rate);
+        _bandwidths[i] = bandwidths[i] * _bandwidth;
+    }
+
+    _oscs.oscillate(num_partials, _hop_size, frame->partial_amplitudes(),
+                    frame->partial_frequencies(), &_bandwidths[0],
+                    _sampling_rate, frame->synth());
+}
+
+
+// ---------------------------------------------------------------------------
+// IFFTSynthesis
+// ---------------------------------------------------------------------------
+
+// 4-term Blackman-Harris (92 dB) window coefficients
+static const double BH_92[4] = {0.35875, 0.48829, 0.14128, 0.01168};
+
+// Half width of the Blackman-Harris main lobe in bins
+static const int BH_92_LOBE = 4;
+
+// Number of values per bin in the main lobe table
+static const int LOBE_RESOLUTION = 1024;
+
+// Transform of the zero-phase Blackman-Harris window of size fft_size, at a
+// distance of bin bins from its centre and normalised so that the centre
+// is BH_92[0]. Each cosine term contributes a pair of periodic sincs, which
+// share the value of sin(pi * bin) up to sign.
+static double blackman_harris_lobe(double bin, int fft_size) {
+    double nearest = floor(bin + 0.5);
+
+    if(fabs(bin - nearest) < 1e-9) {
+        int m = abs((int)nearest);
+        if(m == 0) {
+            return BH_92[0];
+        }
+        return m < 4 ? BH_92[m] / 2 : 0.0;
+    }
+
+    double s = sin(M_PI * bin) / fft_size;
+    double lobe = BH_92[0] / tan(M_PI * bin / fft_size);
+    for(int m = 1; m < 4; m++) {
+        double sign = (m % 2) ? -1.0 : 1.0;
+        lobe += sign * (BH_92[m] / 2) *
+                ((1.0 / tan(M_PI * (bin - m) / fft_size)) +
+                 (1.0 / tan(M_PI * (bin + m) / fft_size)));
+    }
+    return s * lobe;
+}
+
+IFFTSynthesis::IFFTSynthesis() {
+    _fft_size = 0;
+    _fft_plan = NULL;
+    _spectrum = NULL;
+    _fft_out = NULL;
+    _window = NULL;
+    _lobe = NULL;
+    _buffer = NULL;
+    _prev_amps = NULL;
+    _prev_freqs = NULL;
+    _prev_phases = NULL;
+    reset();
+}
+
+IFFTSynthesis::~IFFTSynthesis() {
+    destroy_arrays();
+}
+
+void IFFTSynthesis::destroy_arrays() {
+    if(_spectrum) fftw_free(_spectrum);
+    if(_fft_out) fftw_free(_fft_out);
+    if(_window) delete [] _window;
+    if(_lobe) delete [] _lobe;
+    if(_buffer) delete [] _buffer;
+    if(_prev_amps) delete [] _prev_amps;
+    if(_prev_freqs) delete [] _prev_freqs;
+    if(_prev_phases) delete [] _prev_phases;
+
+    _spectrum = NULL;
+    _fft_out = NULL;
+    _window = NULL;
+    _lobe = NULL;
+    _buffer = NULL;
+    _prev_amps = NULL;
+    _prev_freqs = NULL;
+    _prev_phases = NULL;
+}
+
+Synthesis* IFFTSynthesis::clone() {
+    IFFTSynthesis* synth = new IFFTSynthesis();
+    copy_parameters(synth);
+    return synth;
+}
+
+void IFFTSynthesis::reset() {
+    destroy_arrays();
+
+    _fft_size = 4 * _hop_size;
+    _fft_plan = simpl_fft_plan(_fft_size, SIMPL_FFT_C2R);
+    if(!_fft_plan) {
+        throw Exception(std::string("Could not create IFFTSynthesis FFT plan."));
+    }
+
+    _spectrum = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) *
+                                           ((_fft_size / 2) + 1));
+    _fft_out = (double*)fftw_malloc(sizeof(double) * _fft_size);
+    _window = new sample[2 * _hop_size];
+    _lobe = new sample[(BH_92_LOBE * LOBE_RESOLUTION) + 2];
+    _buffer = new sample[2 * _hop_size];
+    _prev_amps = new sample[_max_partials];
+    _prev_freqs = new sample[_max_partials];
+    _prev_phases = new sample[_max_partials];
+
+    // the inverse FFT gives each sinusoid a Blackman-Harris envelope
+    // centred on the frame. The middle half of it is replaced by a
+    // triangle, so that frames overlapping by half add up to a constant.
+    // Only using the middle half keeps the window gain low, as dividing
+    // by the small tails of the Blackman-Harris window would amplify the
+    // sidelobes that are left out of the spectrum.
+    for(int i = 0; i < 2 * _hop_size; i++) {
+        double x = (2 * M_PI * (i + _hop_size)) / _fft_size;
+        double bh = BH_92[0] - (BH_92[1] * cos(x)) + (BH_92[2] * cos(2 * x)) -
+                    (BH_92[3] * cos(3 * x));
+        double triangle = 1.0 - (fabs(i - _hop_size) / _hop_size);
+        _window[i] = triangle / bh;
+    }
+
+    for(int i = 0; i < (BH_92_LOBE * LOBE_RESOLUTION) + 2; i++) {
+        _lobe[i] = blackman_harris_lobe((double)i / LOBE_RESOLUTION,
+                                        _fft_size);
+    }
+
+    memset(_buffer, 0, sizeof(sample) * 2 * _hop_size);
+    memset(_prev_amps, 0, sizeof(sample) * _max_partials);
+    memset(_prev_freqs, 0, sizeof(sample) * _max_partials);
+    memset(_prev_phases, 0, sizeof(sample) * _max_partials);
+}
+
+void IFFTSynthesis::hop_size(int new_hop_size) {
+    _hop_size = new_hop_size;
+    reset();
+}
+
+void IFFTSynthesis::max_partials(int new_max_partials) {
+    _max_partials = new_max_partials;
+    reset();
+}
+
+// Adds the main lobe of a sinusoid with the given phase at the centre of
+// the frame to the spectrum. Bins below 0 or above the Nyquist bin are
+// folded back as the complex conjugate (the negative frequency image).
+void IFFTSynthesis::add_sinusoid(sample amp, sample freq, sample phase) {
+    int num_bins = _fft_size / 2;
+    double location = ((double)freq * _fft_size) / _sampling_rate;
+    double re = (amp / 2.0) * cos(phase);
+    double im = (amp / 2.0) * sin(phase);
+
+    int first = (int)ceil(location - BH_92_LOBE);
+    int last = (int)floor(location + BH_92_LOBE);
+
+    for(int k = first; k <= last; k++) {
+        // linear interpolation of the main lobe table
+        double index = fabs(k - location) * LOBE_RESOLUTION;
+        int i = (int)index;
+        double mag = _lobe[i] + ((index - i) * (_lobe[i + 1] - _lobe[i]));
+
+        if(k == 0 || k == num_bins) {
+            _spectrum[k][0] += 2 * mag * re;
+        }
+        else if(k > 0 && k < num_bins) {
+            _spectrum[k][0] += mag * re;
+            _spectrum[k][1] += mag * im;
+        }
+        else {
+            int b = k < 0 ? -k : _fft_size - k;
+            _spectrum[b][0] += mag * re;
+            _spectrum[b][1] -= mag * im;
+        }
+    }
+}
+
+void IFFTSynthesis::synth_frame(Frame* frame) {
+    SIMPL_PROFILE_FRAME(&_profile, frame);
+
+    int num_partials = frame->num_partials();
+    if(num_partials > _max_partials) {
+        num_partials = _max_partials;
+    }
+
+    sample* amps = frame->partial_amplitudes();
+    sample* freqs = frame->partial_frequencies();
+    sample* phases = frame->partial_phases();
+    sample nyquist = _sampling_rate / 2.0;
+    sample hop_time = (sample)_hop_size / _sampling_rate;
+
+    memset(_spectrum, 0, sizeof(fftw_complex) * ((_fft_size / 2) + 1));
+
+    for(int i = 0; i < num_partials; i++) {
+        sample amp = amps[i];
+        sample freq = freqs[i];
+
+        if(amp <= 0 || freq <= 0 || freq >= nyquist) {
+            _prev_amps[i] = 0.0;
+            continue;
+        }
+
+        // continue the phase of the previous frame, using the mean
+        // frequency over the hop
+        sample phase = phases[i];
+        if(_prev_amps[i] > 0) {
+            phase = _prev_phases[i] +
+                    (M_PI * (_prev_freqs[i] + freq) * hop_time);
+            phase -= 2 * M_PI * floor(phase / (2 * M_PI));
+        }
+
+        add_sinusoid(amp, freq, phase);
+
+        _prev_amps[i] = amp;
+        _prev_freqs[i] = freq;
+        _prev_phases[i] = phase;
+    }
+
+    for(int i = num_partials; i < _max_partials; i++) {
+        _prev_amps[i] = 0.0;
+    }
+
+    fftw_execute_dft_c2r(_fft_plan, _spectrum, _fft_out);
+
+    // the transform is centred on sample 0, so the middle of the frame is
+    // the end of the output followed by its start
+    for(int i = 0; i < _hop_size; i++) {
+        _buffer[i] += _fft_out[i + (3 * _hop_size)] * _window[i];
+        _buffer[i + _hop_size] += _fft_out[i] * _window[i + _hop_size];
+    }
+
+    for(int i = 0; i < _hop_size; i++) {
+        frame->synth()[i] = _buffer[i];
+        _buffer[i] = _buffer[i + _hop_size];
+        _buffer[i + _hop_size] = 0.0;
     }
 }
@@ -4,6 +4,11 @@
 #include <math.h>
 
 #include "base.h"
+#include "profile.h"
+#include "fft_plans.h"
+
+#include "oscillator_bank.h"
+#include "loris_oscillator_bank.h"
 
 extern "C" {
     #include "sms.h"
@@ -35,10 +40,27 @@ class Synthesis {
         int _hop_size;
         int _max_partials;
         int _sampling_rate;
+        Profile _profile;
+
+        // output for double precision libraries, see double_output
+        std::vector<double> _double_synth;
+
+        void copy_parameters(Synthesis* synth);
 
     public:
         Synthesis();
+        virtual ~Synthesis();
+
+        // Return a new synthesis object with the same parameters as this one
+        // but with its own state. The caller owns the returned object.
+        virtual Synthesis* clone();
+
         virtual void reset();
+
+        // The parameters that affect the audio synthesised by this object,
+        // as "name=value;" pairs
+        virtual std::string parameters();
+
         int frame_size();
         virtual void frame_size(int new_frame_size);
         int hop_size();
@@ -48,6 +70,9 @@ class Synthesis {
         int sampling_rate();
         void sampling_rate(int new_sampling_rate);
 
+        // Statistics for the frames processed by this object, see Profile
+        Profile* profile();
+
         virtual void synth_frame(Frame* frame);
         virtual Frames synth(Frames frames);
 };
@@ -61,11 +86,22 @@ class MQSynthesis : public Synthesis {
         sample* _prev_amps;
         sample* _prev_freqs;
         sample* _prev_phases;
+
+        // oscillator bank parameters for the current frame
+        sample* _amps;
+        sample* _amp_incs;
+        sample* _phases;
+        sample* _freqs;
+        sample* _alphas;
+        sample* _betas;
+
         sample hz_to_radians(sample f);
+        void destroy_arrays();
 
     public:
         MQSynthesis();
         ~MQSynthesis();
+        Synthesis* clone();
         void reset();
         using Synthesis::max_partials;
         void max_partials(int new_max_partials);
@@ -84,10 +120,13 @@ class SMSSynthesis : public Synthesis {
     public:
         SMSSynthesis();
         ~SMSSynthesis();
+        Synthesis* clone();
+        void reset();
         using Synthesis::hop_size;
         void hop_size(int new_hop_size);
         using Synthesis::max_partials;
         void max_partials(int new_max_partials);
+        std::string parameters();
         int num_stochastic_coeffs();
         int stochastic_type();
         int det_synthesis_type();
@@ -100,10 +139,16 @@ class SMSSynthesis : public Synthesis {
 // SndObjSynthesis
 // ---------------------------------------------------------------------------
 class SimplSndObjAnalysisWrapper : public SinAnal {
+    private:
+        int _max_partials;
+
     public:
         SimplSndObjAnalysisWrapper(int max_partials);
         ~SimplSndObjAnalysisWrapper();
-        Peaks partials;
+        int num_partials;
+        sample* amplitudes;
+        sample* frequencies;
+        sample* phases;
         int GetTrackID(int track);
         int GetTracks();
         double Output(int pos);
@@ -119,6 +164,7 @@ class SndObjSynthesis : public Synthesis {
     public:
         SndObjSynthesis();
         ~SndObjSynthesis();
+        Synthesis* clone();
         void reset();
         using Synthesis::frame_size;
         void frame_size(int new_frame_size);
@@ -135,20 +181,76 @@ class SndObjSynthesis : public Synthesis {
 // ---------------------------------------------------------------------------
 class LorisSynthesis : public Synthesis {
     private:
-        std::vector<Loris::Oscillator> _oscs;
+        LorisOscillatorBank _oscs;
+        std::vector<sample> _bandwidths;
         sample _bandwidth;
 
     public:
         LorisSynthesis();
         ~LorisSynthesis();
+        Synthesis* clone();
         void reset();
         using Synthesis::max_partials;
         void max_partials(int new_max_partials);
+        std::string parameters();
         sample bandwidth();
         void bandwidth(sample new_bandwidth);
         void synth_frame(Frame* frame);
 };
 
+
+// ---------------------------------------------------------------------------
+// IFFTSynthesis
+//
+// Inverse FFT (FFT-1) additive synthesis. Each partial is added to a
+// spectrum as the main lobe of a Blackman-Harris window at its frequency,
+// so it costs a few bins rather than a sample loop. The spectrum is
+// inverse transformed once per frame, reshaped from the Blackman-Harris
+// window to a triangular one and overlap-added. The cost of a frame is
+// dominated by the FFT, of size 4 * hop_size, so it hardly depends on the
+// number of partials.
+//
+// Frequencies and amplitudes are constant within each FFT frame and are
+// crossfaded between frames. Phases are taken from the partials when they
+// start and are then accumulated from the frequencies, so that the
+// overlapping frames of a partial stay in phase whatever the tracker.
+// Partial amplitudes are the amplitudes of the output sinusoids.
+// ---------------------------------------------------------------------------
+class IFFTSynthesis : public Synthesis {
+    private:
+        int _fft_size;
+        fftw_plan _fft_plan;
+        fftw_complex* _spectrum;
+        double* _fft_out;
+
+        // triangle / Blackman-Harris synthesis window, 2 * hop_size samples
+        sample* _window;
+
+        // Blackman-Harris main lobe, from 0 to 4 bins
+        sample* _lobe;
+
+        // overlap-add buffer, 2 * hop_size samples
+        sample* _buffer;
+
+        sample* _prev_amps;
+        sample* _prev_freqs;
+        sample* _prev_phases;
+
+        void destroy_arrays();
+        void add_sinusoid(sample amp, sample freq, sample phase);
+
+    public:
+        IFFTSynthesis();
+        ~IFFTSynthesis();
+        Synthesis* clone();
+        void reset();
+        using Synthesis::hop_size;
+        void hop_size(int new_hop_size);
+        using Synthesis::max_partials;
+        void max_partials(int new_max_partials);
+        void synth_frame(Frame* frame);
+};
+
 } // end of namespace Simpl
 
 #endif
@@ -104,7 +104,7 @@ void sms_dCepstrum( int sizeCepstrum, sfloat *pCepstrum, int sizeFreq, sfloat *p
     sfloat factor;
     sfloat fNorm = PI  / (sfloat)iMaxFreq; /* value to normalize frequencies to 0:0.5 */
     //static sizeCepstrumStatic
-    static CepstrumMatrices m;
+    static SMS_THREAD_LOCAL CepstrumMatrices m;
     //printf("nPoints: %d, nCoeff: %d \n", m.nPoints, m.nCoeff);
     if(m.nPoints != sizeCepstrum || m.nCoeff != sizeFreq)
         AllocateDCepstrum(sizeFreq, sizeCepstrum, &m);
@@ -164,8 +164,8 @@ void sms_dCepstrum( int sizeCepstrum, sfloat *pCepstrum, int sizeFreq, sfloat *p
 void sms_dCepstrumEnvelope(int sizeCepstrum, sfloat *pCepstrum, int sizeEnv, sfloat *pEnv)
 {
 
-    static sfloat *pFftBuffer;
-    static int sizeFftArray = 0;
+    static SMS_THREAD_LOCAL sfloat *pFftBuffer;
+    static SMS_THREAD_LOCAL int sizeFftArray = 0;
     int sizeFft = sizeEnv << 1;
     int i;
     if(sizeFftArray != sizeFft)
@@ -209,7 +209,7 @@ void sms_spectralEnvelope( SMS_Data *pSmsData, SMS_SEnvParams *pSpecEnvParams)
     int i, k;
     int sizeCepstrum = pSpecEnvParams->iOrder+1;
     //int nPeaks = 0;
-    static sfloat pFreqBuff[1000], pMagBuff[1000];
+    static SMS_THREAD_LOCAL sfloat pFreqBuff[1000], pMagBuff[1000];
 
     /* \todo see if this memset is even necessary, once working */
     //memset(pSmsData->pSpecEnv, 0, pSpecEnvParams->nCoeff * sizeof(sfloat));
@@ -22,17 +22,32 @@
  * \brief initialization, free, and debug functions
  */
 
+#include <pthread.h>
+
 #include "sms.h"
 #include "SFMT.h" /*!< mersenne twister random number genorator */
 
 char *pChDebugFile = "debug.txt"; /*!< debug text file */
 FILE *pDebug; /*!< pointer to debug file */
 
-static char error_message[256];
-static int error_status = 0;
+/* error state is kept separately by each thread */
+static SMS_THREAD_LOCAL char error_message[256];
+static SMS_THREAD_LOCAL int error_status = 0;
+
+/* the magnitude threshold is shared by every thread, it is set before
+ * analysis starts and only read during it */
 static sfloat mag_thresh = .00001; /*!< magnitude threshold for db conversion (-100db)*/
 static sfloat inv_mag_thresh = 100000.; /*!< inv(.00001) */
-static int initIsDone = 0; /* \todo is this variable necessary? */
+
+/* the sine, sinc and FFT tables are shared by every user of the library,
+ * they are created by the first call to sms_init and freed by the
+ * matching call to sms_free */
+static pthread_mutex_t initLock = PTHREAD_MUTEX_INITIALIZER;
+static int initCount = 0;
+
+#ifdef MERSENNE_TWISTER
+static pthread_mutex_t randomLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 #define SIZE_TABLES 4096
 #define HALF_MAX 1073741823.5  /*!< half the max of a 32-bit word */
@@ -41,47 +56,74 @@ static int initIsDone = 0; /* \todo is this variable necessary? */
 
 /*! \brief initialize global data
  *
- * Currently, just generating the sine and sinc tables.
+ * Currently, just generating the sine, sinc and FFT tables.
  * This is necessary before both analysis and synthesis.
  *
  * If using the Mersenne Twister algorithm for random number
  * generation, initialize (seed) it.
  *
+ * The tables are reference counted and are only read once created, so
+ * sms_init can be called by every analysis or synthesis object (on any
+ * thread), each matched by a call to sms_free.
+ *
  * \return error code \see SMS_MALLOC or SMS_OK in SMS_ERRORS
  */
 int sms_init(void)
 {
-    if (!initIsDone)
+    int error = 0;
+
+    pthread_mutex_lock(&initLock);
+
+    if (initCount == 0)
     {
-        initIsDone = 1;
         if(sms_prepSine(SIZE_TABLES))
         {
             sms_error("cannot allocate memory for sine table");
-            return -1;
+            error = -1;
         }
-        if(sms_prepSinc(SIZE_TABLES))
+        else if(sms_prepSinc(SIZE_TABLES))
         {
             sms_error("cannot allocate memory for sinc table");
-            return -1;
+            sms_clearSine();
+            error = -1;
         }
-
+        else
+        {
+            sms_prepFft();
 #ifdef MERSENNE_TWISTER
-        init_gen_rand(1234);
+            init_gen_rand(1234);
 #endif
+        }
     }
 
-    return 0;
+    if(!error)
+        initCount++;
+
+    pthread_mutex_unlock(&initLock);
+    return error;
 }
 
 /*! \brief free global data
  *
  * deallocates memory allocated to global arrays (windows and tables)
+ * when the last user of the library calls sms_free
  */
 void sms_free()
 {
-    initIsDone = 0;
-    sms_clearSine();
-    sms_clearSinc();
+    pthread_mutex_lock(&initLock);
+
+    if (initCount > 0)
+    {
+        initCount--;
+        if (initCount == 0)
+        {
+            sms_clearSine();
+            sms_clearSinc();
+            sms_clearFft();
+        }
+    }
+
+    pthread_mutex_unlock(&initLock);
 }
 
 /*! \brief give default values to an SMS_AnalParams struct
@@ -227,8 +269,10 @@ int sms_initAnalysis(SMS_AnalParams *pAnalParams)
 
     pAnalParams->sizeNextRead = (pAnalParams->iDefaultSizeWindow + 1) * 0.5;
 
-    /* sound buffer */
-    if((pSoundBuf->pFBuffer = (sfloat *) calloc(sizeBuffer, sizeof(sfloat))) == NULL)
+    /* sound buffer, followed by half a window of zeros that are read as
+     * silence by analysis windows that reach past the newest sample */
+    if((pSoundBuf->pFBuffer = (sfloat *) calloc(sizeBuffer + (SMS_MAX_WINDOW >> 1),
+                                                sizeof(sfloat))) == NULL)
     {
         sms_error("Could not allocate memory for sound buffer");
         return -1;
@@ -504,6 +548,8 @@ int sms_initResidual(SMS_ResidualParams *residualParams)
         return -1;
     }
 
+    memset(residualParams->highPassMemory, 0, SMS_HIGH_PASS_ORDER * sizeof(sfloat));
+
     /* residual signal */
     residualParams->residualSize = residualParams->hopSize * 2;
     residualParams->residual = (sfloat *)calloc(residualParams->residualSize, sizeof(sfloat));
@@ -955,7 +1001,7 @@ void sms_writeDebugData(sfloat *pFBuffer1, sfloat *pFBuffer2,
                         sfloat *pFBuffer3, int sizeBuffer)
 {
     int i;
-    static int counter = 0;
+    static SMS_THREAD_LOCAL int counter = 0;
 
     for(i = 0; i < sizeBuffer; i++)
         fprintf(pDebug, "%d %d %d %d\n", counter++, (int)pFBuffer1[i],
@@ -1033,7 +1079,8 @@ void sms_arrayDBToMag(int sizeArray, sfloat *pArray)
 /*! \brief set the linear magnitude threshold
  *
  * magnitudes below this will go to zero when converted to db.
- * it is limited to 0.00001 (-100db)
+ * it is limited to 0.00001 (-100db). the threshold is shared by all
+ * threads, so set it before starting analysis on other threads.
  *
  * \param x  threshold value
  */
@@ -1087,7 +1134,11 @@ char* sms_errorString()
 sfloat sms_random()
 {
 #ifdef MERSENNE_TWISTER
-    return genrand_real1();
+    sfloat r;
+    pthread_mutex_lock(&randomLock);
+    r = genrand_real1();
+    pthread_mutex_unlock(&randomLock);
+    return r;
 #else
     return (sfloat)(random() * 2 * INV_HALF_MAX);
 #endif
@@ -38,6 +38,15 @@
 
 #define sfloat double
 
+/*! \brief storage class for library state that each thread keeps separately */
+#if defined(_MSC_VER)
+#define SMS_THREAD_LOCAL __declspec(thread)
+#else
+#define SMS_THREAD_LOCAL __thread
+#endif
+
+#define SMS_HIGH_PASS_ORDER 5 /*!< \brief number of coefficients in the residual high-pass filter */
+
 /*! \struct SMS_Header 
  *  \brief structure for the header of an SMS file 
  *  
@@ -212,6 +221,7 @@ typedef struct SMSResidualParams
     sfloat *approx;
     sfloat *approxEnvelope;
     sfloat fftBuffer[SMS_MAX_SPEC * 2];
+    sfloat highPassMemory[SMS_HIGH_PASS_ORDER]; /*!< state of the residual high-pass filter */
 } SMS_ResidualParams;
 
 /*! \struct SMS_AnalParams
@@ -477,6 +487,16 @@ enum SMS_ERRORS
     SMS_SNDERR   /*!< 6, sound IO error */
 };
 
+/*! \brief FFT implementations used by sms_fft and sms_ifft
+ *
+ * \see sms_setFFTBackend
+ */
+enum SMS_FFT_BACKENDS
+{
+    SMS_FFT_OOURA, /*!< 0, bundled OOURA real DFT (sizes up to 8192) */
+    SMS_FFT_FFTW   /*!< 1, FFTW3 with cached plans (default if available) */
+};
+
 /*! \brief debug modes 
  *
  * \todo write details about debug files
@@ -692,12 +712,17 @@ int sms_initResidual(SMS_ResidualParams *residualParams);
 void sms_freeResidual(SMS_ResidualParams *residualParams);
 int sms_residual(int sizeWindow, sfloat *pSynthesis, sfloat *pOriginal, 
                  SMS_ResidualParams* residualParams);
-void sms_filterHighPass(int sizeResidual, sfloat *pResidual, int iSamplingRate);
+void sms_filterHighPass(int sizeResidual, sfloat *pResidual, int iSamplingRate,
+                        sfloat *pFilterMemory);
 int sms_stocAnalysis(int sizeWindow, sfloat *pResidual, sfloat *pWindow,
                      SMS_Data *pSmsFrame, SMS_AnalParams *pAnalParams);
 
 void sms_interpolateFrames(SMS_Data *pSmsFrame1, SMS_Data *pSmsFrame2,
                            SMS_Data *pSmsFrameOut, sfloat fInterpFactor);
+int sms_prepFft(void);
+void sms_clearFft(void);
+int sms_setFFTBackend(int iBackend);
+int sms_getFFTBackend(void);
 void sms_fft(int sizeFft, sfloat *pArray);
 void sms_ifft(int sizeFft, sfloat *pArray);
 void sms_RectToPolar(int sizeSpec, sfloat *pReal, sfloat *pMag, sfloat *pPhase);
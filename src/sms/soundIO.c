@@ -34,9 +34,9 @@ void sms_fillSoundBuffer(int sizeWaveform, sfloat *pWaveform, SMS_AnalParams *pA
     int i;
     long sizeNewData = (long)sizeWaveform;
 
-    /* leave space for new data */
-    memcpy(pAnalParams->soundBuffer.pFBuffer, pAnalParams->soundBuffer.pFBuffer+sizeNewData,
-           sizeof(sfloat) * (pAnalParams->soundBuffer.sizeBuffer - sizeNewData));
+    /* leave space for new data (the ranges overlap) */
+    memmove(pAnalParams->soundBuffer.pFBuffer, pAnalParams->soundBuffer.pFBuffer+sizeNewData,
+            sizeof(sfloat) * (pAnalParams->soundBuffer.sizeBuffer - sizeNewData));
 
     pAnalParams->soundBuffer.iFirstGood = MAX(0, pAnalParams->soundBuffer.iFirstGood - sizeNewData);
     pAnalParams->soundBuffer.iMarker += sizeNewData;
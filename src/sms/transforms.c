@@ -26,13 +26,302 @@
 #include "sms.h"
 #include "OOURA.h"
 
+#ifdef HAVE_FFTW3_H
+#include <pthread.h>
+#include "fft_plans.h"
+#endif
+
+/*! \brief an implementation of sms_fft and sms_ifft */
+typedef struct
+{
+    void (*fft)(int sizeFft, sfloat *pArray);
+    void (*ifft)(int sizeFft, sfloat *pArray);
+} SMS_FFTBackend;
+
+/* ------------------------------------------------------------------------
+ * OOURA
+ *
+ * the cos/sin tables are made for the largest FFT size by sms_prepFft,
+ * after which rdft only reads them for any size up to NMAX. ip[0] and
+ * ip[1] hold the table sizes, the rest of ip is scratch space for each
+ * transform. */
 static int ip[NMAXSQRT +2];
 static sfloat w[NMAX * 5 / 4];
 
+static void fftOOURA(int sizeFft, sfloat *pArray)
+{
+    int ipWork[NMAXSQRT + 2];
+    ipWork[0] = ip[0];
+    ipWork[1] = ip[1];
+    rdft(sizeFft, 1, pArray, ipWork, w);
+}
+
+static void ifftOOURA(int sizeFft, sfloat *pArray)
+{
+    int ipWork[NMAXSQRT + 2];
+    ipWork[0] = ip[0];
+    ipWork[1] = ip[1];
+    rdft(sizeFft, -1, pArray, ipWork, w);
+}
+
+static SMS_FFTBackend ooura = {fftOOURA, ifftOOURA};
+
+#ifdef HAVE_FFTW3_H
+/* ------------------------------------------------------------------------
+ * FFTW
+ *
+ * Plans come from the simpl FFT plan cache, which makes them once for
+ * each FFT size and shares them between all threads. Each thread keeps
+ * the plans for its last FFT size next to its own aligned scratch
+ * buffers, so the cache is only searched when the size changes or the
+ * cache is cleared. The scratch buffers are converted to
+ * and from the OOURA data layout:
+ * pArray[0] = Re(X[0]), pArray[1] = Re(X[N/2]),
+ * pArray[2k] = Re(X[k]), pArray[2k + 1] = -Im(X[k]) for 0 < k < N/2,
+ * with the inverse transform scaled by N/2.
+ *
+ * The scratch buffers are also registered with a pthread key, so that
+ * the buffers of worker threads are freed when those threads exit. */
+typedef struct
+{
+    sfloat *real;
+    fftw_complex *complex;
+    int size;
+    fftw_plan plans[2]; /*!< indexed by SIMPL_FFT_R2C and SIMPL_FFT_C2R */
+    int planSizes[2];
+    unsigned planGeneration;
+} FFTWScratch;
+
+static SMS_THREAD_LOCAL FFTWScratch *fftwScratch = NULL;
+static pthread_key_t fftwScratchKey;
+static pthread_once_t fftwScratchKeyOnce = PTHREAD_ONCE_INIT;
+
+static void freeFFTWScratch(void *p)
+{
+    FFTWScratch *scratch = (FFTWScratch *)p;
+    fftw_free(scratch->real);
+    fftw_free(scratch->complex);
+    free(scratch);
+}
+
+static void makeFFTWScratchKey(void)
+{
+    pthread_key_create(&fftwScratchKey, freeFFTWScratch);
+}
+
+/* make sure that this thread has scratch space for an FFT of sizeFft */
+static int prepFFTWScratch(int sizeFft)
+{
+    FFTWScratch *scratch = fftwScratch;
+
+    if(scratch && sizeFft <= scratch->size)
+        return SMS_OK;
+
+    if(!scratch)
+    {
+        pthread_once(&fftwScratchKeyOnce, makeFFTWScratchKey);
+        scratch = (FFTWScratch *)calloc(1, sizeof(FFTWScratch));
+        if(!scratch)
+            return SMS_MALLOC;
+        if(pthread_setspecific(fftwScratchKey, scratch) != 0)
+        {
+            free(scratch);
+            return SMS_MALLOC;
+        }
+        fftwScratch = scratch;
+    }
+
+    fftw_free(scratch->real);
+    fftw_free(scratch->complex);
+    scratch->real = (sfloat *)fftw_malloc(sizeFft * sizeof(sfloat));
+    scratch->complex = (fftw_complex *)fftw_malloc((sizeFft / 2 + 1) * sizeof(fftw_complex));
+    if(!scratch->real || !scratch->complex)
+    {
+        fftw_free(scratch->real);
+        fftw_free(scratch->complex);
+        scratch->real = NULL;
+        scratch->complex = NULL;
+        scratch->size = 0;
+        return SMS_MALLOC;
+    }
+    scratch->size = sizeFft;
+    return SMS_OK;
+}
+
+/* get the plan of the given type (SIMPL_FFT_R2C or SIMPL_FFT_C2R) for
+ * an FFT of sizeFft, after prepFFTWScratch has succeeded */
+static fftw_plan getFFTWPlan(int sizeFft, int type)
+{
+    FFTWScratch *scratch = fftwScratch;
+    unsigned generation = simpl_fft_plan_generation();
+
+    if(scratch->planGeneration != generation)
+    {
+        scratch->planSizes[SIMPL_FFT_R2C] = 0;
+        scratch->planSizes[SIMPL_FFT_C2R] = 0;
+        scratch->planGeneration = generation;
+    }
+
+    if(scratch->planSizes[type] != sizeFft)
+    {
+        scratch->plans[type] = simpl_fft_plan(sizeFft, type);
+        scratch->planSizes[type] = scratch->plans[type] ? sizeFft : 0;
+    }
+    return scratch->plans[type];
+}
+
+static void fftFFTW(int sizeFft, sfloat *pArray)
+{
+    int k;
+    int sizeHalf = sizeFft >> 1;
+    fftw_plan plan = NULL;
+    sfloat *fftwReal;
+    fftw_complex *fftwComplex;
+
+    if(prepFFTWScratch(sizeFft) == SMS_OK)
+        plan = getFFTWPlan(sizeFft, SIMPL_FFT_R2C);
+    if(!plan)
+    {
+        fftOOURA(sizeFft, pArray);
+        return;
+    }
+
+    fftwReal = fftwScratch->real;
+    fftwComplex = fftwScratch->complex;
+    memcpy(fftwReal, pArray, sizeFft * sizeof(sfloat));
+    fftw_execute_dft_r2c(plan, fftwReal, fftwComplex);
+
+    pArray[0] = fftwComplex[0][0];
+    pArray[1] = fftwComplex[sizeHalf][0];
+    for(k = 1; k < sizeHalf; k++)
+    {
+        pArray[2 * k] = fftwComplex[k][0];
+        pArray[2 * k + 1] = -fftwComplex[k][1];
+    }
+}
+
+static void ifftFFTW(int sizeFft, sfloat *pArray)
+{
+    int k;
+    int sizeHalf = sizeFft >> 1;
+    fftw_plan plan = NULL;
+    sfloat *fftwReal;
+    fftw_complex *fftwComplex;
+
+    if(prepFFTWScratch(sizeFft) == SMS_OK)
+        plan = getFFTWPlan(sizeFft, SIMPL_FFT_C2R);
+    if(!plan)
+    {
+        ifftOOURA(sizeFft, pArray);
+        return;
+    }
+
+    fftwReal = fftwScratch->real;
+    fftwComplex = fftwScratch->complex;
+    fftwComplex[0][0] = pArray[0];
+    fftwComplex[0][1] = 0.0;
+    fftwComplex[sizeHalf][0] = pArray[1];
+    fftwComplex[sizeHalf][1] = 0.0;
+    for(k = 1; k < sizeHalf; k++)
+    {
+        fftwComplex[k][0] = pArray[2 * k];
+        fftwComplex[k][1] = -pArray[2 * k + 1];
+    }
+
+    fftw_execute_dft_c2r(plan, fftwComplex, fftwReal);
+
+    for(k = 0; k < sizeFft; k++)
+        pArray[k] = 0.5 * fftwReal[k];
+}
+
+static SMS_FFTBackend fftw = {fftFFTW, ifftFFTW};
+
+static int fftBackendType = SMS_FFT_FFTW;
+static SMS_FFTBackend *fftBackend = &fftw;
+#else
+static int fftBackendType = SMS_FFT_OOURA;
+static SMS_FFTBackend *fftBackend = &ooura;
+#endif
+
+/* ------------------------------------------------------------------------ */
+
+/*! \brief prepare the FFT tables for all sizes up to NMAX
+ *
+ * called by sms_init
+ *
+ * \return SMS_OK
+ */
+int sms_prepFft(void)
+{
+    if(ip[0] == 0)
+    {
+        makewt(NMAX >> 2, ip, w);
+        makect(NMAX >> 2, ip, w + (NMAX >> 2));
+    }
+    return SMS_OK;
+}
+
+/*! \brief free the FFT scratch space of the calling thread
+ *
+ * called by sms_free when the library is no longer used. the scratch
+ * space of other threads is freed when they exit. FFTW plans belong to
+ * the shared plan cache and are kept.
+ */
+void sms_clearFft(void)
+{
+#ifdef HAVE_FFTW3_H
+    if(fftwScratch)
+    {
+        pthread_setspecific(fftwScratchKey, NULL);
+        freeFFTWScratch(fftwScratch);
+        fftwScratch = NULL;
+    }
+#endif
+}
+
+/*! \brief choose the FFT implementation used by sms_fft and sms_ifft
+ *
+ * This is a global setting, it should not be changed while other
+ * threads are running an analysis or synthesis.
+ *
+ * \param iBackend FFT backend \see SMS_FFT_BACKENDS
+ * \return SMS_OK, or -1 if the backend is not available
+ */
+int sms_setFFTBackend(int iBackend)
+{
+    if(iBackend == SMS_FFT_OOURA)
+    {
+        fftBackendType = iBackend;
+        fftBackend = &ooura;
+        return SMS_OK;
+    }
+#ifdef HAVE_FFTW3_H
+    if(iBackend == SMS_FFT_FFTW)
+    {
+        fftBackendType = iBackend;
+        fftBackend = &fftw;
+        return SMS_OK;
+    }
+#endif
+    sms_error("FFT backend is not available");
+    return -1;
+}
+
+/*! \brief get the FFT implementation used by sms_fft and sms_ifft
+ *
+ * \return FFT backend \see SMS_FFT_BACKENDS
+ */
+int sms_getFFTBackend(void)
+{
+    return fftBackendType;
+}
+
 /*! \brief Forward Fast Fourier Transform
  *
- * function to call the OOURA routines to calculate
+ * function to call the current FFT backend to calculate
  * the forward FFT. Operation is in place.
+ * The result has the layout of the OOURA rdft routine
+ * for every backend.
  * \todo if sizeFft != power of 2, there is a silent crash.. cuidado!
  *
  * \param sizeFft size of the FFT in samples (must be a power of 2 >= 2)
@@ -40,12 +329,12 @@ static sfloat w[NMAX * 5 / 4];
  */
 void sms_fft(int sizeFft, sfloat *pArray)
 { 
-    rdft(sizeFft, 1, pArray, ip, w);
+    fftBackend->fft(sizeFft, pArray);
 }
 
 /*! \brief Inverse Forward Fast Fourier Transform
  *
- * function to call the OOURA routines to calculate
+ * function to call the current FFT backend to calculate
  * the Inverse FFT. Operation is in place.
  *
  * \param sizeFft size of the FFT in samples (must be a power of 2 >= 2)
@@ -53,5 +342,5 @@ void sms_fft(int sizeFft, sfloat *pArray)
  */
 void sms_ifft(int sizeFft, sfloat *pArray)
 { 
-    rdft(sizeFft, -1, pArray, ip, w);
+    fftBackend->ifft(sizeFft, pArray);
 }
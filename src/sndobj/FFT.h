@@ -31,6 +31,7 @@
 #include "SndObj.h"
 #include "Table.h"
 #include <fftw3.h>
+#include "fft_plans.h"
 
 class FFT : public SndObj {
  protected:
@@ -0,0 +1,164 @@
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#include "alloc_guard.h"
+#include "../src/simpl/profile.h"
+
+using namespace simpl;
+
+#if defined(__GLIBC__) || !defined(SIMPL_PROFILE)
+
+static __thread bool guard_enabled = false;
+static __thread int num_allocations = 0;
+static __thread int num_deallocations = 0;
+
+static void count_allocation() {
+    if(guard_enabled) {
+        num_allocations++;
+    }
+}
+
+static void count_deallocation(void* p) {
+    if(p && guard_enabled) {
+        num_deallocations++;
+    }
+}
+
+// ---------------------------------------------------------------------------
+//	AllocationGuard
+// ---------------------------------------------------------------------------
+AllocationGuard::AllocationGuard() {
+    num_allocations = 0;
+    num_deallocations = 0;
+    guard_enabled = true;
+}
+
+AllocationGuard::~AllocationGuard() {
+    guard_enabled = false;
+}
+
+int AllocationGuard::allocations() {
+    return num_allocations;
+}
+
+int AllocationGuard::deallocations() {
+    return num_deallocations;
+}
+
+#endif
+
+#if defined(__GLIBC__)
+
+// With glibc the malloc family is replaced, which also counts the memory
+// allocated by operator new (in either build of the library) and by C code
+// such as libsms
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* p);
+
+void* malloc(size_t size) __THROW {
+    count_allocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size) __THROW {
+    count_allocation();
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* p, size_t size) __THROW {
+    count_allocation();
+    count_deallocation(p);
+    return __libc_realloc(p, size);
+}
+
+int posix_memalign(void** p, size_t alignment, size_t size) __THROW {
+    if(alignment % sizeof(void*) != 0 ||
+       (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    count_allocation();
+    *p = __libc_memalign(alignment, size);
+    return *p ? 0 : ENOMEM;
+}
+
+void free(void* p) __THROW {
+    count_deallocation(p);
+    __libc_free(p);
+}
+
+}
+
+#elif !defined(SIMPL_PROFILE)
+
+#if __cplusplus >= 201103L
+    #define ALLOC_GUARD_THROW noexcept(false)
+    #define ALLOC_GUARD_NOTHROW noexcept
+#else
+    #define ALLOC_GUARD_THROW throw(std::bad_alloc)
+    #define ALLOC_GUARD_NOTHROW throw()
+#endif
+
+static void* guarded_alloc(std::size_t size) {
+    count_allocation();
+
+    void* p = malloc(size ? size : 1);
+    if(!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+static void guarded_free(void* p) {
+    count_deallocation(p);
+    free(p);
+}
+
+void* operator new(std::size_t size) ALLOC_GUARD_THROW {
+    return guarded_alloc(size);
+}
+
+void* operator new[](std::size_t size) ALLOC_GUARD_THROW {
+    return guarded_alloc(size);
+}
+
+void operator delete(void* p) ALLOC_GUARD_NOTHROW {
+    guarded_free(p);
+}
+
+void operator delete[](void* p) ALLOC_GUARD_NOTHROW {
+    guarded_free(p);
+}
+
+#else
+
+// Profiling builds of the library replace operator new and delete
+// themselves, counting every allocation made on each thread
+static __thread long first_allocation = 0;
+static __thread long first_deallocation = 0;
+
+// ---------------------------------------------------------------------------
+//	AllocationGuard
+// ---------------------------------------------------------------------------
+AllocationGuard::AllocationGuard() {
+    first_allocation = thread_allocations();
+    first_deallocation = thread_deallocations();
+}
+
+AllocationGuard::~AllocationGuard() {
+}
+
+int AllocationGuard::allocations() {
+    return (int)(thread_allocations() - first_allocation);
+}
+
+int AllocationGuard::deallocations() {
+    return (int)(thread_deallocations() - first_deallocation);
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef ALLOC_GUARD_H
+#define ALLOC_GUARD_H
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	AllocationGuard
+//
+// The test suite counts the allocations and deallocations made on a thread
+// while an AllocationGuard exists on that thread, so that tests can check
+// that code does not allocate memory. With glibc, malloc, calloc, realloc,
+// posix_memalign and free are replaced, so memory allocated by C code is
+// counted along with operator new. Elsewhere only operator new and delete
+// are counted: the test suite replaces them, or in library builds with
+// SIMPL_PROFILE the library's own counting operators are used.
+// ---------------------------------------------------------------------------
+class AllocationGuard {
+    public:
+        AllocationGuard();
+        ~AllocationGuard();
+        int allocations();
+        int deallocations();
+};
+
+} // end of namespace simpl
+
+#endif
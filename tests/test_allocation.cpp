@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "test_allocation.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestAllocation
+// ---------------------------------------------------------------------------
+static const int ALLOC_FRAME_SIZE = 512;
+static const int ALLOC_HOP_SIZE = 256;
+static const int ALLOC_WARMUP_FRAMES = 4;
+
+// Analyse and synthesise audio frame by frame, counting the allocations
+// made by each stage after the first few frames
+static void check_allocations(PeakDetection* pd, PartialTracking* pt,
+                              Synthesis* synth, std::vector<sample>& audio) {
+    pd->frame_size(ALLOC_FRAME_SIZE);
+    pd->hop_size(ALLOC_HOP_SIZE);
+    synth->hop_size(ALLOC_HOP_SIZE);
+
+    Frame frame(ALLOC_FRAME_SIZE, true);
+    frame.max_peaks(pd->max_peaks());
+    frame.max_partials(pt->max_partials());
+    frame.synth_size(ALLOC_HOP_SIZE);
+
+    int num_frames = ((int)audio.size() - ALLOC_FRAME_SIZE) / ALLOC_HOP_SIZE;
+    int pd_allocations = 0;
+    int pt_allocations = 0;
+    int synth_allocations = 0;
+    int num_peaks = 0;
+
+    for(int i = 0; i < num_frames; i++) {
+        std::copy(audio.begin() + (i * ALLOC_HOP_SIZE),
+                  audio.begin() + (i * ALLOC_HOP_SIZE) + ALLOC_FRAME_SIZE,
+                  frame.audio());
+        frame.clear_peaks();
+        frame.clear_partials();
+        frame.clear_synth();
+
+        if(i < ALLOC_WARMUP_FRAMES) {
+            pd->find_peaks_in_frame(&frame);
+            pt->update_partials(&frame);
+            synth->synth_frame(&frame);
+            continue;
+        }
+
+        AllocationGuard pd_guard;
+        pd->find_peaks_in_frame(&frame);
+        pd_allocations += pd_guard.allocations() + pd_guard.deallocations();
+
+        AllocationGuard pt_guard;
+        pt->update_partials(&frame);
+        pt_allocations += pt_guard.allocations() + pt_guard.deallocations();
+
+        AllocationGuard synth_guard;
+        synth->synth_frame(&frame);
+        synth_allocations += synth_guard.allocations() +
+                             synth_guard.deallocations();
+
+        num_peaks += frame.num_peaks();
+    }
+
+    CPPUNIT_ASSERT(num_peaks > 0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("peak detection", 0, pd_allocations);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("partial tracking", 0, pt_allocations);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("synthesis", 0, synth_allocations);
+}
+
+void TestAllocation::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+
+    int start = (int)_sf.frames() / 2;
+    _audio.assign(audio.begin() + start, audio.begin() + start + 16384);
+}
+
+void TestAllocation::test_guard() {
+    AllocationGuard guard;
+    CPPUNIT_ASSERT_EQUAL(0, guard.allocations());
+
+    Frame* frame = new Frame(512, true);
+    int num_allocations = guard.allocations();
+    CPPUNIT_ASSERT(num_allocations > 0);
+    CPPUNIT_ASSERT_EQUAL(0, guard.deallocations());
+
+    delete frame;
+    CPPUNIT_ASSERT_EQUAL(num_allocations, guard.deallocations());
+
+#if defined(__GLIBC__)
+    // memory allocated by C code is also counted
+    // (volatile so that the compiler cannot remove unused allocations)
+    AllocationGuard c_guard;
+    void* volatile p = malloc(16);
+    p = realloc(p, 1024);
+    void* volatile q = calloc(4, 16);
+    free(p);
+    free(q);
+    CPPUNIT_ASSERT_EQUAL(3, c_guard.allocations());
+    CPPUNIT_ASSERT_EQUAL(3, c_guard.deallocations());
+#endif
+}
+
+void TestAllocation::test_mq() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    check_allocations(&pd, &pt, &synth, _audio);
+}
+
+void TestAllocation::test_lp() {
+    MQPeakDetection pd;
+    LPPartialTracking pt;
+    MQSynthesis synth;
+    check_allocations(&pd, &pt, &synth, _audio);
+}
+
+void TestAllocation::test_sms() {
+    SMSPeakDetection pd;
+    SMSPartialTracking pt;
+    SMSSynthesis synth;
+    pd.realtime(1);
+    pt.realtime(true);
+    check_allocations(&pd, &pt, &synth, _audio);
+}
+
+void TestAllocation::test_sndobj() {
+    SndObjPeakDetection pd;
+    SndObjPartialTracking pt;
+    SndObjSynthesis synth;
+    check_allocations(&pd, &pt, &synth, _audio);
+}
+
+void TestAllocation::test_loris() {
+    LorisPeakDetection pd;
+    LorisPartialTracking pt;
+    LorisSynthesis synth;
+    check_allocations(&pd, &pt, &synth, _audio);
+}
+
+void TestAllocation::test_ifft_synthesis() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    IFFTSynthesis synth;
+    check_allocations(&pd, &pt, &synth, _audio);
+}
+
+void TestAllocation::test_stream() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    pd.frame_size(ALLOC_FRAME_SIZE);
+    pd.hop_size(ALLOC_HOP_SIZE);
+
+    Stream stream(&pd, &pt, &synth);
+    std::vector<sample> output(_audio.size());
+
+    int warmup = ALLOC_WARMUP_FRAMES * ALLOC_HOP_SIZE + ALLOC_FRAME_SIZE;
+    stream.process(warmup, &_audio[0], &output[0]);
+
+    AllocationGuard guard;
+    for(int pos = warmup; pos + 64 <= _audio.size(); pos += 64) {
+        stream.process(64, &_audio[pos], &output[pos]);
+    }
+    CPPUNIT_ASSERT_EQUAL(0, guard.allocations());
+    CPPUNIT_ASSERT_EQUAL(0, guard.deallocations());
+}
+
+void TestAllocation::test_twm() {
+    MQPeakDetection pd;
+    pd.frame_size(ALLOC_FRAME_SIZE);
+    pd.hop_size(ALLOC_HOP_SIZE);
+
+    Frame frame(ALLOC_FRAME_SIZE, true);
+    frame.max_peaks(pd.max_peaks());
+
+    TWM estimator;
+    estimator.max_peaks(pd.max_peaks());
+
+    int num_frames = ((int)_audio.size() - ALLOC_FRAME_SIZE) / ALLOC_HOP_SIZE;
+    int allocations = 0;
+    int num_estimates = 0;
+
+    for(int i = 0; i < num_frames; i++) {
+        std::copy(_audio.begin() + (i * ALLOC_HOP_SIZE),
+                  _audio.begin() + (i * ALLOC_HOP_SIZE) + ALLOC_FRAME_SIZE,
+                  frame.audio());
+        frame.clear_peaks();
+        pd.find_peaks_in_frame(&frame);
+
+        AllocationGuard guard;
+        if(estimator.find_f0(&frame) > 0) {
+            num_estimates++;
+        }
+        allocations += guard.allocations() + guard.deallocations();
+    }
+
+    CPPUNIT_ASSERT(num_estimates > 0);
+    CPPUNIT_ASSERT_EQUAL(0, allocations);
+}
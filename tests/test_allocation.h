@@ -0,0 +1,53 @@
+#ifndef TEST_ALLOCATION_H
+#define TEST_ALLOCATION_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/peak_detection.h"
+#include "../src/simpl/partial_tracking.h"
+#include "../src/simpl/synthesis.h"
+#include "../src/simpl/stream.h"
+#include "alloc_guard.h"
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestAllocation
+// ---------------------------------------------------------------------------
+class TestAllocation : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestAllocation);
+    CPPUNIT_TEST(test_guard);
+    CPPUNIT_TEST(test_mq);
+    CPPUNIT_TEST(test_lp);
+    CPPUNIT_TEST(test_sms);
+    CPPUNIT_TEST(test_sndobj);
+    CPPUNIT_TEST(test_loris);
+    CPPUNIT_TEST(test_ifft_synthesis);
+    CPPUNIT_TEST(test_stream);
+    CPPUNIT_TEST(test_twm);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    SndfileHandle _sf;
+    std::vector<sample> _audio;
+
+    void test_guard();
+    void test_mq();
+    void test_lp();
+    void test_sms();
+    void test_sndobj();
+    void test_loris();
+    void test_ifft_synthesis();
+    void test_stream();
+    void test_twm();
+};
+
+} // end of namespace simpl
+
+#endif
@@ -0,0 +1,207 @@
+#include "test_archive.h"
+
+using namespace simpl;
+
+static const char* TEST_ARCHIVE_FILE = "test_archive.simpl";
+
+// ---------------------------------------------------------------------------
+//	TestArchive
+// ---------------------------------------------------------------------------
+static void check_values(int n, sample* expected, sample* values) {
+    for(int i = 0; i < n; i++) {
+        CPPUNIT_ASSERT_EQUAL(expected[i], values[i]);
+    }
+}
+
+void TestArchive::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    int num_samples = 8192;
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+    _audio.assign(audio.begin() + ((int)_sf.frames() / 2),
+                  audio.begin() + ((int)_sf.frames() / 2) + num_samples);
+
+    _pd.frame_size(512);
+    _pd.hop_size(256);
+    _synth.hop_size(256);
+
+    _frames = _pd.find_peaks(_audio.size(), &_audio[0]);
+    _pt.find_partials(_frames);
+    _synth.synth(_frames);
+
+    for(int i = 0; i < _frames.size(); i++) {
+        for(int j = 0; j < _frames[i]->size(); j++) {
+            _frames[i]->residual()[j] = i + (j * 0.001);
+        }
+    }
+}
+
+void TestArchive::tearDown() {
+    remove(TEST_ARCHIVE_FILE);
+}
+
+void TestArchive::test_errors() {
+    Archive archive;
+    CPPUNIT_ASSERT(!archive.is_open());
+    CPPUNIT_ASSERT_THROW(archive.open("missing.simpl"), Exception);
+
+    // not an archive
+    FILE* file = fopen(TEST_ARCHIVE_FILE, "wb");
+    std::vector<char> zeros(1024, 0);
+    fwrite(&zeros[0], 1, zeros.size(), file);
+    fclose(file);
+    CPPUNIT_ASSERT_THROW(archive.open(TEST_ARCHIVE_FILE), Exception);
+    CPPUNIT_ASSERT(!archive.is_open());
+
+    // truncated
+    write_archive(TEST_ARCHIVE_FILE, _frames, 44100, 256);
+    archive.open(TEST_ARCHIVE_FILE);
+    CPPUNIT_ASSERT(archive.is_open());
+    CPPUNIT_ASSERT_THROW(archive.num_peaks(-1), Exception);
+    CPPUNIT_ASSERT_THROW(archive.num_peaks(_frames.size()), Exception);
+    archive.close();
+    CPPUNIT_ASSERT(!archive.is_open());
+
+    file = fopen(TEST_ARCHIVE_FILE, "rb");
+    std::vector<char> data(100000);
+    int size = fread(&data[0], 1, data.size(), file);
+    fclose(file);
+    file = fopen(TEST_ARCHIVE_FILE, "wb");
+    fwrite(&data[0], 1, size - 100, file);
+    fclose(file);
+    CPPUNIT_ASSERT_THROW(archive.open(TEST_ARCHIVE_FILE), Exception);
+
+    // written by a newer version
+    ((ArchiveHeader*)&data[0])->version = ARCHIVE_VERSION + 1;
+    file = fopen(TEST_ARCHIVE_FILE, "wb");
+    fwrite(&data[0], 1, size, file);
+    fclose(file);
+    CPPUNIT_ASSERT_THROW(archive.open(TEST_ARCHIVE_FILE), Exception);
+
+    // frames without audio buffers
+    Frame frame(512, false);
+    Frames frames(1, &frame);
+    CPPUNIT_ASSERT_THROW(write_archive(TEST_ARCHIVE_FILE, frames, 44100, 256,
+                                       ARCHIVE_AUDIO),
+                         Exception);
+}
+
+void TestArchive::test_read_write() {
+    write_archive(TEST_ARCHIVE_FILE, _frames, 44100, 256,
+                  ARCHIVE_PEAKS | ARCHIVE_PARTIALS | ARCHIVE_AUDIO |
+                  ARCHIVE_SYNTH | ARCHIVE_RESIDUAL);
+
+    Archive archive(TEST_ARCHIVE_FILE);
+    CPPUNIT_ASSERT_EQUAL((int)ARCHIVE_VERSION, archive.version());
+    CPPUNIT_ASSERT_EQUAL(44100, archive.sampling_rate());
+    CPPUNIT_ASSERT_EQUAL(256, archive.hop_size());
+    CPPUNIT_ASSERT_EQUAL((int)_frames.size(), archive.num_frames());
+    CPPUNIT_ASSERT(archive.num_frames() > 0);
+
+    Frame frame(64, true);
+    for(int i = 0; i < _frames.size(); i++) {
+        Frame* f = _frames[i];
+        archive.read_frame(i, &frame);
+
+        CPPUNIT_ASSERT_EQUAL(f->num_peaks(), frame.num_peaks());
+        check_values(f->num_peaks(), f->peak_amplitudes(),
+                     frame.peak_amplitudes());
+        check_values(f->num_peaks(), f->peak_frequencies(),
+                     frame.peak_frequencies());
+        check_values(f->num_peaks(), f->peak_phases(), frame.peak_phases());
+        check_values(f->num_peaks(), f->peak_bandwidths(),
+                     frame.peak_bandwidths());
+
+        CPPUNIT_ASSERT_EQUAL(f->num_partials(), frame.num_partials());
+        check_values(f->num_partials(), f->partial_amplitudes(),
+                     frame.partial_amplitudes());
+        check_values(f->num_partials(), f->partial_frequencies(),
+                     frame.partial_frequencies());
+        check_values(f->num_partials(), f->partial_phases(),
+                     frame.partial_phases());
+        check_values(f->num_partials(), f->partial_bandwidths(),
+                     frame.partial_bandwidths());
+
+        CPPUNIT_ASSERT_EQUAL(f->size(), frame.size());
+        CPPUNIT_ASSERT_EQUAL(f->synth_size(), frame.synth_size());
+        check_values(f->size(), f->audio(), frame.audio());
+        check_values(f->size(), f->residual(), frame.residual());
+        check_values(f->synth_size(), f->synth(), frame.synth());
+    }
+
+    // only the peaks
+    write_archive(TEST_ARCHIVE_FILE, _frames, 44100, 256, ARCHIVE_PEAKS);
+    archive.open(TEST_ARCHIVE_FILE);
+    CPPUNIT_ASSERT_EQUAL((int)ARCHIVE_PEAKS, archive.contents());
+    CPPUNIT_ASSERT(archive.peak_frequencies() != NULL);
+    CPPUNIT_ASSERT(archive.partial_frequencies() == NULL);
+    CPPUNIT_ASSERT(archive.audio() == NULL);
+    CPPUNIT_ASSERT_EQUAL(0, archive.num_partials(0));
+    CPPUNIT_ASSERT_EQUAL(0, archive.frame_size(0));
+
+    frame.clear();
+    archive.read_frame(3, &frame);
+    CPPUNIT_ASSERT_EQUAL(_frames[3]->num_peaks(), frame.num_peaks());
+    CPPUNIT_ASSERT_EQUAL(0, frame.num_partials());
+}
+
+void TestArchive::test_columns() {
+    write_archive(TEST_ARCHIVE_FILE, _frames, 44100, 256);
+    Archive archive(TEST_ARCHIVE_FILE);
+
+    uint64_t* peak_starts = archive.peak_starts();
+    uint64_t* partial_starts = archive.partial_starts();
+    CPPUNIT_ASSERT(archive.audio_starts() == NULL);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, peak_starts[0]);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)archive.num_peaks(),
+                         peak_starts[archive.num_frames()]);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)archive.num_partials(),
+                         partial_starts[archive.num_frames()]);
+
+    size_t alignment = ARCHIVE_ALIGNMENT;
+    CPPUNIT_ASSERT_EQUAL((size_t)0,
+                         (size_t)archive.peak_frequencies() % alignment);
+    CPPUNIT_ASSERT_EQUAL((size_t)0,
+                         (size_t)archive.partial_bandwidths() % alignment);
+
+    for(int i = 0; i < _frames.size(); i++) {
+        Frame* f = _frames[i];
+        CPPUNIT_ASSERT_EQUAL(f->num_peaks(), archive.num_peaks(i));
+        CPPUNIT_ASSERT_EQUAL(f->num_partials(), archive.num_partials(i));
+        check_values(f->num_peaks(), f->peak_frequencies(),
+                     archive.peak_frequencies() + peak_starts[i]);
+        check_values(f->num_partials(), f->partial_amplitudes(),
+                     archive.partial_amplitudes() + partial_starts[i]);
+    }
+
+    // time index
+    double hop_time = 256.0 / 44100;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3 * hop_time, archive.frame_time(3),
+                                 PRECISION);
+    CPPUNIT_ASSERT_EQUAL(3, archive.frame_at(archive.frame_time(3)));
+    CPPUNIT_ASSERT_EQUAL(3, archive.frame_at(3.5 * hop_time));
+    CPPUNIT_ASSERT_EQUAL(0, archive.frame_at(-1.0));
+    CPPUNIT_ASSERT_EQUAL(archive.num_frames() - 1, archive.frame_at(1000.0));
+}
+
+void TestArchive::test_audio_views() {
+    write_archive(TEST_ARCHIVE_FILE, _frames, 44100, 256,
+                  ARCHIVE_AUDIO | ARCHIVE_SYNTH);
+    Archive archive(TEST_ARCHIVE_FILE);
+
+    // frames that do not manage their memory use the archive buffers
+    Frame frame(512, false);
+    archive.read_frame(2, &frame);
+    CPPUNIT_ASSERT(frame.audio() == archive.audio() +
+                                    archive.audio_starts()[2]);
+    CPPUNIT_ASSERT(frame.synth() == archive.synth() +
+                                    archive.synth_starts()[2]);
+    check_values(frame.size(), _frames[2]->audio(), frame.audio());
+
+    // the map is private, so changes are not written to the file
+    frame.audio()[0] = 10.0;
+    archive.open(TEST_ARCHIVE_FILE);
+    CPPUNIT_ASSERT_EQUAL(_frames[2]->audio()[0],
+                         (archive.audio() + archive.audio_starts()[2])[0]);
+}
@@ -0,0 +1,47 @@
+#ifndef TEST_ARCHIVE_H
+#define TEST_ARCHIVE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/peak_detection.h"
+#include "../src/simpl/partial_tracking.h"
+#include "../src/simpl/synthesis.h"
+#include "../src/simpl/archive.h"
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestArchive
+// ---------------------------------------------------------------------------
+class TestArchive : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestArchive);
+    CPPUNIT_TEST(test_errors);
+    CPPUNIT_TEST(test_read_write);
+    CPPUNIT_TEST(test_columns);
+    CPPUNIT_TEST(test_audio_views);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+protected:
+    SndfileHandle _sf;
+    std::vector<sample> _audio;
+    MQPeakDetection _pd;
+    MQPartialTracking _pt;
+    MQSynthesis _synth;
+    Frames _frames;
+
+    void test_errors();
+    void test_read_write();
+    void test_columns();
+    void test_audio_views();
+};
+
+} // end of namespace simpl
+
+#endif
@@ -0,0 +1,79 @@
+import os
+import tempfile
+import numpy as np
+import simpl
+import simpl.peak_detection as peak_detection
+import simpl.partial_tracking as partial_tracking
+import simpl.archive as archive
+
+frame_size = 512
+hop_size = 512
+max_peaks = 10
+max_partials = 10
+num_frames = 30
+num_samples = num_frames * hop_size
+audio_path = os.path.join(
+    os.path.dirname(__file__), 'audio/flute.wav'
+)
+
+
+class TestArchive(object):
+    @classmethod
+    def setup_class(cls):
+        cls.audio = simpl.read_wav(audio_path)[0]
+        cls.audio = cls.audio[0:num_samples]
+
+        pd = peak_detection.SMSPeakDetection()
+        pd.hop_size = hop_size
+        pd.max_peaks = max_peaks
+        cls.frames = pd.find_peaks(cls.audio)
+
+        pt = partial_tracking.SMSPartialTracking()
+        pt.max_partials = max_partials
+        cls.frames = pt.find_partials(cls.frames)
+
+    def setup(self):
+        fd, self.path = tempfile.mkstemp(suffix='.simpl')
+        os.close(fd)
+
+    def teardown(self):
+        os.remove(self.path)
+
+    def test_columns(self):
+        archive.write_archive(self.path, self.frames, 44100, hop_size)
+        a = archive.Archive(self.path)
+
+        assert len(a) == len(self.frames)
+        assert a.hop_size == hop_size
+        assert a.contents == archive.ARCHIVE_PEAKS | archive.ARCHIVE_PARTIALS
+        assert a.audio is None
+
+        peak_starts = a.peak_starts
+        partial_starts = a.partial_starts
+        frequencies = a.peak_frequencies
+        amplitudes = a.partial_amplitudes
+        for i, frame in enumerate(self.frames):
+            peaks = frequencies[peak_starts[i]:peak_starts[i + 1]]
+            assert len(peaks) == len(frame.peaks)
+            for peak, frequency in zip(frame.peaks, peaks):
+                assert peak.frequency == frequency
+
+            partials = amplitudes[partial_starts[i]:partial_starts[i + 1]]
+            assert len(partials) == len(frame.partials)
+            for partial, amplitude in zip(frame.partials, partials):
+                assert partial.amplitude == amplitude
+
+    def test_columns_outlive_archive(self):
+        archive.write_archive(self.path, self.frames, 44100, hop_size)
+        frequencies = archive.Archive(self.path).peak_frequencies
+        assert frequencies[0] == self.frames[0].peaks[0].frequency
+
+    def test_frame(self):
+        archive.write_archive(self.path, self.frames, 44100, hop_size,
+                              archive.ARCHIVE_PEAKS | archive.ARCHIVE_AUDIO)
+        a = archive.Archive(self.path)
+
+        f = a.frame(5)
+        assert len(f.peaks) == len(self.frames[5].peaks)
+        assert np.all(f.audio == self.frames[5].audio)
+        assert a.frame_at(a.frame_time(5)) == 5
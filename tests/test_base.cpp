@@ -50,16 +50,118 @@ void TestFrame::test_add_peak() {
     frame->add_peak(1.5, 220, 0, 0);
     CPPUNIT_ASSERT(frame->max_peaks() == 100);
     CPPUNIT_ASSERT(frame->num_peaks() == 1);
-    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, frame->peak(0)->amplitude, PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, frame->peak(0).amplitude, PRECISION);
 
     frame->add_peak(2.0, 440, 0, 0);
     CPPUNIT_ASSERT(frame->max_peaks() == 100);
     CPPUNIT_ASSERT(frame->num_peaks() == 2);
-    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, frame->peak(1)->amplitude, PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, frame->peak(1).amplitude, PRECISION);
 
     frame->clear();
 }
 
+void TestFrame::test_peak_arrays() {
+    frame->add_peak(1.5, 220, 0.5, 0.1);
+    frame->add_peak(2.0, 440, 0.25, 0.2);
+    frame->add_partial(0.5, 110, 0.75, 0.3);
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, frame->peak_amplitudes()[0], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, frame->peak_amplitudes()[1], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(440, frame->peak_frequencies()[1], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, frame->peak_phases()[1], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, frame->peak_bandwidths()[1], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, frame->peak_amplitudes()[2], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(110, frame->partial_frequencies()[0],
+                                 PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.3, frame->partial_bandwidths()[0],
+                                 PRECISION);
+
+    frame->peak(1, 3.0, 880, 0, 0);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, frame->peak(1).amplitude, PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(880, frame->peak_frequencies()[1], PRECISION);
+
+    Peak p = frame->peak(1);
+    p.amplitude = 4.0;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, frame->peak(1).amplitude, PRECISION);
+
+    frame->clear();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, frame->peak_amplitudes()[0], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, frame->partial_amplitudes()[0],
+                                 PRECISION);
+
+    Frame empty(256, true);
+    empty.max_peaks(0);
+    empty.max_partials(0);
+    CPPUNIT_ASSERT(empty.peak_amplitudes() == NULL);
+    CPPUNIT_ASSERT(empty.peak_bandwidths() == NULL);
+    CPPUNIT_ASSERT(empty.partial_frequencies() == NULL);
+    CPPUNIT_ASSERT(empty.partial_phases() == NULL);
+}
+
+void TestFrame::test_copy_peaks() {
+    Frame f1(256, true);
+    Frame f2(256, true);
+    f1.max_peaks(2);
+    f2.max_peaks(4);
+    f1.add_peak(1.5, 220, 0.5, 0.1);
+    f1.add_peak(2.0, 440, 0.25, 0.2);
+    f2.add_peak(0.5, 110, 0.75, 0.3);
+
+    Frames frames;
+    frames.push_back(&f1);
+    frames.push_back(&f2);
+    CPPUNIT_ASSERT(max_peaks(frames) == 4);
+
+    std::vector<sample> amps(8, -1);
+    std::vector<sample> freqs(8, -1);
+    std::vector<sample> bws(8, -1);
+    copy_peaks(frames, 4, &amps[0], &freqs[0], NULL, &bws[0]);
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, amps[0], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, amps[1], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, amps[2], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, amps[3], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, amps[4], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, amps[5], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(440, freqs[1], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(110, freqs[4], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.3, bws[4], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, bws[7], PRECISION);
+
+    // rows narrower than the number of peaks are truncated
+    std::vector<sample> narrow(2, -1);
+    copy_peaks(frames, 1, &narrow[0], NULL, NULL, NULL);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, narrow[0], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, narrow[1], PRECISION);
+}
+
+void TestFrame::test_copy_partials() {
+    Frame f1(256, true);
+    Frame f2(256, true);
+    f1.max_partials(3);
+    f2.max_partials(3);
+    f1.add_partial(1.5, 220, 0.5, 0.1);
+    f2.add_partial(0.0, 0.0, 0.0, 0.0);
+    f2.add_partial(0.5, 110, 0.75, 0.3);
+
+    Frames frames;
+    frames.push_back(&f1);
+    frames.push_back(&f2);
+    CPPUNIT_ASSERT(max_partials(frames) == 3);
+
+    std::vector<sample> amps(6, -1);
+    std::vector<sample> phases(6, -1);
+    copy_partials(frames, 3, &amps[0], NULL, &phases[0], NULL);
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, amps[0], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, amps[1], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, amps[3], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, amps[4], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, amps[5], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, phases[0], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75, phases[4], PRECISION);
+}
+
 void TestFrame::test_clear() {
     frame->add_peak(1.5, 220, 0, 0);
     CPPUNIT_ASSERT(frame->num_peaks() == 1);
@@ -89,3 +191,125 @@ void TestFrame::test_audio() {
         CPPUNIT_ASSERT(frame->audio()[i] == rotated_samples[i]);
     }
 }
+
+void TestFrame::test_audio_view() {
+    sample samples[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    frame->size(8);
+
+    frame->audio_view(&samples[0], 8);
+    CPPUNIT_ASSERT(frame->audio() == &samples[0]);
+
+    // a partial view is zero padded in the same way as a copy
+    Frame copy(8, true);
+    copy.audio(&samples[0], 3);
+    frame->audio_view(&samples[0], 3);
+    CPPUNIT_ASSERT(frame->audio() != &samples[0]);
+    for(int i = 0; i < 8; i++) {
+        CPPUNIT_ASSERT(frame->audio()[i] == copy.audio()[i]);
+    }
+
+    copy.clear();
+    copy.audio(&samples[0], 4);
+    frame->audio_view(&samples[0], 4);
+    for(int i = 0; i < 8; i++) {
+        CPPUNIT_ASSERT(frame->audio()[i] == copy.audio()[i]);
+    }
+
+    // copying over a view does not change the viewed samples
+    sample new_samples[8] = {8, 9, 10, 11, 12, 13, 14, 15};
+    frame->audio_view(&samples[0], 8);
+    frame->audio(&new_samples[0], 8);
+    CPPUNIT_ASSERT(frame->audio() != &samples[0]);
+    for(int i = 0; i < 8; i++) {
+        CPPUNIT_ASSERT(samples[i] == i);
+        CPPUNIT_ASSERT(frame->audio()[i] == new_samples[i]);
+    }
+
+    // a hop sized view is added to the existing audio in the same way as
+    // a copy, including audio from an earlier view
+    copy.audio(&samples[0], 8);
+    copy.audio(&new_samples[0], 4);
+    copy.audio(&samples[4], 4);
+    frame->audio_view(&samples[0], 8);
+    frame->audio_view(&new_samples[0], 4);
+    frame->audio_view(&samples[4], 4);
+    for(int i = 0; i < 8; i++) {
+        CPPUNIT_ASSERT(frame->audio()[i] == copy.audio()[i]);
+    }
+    CPPUNIT_ASSERT(frame->audio()[0] == 8);
+    CPPUNIT_ASSERT(frame->audio()[4] == 4);
+
+    CPPUNIT_ASSERT_THROW(frame->audio_view(&samples[0], 9), Exception);
+}
+
+
+// ---------------------------------------------------------------------------
+//	TestFramePool
+// ---------------------------------------------------------------------------
+
+void TestFramePool::setUp() {
+    pool = new FramePool();
+}
+
+void TestFramePool::tearDown() {
+    delete pool;
+}
+
+void TestFramePool::test_acquire() {
+    Frame* f = pool->acquire(512);
+    CPPUNIT_ASSERT(f);
+    CPPUNIT_ASSERT(f->size() == 512);
+    CPPUNIT_ASSERT(pool->num_free_frames() == 0);
+    delete f;
+}
+
+void TestFramePool::test_release() {
+    Frames frames;
+    for(int i = 0; i < 4; i++) {
+        frames.push_back(pool->acquire(512));
+    }
+    Frame* f = frames[3];
+
+    pool->release(frames);
+    CPPUNIT_ASSERT(frames.size() == 0);
+    CPPUNIT_ASSERT(pool->num_free_frames() == 4);
+
+    CPPUNIT_ASSERT(pool->acquire(512) == f);
+    CPPUNIT_ASSERT(pool->num_free_frames() == 3);
+    pool->release(f);
+}
+
+void TestFramePool::test_reserve() {
+    pool->reserve(8, 1024);
+    CPPUNIT_ASSERT(pool->num_free_frames() == 8);
+
+    Frame* f = pool->acquire(1024);
+    CPPUNIT_ASSERT(f->size() == 1024);
+    CPPUNIT_ASSERT(pool->num_free_frames() == 7);
+    pool->release(f);
+
+    pool->clear();
+    CPPUNIT_ASSERT(pool->num_free_frames() == 0);
+}
+
+void TestFramePool::test_reset() {
+    Frame* f = pool->acquire(1024);
+    sample samples[4] = {1, 2, 3, 4};
+    f->audio(&samples[0], 4);
+    f->max_peaks(200);
+    f->add_peak(0.5, 220, 0, 0);
+    f->max_partials(200);
+    f->add_partial(0.5, 220, 0, 0);
+    pool->release(f);
+
+    f = pool->acquire(256);
+    CPPUNIT_ASSERT(f->size() == 256);
+    CPPUNIT_ASSERT(f->max_peaks() == 100);
+    CPPUNIT_ASSERT(f->num_peaks() == 0);
+    CPPUNIT_ASSERT(f->max_partials() == 100);
+    CPPUNIT_ASSERT(f->num_partials() == 0);
+    for(int i = 0; i < f->size(); i++) {
+        CPPUNIT_ASSERT(f->audio()[i] == 0);
+    }
+    pool->release(f);
+}
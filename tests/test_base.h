@@ -40,8 +40,12 @@ class TestFrame : public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST(test_max_peaks);
     CPPUNIT_TEST(test_max_partials);
     CPPUNIT_TEST(test_add_peak);
+    CPPUNIT_TEST(test_peak_arrays);
+    CPPUNIT_TEST(test_copy_peaks);
+    CPPUNIT_TEST(test_copy_partials);
     CPPUNIT_TEST(test_clear);
     CPPUNIT_TEST(test_audio);
+    CPPUNIT_TEST(test_audio_view);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -56,8 +60,37 @@ protected:
     void test_max_peaks();
     void test_max_partials();
     void test_add_peak();
+    void test_peak_arrays();
+    void test_copy_peaks();
+    void test_copy_partials();
     void test_clear();
     void test_audio();
+    void test_audio_view();
+};
+
+
+// ---------------------------------------------------------------------------
+//	TestFramePool
+// ---------------------------------------------------------------------------
+class TestFramePool : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestFramePool);
+    CPPUNIT_TEST(test_acquire);
+    CPPUNIT_TEST(test_release);
+    CPPUNIT_TEST(test_reserve);
+    CPPUNIT_TEST(test_reset);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+protected:
+    FramePool* pool;
+
+    void test_acquire();
+    void test_release();
+    void test_reserve();
+    void test_reset();
 };
 
 } // end of namespace simpl
@@ -71,3 +71,44 @@ class TestFrame(object):
                              float_precision)
         assert_almost_equals(f.partial(0).frequency, p.frequency,
                              float_precision)
+
+    def test_peak_arrays(self):
+        f1 = base.Frame(frame_size)
+        f1.max_peaks = 2
+        f2 = base.Frame(frame_size)
+        f2.max_peaks = 4
+        for amp, freq in [(0.5, 220.0), (0.25, 440.0)]:
+            p = base.Peak()
+            p.amplitude = amp
+            p.frequency = freq
+            f1.add_peak(p)
+        p = base.Peak()
+        p.amplitude = 0.75
+        p.frequency = 110.0
+        f2.add_peak(p)
+
+        assert np.all(f1.peak_frequencies == [220.0, 440.0])
+        assert len(f2.peak_amplitudes) == 1
+
+        amps, freqs, phases, bws = base.peak_arrays([f1, f2])
+        assert amps.shape == (2, 4)
+        assert np.all(amps == [[0.5, 0.25, 0, 0], [0.75, 0, 0, 0]])
+        assert np.all(freqs == [[220.0, 440.0, 0, 0], [110.0, 0, 0, 0]])
+        assert not np.any(phases)
+
+        amps = base.peak_arrays([f1, f2], 1)[0]
+        assert np.all(amps == [[0.5], [0.75]])
+
+    def test_partial_arrays(self):
+        f = base.Frame(frame_size)
+        f.max_partials = 3
+        f.add_partial(base.Peak())
+        p = base.Peak()
+        p.amplitude = 0.5
+        p.frequency = 220.0
+        f.add_partial(p)
+
+        amps, freqs, phases, bws = base.partial_arrays([f, f])
+        assert amps.shape == (2, 3)
+        assert np.all(freqs[:, 1] == 220.0)
+        assert np.all(amps[:, 0] == 0)
@@ -0,0 +1,185 @@
+#include "test_batch.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestBatch
+// ---------------------------------------------------------------------------
+static void check_frames(Frames expected, Frames frames) {
+    CPPUNIT_ASSERT_EQUAL(expected.size(), frames.size());
+
+    for(int i = 0; i < expected.size(); i++) {
+        Frame* e = expected[i];
+        Frame* f = frames[i];
+
+        CPPUNIT_ASSERT_EQUAL(e->num_peaks(), f->num_peaks());
+        for(int j = 0; j < e->num_peaks(); j++) {
+            CPPUNIT_ASSERT_EQUAL(e->peak_amplitudes()[j],
+                                 f->peak_amplitudes()[j]);
+            CPPUNIT_ASSERT_EQUAL(e->peak_frequencies()[j],
+                                 f->peak_frequencies()[j]);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(e->num_partials(), f->num_partials());
+        for(int j = 0; j < e->num_partials(); j++) {
+            CPPUNIT_ASSERT_EQUAL(e->partial(j).amplitude,
+                                 f->partial(j).amplitude);
+            CPPUNIT_ASSERT_EQUAL(e->partial(j).frequency,
+                                 f->partial(j).frequency);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(e->synth_size(), f->synth_size());
+        for(int j = 0; j < e->synth_size(); j++) {
+            CPPUNIT_ASSERT_EQUAL(e->synth()[j], f->synth()[j]);
+        }
+    }
+}
+
+// Analyse and synthesise each signal separately with fresh copies of the
+// prototypes, and check that the batch gives the same frames
+static void check_batch(Batch& batch, PeakDetection* pd,
+                        PartialTracking* pt, Synthesis* synth,
+                        std::vector<std::vector<sample> >& signals) {
+    int num_signals = signals.size();
+    std::vector<int> sizes(num_signals);
+    std::vector<sample*> audio(num_signals);
+    for(int i = 0; i < num_signals; i++) {
+        sizes[i] = signals[i].size();
+        audio[i] = &signals[i][0];
+    }
+
+    std::vector<Frames> frames = batch.process(num_signals, &sizes[0],
+                                               &audio[0]);
+    CPPUNIT_ASSERT_EQUAL(num_signals, (int)frames.size());
+    CPPUNIT_ASSERT_EQUAL(num_signals, batch.num_signals());
+
+    for(int i = 0; i < num_signals; i++) {
+        PeakDetection* serial_pd = pd->clone();
+        PartialTracking* serial_pt = pt->clone();
+        Synthesis* serial_synth = synth->clone();
+
+        Frames expected = serial_pd->find_peaks(sizes[i], audio[i]);
+        serial_pt->find_partials(expected);
+        serial_synth->synth(expected);
+
+        CPPUNIT_ASSERT(expected.size() > 0);
+        check_frames(expected, frames[i]);
+
+        delete serial_synth;
+        delete serial_pt;
+        delete serial_pd;
+    }
+}
+
+void TestBatch::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+
+    // parts of the flute of different lengths, so that the workers run
+    // out of signals at different times
+    int sizes[] = {4096, 16384, 2048, 8192, 6144};
+    int start = (int)_sf.frames() / 4;
+
+    _signals.clear();
+    for(int i = 0; i < 5; i++) {
+        _signals.push_back(std::vector<sample>(audio.begin() + start,
+                                               audio.begin() + start +
+                                               sizes[i]));
+        start += 1000;
+    }
+}
+
+void TestBatch::test_errors() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+
+    CPPUNIT_ASSERT_THROW(Batch(NULL, &pt, &synth), Exception);
+    CPPUNIT_ASSERT_THROW(Batch(&pd, NULL, &synth), Exception);
+
+    Batch batch(&pd, &pt, &synth);
+    CPPUNIT_ASSERT_THROW(batch.num_threads(0), Exception);
+
+    std::vector<Frames> frames = batch.process(0, NULL, NULL);
+    CPPUNIT_ASSERT_EQUAL(0, (int)frames.size());
+}
+
+void TestBatch::test_mq() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    pd.frame_size(512);
+    pd.hop_size(256);
+    synth.hop_size(256);
+
+    Batch batch(&pd, &pt, &synth);
+    check_batch(batch, &pd, &pt, &synth, _signals);
+
+    batch.num_threads(3);
+    check_batch(batch, &pd, &pt, &synth, _signals);
+
+    // more threads than signals
+    batch.num_threads(8);
+    check_batch(batch, &pd, &pt, &synth, _signals);
+}
+
+void TestBatch::test_sms() {
+    SMSPeakDetection pd;
+    SMSPartialTracking pt;
+    SMSSynthesis synth;
+    pd.hop_size(512);
+    synth.hop_size(512);
+    pd.max_peaks(20);
+    pt.max_partials(20);
+    synth.max_partials(20);
+
+    // the SMS detector and tracker are replaced for each signal and the
+    // synthesis is reset, so their state must not leak between signals
+    Batch batch(&pd, &pt, &synth);
+    batch.num_threads(2);
+    check_batch(batch, &pd, &pt, &synth, _signals);
+}
+
+void TestBatch::test_interleaved() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    pd.frame_size(512);
+    pd.hop_size(256);
+    synth.hop_size(256);
+
+    // channels taken from different parts of the longest signal
+    int num_channels = 3;
+    int num_samples = 8192;
+    std::vector<sample>& signal = _signals[1];
+    std::vector<sample> audio(num_channels * num_samples);
+    for(int i = 0; i < num_samples; i++) {
+        for(int channel = 0; channel < num_channels; channel++) {
+            audio[(i * num_channels) + channel] = signal[(channel * 3000) + i];
+        }
+    }
+
+    Batch interleaved(&pd, &pt, &synth);
+    interleaved.num_threads(2);
+    std::vector<Frames> frames = interleaved.process_interleaved(
+        num_channels, num_samples, &audio[0]
+    );
+    CPPUNIT_ASSERT_EQUAL(num_channels, (int)frames.size());
+
+    std::vector<std::vector<sample> > channels;
+    for(int channel = 0; channel < num_channels; channel++) {
+        channels.push_back(std::vector<sample>(
+            signal.begin() + (channel * 3000),
+            signal.begin() + (channel * 3000) + num_samples
+        ));
+    }
+
+    Batch batch(&pd, &pt, &synth);
+    check_batch(batch, &pd, &pt, &synth, channels);
+
+    for(int channel = 0; channel < num_channels; channel++) {
+        check_frames(batch.frames(channel), frames[channel]);
+    }
+}
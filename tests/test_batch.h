@@ -0,0 +1,42 @@
+#ifndef TEST_BATCH_H
+#define TEST_BATCH_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/peak_detection.h"
+#include "../src/simpl/partial_tracking.h"
+#include "../src/simpl/synthesis.h"
+#include "../src/simpl/batch.h"
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestBatch
+// ---------------------------------------------------------------------------
+class TestBatch : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestBatch);
+    CPPUNIT_TEST(test_errors);
+    CPPUNIT_TEST(test_mq);
+    CPPUNIT_TEST(test_sms);
+    CPPUNIT_TEST(test_interleaved);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    SndfileHandle _sf;
+    std::vector<std::vector<sample> > _signals;
+
+    void test_errors();
+    void test_mq();
+    void test_sms();
+    void test_interleaved();
+};
+
+} // end of namespace simpl
+
+#endif
@@ -0,0 +1,131 @@
+#include <math.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <vector>
+
+#include "test_fft_plans.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestFFTPlans
+// ---------------------------------------------------------------------------
+static const double PRECISION = 0.00001;
+
+void TestFFTPlans::test_cache() {
+    CPPUNIT_ASSERT(simpl_fft_plan(0, SIMPL_FFT_R2C) == NULL);
+    CPPUNIT_ASSERT(simpl_fft_plan(512, -1) == NULL);
+
+    fftw_plan r2c = simpl_fft_plan(512, SIMPL_FFT_R2C);
+    int num_plans = simpl_num_fft_plans();
+    CPPUNIT_ASSERT(r2c != NULL);
+    CPPUNIT_ASSERT(num_plans > 0);
+
+    // plans are only made once for each size and type
+    CPPUNIT_ASSERT(simpl_fft_plan(512, SIMPL_FFT_R2C) == r2c);
+    CPPUNIT_ASSERT_EQUAL(num_plans, simpl_num_fft_plans());
+
+    fftw_plan c2r = simpl_fft_plan(512, SIMPL_FFT_C2R);
+    CPPUNIT_ASSERT(c2r != NULL);
+    CPPUNIT_ASSERT(c2r != r2c);
+    CPPUNIT_ASSERT(simpl_fft_plan(256, SIMPL_FFT_R2C) != r2c);
+    CPPUNIT_ASSERT(simpl_fft_plan(512, SIMPL_FFT_C2R) == c2r);
+}
+
+// Looks up plans for several sizes at the same time as other threads
+static const int NUM_THREAD_SIZES = 6;
+
+static void* plan_thread(void* arg) {
+    fftw_plan* plans = (fftw_plan*)arg;
+    for(int i = 0; i < NUM_THREAD_SIZES; i++) {
+        plans[i] = simpl_fft_plan(96 << i, SIMPL_FFT_R2C);
+    }
+    return NULL;
+}
+
+void TestFFTPlans::test_threads() {
+    const int num_threads = 4;
+    std::vector<fftw_plan> plans(num_threads * NUM_THREAD_SIZES);
+    std::vector<pthread_t> threads(num_threads);
+
+    for(int t = 0; t < num_threads; t++) {
+        CPPUNIT_ASSERT(pthread_create(&threads[t], NULL, plan_thread,
+                                      &plans[t * NUM_THREAD_SIZES]) == 0);
+    }
+    for(int t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    // every thread gets the one cached plan for each size
+    for(int t = 0; t < num_threads; t++) {
+        for(int i = 0; i < NUM_THREAD_SIZES; i++) {
+            CPPUNIT_ASSERT(plans[(t * NUM_THREAD_SIZES) + i] != NULL);
+            CPPUNIT_ASSERT(plans[(t * NUM_THREAD_SIZES) + i] ==
+                           simpl_fft_plan(96 << i, SIMPL_FFT_R2C));
+        }
+    }
+}
+
+void TestFFTPlans::test_clear() {
+    CPPUNIT_ASSERT(simpl_fft_plan(512, SIMPL_FFT_R2C) != NULL);
+    unsigned generation = simpl_fft_plan_generation();
+
+    simpl_clear_fft_plans();
+    CPPUNIT_ASSERT_EQUAL(0, simpl_num_fft_plans());
+    CPPUNIT_ASSERT(simpl_fft_plan_generation() != generation);
+
+    CPPUNIT_ASSERT(simpl_fft_plan(512, SIMPL_FFT_R2C) != NULL);
+    CPPUNIT_ASSERT_EQUAL(1, simpl_num_fft_plans());
+}
+
+void TestFFTPlans::test_execute() {
+    int size = 256;
+    int bin = 8;
+    double* in = (double*) fftw_malloc(sizeof(double) * size);
+    fftw_complex* out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) *
+                                                    (size / 2 + 1));
+    for(int i = 0; i < size; i++) {
+        in[i] = cos(2 * M_PI * bin * i / size);
+    }
+
+    // cached plans can be executed on any aligned buffers
+    fftw_execute_dft_r2c(simpl_fft_plan(size, SIMPL_FFT_R2C), in, out);
+
+    for(int k = 0; k <= size / 2; k++) {
+        double expected = k == bin ? size / 2 : 0;
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, out[k][0], PRECISION);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, out[k][1], PRECISION);
+    }
+
+    fftw_execute_dft_c2r(simpl_fft_plan(size, SIMPL_FFT_C2R), out, in);
+
+    for(int i = 0; i < size; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(size * cos(2 * M_PI * bin * i / size),
+                                     in[i], PRECISION);
+    }
+
+    fftw_free(in);
+    fftw_free(out);
+}
+
+void TestFFTPlans::test_planner_flags() {
+    unsigned flags = simpl_get_fft_planner_flags();
+    CPPUNIT_ASSERT_EQUAL((unsigned)FFTW_ESTIMATE, flags);
+
+    simpl_set_fft_planner_flags(FFTW_MEASURE);
+    CPPUNIT_ASSERT_EQUAL((unsigned)FFTW_MEASURE, simpl_get_fft_planner_flags());
+    CPPUNIT_ASSERT(simpl_fft_plan(128, SIMPL_FFT_FORWARD) != NULL);
+
+    simpl_set_fft_planner_flags(flags);
+}
+
+void TestFFTPlans::test_wisdom() {
+    const char* filename = "fft_plans_wisdom.tmp";
+
+    CPPUNIT_ASSERT(simpl_fft_plan(1024, SIMPL_FFT_R2C) != NULL);
+    CPPUNIT_ASSERT_EQUAL(1, simpl_save_fft_wisdom(filename));
+    CPPUNIT_ASSERT_EQUAL(1, simpl_load_fft_wisdom(filename));
+    remove(filename);
+
+    CPPUNIT_ASSERT_EQUAL(0, simpl_load_fft_wisdom(filename));
+}
@@ -0,0 +1,35 @@
+#ifndef TEST_FFT_PLANS_H
+#define TEST_FFT_PLANS_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/fft_plans.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestFFTPlans
+// ---------------------------------------------------------------------------
+class TestFFTPlans : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestFFTPlans);
+    CPPUNIT_TEST(test_cache);
+    CPPUNIT_TEST(test_threads);
+    CPPUNIT_TEST(test_clear);
+    CPPUNIT_TEST(test_execute);
+    CPPUNIT_TEST(test_planner_flags);
+    CPPUNIT_TEST(test_wisdom);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void test_cache();
+    void test_threads();
+    void test_clear();
+    void test_execute();
+    void test_planner_flags();
+    void test_wisdom();
+};
+
+} // end of namespace simpl
+
+#endif
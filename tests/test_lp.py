@@ -1,3 +1,4 @@
+import simpl
 from simpl import lp
 import numpy as np
 
@@ -10,3 +11,23 @@ class TestLP(object):
         predictions = lp.predict(test_signal, coefs, 2)
         assert predictions[0] == -sum(coefs)
         assert predictions[1] == -sum(coefs[1:]) - predictions[0]
+
+    def test_partial_tracking(self):
+        """test_partial_tracking"""
+        frames = []
+        for i in range(12):
+            f = simpl.Frame(512)
+            f.max_partials = 4
+            for amp, freq in [(0.5, 400 + (20 * i)), (0.25, 650 - (20 * i))]:
+                p = simpl.Peak()
+                p.amplitude = amp
+                p.frequency = freq
+                f.add_peak(p)
+            frames.append(f)
+
+        pt = lp.LPPartialTracking()
+        pt.max_partials = 4
+        frames = pt.find_partials(frames)
+        for i, f in enumerate(frames):
+            assert f.partials[0].frequency == 400 + (20 * i)
+            assert f.partials[1].frequency == 650 - (20 * i)
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <map>
+
+#include "test_mq.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestMQ
+// ---------------------------------------------------------------------------
+static const int MQ_FRAME_SIZE = 2048;
+static const int MQ_HOP_SIZE = 512;
+
+static void init_params(MQParameters* params, int max_peaks) {
+    params->max_peaks = max_peaks;
+    params->frame_size = MQ_FRAME_SIZE;
+    params->num_bins = (MQ_FRAME_SIZE / 2) + 1;
+    params->peak_threshold = 0.0;
+    params->matching_interval = 100.0;
+    params->fundamental = 44100.0 / MQ_FRAME_SIZE;
+    init_mq(params);
+}
+
+// Compares the peaks and matches made by mq_track_peaks and
+// mq_track_peak_array for a sequence of frames. peaks holds num_peaks[i]
+// amplitudes, frequencies and phases for each frame i, one after another.
+// If max_peaks is given, only the largest max_peaks peaks of each frame are
+// kept. Returns the number of matches.
+static int compare_tracks(std::vector<int>& num_peaks,
+                          std::vector<sample>& amps,
+                          std::vector<sample>& freqs,
+                          std::vector<sample>& phases,
+                          int max_peaks=0) {
+    if(max_peaks <= 0) {
+        max_peaks = *std::max_element(num_peaks.begin(), num_peaks.end());
+    }
+    int num_matches = 0;
+
+    MQParameters params;
+    init_params(&params, max_peaks);
+
+    MQPeakArray peaks;
+    MQPeakArray prev_peaks;
+    mq_init_peak_array(&peaks, max_peaks);
+    mq_init_peak_array(&prev_peaks, max_peaks);
+
+    MQPeakList* prev_list = NULL;
+    std::vector<MQPeak*> prev_sorted;
+    int start = 0;
+
+    for(int frame = 0; frame < num_peaks.size(); frame++) {
+        int n = std::min(num_peaks[frame], max_peaks);
+
+        // MQPeakList version, tracking against the previous list after it
+        // has been sorted by frequency
+        MQPeakList* list = mq_new_peak_list(&params);
+        for(int i = 0; i < num_peaks[frame]; i++) {
+            MQPeak* p = mq_new_peak(&params);
+            p->amplitude = amps[start + i];
+            p->frequency = freqs[start + i];
+            p->phase = phases[start + i];
+            p->bin = i;
+            mq_add_peak(p, list, &params);
+        }
+        mq_track_peaks(list, &params);
+        list = mq_sort_peaks_by_frequency(list, n);
+        params.prev_peaks = list;
+
+        std::vector<MQPeak*> sorted;
+        for(MQPeakList* node = list; node && node->peak; node = node->next) {
+            sorted.push_back(node->peak);
+        }
+
+        // array version
+        mq_set_peaks(&peaks, num_peaks[frame], &amps[start], &freqs[start],
+                     &phases[start]);
+        mq_track_peak_array(&prev_peaks, &peaks, &params);
+
+        CPPUNIT_ASSERT_EQUAL(n, (int)sorted.size());
+        CPPUNIT_ASSERT_EQUAL(n, peaks.num_peaks);
+
+        std::map<MQPeak*, int> prev_index;
+        for(int i = 0; i < prev_sorted.size(); i++) {
+            prev_index[prev_sorted[i]] = i;
+        }
+
+        for(int i = 0; i < n; i++) {
+            CPPUNIT_ASSERT_EQUAL(sorted[i]->amplitude,
+                                 peaks.peaks[i].amplitude);
+            CPPUNIT_ASSERT_EQUAL(sorted[i]->frequency,
+                                 peaks.peaks[i].frequency);
+            CPPUNIT_ASSERT_EQUAL(sorted[i]->bin, peaks.peaks[i].bin);
+
+            int expected = -1;
+            if(sorted[i]->prev) {
+                expected = prev_index[sorted[i]->prev];
+                num_matches++;
+            }
+            CPPUNIT_ASSERT_EQUAL(expected, peaks.peaks[i].prev);
+            if(expected >= 0) {
+                CPPUNIT_ASSERT_EQUAL(i, prev_peaks.peaks[expected].next);
+            }
+        }
+
+        if(prev_list) {
+            delete_peak_list(prev_list, &params);
+        }
+        prev_list = list;
+        prev_sorted = sorted;
+        std::swap(peaks, prev_peaks);
+        start += num_peaks[frame];
+    }
+
+    delete_peak_list(prev_list, &params);
+    mq_destroy_peak_array(&peaks);
+    mq_destroy_peak_array(&prev_peaks);
+    destroy_mq(&params);
+    return num_matches;
+}
+
+void TestMQ::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    if(_sf.error() > 0) {
+        throw Exception(std::string("Could not open audio file: ") +
+                        std::string(TEST_AUDIO_FILE));
+    }
+
+    _audio.resize(_sf.frames());
+    _sf.read(&_audio[0], (int)_sf.frames());
+}
+
+void TestMQ::test_find_peaks() {
+    int max_peaks[] = {1, 10, 100, 1025};
+
+    for(int m = 0; m < 4; m++) {
+        MQParameters params;
+        init_params(&params, max_peaks[m]);
+
+        MQPeakArray peaks;
+        mq_init_peak_array(&peaks, params.num_bins);
+
+        for(int pos = 0; pos + MQ_FRAME_SIZE <= _audio.size();
+            pos += MQ_HOP_SIZE * 8) {
+            MQPeakList* list = mq_find_peaks(MQ_FRAME_SIZE, &_audio[pos],
+                                             &params);
+            int num_peaks = mq_find_peak_array(MQ_FRAME_SIZE, &_audio[pos],
+                                               &params, &peaks);
+            CPPUNIT_ASSERT(num_peaks <= max_peaks[m]);
+
+            MQPeakList* node = list;
+            for(int i = 0; i < num_peaks; i++) {
+                CPPUNIT_ASSERT(node && node->peak);
+                CPPUNIT_ASSERT_EQUAL(node->peak->amplitude,
+                                     peaks.peaks[i].amplitude);
+                CPPUNIT_ASSERT_EQUAL(node->peak->frequency,
+                                     peaks.peaks[i].frequency);
+                CPPUNIT_ASSERT_EQUAL(node->peak->phase, peaks.peaks[i].phase);
+                CPPUNIT_ASSERT_EQUAL(node->peak->bin, peaks.peaks[i].bin);
+                node = node->next;
+            }
+            CPPUNIT_ASSERT(!node || !node->peak);
+
+            delete_peak_list(list, &params);
+        }
+
+        mq_destroy_peak_array(&peaks);
+        destroy_mq(&params);
+    }
+}
+
+void TestMQ::test_track_peaks() {
+    MQParameters params;
+    init_params(&params, 1025);
+
+    MQPeakArray peaks;
+    mq_init_peak_array(&peaks, params.num_bins);
+
+    std::vector<int> num_peaks;
+    std::vector<sample> amps;
+    std::vector<sample> freqs;
+    std::vector<sample> phases;
+
+    int start = (int)_audio.size() / 2;
+    for(int pos = start; pos < start + (MQ_HOP_SIZE * 32); pos += MQ_HOP_SIZE) {
+        int n = mq_find_peak_array(MQ_FRAME_SIZE, &_audio[pos], &params,
+                                   &peaks);
+        num_peaks.push_back(n);
+        for(int i = 0; i < n; i++) {
+            amps.push_back(peaks.peaks[i].amplitude);
+            freqs.push_back(peaks.peaks[i].frequency);
+            phases.push_back(peaks.peaks[i].phase);
+        }
+    }
+
+    mq_destroy_peak_array(&peaks);
+    destroy_mq(&params);
+
+    CPPUNIT_ASSERT(compare_tracks(num_peaks, amps, freqs, phases) > 0);
+
+    // frames with more peaks than can be kept
+    CPPUNIT_ASSERT(compare_tracks(num_peaks, amps, freqs, phases, 40) > 0);
+}
+
+// Frequencies on a grid that is coarse relative to the matching interval,
+// and a few amplitude values, so that many candidates are the same
+// distance apart and some peaks have the same frequency
+void TestMQ::test_track_ties() {
+    std::vector<int> num_peaks;
+    std::vector<sample> amps;
+    std::vector<sample> freqs;
+    std::vector<sample> phases;
+
+    unsigned int seed = 1;
+    for(int frame = 0; frame < 24; frame++) {
+        int n = frame < 12 ? 50 : 1500;
+        num_peaks.push_back(n);
+
+        for(int i = 0; i < n; i++) {
+            seed = (seed * 1103515245) + 12345;
+            freqs.push_back(25.0 * (1 + ((seed >> 8) % 800)));
+            seed = (seed * 1103515245) + 12345;
+            amps.push_back(0.125 * (1 + ((seed >> 8) % 8)));
+            phases.push_back(0.0);
+        }
+    }
+
+    CPPUNIT_ASSERT(compare_tracks(num_peaks, amps, freqs, phases) > 0);
+
+    // frames with more peaks than can be kept
+    CPPUNIT_ASSERT(compare_tracks(num_peaks, amps, freqs, phases, 40) > 0);
+}
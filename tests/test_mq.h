@@ -0,0 +1,37 @@
+#ifndef TEST_MQ_H
+#define TEST_MQ_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/mq/mq.h"
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestMQ
+// ---------------------------------------------------------------------------
+class TestMQ : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestMQ);
+    CPPUNIT_TEST(test_find_peaks);
+    CPPUNIT_TEST(test_track_peaks);
+    CPPUNIT_TEST(test_track_ties);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    SndfileHandle _sf;
+    std::vector<sample> _audio;
+
+    void test_find_peaks();
+    void test_track_peaks();
+    void test_track_ties();
+};
+
+} // end of namespace simpl
+
+#endif
@@ -77,13 +77,13 @@ static void test_peaks(PeakDetection *pd, PartialTracking* pt,
     for(int i = 1; i < num_frames; i++) {
         CPPUNIT_ASSERT(frames[i]->num_peaks() > 0);
         CPPUNIT_ASSERT(frames[i]->num_partials() > 0);
-        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.4, frames[i]->partial(0)->amplitude,
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.4, frames[i]->partial(0).amplitude,
                                      PRECISION);
-        CPPUNIT_ASSERT_DOUBLES_EQUAL(220, frames[i]->partial(0)->frequency,
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(220, frames[i]->partial(0).frequency,
                                      PRECISION);
-        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, frames[i]->partial(1)->amplitude,
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, frames[i]->partial(1).amplitude,
                                      PRECISION);
-        CPPUNIT_ASSERT_DOUBLES_EQUAL(440, frames[i]->partial(1)->frequency,
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(440, frames[i]->partial(1).frequency,
                                      PRECISION);
     }
 
@@ -143,6 +143,209 @@ void TestMQPartialTracking::test_peaks() {
     ::test_peaks(&_pd, &_pt, &_sf);
 }
 
+void TestMQPartialTracking::test_partial_order() {
+    // more peaks than partials, not in frequency order
+    sample amps[] = {0.1, 0.5, 0.2, 0.9, 0.3, 0.8};
+    sample freqs[] = {500, 100, 300, 200, 600, 400};
+
+    Frame frame(512, true);
+    frame.max_peaks(6);
+    for(int i = 0; i < 6; i++) {
+        frame.add_peak(amps[i], freqs[i], 0.0, 0.0);
+    }
+
+    // as before the array version, the first max_partials peaks are tracked
+    // and all of them are returned in order of frequency
+    MQPartialTracking pt;
+    pt.max_partials(3);
+    frame.max_partials(3);
+    pt.update_partials(&frame);
+    CPPUNIT_ASSERT_EQUAL(3, frame.num_partials());
+
+    sample expected_amps[] = {0.5, 0.2, 0.1};
+    sample expected_freqs[] = {100, 300, 500};
+    for(int i = 0; i < 3; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected_amps[i],
+                                     frame.partial(i).amplitude, PRECISION);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected_freqs[i],
+                                     frame.partial(i).frequency, PRECISION);
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+//	TestLPPartialTracking
+// ---------------------------------------------------------------------------
+void TestLPPartialTracking::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    if(_sf.error() > 0) {
+        throw Exception(std::string("Could not open audio file: ") +
+                        std::string(TEST_AUDIO_FILE));
+    }
+}
+
+void TestLPPartialTracking::test_lp() {
+    // two interleaved signals, the second twice the first. Expected values
+    // are from simpl.lp.burg and simpl.lp.predict.
+    sample values[] = {1.0, 2.0, 0.5, -1.0, -0.25, 1.5, 0.75, -0.5};
+    int size = 8;
+    int order = 3;
+    std::vector<sample> signals(size * 2);
+    for(int i = 0; i < size; i++) {
+        signals[i * 2] = values[i];
+        signals[(i * 2) + 1] = values[i] * 2;
+    }
+
+    std::vector<sample> coefs(order * 2);
+    std::vector<sample> buffer;
+    burg(size, 2, &signals[0], order, &coefs[0], buffer);
+
+    sample expected_coefs[] = {-1.165559418455, 1.219689278166,
+                               -0.654397320052};
+    for(int i = 0; i < order; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected_coefs[i], coefs[i * 2],
+                                     PRECISION);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected_coefs[i], coefs[(i * 2) + 1],
+                                     PRECISION);
+    }
+
+    std::vector<sample> predictions(4);
+    predict(size, 2, &signals[0], order, &coefs[0], 2, &predictions[0]);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.515950687774, predictions[0], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.499271445529, predictions[2], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.031901375548, predictions[1], PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.998542891058, predictions[3], PRECISION);
+}
+
+void TestLPPartialTracking::test_basic() {
+    ::test_basic(&_pd, &_pt, &_sf);
+}
+
+void TestLPPartialTracking::test_change_num_partials() {
+    ::test_change_num_partials(&_pd, &_pt, &_sf);
+}
+
+void TestLPPartialTracking::test_peaks() {
+    ::test_peaks(&_pd, &_pt, &_sf);
+}
+
+void TestLPPartialTracking::test_streaming() {
+    ::test_streaming(&_pd, &_pt, &_sf);
+}
+
+void TestLPPartialTracking::test_crossing() {
+    // two partials that glide past each other keep their partial numbers.
+    // Matching the closest previous frequencies would swap them in frame 7.
+    int num_frames = 12;
+    _pt.reset();
+    _pt.max_partials(4);
+
+    for(int i = 0; i < num_frames; i++) {
+        Frame f;
+        f.max_partials(4);
+        f.add_peak(0.5, 400 + (20 * i), 0, 0);
+        f.add_peak(0.25, 650 - (20 * i), 0, 0);
+        _pt.update_partials(&f);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, f.partial(0).amplitude, PRECISION);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(400 + (20 * i), f.partial(0).frequency,
+                                     PRECISION);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, f.partial(1).amplitude, PRECISION);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(650 - (20 * i), f.partial(1).frequency,
+                                     PRECISION);
+    }
+}
+
+void TestLPPartialTracking::test_gap() {
+    // a partial is missing from frame 4 and 6 to 8. With a max_gap of 2 it
+    // keeps its partial number in frame 5, and dies in frame 8.
+    _pt.reset();
+    _pt.max_partials(4);
+    _pt.max_gap(2);
+
+    for(int i = 0; i < 10; i++) {
+        Frame f;
+        f.max_partials(4);
+        if(i < 4 || i == 5) {
+            f.add_peak(0.5, 440, 0, 0);
+        }
+        else if(i == 4) {
+            f.add_peak(0.25, 1000, 0, 0);
+        }
+        else if(i == 9) {
+            f.add_peak(0.25, 300, 0, 0);
+        }
+        _pt.update_partials(&f);
+
+        if(i < 4 || i == 5) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, f.partial(0).amplitude,
+                                         PRECISION);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(440, f.partial(0).frequency,
+                                         PRECISION);
+        }
+        else if(i == 4) {
+            // the missing partial continues at its predicted frequency
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, f.partial(0).amplitude,
+                                         PRECISION);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(440, f.partial(0).frequency,
+                                         PRECISION);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1000, f.partial(1).frequency,
+                                         PRECISION);
+        }
+        else if(i == 9) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, f.partial(0).amplitude,
+                                         PRECISION);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(300, f.partial(0).frequency,
+                                         PRECISION);
+        }
+        else {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, f.partial(0).amplitude,
+                                         PRECISION);
+        }
+    }
+}
+
+
+void TestLPPartialTracking::test_clone() {
+    // a history no larger than the default order can only be set after
+    // lowering the order, which the clone must not depend on
+    LPPartialTracking pt;
+    pt.order(2);
+    pt.history_size(5);
+    pt.matching_interval(50);
+    pt.max_partials(4);
+
+    LPPartialTracking* clone = NULL;
+    CPPUNIT_ASSERT_NO_THROW(clone = (LPPartialTracking*)pt.clone());
+    CPPUNIT_ASSERT_EQUAL(2, clone->order());
+    CPPUNIT_ASSERT_EQUAL(5, clone->history_size());
+    CPPUNIT_ASSERT(pt.parameters() == clone->parameters());
+
+    // the clone tracks the same partials
+    for(int i = 0; i < 8; i++) {
+        Frame f1;
+        Frame f2;
+        f1.max_partials(4);
+        f2.max_partials(4);
+        f1.add_peak(0.5, 400 + (10 * i), 0, 0);
+        f2.add_peak(0.5, 400 + (10 * i), 0, 0);
+        f1.add_peak(0.25, 900, 0, 0);
+        f2.add_peak(0.25, 900, 0, 0);
+        pt.update_partials(&f1);
+        clone->update_partials(&f2);
+
+        for(int j = 0; j < 4; j++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(f1.partial(j).amplitude,
+                                         f2.partial(j).amplitude, PRECISION);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(f1.partial(j).frequency,
+                                         f2.partial(j).frequency, PRECISION);
+        }
+    }
+
+    delete clone;
+}
+
 
 // ---------------------------------------------------------------------------
 //	TestSMSPartialTracking
@@ -195,6 +398,68 @@ void TestSMSPartialTracking::test_streaming() {
     ::test_streaming(&_pd, &_pt, &_sf);
 }
 
+// An SMS analysis with its own peak detection and partial tracking
+// objects, run on a separate thread by test_threads
+struct SMSAnalysisTask {
+    int num_samples;
+    sample* audio;
+    std::vector<sample> partials;
+};
+
+static void* sms_analysis_task(void* arg) {
+    SMSAnalysisTask* task = (SMSAnalysisTask*)arg;
+
+    SMSPeakDetection pd;
+    SMSPartialTracking pt;
+    pd.hop_size(256);
+    pd.frame_size(2048);
+    pt.realtime(true);
+    pt.max_frame_delay(2);
+    pt.max_partials(5);
+
+    Frames frames = pd.find_peaks(task->num_samples, task->audio);
+    frames = pt.find_partials(frames);
+
+    for(int i = 0; i < frames.size(); i++) {
+        for(int j = 0; j < frames[i]->num_partials(); j++) {
+            task->partials.push_back(frames[i]->partial_amplitudes()[j]);
+            task->partials.push_back(frames[i]->partial_frequencies()[j]);
+        }
+    }
+    return NULL;
+}
+
+void TestSMSPartialTracking::test_threads() {
+    const int num_threads = 4;
+
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+
+    // destroying an SMS object must not free the tables used by the others
+    SMSPeakDetection* pd = new SMSPeakDetection();
+    delete pd;
+
+    SMSAnalysisTask serial;
+    serial.num_samples = 4096;
+    serial.audio = &(audio[(int)_sf.frames() / 2]);
+    sms_analysis_task(&serial);
+    CPPUNIT_ASSERT(serial.partials.size() > 0);
+
+    std::vector<SMSAnalysisTask> tasks(num_threads, serial);
+    std::vector<pthread_t> threads(num_threads);
+    for(int i = 0; i < num_threads; i++) {
+        tasks[i].partials.clear();
+        pthread_create(&threads[i], NULL, sms_analysis_task, &tasks[i]);
+    }
+    for(int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for(int i = 0; i < num_threads; i++) {
+        CPPUNIT_ASSERT(tasks[i].partials == serial.partials);
+    }
+}
+
 
 // ---------------------------------------------------------------------------
 //	TestSndObjPartialTracking
@@ -18,6 +18,7 @@ class TestMQPartialTracking : public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST_SUITE(TestMQPartialTracking);
     CPPUNIT_TEST(test_basic);
     CPPUNIT_TEST(test_peaks);
+    CPPUNIT_TEST(test_partial_order);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -30,6 +31,41 @@ protected:
 
     void test_basic();
     void test_peaks();
+    void test_partial_order();
+};
+
+
+// ---------------------------------------------------------------------------
+//	TestLPPartialTracking
+// ---------------------------------------------------------------------------
+class TestLPPartialTracking : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestLPPartialTracking);
+    CPPUNIT_TEST(test_lp);
+    CPPUNIT_TEST(test_basic);
+    CPPUNIT_TEST(test_change_num_partials);
+    CPPUNIT_TEST(test_peaks);
+    CPPUNIT_TEST(test_streaming);
+    CPPUNIT_TEST(test_crossing);
+    CPPUNIT_TEST(test_gap);
+    CPPUNIT_TEST(test_clone);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    MQPeakDetection _pd;
+    LPPartialTracking _pt;
+    SndfileHandle _sf;
+
+    void test_lp();
+    void test_basic();
+    void test_change_num_partials();
+    void test_peaks();
+    void test_streaming();
+    void test_crossing();
+    void test_gap();
+    void test_clone();
 };
 
 
@@ -45,6 +81,7 @@ class TestSMSPartialTracking : public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST(test_peaks);
     CPPUNIT_TEST(test_peaks_harm);
     CPPUNIT_TEST(test_streaming);
+    CPPUNIT_TEST(test_threads);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -63,6 +100,7 @@ protected:
     void test_peaks();
     void test_peaks_harm();
     void test_streaming();
+    void test_threads();
 };
 
 
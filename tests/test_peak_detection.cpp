@@ -1,7 +1,54 @@
 #include "test_peak_detection.h"
 
+#include <algorithm>
+
 using namespace simpl;
 
+// ---------------------------------------------------------------------------
+//	test_find_peaks_threaded
+// ---------------------------------------------------------------------------
+static void test_find_peaks_threaded(PeakDetection* pd, SndfileHandle* sf) {
+    int num_frames = 20;
+    int num_samples = pd->frame_size() + (pd->hop_size() * num_frames) + 100;
+
+    std::vector<sample> audio(sf->frames(), 0.0);
+    sf->read(&audio[0], (int)sf->frames());
+
+    pd->clear();
+    pd->num_threads(1);
+    Frames serial_frames = pd->find_peaks(num_samples,
+                                          &(audio[(int)sf->frames() / 2]));
+
+    // find_peaks deletes the previous frames, so keep a copy of the peaks
+    std::vector<std::vector<Peak> > serial_peaks(serial_frames.size());
+    for(int i = 0; i < serial_frames.size(); i++) {
+        for(int j = 0; j < serial_frames[i]->num_peaks(); j++) {
+            serial_peaks[i].push_back(serial_frames[i]->peak(j));
+        }
+    }
+
+    pd->clear();
+    pd->num_threads(4);
+    Frames frames = pd->find_peaks(num_samples,
+                                   &(audio[(int)sf->frames() / 2]));
+    pd->num_threads(1);
+
+    CPPUNIT_ASSERT(frames.size() == serial_peaks.size());
+    for(int i = 0; i < frames.size(); i++) {
+        CPPUNIT_ASSERT(frames[i]->num_peaks() == serial_peaks[i].size());
+        for(int j = 0; j < frames[i]->num_peaks(); j++) {
+            CPPUNIT_ASSERT(frames[i]->peak(j).amplitude ==
+                           serial_peaks[i][j].amplitude);
+            CPPUNIT_ASSERT(frames[i]->peak(j).frequency ==
+                           serial_peaks[i][j].frequency);
+            CPPUNIT_ASSERT(frames[i]->peak(j).phase ==
+                           serial_peaks[i][j].phase);
+            CPPUNIT_ASSERT(frames[i]->peak(j).bandwidth ==
+                           serial_peaks[i][j].bandwidth);
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 //	TestMQPeakDetection
 // ---------------------------------------------------------------------------
@@ -70,6 +117,51 @@ void TestMQPeakDetection::test_find_peaks_change_hop_frame_size() {
     }
 }
 
+void TestMQPeakDetection::test_find_peaks_threaded() {
+    _pd.frame_size(512);
+    _pd.hop_size(256);
+    ::test_find_peaks_threaded(&_pd, &_sf);
+}
+
+void TestMQPeakDetection::test_find_peaks_in_spectrum() {
+    int frame_size = 512;
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+
+    _pd.clear();
+    _pd.frame_size(frame_size);
+    _pd.max_peaks(20);
+
+    Spectrum spectrum(frame_size);
+    CPPUNIT_ASSERT(_pd.uses_spectrum(&spectrum));
+    Spectrum other_size(1024);
+    CPPUNIT_ASSERT(!_pd.uses_spectrum(&other_size));
+    Spectrum other_window(frame_size, "hann");
+    CPPUNIT_ASSERT(!_pd.uses_spectrum(&other_window));
+
+    for(int n = 0; n < 10; n++) {
+        Frame f1(frame_size, true);
+        Frame f2(frame_size, true);
+        f1.max_peaks(_pd.max_peaks());
+        f2.max_peaks(_pd.max_peaks());
+        f1.audio(&(audio[((int)_sf.frames() / 2) + (n * frame_size)]));
+        f2.audio(f1.audio());
+
+        _pd.find_peaks_in_frame(&f1);
+        spectrum.analyse(&f2);
+        _pd.find_peaks_in_spectrum(&f2, &spectrum);
+
+        // the shared spectrum gives exactly the same peaks
+        CPPUNIT_ASSERT(f1.num_peaks() > 0);
+        CPPUNIT_ASSERT_EQUAL(f1.num_peaks(), f2.num_peaks());
+        for(int i = 0; i < f1.num_peaks(); i++) {
+            CPPUNIT_ASSERT(f1.peak(i).amplitude == f2.peak(i).amplitude);
+            CPPUNIT_ASSERT(f1.peak(i).frequency == f2.peak(i).frequency);
+            CPPUNIT_ASSERT(f1.peak(i).phase == f2.peak(i).phase);
+        }
+    }
+}
+
 
 // ---------------------------------------------------------------------------
 //	TestTWM
@@ -93,6 +185,104 @@ void TestTWM::test_basic() {
     }
 }
 
+// Harmonics of base_freq with equal amplitudes, up to num_harmonics
+static void harmonics(sample base_freq, int num_harmonics,
+                      std::vector<sample>& amps, std::vector<sample>& freqs) {
+    amps.assign(num_harmonics, 0.4);
+    freqs.resize(num_harmonics);
+    for(int i = 0; i < num_harmonics; i++) {
+        freqs[i] = base_freq * (i + 1);
+    }
+}
+
+void TestTWM::test_find_f0() {
+    TWM estimator;
+    std::vector<sample> amps;
+    std::vector<sample> freqs;
+
+    CPPUNIT_ASSERT_EQUAL((sample)0.0, estimator.find_f0(0, NULL, NULL));
+
+    sample base_freqs[] = {110, 150, 220, 250, 330};
+    for(int i = 0; i < 5; i++) {
+        harmonics(base_freqs[i], 100, amps, freqs);
+
+        // the order of the peaks does not matter
+        std::reverse(amps.begin(), amps.end());
+        std::reverse(freqs.begin(), freqs.end());
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(
+            base_freqs[i], estimator.find_f0(100, &amps[0], &freqs[0]),
+            PRECISION);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(base_freqs[i], estimator.f0(), PRECISION);
+    }
+
+    estimator.reset();
+    CPPUNIT_ASSERT_EQUAL((sample)0.0, estimator.f0());
+}
+
+void TestTWM::test_find_f0_frame() {
+    int num_frames = 6;
+    int num_peaks = 100;
+    sample base_freqs[] = {110, 110, 220, 220, 150, 150};
+    TWM estimator;
+    Frame frame;
+    frame.max_peaks(num_peaks);
+
+    for(int n = 0; n < num_frames; n++) {
+        frame.clear_peaks();
+        for(int i = 0; i < num_peaks; i++) {
+            frame.add_peak(0.4, base_freqs[n] * (i + 1), 0.0, 0.0);
+        }
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(base_freqs[n], estimator.find_f0(&frame),
+                                     PRECISION);
+    }
+}
+
+void TestTWM::test_coarse_search() {
+    TWM coarse;
+    TWM exhaustive;
+    exhaustive.coarse_factor(1);
+    std::vector<sample> amps;
+    std::vector<sample> freqs;
+
+    for(int base_freq = 50; base_freq < 1500; base_freq += 10) {
+        harmonics(base_freq, 20, amps, freqs);
+        coarse.reset();
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(
+            exhaustive.find_f0(20, &amps[0], &freqs[0]),
+            coarse.find_f0(20, &amps[0], &freqs[0]),
+            PRECISION);
+    }
+}
+
+void TestTWM::test_simd() {
+    TWM scalar;
+    TWM simd;
+    scalar.simd_level(MQ_SIMD_NONE);
+    std::vector<sample> amps;
+    std::vector<sample> freqs;
+
+    // an odd number of inharmonic peaks, so that the scalar tail is used
+    harmonics(123.4, 37, amps, freqs);
+    for(int i = 0; i < freqs.size(); i++) {
+        freqs[i] *= 1.0 + (0.001 * (i % 7));
+        amps[i] = 0.2 + (0.1 * (i % 5));
+    }
+
+    for(int level = MQ_SIMD_NONE; level <= mq_simd_level(); level++) {
+        simd.simd_level(level);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(scalar.find_f0(37, &amps[0], &freqs[0]),
+                                     simd.find_f0(37, &amps[0], &freqs[0]),
+                                     PRECISION);
+
+        for(sample f0 = 20; f0 < 3000; f0 += 7.5) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(scalar.error(f0), simd.error(f0),
+                                         PRECISION);
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 //	TestLorisPeakDetection
 // ---------------------------------------------------------------------------
@@ -161,6 +351,12 @@ void TestLorisPeakDetection::test_find_peaks_change_hop_frame_size() {
     }
 }
 
+void TestLorisPeakDetection::test_find_peaks_threaded() {
+    _pd.frame_size(512);
+    _pd.hop_size(256);
+    ::test_find_peaks_threaded(&_pd, &_sf);
+}
+
 
 // ---------------------------------------------------------------------------
 //	TestSndObjPeakDetection
@@ -229,3 +425,105 @@ void TestSndObjPeakDetection::test_find_peaks_change_hop_frame_size() {
         CPPUNIT_ASSERT(frames[i]->num_peaks() == 0);
     }
 }
+
+
+// ---------------------------------------------------------------------------
+//	TestMultiPeakDetection
+// ---------------------------------------------------------------------------
+void TestMultiPeakDetection::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    if(_sf.error() > 0) {
+        throw Exception(std::string("Could not open audio file: ") +
+                        std::string(TEST_AUDIO_FILE));
+    }
+}
+
+void TestMultiPeakDetection::test_errors() {
+    std::vector<sample> audio(4096, 0.0);
+    MQPeakDetection pd1;
+    MQPeakDetection pd2;
+    pd2.frame_size(1024);
+
+    MultiPeakDetection mpd;
+    CPPUNIT_ASSERT(mpd.find_peaks(audio.size(), &audio[0]).size() == 0);
+
+    mpd.add(&pd1);
+    mpd.add(&pd2);
+    CPPUNIT_ASSERT_EQUAL(2, mpd.num_detectors());
+    CPPUNIT_ASSERT_THROW(mpd.find_peaks(audio.size(), &audio[0]), Exception);
+
+    pd2.frame_size(pd1.frame_size());
+    pd2.hop_size(pd1.hop_size() * 2);
+    CPPUNIT_ASSERT_THROW(mpd.find_peaks(audio.size(), &audio[0]), Exception);
+
+    pd2.hop_size(pd1.hop_size());
+    CPPUNIT_ASSERT(mpd.find_peaks(audio.size(), &audio[0]).size() == 2);
+}
+
+static PeakDetection* new_detector(int n) {
+    PeakDetection* pd;
+    if(n < 2) {
+        pd = new MQPeakDetection();
+    }
+    else if(n == 2) {
+        pd = new SndObjPeakDetection();
+    }
+    else {
+        pd = new SMSPeakDetection();
+        pd->static_frame_size(true);
+    }
+    pd->frame_size(512);
+    pd->hop_size(256);
+    pd->max_peaks(n == 0 ? 10 : 40);
+    return pd;
+}
+
+void TestMultiPeakDetection::test_find_peaks() {
+    int num_detectors = 4;
+    int num_samples = 512 + (256 * 20) + 100;
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+    sample* input = &(audio[(int)_sf.frames() / 2]);
+
+    MultiPeakDetection mpd;
+    std::vector<PeakDetection*> shared(num_detectors);
+    std::vector<PeakDetection*> separate(num_detectors);
+    for(int n = 0; n < num_detectors; n++) {
+        shared[n] = new_detector(n);
+        separate[n] = new_detector(n);
+        mpd.add(shared[n]);
+    }
+
+    std::vector<Frames> frames = mpd.find_peaks(num_samples, input);
+    CPPUNIT_ASSERT(frames.size() == num_detectors);
+
+    // each detector finds the same peaks as its own find_peaks
+    for(int n = 0; n < num_detectors; n++) {
+        Frames expected = separate[n]->find_peaks(num_samples, input);
+        CPPUNIT_ASSERT(frames[n].size() == expected.size());
+
+        for(int i = 0; i < expected.size(); i++) {
+            CPPUNIT_ASSERT_EQUAL(expected[i]->num_peaks(),
+                                 frames[n][i]->num_peaks());
+            for(int j = 0; j < expected[i]->num_peaks(); j++) {
+                Peak p1 = expected[i]->peak(j);
+                Peak p2 = frames[n][i]->peak(j);
+                CPPUNIT_ASSERT(p1.amplitude == p2.amplitude);
+                CPPUNIT_ASSERT(p1.frequency == p2.frequency);
+                CPPUNIT_ASSERT(p1.phase == p2.phase);
+                CPPUNIT_ASSERT(p1.bandwidth == p2.bandwidth);
+            }
+        }
+    }
+
+    CPPUNIT_ASSERT(frames[0][10]->num_peaks() == 10);
+    CPPUNIT_ASSERT(frames[1][10]->num_peaks() > 10);
+    CPPUNIT_ASSERT(frames[3][10]->num_peaks() > 0);
+
+    mpd.clear();
+    for(int n = 0; n < num_detectors; n++) {
+        delete shared[n];
+        delete separate[n];
+    }
+}
@@ -20,6 +20,8 @@ class TestMQPeakDetection : public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST(test_find_peaks_basic);
     CPPUNIT_TEST(test_find_peaks_audio);
     CPPUNIT_TEST(test_find_peaks_change_hop_frame_size);
+    CPPUNIT_TEST(test_find_peaks_threaded);
+    CPPUNIT_TEST(test_find_peaks_in_spectrum);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -33,6 +35,8 @@ protected:
     void test_find_peaks_basic();
     void test_find_peaks_audio();
     void test_find_peaks_change_hop_frame_size();
+    void test_find_peaks_threaded();
+    void test_find_peaks_in_spectrum();
 };
 
 
@@ -42,10 +46,18 @@ protected:
 class TestTWM : public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST_SUITE(TestTWM);
     CPPUNIT_TEST(test_basic);
+    CPPUNIT_TEST(test_find_f0);
+    CPPUNIT_TEST(test_find_f0_frame);
+    CPPUNIT_TEST(test_coarse_search);
+    CPPUNIT_TEST(test_simd);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
     void test_basic();
+    void test_find_f0();
+    void test_find_f0_frame();
+    void test_coarse_search();
+    void test_simd();
 };
 
 
@@ -58,6 +70,7 @@ class TestLorisPeakDetection : public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST(test_find_peaks_basic);
     CPPUNIT_TEST(test_find_peaks_audio);
     CPPUNIT_TEST(test_find_peaks_change_hop_frame_size);
+    CPPUNIT_TEST(test_find_peaks_threaded);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -71,6 +84,7 @@ protected:
     void test_find_peaks_basic();
     void test_find_peaks_audio();
     void test_find_peaks_change_hop_frame_size();
+    void test_find_peaks_threaded();
 };
 
 
@@ -98,6 +112,26 @@ protected:
     void test_find_peaks_change_hop_frame_size();
 };
 
+
+// ---------------------------------------------------------------------------
+//	TestMultiPeakDetection
+// ---------------------------------------------------------------------------
+class TestMultiPeakDetection : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestMultiPeakDetection);
+    CPPUNIT_TEST(test_errors);
+    CPPUNIT_TEST(test_find_peaks);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    SndfileHandle _sf;
+
+    void test_errors();
+    void test_find_peaks();
+};
+
 } // end of namespace simpl
 
 #endif
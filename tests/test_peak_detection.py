@@ -1,11 +1,14 @@
 import os
 import json
+import threading
 import simpl
 import simpl.peak_detection as peak_detection
 
 PeakDetection = peak_detection.PeakDetection
 SMSPeakDetection = peak_detection.SMSPeakDetection
 SndObjPeakDetection = peak_detection.SndObjPeakDetection
+MQPeakDetection = peak_detection.MQPeakDetection
+Spectrum = peak_detection.Spectrum
 
 float_precision = 5
 hop_size = 512
@@ -43,6 +46,40 @@ class TestPeakDetection(object):
         assert pd.frames[0].max_peaks == max_peaks
 
 
+class TestSpectrum(object):
+    @classmethod
+    def setup_class(cls):
+        cls.audio = simpl.read_wav(audio_path)[0]
+        cls.audio = cls.audio[0:num_samples]
+
+    def test_find_peaks_in_spectrum(self):
+        frame_size = 512
+        pd = MQPeakDetection()
+        pd.frame_size = frame_size
+        pd.max_peaks = max_peaks
+        spectrum = Spectrum(frame_size)
+        assert spectrum.num_bins == (frame_size / 2) + 1
+        assert pd.uses_spectrum(spectrum)
+
+        for i in range(0, len(self.audio) - frame_size, hop_size):
+            f1 = simpl.Frame(frame_size)
+            f1.audio = self.audio[i:i + frame_size]
+            f1.max_peaks = max_peaks
+            f2 = simpl.Frame(frame_size)
+            f2.audio = self.audio[i:i + frame_size]
+            f2.max_peaks = max_peaks
+
+            pd.find_peaks_in_frame(f1)
+            spectrum.analyse(f2.audio)
+            pd.find_peaks_in_spectrum(f2, spectrum)
+
+            assert len(f1.peaks) == len(f2.peaks)
+            for p1, p2 in zip(f1.peaks, f2.peaks):
+                assert p1.amplitude == p2.amplitude
+                assert p1.frequency == p2.frequency
+                assert p1.phase == p2.phase
+
+
 class TestSMSPeakDetection(object):
     @classmethod
     def setup_class(cls):
@@ -60,6 +97,24 @@ class TestSMSPeakDetection(object):
             ((len(self.audio) - pd.frame_size) / hop_size) + 1
         assert len(pd.frames[0].peaks)
 
+    def test_profile(self):
+        pd = SMSPeakDetection()
+        pd.hop_size = hop_size
+        pd.frame_size = hop_size
+        pd.static_frame_size = True
+        frames = pd.find_peaks(self.audio[0:num_samples])
+
+        profile = pd.profile
+        if simpl.profiling_enabled():
+            assert profile['num_frames'] == len(frames)
+            assert profile['num_peaks'] == sum(len(f.peaks) for f in frames)
+        else:
+            assert profile['num_frames'] == 0
+            assert profile['time'] == 0
+
+        pd.reset_profile()
+        assert pd.profile['num_frames'] == 0
+
     def test_size_next_read(self):
         audio, sampling_rate = simpl.read_wav(audio_path)
 
@@ -115,3 +170,30 @@ class TestSndObjPeakDetection(object):
             assert len(frame.peaks) <= max_peaks, len(frame.peaks)
             max_amp = max([p.amplitude for p in frame.peaks])
             assert max_amp
+
+    def test_threads(self):
+        def find_peaks(results, i):
+            pd = SndObjPeakDetection()
+            pd.hop_size = hop_size
+            pd.max_peaks = max_peaks
+            results[i] = pd.find_peaks(self.audio)
+
+        serial = [None]
+        find_peaks(serial, 0)
+
+        num_threads = 4
+        results = [None] * num_threads
+        threads = [threading.Thread(target=find_peaks, args=(results, i))
+                   for i in range(num_threads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        for frames in results:
+            assert len(frames) == len(serial[0])
+            for frame, serial_frame in zip(frames, serial[0]):
+                assert len(frame.peaks) == len(serial_frame.peaks)
+                for p, q in zip(frame.peaks, serial_frame.peaks):
+                    assert p.frequency == q.frequency
+                    assert p.amplitude == q.amplitude
@@ -0,0 +1,219 @@
+#include "test_pipeline.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestPipeline
+// ---------------------------------------------------------------------------
+
+// Analyse and synthesise audio with fresh copies of the objects, and check
+// that the pipeline frames are the same
+static void check_pipeline(Frames frames, PeakDetection* pd,
+                           PartialTracking* pt, Synthesis* synth,
+                           std::vector<sample>& audio) {
+    PeakDetection* serial_pd = pd->clone();
+    PartialTracking* serial_pt = pt->clone();
+    Synthesis* serial_synth = synth->clone();
+
+    Frames expected = serial_pd->find_peaks(audio.size(), &audio[0]);
+    serial_pt->find_partials(expected);
+    serial_synth->synth(expected);
+
+    CPPUNIT_ASSERT(expected.size() > 0);
+    CPPUNIT_ASSERT_EQUAL(expected.size(), frames.size());
+
+    for(int i = 0; i < expected.size(); i++) {
+        Frame* e = expected[i];
+        Frame* f = frames[i];
+
+        CPPUNIT_ASSERT_EQUAL(e->num_peaks(), f->num_peaks());
+        for(int j = 0; j < e->num_peaks(); j++) {
+            CPPUNIT_ASSERT_EQUAL(e->peak_amplitudes()[j],
+                                 f->peak_amplitudes()[j]);
+            CPPUNIT_ASSERT_EQUAL(e->peak_frequencies()[j],
+                                 f->peak_frequencies()[j]);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(e->num_partials(), f->num_partials());
+        for(int j = 0; j < e->num_partials(); j++) {
+            CPPUNIT_ASSERT_EQUAL(e->partial(j).amplitude,
+                                 f->partial(j).amplitude);
+            CPPUNIT_ASSERT_EQUAL(e->partial(j).frequency,
+                                 f->partial(j).frequency);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(e->synth_size(), f->synth_size());
+        for(int j = 0; j < e->synth_size(); j++) {
+            CPPUNIT_ASSERT_EQUAL(e->synth()[j], f->synth()[j]);
+        }
+    }
+
+    delete serial_synth;
+    delete serial_pt;
+    delete serial_pd;
+}
+
+static void check_runs(Pipeline& pipeline, int peak_detection_runs,
+                       int partial_tracking_runs, int synthesis_runs) {
+    CPPUNIT_ASSERT_EQUAL(peak_detection_runs,
+                         pipeline.peak_detection_runs());
+    CPPUNIT_ASSERT_EQUAL(partial_tracking_runs,
+                         pipeline.partial_tracking_runs());
+    CPPUNIT_ASSERT_EQUAL(synthesis_runs, pipeline.synthesis_runs());
+}
+
+void TestPipeline::setUp() {
+    SndfileHandle sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    if(sf.error() > 0) {
+        throw Exception(std::string("Could not open audio file: ") +
+                        std::string(TEST_AUDIO_FILE));
+    }
+
+    std::vector<sample> audio(sf.frames(), 0.0);
+    sf.read(&audio[0], (int)sf.frames());
+
+    int start = (int)sf.frames() / 4;
+    _audio.assign(audio.begin() + start, audio.begin() + start + 16384);
+}
+
+void TestPipeline::test_parameters() {
+    MQPeakDetection pd;
+    std::string key = pd.parameters();
+    PeakDetection* pd_clone = pd.clone();
+    CPPUNIT_ASSERT(key == pd_clone->parameters());
+    delete pd_clone;
+    pd.hop_size(pd.hop_size() + 1);
+    CPPUNIT_ASSERT(key != pd.parameters());
+
+    SMSPartialTracking pt;
+    key = pt.parameters();
+    pt.default_fundamental(pt.default_fundamental() * 2);
+    CPPUNIT_ASSERT(key != pt.parameters());
+    key = pt.parameters();
+    pt.harmonic(!pt.harmonic());
+    CPPUNIT_ASSERT(key != pt.parameters());
+
+    MQPartialTracking mq_pt;
+    key = mq_pt.parameters();
+    mq_pt.matching_interval(mq_pt.matching_interval() / 2);
+    CPPUNIT_ASSERT(key != mq_pt.parameters());
+    PartialTracking* pt_clone = mq_pt.clone();
+    CPPUNIT_ASSERT(pt_clone->parameters() == mq_pt.parameters());
+    delete pt_clone;
+
+    LorisSynthesis synth;
+    key = synth.parameters();
+    synth.bandwidth(synth.bandwidth() + 0.25);
+    CPPUNIT_ASSERT(key != synth.parameters());
+}
+
+void TestPipeline::test_mq() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    pd.frame_size(512);
+    pd.hop_size(256);
+    synth.hop_size(256);
+
+    Pipeline pipeline(&pd, &pt, &synth);
+    Frames frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 1, 1);
+    check_pipeline(frames, &pd, &pt, &synth, _audio);
+
+    // nothing has changed
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 1, 1);
+
+    // tracking parameters only run tracking and synthesis
+    pt.matching_interval(20.0);
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 2, 2);
+    check_pipeline(frames, &pd, &pt, &synth, _audio);
+
+    pt.max_gap(4);
+    pt.min_partial_length(3);
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 3, 3);
+
+    // fewer partials than the frames already have
+    pt.max_partials(10);
+    synth.max_partials(10);
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 4, 4);
+    check_pipeline(frames, &pd, &pt, &synth, _audio);
+
+    // peak detection parameters run every stage
+    pd.max_peaks(30);
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 2, 5, 5);
+    check_pipeline(frames, &pd, &pt, &synth, _audio);
+
+    pipeline.invalidate();
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 3, 6, 6);
+}
+
+void TestPipeline::test_sms() {
+    SMSPeakDetection pd;
+    SMSPartialTracking pt;
+    SMSSynthesis synth;
+    pd.hop_size(512);
+    synth.hop_size(512);
+    pd.max_peaks(20);
+    pt.max_partials(20);
+    synth.max_partials(20);
+
+    Pipeline pipeline(&pd, &pt, &synth);
+    Frames frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 1, 1);
+    check_pipeline(frames, &pd, &pt, &synth, _audio);
+
+    // the tracker is cloned for each run, so the tracks found by the
+    // previous run do not affect the next one
+    pt.harmonic(true);
+    pt.default_fundamental(440.0);
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 2, 2);
+    check_pipeline(frames, &pd, &pt, &synth, _audio);
+
+    // synthesis parameters only run synthesis. IFFT synthesis starts new
+    // partials with random phases, so only the sinusoidal synthesis output
+    // is compared.
+    int det_synthesis_type = synth.det_synthesis_type();
+    synth.det_synthesis_type(SMS_DET_IFFT);
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 2, 3);
+
+    synth.det_synthesis_type(det_synthesis_type);
+    frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 2, 4);
+    check_pipeline(frames, &pd, &pt, &synth, _audio);
+}
+
+void TestPipeline::test_audio() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    pd.frame_size(512);
+    pd.hop_size(256);
+
+    // synthesis is optional
+    Pipeline pipeline(&pd, &pt);
+    Frames frames = pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 1, 1, 0);
+    CPPUNIT_ASSERT(frames[10]->num_partials() > 0);
+
+    // changing the audio in place runs every stage
+    for(int i = 0; i < _audio.size(); i++) {
+        _audio[i] *= 0.5;
+    }
+    pipeline.process(_audio.size(), &_audio[0]);
+    check_runs(pipeline, 2, 2, 0);
+
+    pipeline.process(_audio.size() / 2, &_audio[0]);
+    check_runs(pipeline, 3, 3, 0);
+
+    std::vector<sample> copy(_audio);
+    pipeline.process(copy.size(), &copy[0]);
+    check_runs(pipeline, 4, 4, 0);
+}
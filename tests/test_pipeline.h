@@ -0,0 +1,41 @@
+#ifndef TEST_PIPELINE_H
+#define TEST_PIPELINE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/peak_detection.h"
+#include "../src/simpl/partial_tracking.h"
+#include "../src/simpl/synthesis.h"
+#include "../src/simpl/pipeline.h"
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestPipeline
+// ---------------------------------------------------------------------------
+class TestPipeline : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestPipeline);
+    CPPUNIT_TEST(test_parameters);
+    CPPUNIT_TEST(test_mq);
+    CPPUNIT_TEST(test_sms);
+    CPPUNIT_TEST(test_audio);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    std::vector<sample> _audio;
+
+    void test_parameters();
+    void test_mq();
+    void test_sms();
+    void test_audio();
+};
+
+} // end of namespace simpl
+
+#endif
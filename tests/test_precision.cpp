@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+
+#include "test_precision.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestPrecision
+// ---------------------------------------------------------------------------
+static const int NUM_SAMPLES = 8192;
+static const int NUM_SINES = 5;
+static const double SINE_FREQUENCIES[NUM_SINES] = {
+    220.0, 440.5, 661.0, 1250.0, 3320.0
+};
+static const double SINE_AMPLITUDES[NUM_SINES] = {
+    0.4, 0.2, 0.1, 0.05, 0.02
+};
+
+// Reference values from the double precision build: the largest peaks of
+// frame 8 (sorted by frequency), and the energy of the synthesised signal
+static const int REFERENCE_FRAME = 8;
+
+static const double MQ_FREQUENCIES[NUM_SINES] = {
+    215.3320312, 430.6640625, 667.5292969, 1248.925781, 3316.113281
+};
+static const double MQ_AMPLITUDES[NUM_SINES] = {
+    0.1928882897, 0.08452682942, 0.04635742307, 0.0250220038, 0.009733675048
+};
+static const double MQ_ENERGY = 667.63215;
+
+static const double SMS_FREQUENCIES[NUM_SINES] = {
+    219.5868111, 440.7548223, 662.5760093, 1251.571935, 3322.073096
+};
+static const double SMS_AMPLITUDES[NUM_SINES] = {
+    0.4000695852, 0.2001477862, 0.1006686812, 0.04924844877, 0.01978924339
+};
+static const double SMS_ENERGY = 621.8428034;
+
+static const double FREQUENCY_TOLERANCE = 1e-3;
+static const double AMPLITUDE_TOLERANCE = 1e-5;
+static const double ENERGY_TOLERANCE = 1e-4;
+
+static bool larger_amplitude(const Peak& a, const Peak& b) {
+    return a.amplitude > b.amplitude;
+}
+
+static bool lower_frequency(const Peak& a, const Peak& b) {
+    return a.frequency < b.frequency;
+}
+
+static void check_peaks(Frame* frame, const double* frequencies,
+                        const double* amplitudes) {
+    CPPUNIT_ASSERT(frame->num_peaks() >= NUM_SINES);
+
+    std::vector<Peak> peaks;
+    for(int i = 0; i < frame->num_peaks(); i++) {
+        peaks.push_back(frame->peak(i));
+    }
+    std::stable_sort(peaks.begin(), peaks.end(), larger_amplitude);
+    peaks.resize(NUM_SINES);
+    std::sort(peaks.begin(), peaks.end(), lower_frequency);
+
+    for(int i = 0; i < NUM_SINES; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(frequencies[i],
+                                     (double)peaks[i].frequency,
+                                     FREQUENCY_TOLERANCE);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(amplitudes[i],
+                                     (double)peaks[i].amplitude,
+                                     amplitudes[i] * AMPLITUDE_TOLERANCE);
+    }
+}
+
+static void check_energy(Frames& frames, double expected) {
+    double energy = 0.0;
+    for(int i = 0; i < frames.size(); i++) {
+        for(int j = 0; j < frames[i]->synth_size(); j++) {
+            double s = frames[i]->synth()[j];
+            energy += s * s;
+        }
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, energy,
+                                 expected * ENERGY_TOLERANCE);
+}
+
+void TestPrecision::setUp() {
+    // the signal is computed in double precision in both builds
+    _audio.resize(NUM_SAMPLES);
+    for(int n = 0; n < NUM_SAMPLES; n++) {
+        double s = 0.0;
+        for(int i = 0; i < NUM_SINES; i++) {
+            s += SINE_AMPLITUDES[i] *
+                 cos((2 * M_PI * SINE_FREQUENCIES[i] * n / 44100.0) + i);
+        }
+        _audio[n] = s;
+    }
+}
+
+void TestPrecision::test_mq() {
+    MQPeakDetection pd;
+    pd.frame_size(2048);
+    pd.hop_size(512);
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    synth.hop_size(512);
+
+    Frames frames = pd.find_peaks(NUM_SAMPLES, &_audio[0]);
+    CPPUNIT_ASSERT(frames.size() > REFERENCE_FRAME);
+    check_peaks(frames[REFERENCE_FRAME], MQ_FREQUENCIES, MQ_AMPLITUDES);
+
+    pt.find_partials(frames);
+    synth.synth(frames);
+    check_energy(frames, MQ_ENERGY);
+}
+
+void TestPrecision::test_sms() {
+    SMSPeakDetection pd;
+    pd.hop_size(512);
+    SMSPartialTracking pt;
+    SMSSynthesis synth;
+    synth.hop_size(512);
+
+    Frames frames = pd.find_peaks(NUM_SAMPLES, &_audio[0]);
+    CPPUNIT_ASSERT(frames.size() > REFERENCE_FRAME);
+    check_peaks(frames[REFERENCE_FRAME], SMS_FREQUENCIES, SMS_AMPLITUDES);
+
+    pt.find_partials(frames);
+    synth.synth(frames);
+    check_energy(frames, SMS_ENERGY);
+}
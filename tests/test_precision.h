@@ -0,0 +1,39 @@
+#ifndef TEST_PRECISION_H
+#define TEST_PRECISION_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/peak_detection.h"
+#include "../src/simpl/partial_tracking.h"
+#include "../src/simpl/synthesis.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestPrecision
+//
+//  Compares analysis and synthesis of a fixed test signal with reference
+//  values from the double precision build, so that a SIMPL_FLOAT build can
+//  be checked against them.
+// ---------------------------------------------------------------------------
+class TestPrecision : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestPrecision);
+    CPPUNIT_TEST(test_mq);
+    CPPUNIT_TEST(test_sms);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    std::vector<sample> _audio;
+
+    void test_mq();
+    void test_sms();
+};
+
+} // end of namespace simpl
+
+#endif
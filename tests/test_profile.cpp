@@ -0,0 +1,172 @@
+#include "test_profile.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestProfile
+// ---------------------------------------------------------------------------
+static const int PROFILE_FRAME_SIZE = 512;
+static const int PROFILE_HOP_SIZE = 256;
+
+void TestProfile::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+
+    int start = (int)_sf.frames() / 2;
+    _audio.assign(audio.begin() + start, audio.begin() + start + 8192);
+}
+
+void TestProfile::test_add_frame() {
+    Profile profile;
+    CPPUNIT_ASSERT_EQUAL(0, profile.num_frames());
+    CPPUNIT_ASSERT_EQUAL(0.0, profile.mean_time());
+    CPPUNIT_ASSERT_EQUAL(0.0, profile.mean_peaks());
+
+    profile.add_frame(0.5, 10, 4, 2, 1);
+    profile.add_frame(1.5, 20, 6, 0, 1);
+
+    CPPUNIT_ASSERT_EQUAL(2, profile.num_frames());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, profile.time(), PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, profile.mean_time(), PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, profile.max_time(), PRECISION);
+    CPPUNIT_ASSERT_EQUAL(30L, profile.num_peaks());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(15.0, profile.mean_peaks(), PRECISION);
+    CPPUNIT_ASSERT_EQUAL(10L, profile.num_partials());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, profile.mean_partials(), PRECISION);
+    CPPUNIT_ASSERT_EQUAL(2L, profile.num_allocations());
+    CPPUNIT_ASSERT_EQUAL(2L, profile.num_deallocations());
+
+    profile.reset();
+    CPPUNIT_ASSERT_EQUAL(0, profile.num_frames());
+    CPPUNIT_ASSERT_EQUAL(0.0, profile.time());
+    CPPUNIT_ASSERT_EQUAL(0L, profile.num_peaks());
+}
+
+void TestProfile::test_add() {
+    Profile a;
+    Profile b;
+    a.add_frame(0.5, 10, 4, 2, 1);
+    b.add_frame(1.5, 20, 6, 0, 1);
+    b.add_frame(0.25, 30, 8, 1, 1);
+
+    a.add(&b);
+    CPPUNIT_ASSERT_EQUAL(3, a.num_frames());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.25, a.time(), PRECISION);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, a.max_time(), PRECISION);
+    CPPUNIT_ASSERT_EQUAL(60L, a.num_peaks());
+    CPPUNIT_ASSERT_EQUAL(18L, a.num_partials());
+    CPPUNIT_ASSERT_EQUAL(3L, a.num_allocations());
+    CPPUNIT_ASSERT_EQUAL(3L, a.num_deallocations());
+}
+
+void TestProfile::test_scope() {
+    Profile profile;
+    Frame frame;
+    frame.max_peaks(10);
+    frame.add_peak(0.5, 440.0, 0.0, 0.0);
+
+    {
+        ProfileScope scope(&profile, &frame);
+        std::vector<sample>* v = new std::vector<sample>(100);
+        delete v;
+        frame.add_peak(0.5, 880.0, 0.0, 0.0);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(1, profile.num_frames());
+    CPPUNIT_ASSERT(profile.time() >= 0.0);
+    CPPUNIT_ASSERT_EQUAL(2L, profile.num_peaks());
+    CPPUNIT_ASSERT_EQUAL(0L, profile.num_partials());
+
+    if(profiling_enabled()) {
+        CPPUNIT_ASSERT_EQUAL(2L, profile.num_allocations());
+        CPPUNIT_ASSERT_EQUAL(2L, profile.num_deallocations());
+    }
+    else {
+        CPPUNIT_ASSERT_EQUAL(0L, profile.num_allocations());
+        CPPUNIT_ASSERT_EQUAL(0L, profile.num_deallocations());
+    }
+}
+
+void TestProfile::test_analysis() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    pd.frame_size(PROFILE_FRAME_SIZE);
+    pd.hop_size(PROFILE_HOP_SIZE);
+    synth.hop_size(PROFILE_HOP_SIZE);
+
+    Frames frames = pd.find_peaks(_audio.size(), &_audio[0]);
+    frames = pt.find_partials(frames);
+    frames = synth.synth(frames);
+
+    long num_peaks = 0;
+    long num_partials = 0;
+    for(int i = 0; i < frames.size(); i++) {
+        num_peaks += frames[i]->num_peaks();
+        num_partials += frames[i]->num_partials();
+    }
+    CPPUNIT_ASSERT(num_peaks > 0);
+
+    if(!profiling_enabled()) {
+        CPPUNIT_ASSERT_EQUAL(0, pd.profile()->num_frames());
+        CPPUNIT_ASSERT_EQUAL(0, pt.profile()->num_frames());
+        CPPUNIT_ASSERT_EQUAL(0, synth.profile()->num_frames());
+        return;
+    }
+
+    int num_frames = frames.size();
+    CPPUNIT_ASSERT_EQUAL(num_frames, pd.profile()->num_frames());
+    CPPUNIT_ASSERT_EQUAL(num_frames, pt.profile()->num_frames());
+    CPPUNIT_ASSERT_EQUAL(num_frames, synth.profile()->num_frames());
+
+    CPPUNIT_ASSERT_EQUAL(num_peaks, pd.profile()->num_peaks());
+    CPPUNIT_ASSERT_EQUAL(0L, pd.profile()->num_partials());
+    CPPUNIT_ASSERT_EQUAL(num_partials, pt.profile()->num_partials());
+    CPPUNIT_ASSERT_EQUAL(num_partials, synth.profile()->num_partials());
+
+    CPPUNIT_ASSERT(pd.profile()->time() > 0.0);
+    CPPUNIT_ASSERT(pd.profile()->max_time() <= pd.profile()->time());
+
+    pd.profile()->reset();
+    CPPUNIT_ASSERT_EQUAL(0, pd.profile()->num_frames());
+}
+
+void TestProfile::test_threaded() {
+    MQPeakDetection pd;
+    pd.frame_size(PROFILE_FRAME_SIZE);
+    pd.hop_size(PROFILE_HOP_SIZE);
+    pd.num_threads(3);
+
+    Frames frames = pd.find_peaks(_audio.size(), &_audio[0]);
+
+    long num_peaks = 0;
+    for(int i = 0; i < frames.size(); i++) {
+        num_peaks += frames[i]->num_peaks();
+    }
+
+    if(profiling_enabled()) {
+        CPPUNIT_ASSERT_EQUAL((int)frames.size(), pd.profile()->num_frames());
+        CPPUNIT_ASSERT_EQUAL(num_peaks, pd.profile()->num_peaks());
+    }
+    else {
+        CPPUNIT_ASSERT_EQUAL(0, pd.profile()->num_frames());
+    }
+}
+
+void TestProfile::test_residual() {
+    SMSResidual residual;
+    residual.frame_size(PROFILE_FRAME_SIZE);
+    residual.hop_size(PROFILE_HOP_SIZE);
+
+    Frames frames = residual.synth(_audio.size(), &_audio[0]);
+
+    if(profiling_enabled()) {
+        CPPUNIT_ASSERT_EQUAL((int)frames.size(),
+                             residual.profile()->num_frames());
+    }
+    else {
+        CPPUNIT_ASSERT_EQUAL(0, residual.profile()->num_frames());
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef TEST_PROFILE_H
+#define TEST_PROFILE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/profile.h"
+#include "../src/simpl/peak_detection.h"
+#include "../src/simpl/partial_tracking.h"
+#include "../src/simpl/synthesis.h"
+#include "../src/simpl/residual.h"
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestProfile
+// ---------------------------------------------------------------------------
+class TestProfile : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestProfile);
+    CPPUNIT_TEST(test_add_frame);
+    CPPUNIT_TEST(test_add);
+    CPPUNIT_TEST(test_scope);
+    CPPUNIT_TEST(test_analysis);
+    CPPUNIT_TEST(test_threaded);
+    CPPUNIT_TEST(test_residual);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    SndfileHandle _sf;
+    std::vector<sample> _audio;
+
+    void test_add_frame();
+    void test_add();
+    void test_scope();
+    void test_analysis();
+    void test_threaded();
+    void test_residual();
+};
+
+} // end of namespace simpl
+
+#endif
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <unistd.h>
+
+#include "SdifFile.h"
+
+#include "test_sdif.h"
+
+using namespace simpl;
+
+static const char* TEST_SDIF_FILE = "test_sdif.sdif";
+
+// ---------------------------------------------------------------------------
+//	TestSDIF
+// ---------------------------------------------------------------------------
+// The active partials of a frame, sorted by frequency
+static std::vector<Peak> active_partials(Frame* frame) {
+    std::vector<std::pair<sample, int> > order;
+    for(int i = 0; i < frame->num_partials(); i++) {
+        if(frame->partial_amplitudes()[i] > 0) {
+            order.push_back(std::make_pair(frame->partial_frequencies()[i],
+                                           i));
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<Peak> partials;
+    for(int i = 0; i < order.size(); i++) {
+        partials.push_back(frame->partial(order[i].second));
+    }
+    return partials;
+}
+
+// Writes the test frames, reads them back and checks that they have the
+// same active partials, and that partials continue in the same partial
+// number as in the original frames
+static void check_read_write(Frames& frames, bool bandwidth_enhanced) {
+    SDIFWriter writer;
+    writer.open(TEST_SDIF_FILE, bandwidth_enhanced);
+    for(int i = 0; i < frames.size(); i++) {
+        writer.write_frame(frames[i], i * 0.01);
+    }
+    CPPUNIT_ASSERT_EQUAL((int)frames.size(), writer.num_frames());
+    writer.close();
+
+    SDIFReader reader(TEST_SDIF_FILE);
+    Frame frame;
+    std::vector<int> previous;
+    for(int i = 0; i < frames.size(); i++) {
+        CPPUNIT_ASSERT(reader.read_frame(&frame));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(i * 0.01, reader.time(), 1e-12);
+
+        std::vector<Peak> expected = active_partials(frames[i]);
+        std::vector<Peak> partials = active_partials(&frame);
+        CPPUNIT_ASSERT_EQUAL(expected.size(), partials.size());
+        for(int j = 0; j < expected.size(); j++) {
+            CPPUNIT_ASSERT_EQUAL(expected[j].frequency,
+                                 partials[j].frequency);
+            CPPUNIT_ASSERT_EQUAL(expected[j].amplitude,
+                                 partials[j].amplitude);
+            CPPUNIT_ASSERT_EQUAL(expected[j].phase, partials[j].phase);
+            CPPUNIT_ASSERT_EQUAL(
+                bandwidth_enhanced ? expected[j].bandwidth : (sample)0,
+                partials[j].bandwidth
+            );
+        }
+
+        // the original partial number of each partial number read
+        std::vector<int> numbers(frame.num_partials(), -1);
+        for(int j = 0; j < frame.num_partials(); j++) {
+            if(frame.partial_amplitudes()[j] <= 0) {
+                continue;
+            }
+            for(int k = 0; k < frames[i]->num_partials(); k++) {
+                if(frames[i]->partial_frequencies()[k] ==
+                   frame.partial_frequencies()[j] &&
+                   frames[i]->partial_amplitudes()[k] ==
+                   frame.partial_amplitudes()[j]) {
+                    numbers[j] = k;
+                }
+            }
+            if(j < previous.size() && previous[j] >= 0 &&
+               frames[i - 1]->partial_amplitudes()[previous[j]] > 0 &&
+               frames[i]->partial_amplitudes()[previous[j]] > 0) {
+                CPPUNIT_ASSERT_EQUAL(previous[j], numbers[j]);
+            }
+        }
+        previous = numbers;
+    }
+    CPPUNIT_ASSERT(!reader.read_frame(&frame));
+}
+
+void TestSDIF::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    int num_samples = 16384;
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+    _audio.assign(audio.begin() + ((int)_sf.frames() / 2),
+                  audio.begin() + ((int)_sf.frames() / 2) + num_samples);
+
+    _pd.frame_size(512);
+    _pd.hop_size(256);
+    _frames = _pd.find_peaks(_audio.size(), &_audio[0]);
+    _pt.find_partials(_frames);
+
+    for(int i = 0; i < _frames.size(); i++) {
+        for(int j = 0; j < _frames[i]->num_partials(); j++) {
+            _frames[i]->partial_bandwidths()[j] = 0.01 * j;
+        }
+    }
+}
+
+void TestSDIF::tearDown() {
+    remove(TEST_SDIF_FILE);
+}
+
+void TestSDIF::test_errors() {
+    SDIFReader reader;
+    Frame frame;
+    CPPUNIT_ASSERT(!reader.is_open());
+    CPPUNIT_ASSERT_THROW(reader.open("missing.sdif"), Exception);
+    CPPUNIT_ASSERT_THROW(reader.read_frame(&frame), Exception);
+
+    SDIFWriter writer;
+    CPPUNIT_ASSERT_THROW(writer.write_frame(&frame, 0.0), Exception);
+    writer.open(TEST_SDIF_FILE);
+    writer.write_frame(&frame, 1.0);
+    CPPUNIT_ASSERT_THROW(writer.write_frame(&frame, 0.5), Exception);
+    writer.close();
+
+    // truncated frame
+    truncate(TEST_SDIF_FILE, 16 + 30);
+    reader.open(TEST_SDIF_FILE);
+    CPPUNIT_ASSERT_THROW(reader.read_frame(&frame), Exception);
+
+    // not an SDIF file
+    FILE* file = fopen(TEST_SDIF_FILE, "wb");
+    fwrite("RIFF0000WAVE", 1, 12, file);
+    fclose(file);
+    CPPUNIT_ASSERT_THROW(reader.open(TEST_SDIF_FILE), Exception);
+}
+
+void TestSDIF::test_read_write() {
+    check_read_write(_frames, false);
+}
+
+void TestSDIF::test_bandwidth_enhanced() {
+    check_read_write(_frames, true);
+}
+
+void TestSDIF::test_loris() {
+    // count the partials and their breakpoints
+    int num_partials = 0;
+    int num_breakpoints = 0;
+    for(int i = 0; i < _frames.size(); i++) {
+        for(int j = 0; j < _frames[i]->num_partials(); j++) {
+            if(_frames[i]->partial_amplitudes()[j] <= 0) {
+                continue;
+            }
+            num_breakpoints++;
+            if(i == 0 || j >= _frames[i - 1]->num_partials() ||
+               _frames[i - 1]->partial_amplitudes()[j] <= 0) {
+                num_partials++;
+            }
+        }
+    }
+
+    SDIFWriter writer;
+    writer.open(TEST_SDIF_FILE, true);
+    for(int i = 0; i < _frames.size(); i++) {
+        writer.write_frame(_frames[i], i * 0.01);
+    }
+    writer.close();
+
+    Loris::SdifFile file(TEST_SDIF_FILE);
+    Loris::PartialList& partials = file.partials();
+    CPPUNIT_ASSERT_EQUAL(num_partials, (int)partials.size());
+
+    int num_loris_breakpoints = 0;
+    Loris::PartialList::iterator partial;
+    for(partial = partials.begin(); partial != partials.end(); partial++) {
+        num_loris_breakpoints += partial->numBreakpoints();
+    }
+    CPPUNIT_ASSERT_EQUAL(num_breakpoints, num_loris_breakpoints);
+
+    // files written by Loris, which chooses its own frame times, so each
+    // row is compared with a breakpoint read back by Loris
+    file.write(TEST_SDIF_FILE);
+    Loris::SdifFile loris_file(TEST_SDIF_FILE);
+    num_loris_breakpoints = 0;
+    for(partial = loris_file.partials().begin();
+        partial != loris_file.partials().end(); partial++) {
+        num_loris_breakpoints += partial->numBreakpoints();
+    }
+
+    SDIFReader reader(TEST_SDIF_FILE);
+    Frame frame;
+    int num_rows = 0;
+    while(reader.read_frame(&frame)) {
+        num_rows += active_partials(&frame).size();
+    }
+    CPPUNIT_ASSERT(num_rows > 0);
+    CPPUNIT_ASSERT_EQUAL(num_loris_breakpoints, num_rows);
+}
@@ -0,0 +1,45 @@
+#ifndef TEST_SDIF_H
+#define TEST_SDIF_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/peak_detection.h"
+#include "../src/simpl/partial_tracking.h"
+#include "../src/simpl/sdif.h"
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestSDIF
+// ---------------------------------------------------------------------------
+class TestSDIF : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestSDIF);
+    CPPUNIT_TEST(test_errors);
+    CPPUNIT_TEST(test_read_write);
+    CPPUNIT_TEST(test_bandwidth_enhanced);
+    CPPUNIT_TEST(test_loris);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+protected:
+    SndfileHandle _sf;
+    std::vector<sample> _audio;
+    MQPeakDetection _pd;
+    MQPartialTracking _pt;
+    Frames _frames;
+
+    void test_errors();
+    void test_read_write();
+    void test_bandwidth_enhanced();
+    void test_loris();
+};
+
+} // end of namespace simpl
+
+#endif
@@ -0,0 +1,121 @@
+#include <pthread.h>
+
+#include "test_sms.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestSMSFFT
+// ---------------------------------------------------------------------------
+static const int MIN_FFT_SIZE = 4;
+static const int MAX_FFT_SIZE = 8192;
+
+static void test_signal(int size, sfloat* signal) {
+    for(int i = 0; i < size; i++) {
+        signal[i] = sin(0.37 * i) + (0.5 * cos(0.05 * i * i / size)) +
+                    ((sfloat)i / size);
+    }
+}
+
+// Transform signal with the given backend, in place
+static void transform(int backend, bool inverse, int size, sfloat* signal) {
+    sms_setFFTBackend(backend);
+    if(inverse) {
+        sms_ifft(size, signal);
+    }
+    else {
+        sms_fft(size, signal);
+    }
+}
+
+static void test_transform(bool inverse) {
+    std::vector<sfloat> ooura(MAX_FFT_SIZE);
+    std::vector<sfloat> fftw(MAX_FFT_SIZE);
+
+    for(int size = MIN_FFT_SIZE; size <= MAX_FFT_SIZE; size *= 2) {
+        test_signal(size, &ooura[0]);
+        test_signal(size, &fftw[0]);
+
+        transform(SMS_FFT_OOURA, inverse, size, &ooura[0]);
+        transform(SMS_FFT_FFTW, inverse, size, &fftw[0]);
+
+        for(int i = 0; i < size; i++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(ooura[i], fftw[i], 1e-9 * size);
+        }
+    }
+}
+
+void TestSMSFFT::setUp() {
+    sms_init();
+    _backend = sms_getFFTBackend();
+}
+
+void TestSMSFFT::tearDown() {
+    sms_setFFTBackend(_backend);
+    sms_free();
+}
+
+void TestSMSFFT::test_backend() {
+    CPPUNIT_ASSERT(sms_setFFTBackend(SMS_FFT_OOURA) == SMS_OK);
+    CPPUNIT_ASSERT(sms_getFFTBackend() == SMS_FFT_OOURA);
+    CPPUNIT_ASSERT(sms_setFFTBackend(SMS_FFT_FFTW) == SMS_OK);
+    CPPUNIT_ASSERT(sms_getFFTBackend() == SMS_FFT_FFTW);
+    CPPUNIT_ASSERT(sms_setFFTBackend(-1) == -1);
+    CPPUNIT_ASSERT(sms_getFFTBackend() == SMS_FFT_FFTW);
+
+    // reading the error also clears it
+    CPPUNIT_ASSERT(sms_errorString() != NULL);
+    CPPUNIT_ASSERT(sms_errorString() == NULL);
+}
+
+void TestSMSFFT::test_fft() {
+    test_transform(false);
+
+    // the plans kept by this thread are looked up again after the plan
+    // cache is cleared
+    const int size = 256;
+    std::vector<sfloat> before(size);
+    std::vector<sfloat> after(size);
+    test_signal(size, &before[0]);
+    test_signal(size, &after[0]);
+    transform(SMS_FFT_FFTW, false, size, &before[0]);
+    simpl_clear_fft_plans();
+    transform(SMS_FFT_FFTW, false, size, &after[0]);
+    CPPUNIT_ASSERT(simpl_num_fft_plans() > 0);
+    for(int i = 0; i < size; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(before[i], after[i], 1e-12);
+    }
+}
+
+void TestSMSFFT::test_ifft() {
+    test_transform(true);
+}
+
+// Transform the test signal with FFTW in a thread that exits afterwards,
+// which frees the scratch space of that thread
+static void* fft_thread(void* arg) {
+    std::vector<sfloat>* signal = (std::vector<sfloat>*)arg;
+    sms_fft((int)signal->size(), &(*signal)[0]);
+    return NULL;
+}
+
+void TestSMSFFT::test_threads() {
+    const int size = 1024;
+    std::vector<sfloat> expected(size);
+    test_signal(size, &expected[0]);
+    transform(SMS_FFT_FFTW, false, size, &expected[0]);
+
+    for(int n = 0; n < 4; n++) {
+        std::vector<sfloat> signal(size);
+        test_signal(size, &signal[0]);
+
+        pthread_t thread;
+        CPPUNIT_ASSERT(pthread_create(&thread, NULL, fft_thread,
+                                      &signal) == 0);
+        pthread_join(thread, NULL);
+
+        for(int i = 0; i < size; i++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], signal[i], 1e-12);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef TEST_SMS_H
+#define TEST_SMS_H
+
+#include <vector>
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C" {
+    #include "../src/sms/sms.h"
+}
+
+#include "../src/simpl/fft_plans.h"
+
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestSMSFFT
+// ---------------------------------------------------------------------------
+class TestSMSFFT : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestSMSFFT);
+    CPPUNIT_TEST(test_backend);
+    CPPUNIT_TEST(test_fft);
+    CPPUNIT_TEST(test_ifft);
+    CPPUNIT_TEST(test_threads);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+protected:
+    int _backend;
+
+    void test_backend();
+    void test_fft();
+    void test_ifft();
+    void test_threads();
+};
+
+} // end of namespace simpl
+
+#endif
@@ -0,0 +1,96 @@
+#include <math.h>
+#include <vector>
+
+#include "test_spectrum.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestSpectrum
+// ---------------------------------------------------------------------------
+static const double PRECISION = 0.0001;
+
+static void sine(int size, sample frequency, sample amplitude,
+                 int sampling_rate, std::vector<sample>& audio) {
+    audio.resize(size);
+    for(int i = 0; i < size; i++) {
+        audio[i] = amplitude * sin(2 * M_PI * frequency * i / sampling_rate);
+    }
+}
+
+void TestSpectrum::test_errors() {
+    CPPUNIT_ASSERT_THROW(Spectrum(1024, "invalid"), Exception);
+    CPPUNIT_ASSERT_THROW(Spectrum(1), Exception);
+
+    Spectrum s(1024);
+    CPPUNIT_ASSERT_THROW(s.window_type("invalid"), Exception);
+    CPPUNIT_ASSERT_THROW(s.size(0), Exception);
+    CPPUNIT_ASSERT(s.window_type() == "hamming");
+    CPPUNIT_ASSERT_EQUAL(1024, s.size());
+    CPPUNIT_ASSERT_EQUAL(513, s.num_bins());
+}
+
+void TestSpectrum::test_magnitudes() {
+    int size = 1024;
+    int bin = 64;
+    const char* window_types[] = {"hamming", "hann", "blackman"};
+    std::vector<sample> audio;
+
+    for(int w = 0; w < 3; w++) {
+        Spectrum s(size, window_types[w]);
+        sine(size, bin * 44100.0 / size, 0.5, 44100, audio);
+        s.analyse(size, &audio[0]);
+
+        // the window is normalised, so a sine at a bin frequency has a
+        // magnitude of half its amplitude
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, s.magnitudes()[bin], 0.001);
+        CPPUNIT_ASSERT(s.magnitudes()[bin] > s.magnitudes()[bin - 1]);
+        CPPUNIT_ASSERT(s.magnitudes()[bin] > s.magnitudes()[bin + 1]);
+        CPPUNIT_ASSERT(s.magnitudes()[bin * 2] < 0.001);
+
+        // without reassignment the frequencies are the bin frequencies
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(bin * 44100.0 / size,
+                                     s.frequencies()[bin], PRECISION);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, s.time_offsets()[bin], PRECISION);
+    }
+}
+
+void TestSpectrum::test_reassigned_frequency() {
+    int size = 1024;
+    sample frequency = 1000.0;
+    std::vector<sample> audio;
+    sine(size, frequency, 0.5, 44100, audio);
+
+    Spectrum s(size, "hann", true);
+    s.analyse(size, &audio[0]);
+
+    // the largest bin is reassigned to the frequency of the sine, which is
+    // between bins
+    int bin = (int)(frequency * size / 44100.0 + 0.5);
+    CPPUNIT_ASSERT(fabs(bin * 44100.0 / size - frequency) > 5.0);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(frequency, s.frequencies()[bin], 0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(frequency, s.frequencies()[bin + 1], 1.0);
+
+    // the sine is stationary, so its energy is at the centre of the frame
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, s.time_offsets()[bin], 0.0001);
+
+    s.sampling_rate(22050);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(22050.0 / size, s.frequencies()[1],
+                                 PRECISION);
+}
+
+void TestSpectrum::test_reassigned_time() {
+    int size = 512;
+    int position = 384;
+    std::vector<sample> audio(size, 0.0);
+    audio[position] = 1.0;
+
+    Spectrum s(size, "hamming", true);
+    s.analyse(size, &audio[0]);
+
+    sample expected = (position - ((size - 1) / 2.0)) / 44100.0;
+    for(int i = 1; i < s.num_bins() - 1; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, s.time_offsets()[i],
+                                     PRECISION);
+    }
+}
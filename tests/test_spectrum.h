@@ -0,0 +1,33 @@
+#ifndef TEST_SPECTRUM_H
+#define TEST_SPECTRUM_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/spectrum.h"
+#include "../src/simpl/exceptions.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestSpectrum
+// ---------------------------------------------------------------------------
+class TestSpectrum : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestSpectrum);
+    CPPUNIT_TEST(test_errors);
+    CPPUNIT_TEST(test_magnitudes);
+    CPPUNIT_TEST(test_reassigned_frequency);
+    CPPUNIT_TEST(test_reassigned_time);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void test_errors();
+    void test_magnitudes();
+    void test_reassigned_frequency();
+    void test_reassigned_time();
+};
+
+} // end of namespace simpl
+
+#endif
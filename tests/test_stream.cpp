@@ -0,0 +1,124 @@
+#include <algorithm>
+
+#include "test_stream.h"
+
+using namespace simpl;
+
+// ---------------------------------------------------------------------------
+//	TestStream
+// ---------------------------------------------------------------------------
+static const int STREAM_FRAME_SIZE = 512;
+static const int STREAM_HOP_SIZE = 128;
+
+// Stream audio through a new set of MQ objects, block_size samples at a
+// time, with enough trailing silence to flush the whole signal
+static void stream_mq(int block_size, std::vector<sample>& audio,
+                      std::vector<sample>& output) {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    pd.frame_size(STREAM_FRAME_SIZE);
+    pd.hop_size(STREAM_HOP_SIZE);
+
+    Stream stream(&pd, &pt, &synth);
+
+    std::vector<sample> input(audio);
+    input.resize(audio.size() + stream.latency(), 0.0);
+    output.resize(input.size());
+
+    for(int pos = 0; pos < input.size(); pos += block_size) {
+        int n = std::min(block_size, (int)input.size() - pos);
+        stream.process(n, &input[pos], &output[pos]);
+    }
+}
+
+void TestStream::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    std::vector<sample> audio(_sf.frames(), 0.0);
+    _sf.read(&audio[0], (int)_sf.frames());
+
+    // a frame of silence followed by part of the flute
+    int start = (int)_sf.frames() / 2;
+    _audio.assign(STREAM_FRAME_SIZE, 0.0);
+    _audio.insert(_audio.end(), audio.begin() + start,
+                  audio.begin() + start + 8192);
+}
+
+void TestStream::test_latency() {
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+
+    pd.frame_size(512);
+    pd.hop_size(256);
+    Stream stream(&pd, &pt, &synth);
+    CPPUNIT_ASSERT_EQUAL(512, stream.frame_size());
+    CPPUNIT_ASSERT_EQUAL(256, stream.hop_size());
+    CPPUNIT_ASSERT_EQUAL(256, synth.hop_size());
+    CPPUNIT_ASSERT_EQUAL(511, stream.latency());
+
+    pd.frame_size(1024);
+    pd.hop_size(128);
+    stream.prepare();
+    CPPUNIT_ASSERT_EQUAL(128, synth.hop_size());
+    CPPUNIT_ASSERT_EQUAL(1023, stream.latency());
+
+    pd.hop_size(2048);
+    CPPUNIT_ASSERT_THROW(stream.prepare(), Exception);
+}
+
+void TestStream::test_block_sizes() {
+    std::vector<sample> expected;
+    stream_mq(STREAM_HOP_SIZE, _audio, expected);
+
+    double energy = 0.0;
+    for(int i = 0; i < expected.size(); i++) {
+        energy += expected[i] * expected[i];
+    }
+    CPPUNIT_ASSERT(energy > 0.0);
+
+    int block_sizes[] = {1, 17, 64, 100, 1000};
+    for(int i = 0; i < 5; i++) {
+        std::vector<sample> output;
+        stream_mq(block_sizes[i], _audio, output);
+
+        CPPUNIT_ASSERT_EQUAL(expected.size(), output.size());
+        for(int j = 0; j < output.size(); j++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[j], output[j], PRECISION);
+        }
+    }
+}
+
+void TestStream::test_offline() {
+    std::vector<sample> output;
+    stream_mq(100, _audio, output);
+
+    MQPeakDetection pd;
+    MQPartialTracking pt;
+    MQSynthesis synth;
+    pd.frame_size(STREAM_FRAME_SIZE);
+    pd.hop_size(STREAM_HOP_SIZE);
+    synth.hop_size(STREAM_HOP_SIZE);
+
+    Frames frames = pd.find_peaks(_audio.size(), &_audio[0]);
+    frames = pt.find_partials(frames);
+    frames = synth.synth(frames);
+
+    int latency = STREAM_FRAME_SIZE - 1;
+
+    // frames that extend past the end of the signal are zero padded
+    // offline, but contain the following input when streaming
+    for(int i = 0; i < frames.size(); i++) {
+        int start = i * STREAM_HOP_SIZE;
+        if(start + STREAM_FRAME_SIZE > _audio.size()) {
+            break;
+        }
+
+        for(int j = 0; j < STREAM_HOP_SIZE; j++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(frames[i]->synth()[j],
+                                         output[start + latency + j],
+                                         PRECISION);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef TEST_STREAM_H
+#define TEST_STREAM_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../src/simpl/base.h"
+#include "../src/simpl/peak_detection.h"
+#include "../src/simpl/partial_tracking.h"
+#include "../src/simpl/synthesis.h"
+#include "../src/simpl/stream.h"
+#include "test_common.h"
+
+namespace simpl
+{
+
+// ---------------------------------------------------------------------------
+//	TestStream
+// ---------------------------------------------------------------------------
+class TestStream : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestStream);
+    CPPUNIT_TEST(test_latency);
+    CPPUNIT_TEST(test_block_sizes);
+    CPPUNIT_TEST(test_offline);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    SndfileHandle _sf;
+    std::vector<sample> _audio;
+
+    void test_latency();
+    void test_block_sizes();
+    void test_offline();
+};
+
+} // end of namespace simpl
+
+#endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "test_synthesis.h"
 
 using namespace simpl;
@@ -124,6 +126,61 @@ void TestMQSynthesis::test_changing_frame_size() {
     ::test_changing_frame_size(&_pd, &_pt, &_synth, &_sf);
 }
 
+void TestMQSynthesis::test_oscillator_bank() {
+    // enough oscillators to use every vector width and the scalar remainder
+    const int num_oscillators = 11;
+    const int num_samples = 1024;
+    sample amps[num_oscillators];
+    sample amp_incs[num_oscillators];
+    sample phases[num_oscillators];
+    sample freqs[num_oscillators];
+    sample alphas[num_oscillators];
+    sample betas[num_oscillators];
+
+    for(int i = 0; i < num_oscillators; i++) {
+        sample next_freq = M_PI * (i + 0.5) / num_oscillators;
+        sample phase_diff = M_PI * (i - 5) / 6.0;
+        amps[i] = 1.0 / (i + 1);
+        amp_incs[i] = (0.5 - amps[i]) / num_samples;
+        phases[i] = M_PI * (5 - i) / 6.0;
+        freqs[i] = M_PI * (num_oscillators - i - 0.5) / num_oscillators;
+        alphas[i] = ((3.0 / (num_samples * num_samples)) * phase_diff) -
+                    ((next_freq - freqs[i]) / num_samples);
+        betas[i] = ((-2.0 / pow((sample)num_samples, 3.0)) * phase_diff) +
+                   ((next_freq - freqs[i]) / (num_samples * num_samples));
+    }
+
+    // evaluated in double precision in both builds
+    std::vector<double> expected(num_samples, 0.0);
+    for(int i = 0; i < num_oscillators; i++) {
+        for(int n = 0; n < num_samples; n++) {
+            double phase = (double)phases[i] + ((double)freqs[i] * n) +
+                           ((double)alphas[i] * pow((double)n, 2.0)) +
+                           ((double)betas[i] * pow((double)n, 3.0));
+            double amp = (double)amps[i] + ((n + 1) * (double)amp_incs[i]);
+            expected[n] += amp * cos(phase);
+        }
+    }
+
+    // with float samples the phases of up to about 3000 radians here can
+    // only be represented to within about 2e-4 radians
+#ifdef SIMPL_FLOAT
+    const double tolerance = 5e-4;
+#else
+    const double tolerance = 1e-9;
+#endif
+
+    for(int level = MQ_SIMD_NONE; level <= mq_simd_level(); level++) {
+        std::vector<sample> out(num_samples, 0.0);
+        mq_oscillator_bank(num_oscillators, num_samples, amps, amp_incs,
+                           phases, freqs, alphas, betas, &out[0], level);
+
+        for(int n = 0; n < num_samples; n++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[n], out[n], tolerance);
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 //	TestLorisSynthesis
 // ---------------------------------------------------------------------------
@@ -144,6 +201,72 @@ void TestLorisSynthesis::test_changing_frame_size() {
     ::test_changing_frame_size(&_pd, &_pt, &_synth, &_sf);
 }
 
+void TestLorisSynthesis::test_oscillator_bank() {
+    // not a multiple of the 4 oscillators processed together
+    const int num_oscillators = 7;
+    const int num_samples = 512;
+    const int num_frames = 6;
+    const int sampling_rate = 44100;
+    sample amps[num_oscillators];
+    sample freqs[num_oscillators];
+    sample bandwidths[num_oscillators];
+
+    // the breakpoints of each frame, going through zero bandwidth (which
+    // skips the noise), bandwidths outside [0, 1] and the Nyquist frequency
+    std::vector<std::vector<Loris::Breakpoint> > breakpoints(num_frames);
+    for(int f = 0; f < num_frames; f++) {
+        for(int i = 0; i < num_oscillators; i++) {
+            double freq = 200.0 * (i + 1) * (1.0 + (0.05 * f));
+            if(i == num_oscillators - 1 && f > 2) {
+                freq = 23000.0;
+            }
+            double amp = 0.1 + (0.05 * ((i + f) % 3));
+            double bw = 0.2 * (((i * f) % 7) - 1);
+            if(i == 1) {
+                bw = 0.0;
+            }
+            breakpoints[f].push_back(Loris::Breakpoint(freq, amp, bw, 0.0));
+        }
+    }
+
+    // Loris output, in double precision in both builds
+    std::vector<Loris::Oscillator> oscs(num_oscillators);
+    std::vector<double> expected(num_samples * num_frames, 0.0);
+    for(int f = 0; f < num_frames; f++) {
+        double* begin = &expected[f * num_samples];
+        for(int i = 0; i < num_oscillators; i++) {
+            oscs[i].oscillate(begin, begin + num_samples, breakpoints[f][i],
+                              sampling_rate);
+        }
+    }
+
+#ifdef SIMPL_FLOAT
+    const double tolerance = 1e-5;
+#else
+    const double tolerance = 1e-10;
+#endif
+
+    for(int level = MQ_SIMD_NONE; level <= mq_simd_level(); level++) {
+        LorisOscillatorBank bank(num_oscillators);
+        std::vector<sample> out(num_samples * num_frames, 0.0);
+
+        for(int f = 0; f < num_frames; f++) {
+            for(int i = 0; i < num_oscillators; i++) {
+                amps[i] = breakpoints[f][i].amplitude();
+                freqs[i] = breakpoints[f][i].frequency();
+                bandwidths[i] = breakpoints[f][i].bandwidth();
+            }
+            bank.oscillate(num_oscillators, num_samples, amps, freqs,
+                           bandwidths, sampling_rate, &out[f * num_samples],
+                           level);
+        }
+
+        for(int n = 0; n < num_samples * num_frames; n++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[n], out[n], tolerance);
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 //	TestSMSSynthesis
 // ---------------------------------------------------------------------------
@@ -204,3 +327,70 @@ void TestSndObjSynthesis::test_basic() {
 void TestSndObjSynthesis::test_changing_frame_size() {
     ::test_changing_frame_size(&_pd, &_pt, &_synth, &_sf);
 }
+
+
+// ---------------------------------------------------------------------------
+//	TestIFFTSynthesis
+// ---------------------------------------------------------------------------
+void TestIFFTSynthesis::setUp() {
+    _sf = SndfileHandle(TEST_AUDIO_FILE);
+
+    if(_sf.error() > 0) {
+        throw Exception(std::string("Could not open audio file: ") +
+                        std::string(TEST_AUDIO_FILE));
+    }
+}
+
+void TestIFFTSynthesis::test_basic() {
+    ::test_basic(&_pd, &_pt, &_synth, &_sf);
+}
+
+void TestIFFTSynthesis::test_changing_frame_size() {
+    ::test_changing_frame_size(&_pd, &_pt, &_synth, &_sf);
+}
+
+void TestIFFTSynthesis::test_sinusoids() {
+    // many stationary partials, from near 0 Hz to near Nyquist
+    int num_partials = 500;
+    int hop_size = 256;
+    int num_frames = 10;
+    sample amp = 0.001;
+
+    IFFTSynthesis synth;
+    synth.max_partials(num_partials);
+    synth.hop_size(hop_size);
+
+    std::vector<double> freqs(num_partials);
+    for(int i = 0; i < num_partials; i++) {
+        freqs[i] = 20.0 + (i * 44.0) + (i % 7);
+    }
+
+    double max_error = 0.0;
+    for(int n = 0; n < num_frames; n++) {
+        Frame frame(hop_size, true);
+        frame.max_partials(num_partials);
+        frame.synth_size(hop_size);
+        for(int i = 0; i < num_partials; i++) {
+            frame.add_partial(amp, freqs[i], i * 0.1, 0.0);
+        }
+        synth.synth_frame(&frame);
+
+        // the first frame fades in, and each frame's partial values are
+        // reached at the end of its hop
+        if(n == 0) {
+            continue;
+        }
+        for(int j = 0; j < hop_size; j++) {
+            double t = ((n - 1) * hop_size) + j;
+            double expected = 0.0;
+            for(int i = 0; i < num_partials; i++) {
+                expected += amp * cos((2 * M_PI * freqs[i] * t / 44100.0) +
+                                      (i * 0.1));
+            }
+            max_error = std::max(max_error,
+                                 fabs(expected - frame.synth()[j]));
+        }
+    }
+
+    CPPUNIT_ASSERT(max_error < num_partials * amp * 1e-4);
+}
@@ -19,6 +19,7 @@ class TestMQSynthesis : public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST_SUITE(TestMQSynthesis);
     CPPUNIT_TEST(test_basic);
     CPPUNIT_TEST(test_changing_frame_size);
+    CPPUNIT_TEST(test_oscillator_bank);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -32,6 +33,7 @@ protected:
 
     void test_basic();
     void test_changing_frame_size();
+    void test_oscillator_bank();
 };
 
 // ---------------------------------------------------------------------------
@@ -41,6 +43,7 @@ class TestLorisSynthesis : public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST_SUITE(TestLorisSynthesis);
     CPPUNIT_TEST(test_basic);
     CPPUNIT_TEST(test_changing_frame_size);
+    CPPUNIT_TEST(test_oscillator_bank);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -54,6 +57,7 @@ protected:
 
     void test_basic();
     void test_changing_frame_size();
+    void test_oscillator_bank();
 };
 
 // ---------------------------------------------------------------------------
@@ -104,6 +108,31 @@ protected:
     void test_changing_frame_size();
 };
 
+
+// ---------------------------------------------------------------------------
+//	TestIFFTSynthesis
+// ---------------------------------------------------------------------------
+class TestIFFTSynthesis : public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE(TestIFFTSynthesis);
+    CPPUNIT_TEST(test_basic);
+    CPPUNIT_TEST(test_changing_frame_size);
+    CPPUNIT_TEST(test_sinusoids);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+
+protected:
+    MQPeakDetection _pd;
+    MQPartialTracking _pt;
+    IFFTSynthesis _synth;
+    SndfileHandle _sf;
+
+    void test_basic();
+    void test_changing_frame_size();
+    void test_sinusoids();
+};
+
 } // end of namespace simpl
 
 #endif
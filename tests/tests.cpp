@@ -3,18 +3,35 @@
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
 #include "test_base.h"
+#include "test_fft_plans.h"
+#include "test_mq.h"
 #include "test_peak_detection.h"
 #include "test_partial_tracking.h"
 #include "test_synthesis.h"
 #include "test_residual.h"
+#include "test_sms.h"
+#include "test_stream.h"
+#include "test_allocation.h"
+#include "test_profile.h"
+#include "test_batch.h"
+#include "test_precision.h"
+#include "test_archive.h"
+#include "test_sdif.h"
+#include "test_spectrum.h"
+#include "test_pipeline.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestPeak);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestFrame);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestFramePool);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestFFTPlans);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestMQ);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestMQPeakDetection);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSndObjPeakDetection);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestTWM);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestLorisPeakDetection);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestMultiPeakDetection);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestMQPartialTracking);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestLPPartialTracking);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSMSPartialTracking);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSndObjPartialTracking);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestLorisPartialTracking);
@@ -22,7 +39,18 @@ CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestMQSynthesis);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestLorisSynthesis);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSMSSynthesis);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSndObjSynthesis);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestIFFTSynthesis);
 CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSMSResidual);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSMSFFT);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestStream);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestAllocation);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestProfile);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestBatch);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestPrecision);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestArchive);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSDIF);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestSpectrum);
+CPPUNIT_TEST_SUITE_REGISTRATION(simpl::TestPipeline);
 
 int main(int arg, char **argv) {
     CppUnit::TextTestRunner runner;